@@ -27,9 +27,34 @@
 #include <OpenSim/Analyses/StaticOptimization.h>
 #include <OpenSim/Auxiliary/auxiliaryTestFunctions.h>
 
+#include <atomic>
+
 using namespace OpenSim;
 using namespace std;
 
+/** A frame-independent analysis that counts the frames that it and all of its
+copies are stepped with, and records the largest number of analyses in the
+models that they are stepped with. */
+class FrameCountingAnalysis : public Analysis {
+OpenSim_DECLARE_CONCRETE_OBJECT(FrameCountingAnalysis, Analysis);
+public:
+    static std::atomic<int> numFrames;
+    static std::atomic<int> maxNumAnalyses;
+
+    bool isFrameIndependent() const override { return true; }
+
+    int step(const SimTK::State& s, int stepNumber) override {
+        ++numFrames;
+        const int numAnalyses = _model->getAnalysisSet().getSize();
+        int max = maxNumAnalyses;
+        while (numAnalyses > max &&
+                !maxNumAnalyses.compare_exchange_weak(max, numAnalyses)) {}
+        return 0;
+    }
+};
+std::atomic<int> FrameCountingAnalysis::numFrames(0);
+std::atomic<int> FrameCountingAnalysis::maxNumAnalyses(0);
+
 /** @param muscleModelClassName selects from:
         Thelen2003Muscle_Deprecated
         Thelen2003Muscle
@@ -40,6 +65,10 @@ void testArm26(const string& muscleModelClassName, double atol, double ftol);
 
 void testArm26DisabledMuscles();
 
+void testActiveSetSolver();
+
+void testParallelAnalysis();
+
 void testLapackErrorDLASD4();
 
 void testModelWithPassiveForces();
@@ -105,6 +134,22 @@ int main()
         failures.push_back("testArm26DisabledMuscles");
     }
 
+    try {
+        testActiveSetSolver();
+    }
+    catch (const std::exception& e) {
+        cout << e.what() << endl;
+        failures.push_back("testActiveSetSolver");
+    }
+
+    try {
+        testParallelAnalysis();
+    }
+    catch (const std::exception& e) {
+        cout << e.what() << endl;
+        failures.push_back("testParallelAnalysis");
+    }
+
     if (!failures.empty()) {
         cout << "Done, with failure(s): " << failures << endl;
         return 1;
@@ -265,4 +310,139 @@ void testArm26DisabledMuscles() {
     ASSERT_EQUAL(forces.getColumnLabels().findIndex("TRIlat"), -1);
     ASSERT_EQUAL(forces.getColumnLabels().findIndex("TRImed"), -1);
 
-}
\ No newline at end of file
+}
+
+void testActiveSetSolver() {
+    // The active-set solver must find the same activations and forces as the
+    // optimizer, with and without active bounds.
+    for (const std::string& name : {"arm26", "arm26_bounds"}) {
+        AnalyzeTool analyze1(name + "_Setup_StaticOptimization.xml");
+        analyze1.setResultsDir("Results_" + name + "_Optimizer");
+        analyze1.run();
+
+        AnalyzeTool analyze2(name + "_Setup_StaticOptimization.xml");
+        analyze2.setResultsDir("Results_" + name + "_ActiveSetSolver");
+        auto& so = dynamic_cast<StaticOptimization&>(
+                analyze2.getModel().updAnalysisSet().get("StaticOptimization"));
+        so.setUseActiveSetSolver(true);
+        analyze2.run();
+        // Every time must be solved by the active-set solver; otherwise the
+        // comparison below would only test the optimizer against itself.
+        ASSERT(so.getNumActiveSetSolverSolutions() > 0, __FILE__, __LINE__,
+                name + ": the active-set solver was not used.");
+        ASSERT_EQUAL(0, so.getNumActiveSetSolverFailures(), __FILE__,
+                __LINE__, name + ": the active-set solver failed.");
+
+        const std::string prefix = "/" + name + "_StaticOptimization_";
+        Storage activations1(analyze1.getResultsDir() + prefix +
+                "activation.sto");
+        Storage activations2(analyze2.getResultsDir() + prefix +
+                "activation.sto");
+        CHECK_STORAGE_AGAINST_STANDARD(activations2, activations1,
+                std::vector<double>(6, 0.005), __FILE__, __LINE__,
+                name + " activations with active-set solver failed.");
+
+        Storage forces1(analyze1.getResultsDir() + prefix + "force.sto");
+        Storage forces2(analyze2.getResultsDir() + prefix + "force.sto");
+        CHECK_STORAGE_AGAINST_STANDARD(forces2, forces1,
+                std::vector<double>(6, 1), __FILE__, __LINE__,
+                name + " forces with active-set solver failed.");
+        cout << name << ": test ActiveSetSolver passed." << endl;
+    }
+}
+
+void testParallelAnalysis() {
+    // Analyzing the frames in parallel chunks must give the same results, in
+    // the same order, as analyzing them in one pass.
+    AnalyzeTool analyze1("arm26_Setup_StaticOptimization.xml");
+    analyze1.setResultsDir("Results_arm26_Serial");
+    analyze1.run();
+
+    AnalyzeTool analyze2("arm26_Setup_StaticOptimization.xml");
+    analyze2.setResultsDir("Results_arm26_Parallel");
+    analyze2.setNumThreads(4);
+    analyze2.run();
+
+    const std::string prefix = "/arm26_StaticOptimization_";
+    Storage activations1(analyze1.getResultsDir() + prefix + "activation.sto");
+    Storage activations2(analyze2.getResultsDir() + prefix + "activation.sto");
+    ASSERT(activations2.getSize() == activations1.getSize(), __FILE__,
+            __LINE__, "Parallel analysis recorded a different number of "
+            "frames.");
+    for (int i = 0; i < activations1.getSize(); ++i) {
+        ASSERT_EQUAL(activations1.getStateVector(i)->getTime(),
+                activations2.getStateVector(i)->getTime(), 1e-12);
+    }
+    CHECK_STORAGE_AGAINST_STANDARD(activations2, activations1,
+            std::vector<double>(6, 0.005), __FILE__, __LINE__,
+            "arm26 activations of parallel analysis failed.");
+
+    Storage forces1(analyze1.getResultsDir() + prefix + "force.sto");
+    Storage forces2(analyze2.getResultsDir() + prefix + "force.sto");
+    CHECK_STORAGE_AGAINST_STANDARD(forces2, forces1,
+            std::vector<double>(6, 1), __FILE__, __LINE__,
+            "arm26 forces of parallel analysis failed.");
+    cout << "arm26: test ParallelAnalysis passed." << endl;
+
+    // The chunks of a model with external loads whose data file is given
+    // relative to the ExternalLoads file, which requires changing the working
+    // directory while the models are connected.
+    AnalyzeTool analyze3("UsingRelativePaths/Setup_SO.xml");
+    analyze3.setResultsDir("Results_UsingRelativePaths_Serial");
+    analyze3.setFinalTime(0.05);
+    analyze3.run();
+
+    AnalyzeTool analyze4("UsingRelativePaths/Setup_SO.xml");
+    analyze4.setResultsDir("Results_UsingRelativePaths_Parallel");
+    analyze4.setFinalTime(0.05);
+    analyze4.setNumThreads(3);
+    analyze4.run();
+
+    const std::string prefix2 = "/" + analyze3.getName() +
+            "_StaticOptimization_";
+    Storage activations3(analyze3.getResultsDir() + prefix2 +
+            "activation.sto");
+    Storage activations4(analyze4.getResultsDir() + prefix2 +
+            "activation.sto");
+    ASSERT(activations3.getSize() > 3, __FILE__, __LINE__,
+            "Expected more frames than threads.");
+    ASSERT(activations4.getSize() == activations3.getSize(), __FILE__,
+            __LINE__, "Parallel analysis with external loads recorded a "
+            "different number of frames.");
+    CHECK_STORAGE_AGAINST_STANDARD(activations4, activations3,
+            std::vector<double>(activations3.getColumnLabels().getSize() - 1,
+                    1e-6),
+            __FILE__, __LINE__,
+            "Activations of parallel analysis with external loads failed.");
+
+    // Like the serial analysis, the parallel analysis leaves the state at
+    // the last frame. Each chunk model has exactly the analyses of the
+    // original model, and each frame is analyzed once.
+    FrameCountingAnalysis counter;
+    Model model("arm26.osim");
+    model.addAnalysis(&counter);
+    SimTK::State& s = model.initSystem();
+    const Coordinate& elbow = model.getCoordinateSet().get("r_elbow_flex");
+    Array<std::string> labels("time", 1);
+    labels.append(model.getStateVariableNames());
+    Storage states;
+    states.setColumnLabels(labels);
+    const int elbowColumn = labels.findIndex(
+            elbow.getAbsolutePathString() + "/value") - 1;
+    for (int i = 0; i < 10; ++i) {
+        SimTK::Vector values = model.getStateVariableValues(s);
+        values[elbowColumn] = 0.1 * i;
+        states.append(0.01 * i, values);
+    }
+    AnalyzeTool::run(s, model, 0, states.getSize() - 1, states, false, 3);
+    ASSERT_EQUAL(0.09, s.getTime(), 1e-12, __FILE__, __LINE__,
+            "Parallel analysis did not leave the state at the last frame.");
+    ASSERT_EQUAL(0.9, elbow.getValue(s), 1e-12, __FILE__, __LINE__,
+            "Parallel analysis did not leave the state at the last frame.");
+    ASSERT_EQUAL(1, FrameCountingAnalysis::maxNumAnalyses.load(), __FILE__,
+            __LINE__, "A chunk model has more analyses than the original.");
+    ASSERT_EQUAL(states.getSize(), FrameCountingAnalysis::numFrames.load(),
+            __FILE__, __LINE__, "Parallel analysis did not analyze each "
+            "frame exactly once.");
+    cout << "UsingRelativePaths: test ParallelAnalysis passed." << endl;
+}
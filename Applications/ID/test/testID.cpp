@@ -21,6 +21,7 @@
  * limitations under the License.                                             *
  * -------------------------------------------------------------------------- */
 // INCLUDE
+#include <fstream>
 #include <string>
 #include <iostream>
 #include <OpenSim/version.h>
@@ -28,6 +29,7 @@
 #include <OpenSim/Simulation/Model/Model.h>
 #include <OpenSim/Simulation/Model/ForceSet.h>
 #include <OpenSim/Tools/InverseDynamicsTool.h>
+#include <OpenSim/Tools/BatchToolRunner.h>
 #include <OpenSim/Simulation/InverseDynamicsSolver.h>
 #include <OpenSim/Auxiliary/auxiliaryTestFunctions.h>
 #include <OpenSim/Simulation/SimbodyEngine/BallJoint.h>
@@ -39,6 +41,8 @@ using namespace std;
 
 void testThoracoscapularShoulderModel();
 void testBallJoint();
+void testBatchToolRunner();
+void testParallelFrames();
 
 int main()
 {
@@ -61,6 +65,12 @@ int main()
 
         testThoracoscapularShoulderModel();
         cout << "testThoracoscapularShoulderModel passed" << endl;
+
+        testBatchToolRunner();
+        cout << "testBatchToolRunner passed" << endl;
+
+        testParallelFrames();
+        cout << "testParallelFrames passed" << endl;
         // Commented out testBallJoint due to sporadic crash in Model destructor
         // -Ayman 03/21
         //testBallJoint();
@@ -127,6 +137,83 @@ void testThoracoscapularShoulderModel() {
         "testThoracoscapularShoulderModel failed");
 }
 
+void testBatchToolRunner() {
+    // Two trials with the same input and a trial whose input is missing.
+    BatchToolRunner runner("arm26_Setup_InverseDynamics.xml");
+    runner.setResultsDir("BatchResults");
+    runner.setNumThreads(2);
+    runner.addTrial("arm26_a", "arm26_InverseKinematics.mot");
+    runner.addTrial("arm26_missing", "arm26_missing.mot");
+    runner.addTrial("arm26_b", "arm26_InverseKinematics.mot");
+    ASSERT_THROW(Exception, runner.addTrial("arm26_a", "other.mot"));
+    const auto results = runner.run();
+    ASSERT(results.size() == 3);
+    ASSERT(results[0].success && results[2].success);
+    ASSERT(!results[1].success && !results[1].message.empty());
+    ASSERT(results[1].name == "arm26_missing");
+    Storage standard("std_arm26_InverseDynamics.sto");
+    for (const auto& name : {"arm26_a", "arm26_b"}) {
+        Storage result(std::string("BatchResults/") + name + "_id.sto");
+        CHECK_STORAGE_AGAINST_STANDARD(result, standard,
+                std::vector<double>(23, 1e-2), __FILE__, __LINE__,
+                "testBatchToolRunner failed");
+        ASSERT(IO::FileExists(std::string("BatchResults/") + name + ".log"));
+    }
+
+    // Trials read from a file; the external loads come from the setup file.
+    {
+        std::ofstream trials("testBatchToolRunner_trials.txt");
+        trials << "# name input\n"
+               << "walk1 subject01_walk1_ik.mot\n\n";
+    }
+    BatchToolRunner gaitRunner("subject01_Setup_InverseDynamics.xml");
+    gaitRunner.setResultsDir("BatchResults");
+    gaitRunner.setWriteTrialLogs(false);
+    gaitRunner.addTrialsFromFile("testBatchToolRunner_trials.txt");
+    ASSERT(gaitRunner.getTrials().size() == 1);
+    const auto gaitResults = gaitRunner.run();
+    ASSERT(gaitResults[0].success && gaitResults[0].logFile.empty());
+    Storage gaitResult("BatchResults/walk1_id.sto");
+    Storage gaitStandard("std_subject01_InverseDynamics.sto");
+    CHECK_STORAGE_AGAINST_STANDARD(gaitResult, gaitStandard,
+            std::vector<double>(23, 2.0), __FILE__, __LINE__,
+            "testBatchToolRunner failed");
+}
+
+void testParallelFrames() {
+    // Solving chunks of frames in parallel gives the same generalized forces
+    // and body forces as solving the frames serially.
+    Array<std::string> allJoints;
+    allJoints.append("All");
+    InverseDynamicsTool serial("subject01_Setup_InverseDynamics.xml");
+    serial.setJointsToReportBodyForces(allJoints);
+    serial.setOutputGenForceFileName("subject01_InverseDynamics_serial.sto");
+    serial.setOutputBodyForcesFileName("subject01_BodyForces_serial.sto");
+    serial.run();
+    InverseDynamicsTool parallel("subject01_Setup_InverseDynamics.xml");
+    parallel.setJointsToReportBodyForces(allJoints);
+    parallel.setNumThreads(4);
+    parallel.setOutputGenForceFileName(
+            "subject01_InverseDynamics_parallel.sto");
+    parallel.setOutputBodyForcesFileName("subject01_BodyForces_parallel.sto");
+    parallel.run();
+
+    for (const std::string& name : {"InverseDynamics", "BodyForces"}) {
+        Storage serialResult("Results/subject01_" + name + "_serial.sto");
+        Storage parallelResult("Results/subject01_" + name + "_parallel.sto");
+        ASSERT(parallelResult.getSize() == serialResult.getSize());
+        const int nc = serialResult.getColumnLabels().getSize() - 1;
+        ASSERT(parallelResult.getColumnLabels().getSize() == nc + 1);
+        CHECK_STORAGE_AGAINST_STANDARD(parallelResult, serialResult,
+                std::vector<double>(nc, 1e-8), __FILE__, __LINE__,
+                "testParallelFrames failed");
+    }
+
+    InverseDynamicsTool invalid("subject01_Setup_InverseDynamics.xml");
+    invalid.setNumThreads(0);
+    ASSERT_THROW(Exception, invalid.run());
+}
+
 void testBallJoint() {
     Model mdl;
     Body* bdy = new Body("body", 1.0, SimTK::Vec3(0), SimTK::Inertia(1));
@@ -89,6 +89,54 @@ int main()
         failures.push_back("testInverseKinematicsGait2354");
     }
 
+    try {
+        // Solving chunks of frames in parallel gives the same output files as
+        // solving the frames serially, with values within solver accuracy.
+        InverseKinematicsTool ikSerial("subject01_Setup_InverseKinematics.xml");
+        ikSerial.setName("subject01_serial");
+        ikSerial.set_report_errors(true);
+        ikSerial.setOutputMotionFileName("subject01_walk1_ik_serial.mot");
+        ikSerial.run();
+        InverseKinematicsTool ikParallel(
+                "subject01_Setup_InverseKinematics.xml");
+        ikParallel.setName("subject01_parallel");
+        ikParallel.set_report_errors(true);
+        ikParallel.set_num_threads(4);
+        ikParallel.setOutputMotionFileName("subject01_walk1_ik_parallel.mot");
+        ikParallel.run();
+        Storage serial("subject01_walk1_ik_serial.mot");
+        Storage parallel("subject01_walk1_ik_parallel.mot");
+        ASSERT(parallel.getSize() == serial.getSize());
+        CHECK_STORAGE_AGAINST_STANDARD(parallel, serial,
+            std::vector<double>(24, 0.01), __FILE__, __LINE__,
+            "testInverseKinematicsParallel failed");
+        for (const std::string& suffix :
+                {"_ik_marker_errors.sto", "_ik_model_marker_locations.sto"}) {
+            TimeSeriesTable serialTable(
+                    ikSerial.getResultsDir() + "/subject01_serial" + suffix);
+            TimeSeriesTable parallelTable(
+                    ikParallel.getResultsDir() + "/subject01_parallel" + suffix);
+            ASSERT(parallelTable.getColumnLabels() ==
+                    serialTable.getColumnLabels());
+            ASSERT(parallelTable.getIndependentColumn() ==
+                    serialTable.getIndependentColumn());
+            const auto& serialMatrix = serialTable.getMatrix();
+            const auto& parallelMatrix = parallelTable.getMatrix();
+            for (int i = 0; i < serialMatrix.nrow(); ++i) {
+                for (int j = 0; j < serialMatrix.ncol(); ++j) {
+                    ASSERT_EQUAL<double>(parallelMatrix(i, j),
+                            serialMatrix(i, j), 1e-3, __FILE__, __LINE__,
+                            "testInverseKinematicsParallel failed");
+                }
+            }
+        }
+        cout << "testInverseKinematicsParallel passed" << endl;
+    }
+    catch (const std::exception& e) {
+        cout << e.what() << endl;
+        failures.push_back("testInverseKinematicsParallel");
+    }
+
     try {
         InverseKinematicsTool ik2("subject01_Setup_InverseKinematics_NoModel.xml");
         Model mdl("subject01_simbody.osim");
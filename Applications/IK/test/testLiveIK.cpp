@@ -33,6 +33,7 @@
 #include <OpenSim/Simulation/InverseKinematicsSolver.h>
 #include <OpenSim/Tools/InverseKinematicsTool.h>
 #include <OpenSim/Tools/IKTaskSet.h>
+#include <OpenSim/Tools/StreamingInverseKinematics.h>
 #include <OpenSim/Auxiliary/auxiliaryTestFunctions.h>
 #include <thread> 
 
@@ -41,6 +42,10 @@ using namespace std;
 
 void testInverseKinematicsSolverWithOrientations();
 void testInverseKinematicsSolverWithEulerAnglesFromFile();
+void testStreamingInverseKinematicsMatchesOfflineTracking();
+void testStreamingInverseKinematicsDropsStaleFrames();
+void testAdvanceTimeWithMarkersReference();
+void testReplayProducerStops();
 TimeSeriesTable_<SimTK::Rotation> convertMotionFileToRotations(
         Model& model, const std::string& motionFile);
 
@@ -157,6 +162,19 @@ int main() {
     catch (const std::exception& e) { 
         cout << e.what() << endl; 
     }
+
+    try {
+        testStreamingInverseKinematicsMatchesOfflineTracking();
+        testStreamingInverseKinematicsDropsStaleFrames();
+        testAdvanceTimeWithMarkersReference();
+        testReplayProducerStops();
+    }
+    catch (const std::exception& e) {
+        cout << e.what() << endl;
+        return 1;
+    }
+    cout << "Done" << endl;
+    return 0;
 }
 TimeSeriesTable_<SimTK::Rotation> convertMotionFileToRotations(
     Model& model,
@@ -350,3 +368,216 @@ void producer(std::shared_ptr<BufferedOrientationsReference> oRef,
         oRef->putValues(t, dataSource.getNearestRow(t));
     }
 }
+
+void testStreamingInverseKinematicsMatchesOfflineTracking()
+{
+    cout << "testStreamingInverseKinematicsMatchesOfflineTracking" << endl;
+    Model model("subject01_simbody.osim");
+    TimeSeriesTable_<SimTK::Vec3> markerData(
+            "subject01_synthetic_marker_data.trc");
+    const auto times = markerData.getIndependentColumn();
+
+    // Track all frames offline.
+    SimTK::Array_<CoordinateReference> coordinateRefs;
+    SimTK::State& s = model.initSystem();
+    InverseKinematicsSolver offlineSolver(model,
+            std::make_shared<MarkersReference>(
+                    markerData, Set<MarkerWeight>()),
+            coordinateRefs);
+    offlineSolver.setAccuracy(1e-5);
+    s.updTime() = times[0];
+    offlineSolver.assemble(s);
+    std::vector<SimTK::Vector> expected;
+    for (size_t i = 1; i < times.size(); ++i) {
+        s.updTime() = times[i];
+        offlineSolver.track(s);
+        expected.push_back(s.getQ());
+    }
+
+    // Stream the same frames, solving every frame in order. The reference
+    // starts with only the first frame, to which the model is assembled.
+    TimeSeriesTable_<SimTK::Vec3> firstFrame(markerData);
+    firstFrame.trim(times[0], times[0]);
+    TimeSeriesTable_<SimTK::Vec3> remainingFrames(markerData);
+    remainingFrames.trimFrom(times[1]);
+
+    auto markersRef = std::make_shared<BufferedMarkersReference>(
+            firstFrame, Set<MarkerWeight>(), Units(Units::Meters), 8);
+    StreamingInverseKinematics streamingIK(model, markersRef);
+    streamingIK.setAccuracy(1e-5);
+    streamingIK.setDropStaleFrames(false);
+    std::vector<double> solvedTimes;
+    std::vector<SimTK::Vector> solved;
+    streamingIK.setFrameCallback(
+            [&](const SimTK::State& state, InverseKinematicsSolver&) {
+                solvedTimes.push_back(state.getTime());
+                solved.push_back(state.getQ());
+            });
+
+    // A frame rate of 0 replays as fast as possible without dropping frames.
+    MarkersReplayProducer producer(markersRef, remainingFrames, 0);
+    streamingIK.start();
+    producer.start();
+    producer.join();
+    streamingIK.waitUntilFinished();
+
+    ASSERT(solved.size() == expected.size(), __FILE__, __LINE__,
+            "Expected every streamed frame to be solved.");
+    for (size_t i = 0; i < solved.size(); ++i) {
+        ASSERT_EQUAL<double>(times[i + 1], solvedTimes[i], 1e-12,
+                __FILE__, __LINE__, "Frames were solved out of order.");
+        for (int j = 0; j < expected[i].size(); ++j) {
+            ASSERT_EQUAL<double>(expected[i][j], solved[i][j], 1e-8,
+                    __FILE__, __LINE__,
+                    "Streaming IK differs from offline tracking.");
+        }
+    }
+
+    const auto stats = streamingIK.getStatistics();
+    ASSERT(stats.numFramesSolved == (int)expected.size());
+    ASSERT(stats.numFramesSkipped == 0);
+    ASSERT(stats.numFramesRejected == 0);
+    ASSERT(producer.getNumFramesRejected() == 0);
+    ASSERT(stats.throughput > 0);
+    cout << "Mean solve time: " << stats.meanSolveTime << " s, throughput: "
+         << stats.throughput << " frames/s." << endl;
+}
+
+void testStreamingInverseKinematicsDropsStaleFrames()
+{
+    cout << "testStreamingInverseKinematicsDropsStaleFrames" << endl;
+    Model model("subject01_simbody.osim");
+    TimeSeriesTable_<SimTK::Vec3> markerData(
+            "subject01_synthetic_marker_data.trc");
+    const auto times = markerData.getIndependentColumn();
+    TimeSeriesTable_<SimTK::Vec3> firstFrame(markerData);
+    firstFrame.trim(times[0], times[0]);
+    TimeSeriesTable_<SimTK::Vec3> remainingFrames(markerData);
+    remainingFrames.trimFrom(times[1]);
+
+    // Fill the buffer before the solver starts, so that all but the newest
+    // frame are stale when the solver first draws from the buffer.
+    {
+        auto markersRef = std::make_shared<BufferedMarkersReference>(
+                firstFrame, Set<MarkerWeight>());
+        const int numFrames = 10;
+        for (int i = 1; i <= numFrames; ++i) {
+            ASSERT(markersRef->putValues(times[i],
+                    SimTK::RowVector_<SimTK::Vec3>(
+                            markerData.getRowAtIndex(i))));
+        }
+        markersRef->setFinished(true);
+
+        StreamingInverseKinematics streamingIK(model, markersRef);
+        streamingIK.start();
+        streamingIK.waitUntilFinished();
+
+        const auto stats = streamingIK.getStatistics();
+        ASSERT_EQUAL(1, stats.numFramesSolved, __FILE__, __LINE__,
+                "Expected only the newest frame to be solved.");
+        ASSERT_EQUAL(numFrames - 1, stats.numFramesSkipped, __FILE__,
+                __LINE__, "Expected the stale frames to be skipped.");
+        ASSERT_EQUAL(0, stats.numFramesRejected, __FILE__, __LINE__,
+                "Expected no frames to be rejected.");
+
+        double latestTime;
+        SimTK::Vector latestQ;
+        ASSERT(streamingIK.getLatestSolution(latestTime, latestQ));
+        ASSERT_EQUAL<double>(times[numFrames], latestTime, 1e-12, __FILE__,
+                __LINE__, "Expected the newest frame to be solved.");
+        ASSERT(latestQ.size() == streamingIK.getModel().getNumCoordinates());
+    }
+
+    // With a consumer that is slower than the 200 Hz feed, how many frames
+    // are skipped depends on the timing, but every frame is accounted for.
+    auto markersRef = std::make_shared<BufferedMarkersReference>(
+            firstFrame, Set<MarkerWeight>());
+    StreamingInverseKinematics streamingIK(model, markersRef);
+    streamingIK.setFrameCallback(
+            [](const SimTK::State&, InverseKinematicsSolver&) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            });
+
+    MarkersReplayProducer producer(markersRef, remainingFrames, 200);
+    streamingIK.start();
+    producer.start();
+    producer.join();
+    streamingIK.waitUntilFinished();
+
+    const auto stats = streamingIK.getStatistics();
+    cout << "Solved " << stats.numFramesSolved << ", skipped "
+         << stats.numFramesSkipped << ", rejected "
+         << stats.numFramesRejected << " frames; mean latency "
+         << stats.meanLatency << " s, max latency " << stats.maxLatency
+         << " s." << endl;
+
+    // Every frame that was accepted was either solved or skipped.
+    ASSERT(stats.numFramesSolved + stats.numFramesSkipped ==
+            producer.getNumFramesPushed());
+    ASSERT(stats.numFramesRejected == producer.getNumFramesRejected());
+    ASSERT(producer.getNumFramesPushed() + producer.getNumFramesRejected() ==
+            producer.getNumFrames());
+}
+
+void testAdvanceTimeWithMarkersReference()
+{
+    cout << "testAdvanceTimeWithMarkersReference" << endl;
+    // When time advances from the orientations reference, a MarkersReference
+    // that does not stream is tracked as before, with its observations
+    // unchanged, rather than causing an exception.
+    Model model("subject01_simbody.osim");
+    TimeSeriesTable_<SimTK::Rotation> orientationsData =
+            convertMotionFileToRotations(model, "std_subject01_walk1_ik.mot");
+    const auto times = orientationsData.getIndependentColumn();
+    TimeSeriesTable_<SimTK::Rotation> firstFrame{orientationsData};
+    firstFrame.trim(times[0], times[0]);
+    auto oRefs = std::make_shared<BufferedOrientationsReference>(firstFrame);
+    for (int i = 1; i < 3; ++i) {
+        oRefs->putValues(times[i], orientationsData.getRowAtIndex(i));
+    }
+    auto markersRef = std::make_shared<MarkersReference>(
+            TimeSeriesTable_<SimTK::Vec3>(
+                    "subject01_synthetic_marker_data.trc"),
+            Set<MarkerWeight>());
+    ASSERT(markersRef->getNumRefs() > 0);
+
+    SimTK::Array_<CoordinateReference> coordinateRefs;
+    SimTK::State& s = model.initSystem();
+    InverseKinematicsSolver ikSolver(
+            model, markersRef, oRefs, coordinateRefs);
+    ikSolver.setAccuracy(1e-4);
+    s.updTime() = times[0];
+    ikSolver.assemble(s);
+    ikSolver.setAdvanceTimeFromReference(true);
+    for (int i = 1; i < 3; ++i) {
+        ikSolver.track(s);
+        ASSERT_EQUAL<double>(times[i], s.getTime(), 1e-12, __FILE__, __LINE__,
+                "Expected time to advance from the orientations reference.");
+    }
+}
+
+void testReplayProducerStops()
+{
+    cout << "testReplayProducerStops" << endl;
+    // With a frame rate of 0, the producer waits for room in the buffer. If
+    // no frames are drawn, stop() must end the wait.
+    TimeSeriesTable_<SimTK::Vec3> markerData(
+            "subject01_synthetic_marker_data.trc");
+    const auto times = markerData.getIndependentColumn();
+    TimeSeriesTable_<SimTK::Vec3> firstFrame(markerData);
+    firstFrame.trim(times[0], times[0]);
+    auto markersRef = std::make_shared<BufferedMarkersReference>(
+            firstFrame, Set<MarkerWeight>(), Units(Units::Meters), 4);
+    MarkersReplayProducer producer(markersRef, markerData, 0);
+    producer.start();
+    while (producer.getNumFramesPushed() < markersRef->getBufferCapacity()) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    // Give the producer time to switch from spinning to sleeping.
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    producer.stop();
+    ASSERT(producer.getNumFramesPushed() == markersRef->getBufferCapacity());
+    ASSERT(producer.getNumFramesRejected() == 0);
+    ASSERT(markersRef->getNumBufferedFrames() ==
+            markersRef->getBufferCapacity());
+}
@@ -0,0 +1,130 @@
+#ifndef OPENSIM_CMD_RUN_BATCH_H_
+#define OPENSIM_CMD_RUN_BATCH_H_
+/* -------------------------------------------------------------------------- *
+ *                      OpenSim:  opensim-cmd_run-batch.h                     *
+ * -------------------------------------------------------------------------- *
+ * The OpenSim API is a toolkit for musculoskeletal modeling and simulation.  *
+ * See http://opensim.stanford.edu and the NOTICE file for more information.  *
+ * OpenSim is developed at Stanford University and supported by the US        *
+ * National Institutes of Health (U54 GM072970, R24 HD065690) and by DARPA    *
+ * through the Warrior Web program.                                           *
+ *                                                                            *
+ * Copyright (c) 2005-2021 Stanford University and the Authors                *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+#include <iostream>
+
+#include <docopt.h>
+#include "parse_arguments.h"
+
+static const char HELP_RUN_BATCH[] =
+R"(Run a tool from an XML setup file on many trials in parallel.
+
+Usage:
+  opensim-cmd [options]... run-batch [--threads=<n>] [--results=<dir>] [--trials=<file>] <setup-xml-file> [<input-file>...]
+  opensim-cmd run-batch -h | --help
+
+Options:
+  -L <path>, --library <path>  Load a plugin.
+  -o <level>, --log <level>  Logging level.
+  -j <n>, --threads <n>  Number of trials to run at the same time.
+  -r <dir>, --results <dir>  Directory for the results of all trials.
+  -t <file>, --trials <file>  Text file listing the trials to run.
+
+Description:
+  Runs the tool defined by <setup-xml-file> once for each trial, using the
+  same settings for all trials except for the input files. The setup file and
+  the model are loaded only once. Supported tools:
+
+            Inverse Kinematics           (IK): input is the marker file
+            Inverse Dynamics             (ID): input is the coordinates file
+            Analyze                          : input is the states file (if
+                                               the setup file has one) or
+                                               the coordinates file
+
+  Each <input-file> is a trial whose name is the file name without its
+  extension. With --trials, each line of <file> contains the name of a trial,
+  its input file, and optionally its external loads file (for ID and Analyze),
+  separated by whitespace; lines starting with '#' are ignored.
+
+  Results are written to the results directory of the setup file (or the
+  directory given with --results), prefixed with the trial name, and the
+  messages for each trial are written to <trial>.log in that directory. A
+  failed trial does not stop the other trials. By default, as many trials as
+  there are hardware threads run at the same time.
+
+  The command fails if any trial fails.
+
+Examples:
+  opensim-cmd run-batch IK_setup.xml walk1.trc walk2.trc run1.trc
+  opensim-cmd run-batch --threads=8 --trials=trials.txt ID_setup.xml
+  opensim-cmd -L C:\Plugins\osimMyCustomForce.dll run-batch Analyze_setup.xml walk1_ik.mot
+)";
+
+int run_batch(int argc, const char** argv) {
+
+    using namespace OpenSim;
+
+    std::map<std::string, docopt::value> args = OpenSim::parse_arguments(
+            HELP_RUN_BATCH, { argv + 1, argv + argc },
+            true); // show help if requested
+
+    const auto& setupFile = args["<setup-xml-file>"].asString();
+    BatchToolRunner runner(setupFile);
+
+    if (args["--threads"]) {
+        const auto& threads = args["--threads"].asString();
+        try {
+            runner.setNumThreads(std::stoi(threads));
+        } catch (const std::logic_error&) {
+            throw Exception("Expected --threads to be a positive integer, "
+                    "but got '" + threads + "'.");
+        }
+    }
+    if (args["--results"]) {
+        runner.setResultsDir(args["--results"].asString());
+    }
+    if (args["--trials"]) {
+        runner.addTrialsFromFile(args["--trials"].asString());
+    }
+    for (const auto& inputFile : args["<input-file>"].asStringList()) {
+        // The trial name is the file name without directories or extension.
+        std::string name = inputFile.substr(
+                IO::getParentDirectory(inputFile).size());
+        name = name.substr(0, name.rfind('.'));
+        runner.addTrial(name, inputFile);
+    }
+    if (runner.getTrials().empty()) {
+        log_error("No trials provided. Provide input files or --trials.");
+        return EXIT_FAILURE;
+    }
+
+    log_info("Preparing to run {} on {} trials.", runner.getToolClassName(),
+            runner.getTrials().size());
+    const auto results = runner.run();
+
+    bool success = true;
+    for (const auto& result : results) {
+        if (result.success) {
+            log_info("  {}: completed in {:.2f} s.", result.name,
+                    result.elapsedTime);
+        } else {
+            log_error("  {}: failed: {}", result.name, result.message);
+            success = false;
+        }
+    }
+    if (success) return EXIT_SUCCESS;
+    else return EXIT_FAILURE;
+}
+
+#endif // OPENSIM_CMD_RUN_BATCH_H_
@@ -349,6 +349,34 @@ void testRunTool() {
     testLoadPluginLibraries("run-tool");
 }
 
+void testRunBatch() {
+    // Help.
+    // =====
+    {
+        StartsWith output("Run a tool from an XML setup file on many trials");
+        testCommand("run-batch -h", EXIT_SUCCESS, output);
+        testCommand("run-batch --help", EXIT_SUCCESS, output);
+    }
+
+    // Error messages.
+    // ===============
+    testCommand("run-batch", EXIT_FAILURE,
+            ContainsSubstring("Arguments did not match expected patterns"));
+    testCommand("run-batch putes.xml walk.trc", EXIT_FAILURE,
+            StartsWith("[error] SimTK Exception thrown at"));
+    // Only IK, ID, and Analyze setup files are supported.
+    testCommand("print-xml cmc testrunbatch_cmc_setup.xml", EXIT_SUCCESS,
+            ContainsSubstring("Printing 'testrunbatch_cmc_setup.xml'.\n"));
+    testCommand("run-batch testrunbatch_cmc_setup.xml walk.mot", EXIT_FAILURE,
+            ContainsSubstring("does not define an InverseKinematicsTool, "
+                              "InverseDynamicsTool, or AnalyzeTool."));
+    // The setup file must specify a model.
+    testCommand("print-xml ik testrunbatch_ik_setup.xml", EXIT_SUCCESS,
+            ContainsSubstring("Printing 'testrunbatch_ik_setup.xml'.\n"));
+    testCommand("run-batch testrunbatch_ik_setup.xml walk.trc", EXIT_FAILURE,
+            ContainsSubstring("No model file was specified"));
+}
+
 void testPrintXML() {
     // Help.
     // =====
@@ -494,6 +522,7 @@ int main() {
     SimTK_START_TEST("testCommandLineInterface");
         SimTK_SUBTEST(testNoCommand);
         SimTK_SUBTEST(testRunTool);
+        SimTK_SUBTEST(testRunBatch);
         SimTK_SUBTEST(testPrintXML);
         SimTK_SUBTEST(testInfo);
         SimTK_SUBTEST(testUpdateFile);
@@ -104,6 +104,16 @@ MODEL_ADOPT_HELPER(Controller);
 // TODO remove.
 %rename(_getBetween) OpenSim::StatesTrajectory::getBetween;
 
+// The iterator restores each state into a working state that it reuses, so
+// next() returns a copy of the state.
+%extend OpenSim::StatesTrajectory::const_iterator {
+    SimTK::State next() {
+        SimTK::State state = **$self;
+        ++(*$self);
+        return state;
+    }
+};
+
 %extend OpenSim::StatesTrajectory {
 %pythoncode %{
 
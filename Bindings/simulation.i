@@ -191,6 +191,7 @@ OpenSim::ModelComponentSet<OpenSim::Controller>;
 %include <OpenSim/Simulation/Model/PointForceDirection.h>
 %template(ArrayPointForceDirection) OpenSim::Array<OpenSim::PointForceDirection*>;
 
+%include <OpenSim/Simulation/Model/PolynomialPathSurrogate.h>
 %include <OpenSim/Simulation/Model/GeometryPath.h>
 %include <OpenSim/Simulation/Model/Ligament.h>
 %include <OpenSim/Simulation/Model/Blankevoort1991Ligament.h>
@@ -213,6 +214,7 @@ OpenSim::ModelComponentSet<OpenSim::Controller>;
 %template(ReferenceDouble) OpenSim::Reference_<double>;
 %template(ReferenceRotation) OpenSim::Reference_<SimTK::Rotation_<double>>;
 %template(StreamableReferenceRotation) OpenSim::StreamableReference_<SimTK::Rotation_<double>>;
+%template(StreamableReferenceVec3) OpenSim::StreamableReference_<SimTK::Vec3>;
 
 %template(SimTKArrayCoordinateReference) SimTK::Array_<OpenSim::CoordinateReference>;
 
@@ -229,6 +231,7 @@ OpenSim::ModelComponentSet<OpenSim::Controller>;
 %shared_ptr(OpenSim::OrientationsReference);
 %include <OpenSim/Simulation/BufferedOrientationsReference.h>
 %shared_ptr(OpenSim::BufferedOrientationsReference);
+%include <OpenSim/Simulation/BufferedMarkersReference.h>
 
 %include <OpenSim/Simulation/AssemblySolver.h>
 %include <OpenSim/Simulation/InverseKinematicsSolver.h>
@@ -239,6 +242,8 @@ OpenSim::ModelComponentSet<OpenSim::Controller>;
 
 %template(StdVectorIMUs) std::vector< OpenSim::IMU* >;
 
+%feature("flatnested") OpenSim::StatesTrajectory::const_iterator;
+%rename(StatesTrajectoryIterator) OpenSim::StatesTrajectory::const_iterator;
 %include <OpenSim/Simulation/StatesTrajectory.h>
 // This enables iterating using the getBetween() method.
 %template(IteratorRangeStatesTrajectoryIterator)
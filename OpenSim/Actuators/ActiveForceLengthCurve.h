@@ -36,6 +36,9 @@
 #endif
 
 namespace OpenSim {
+
+class Millard2012EquilibriumMuscle;
+
 /** This class serves as a serializable ActiveForceLengthCurve, commonly used
     to model the active element in muscle models. The active-force-length curve
     is dimensionless: force is normalized to maximum isometric force and length
@@ -286,6 +289,8 @@ private:
     void buildCurve();
 
     SmoothSegmentedFunction   m_curve;
+
+    friend class Millard2012EquilibriumMuscle;
 };
 
 }
@@ -22,6 +22,7 @@
  * -------------------------------------------------------------------------- */
 
 #include "DeGrooteFregly2016Muscle.h"
+#include "MuscleBank.h"
 
 #include <OpenSim/Actuators/Millard2012EquilibriumMuscle.h>
 #include <OpenSim/Actuators/Thelen2003Muscle.h>
@@ -162,6 +163,9 @@ void DeGrooteFregly2016Muscle::extendFinalizeFromProperties() {
            (1.0 + get_tendon_strain_at_one_norm_force() - c2);
     m_isTendonDynamicsExplicit =
             get_tendon_compliance_dynamics_mode() == "explicit";
+
+    // A MuscleBank (if any) registers this muscle again when it connects.
+    m_muscleBank.reset();
 }
 
 void DeGrooteFregly2016Muscle::extendAddToSystem(
@@ -474,6 +478,13 @@ void DeGrooteFregly2016Muscle::calcMusclePotentialEnergyInfoHelper(
 void DeGrooteFregly2016Muscle::calcMuscleLengthInfo(
         const SimTK::State& s, MuscleLengthInfo& mli) const {
 
+    if (m_muscleBank) {
+        m_muscleBank->computeMuscleLengthInfo(s);
+        const auto& bankMLI = updMuscleLengthInfo(s);
+        if (&bankMLI != &mli) mli = bankMLI;
+        return;
+    }
+
     const auto& muscleTendonLength = getLength(s);
     SimTK::Real normTendonForce = SimTK::NaN;
     if (!get_ignore_tendon_compliance()) {
@@ -494,6 +505,13 @@ void DeGrooteFregly2016Muscle::calcMuscleLengthInfo(
 void DeGrooteFregly2016Muscle::calcFiberVelocityInfo(
         const SimTK::State& s, FiberVelocityInfo& fvi) const {
 
+    if (m_muscleBank) {
+        m_muscleBank->computeFiberVelocityInfo(s);
+        const auto& bankFVI = updFiberVelocityInfo(s);
+        if (&bankFVI != &fvi) fvi = bankFVI;
+        return;
+    }
+
     const auto& mli = getMuscleLengthInfo(s);
     const auto& muscleTendonVelocity = getLengtheningSpeed(s);
     const auto& activation = getActivation(s);
@@ -521,6 +539,13 @@ void DeGrooteFregly2016Muscle::calcFiberVelocityInfo(
 
 void DeGrooteFregly2016Muscle::calcMuscleDynamicsInfo(
         const SimTK::State& s, MuscleDynamicsInfo& mdi) const {
+    if (m_muscleBank) {
+        m_muscleBank->computeMuscleDynamicsInfo(s);
+        const auto& bankMDI = updMuscleDynamicsInfo(s);
+        if (&bankMDI != &mdi) mdi = bankMDI;
+        return;
+    }
+
     const auto& activation = getActivation(s);
     SimTK::Real normTendonForce = SimTK::NaN;
     if (!get_ignore_tendon_compliance()) {
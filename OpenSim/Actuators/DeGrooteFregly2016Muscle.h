@@ -31,6 +31,8 @@
 
 namespace OpenSim {
 
+class MuscleBank;
+
 // TODO avoid checking ignore_tendon_compliance() in each function;
 //       might be slow.
 // TODO prohibit fiber length from going below 0.2.
@@ -84,6 +86,10 @@ time-stepping.
    The methods getMinNormalizedTendonForce() and 
    getMaxNormalizedTendonForce() provide these bounds for use in custom solvers.
 
+@note In models with many of these muscles, add a MuscleBank to the model to
+   compute the length, velocity, and dynamics information of all muscles in
+   one pass.
+
 @section departures Departures from the Muscle base class
 
 The documentation for Muscle::MuscleLengthInfo states that the
@@ -948,6 +954,11 @@ private:
     constexpr static int m_mdi_partialFiberForceAlongTendonPartialFiberLength =
             3;
     constexpr static int m_mdi_partialTendonForcePartialFiberLength = 4;
+
+    // The MuscleBank that computes the information of this muscle, if any.
+    // The bank sets this when it connects to the model.
+    friend class MuscleBank;
+    SimTK::ReferencePtr<const MuscleBank> m_muscleBank;
 };
 
 } // namespace OpenSim
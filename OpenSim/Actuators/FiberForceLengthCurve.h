@@ -36,6 +36,9 @@
 #endif
 
 namespace OpenSim {
+
+class Millard2012EquilibriumMuscle;
+
 /** This class serves as a serializable FiberForceLengthCurve, commonly used to
     model the parallel elastic element in muscle models. The fiber-force-length
     curve is dimensionless: force is normalized to maximum isometric force and
@@ -385,6 +388,8 @@ private:
                                   double area, double relTol);
 
     SmoothSegmentedFunction m_curve;
+
+    friend class Millard2012EquilibriumMuscle;
     double m_stiffnessAtLowForceInUse;
     double m_stiffnessAtOneNormForceInUse;
     double m_curvinessInUse;
@@ -36,6 +36,9 @@
 #endif
 
 namespace OpenSim {
+
+class Millard2012EquilibriumMuscle;
+
 /** This class serves as a serializable ForceVelocityCurve for use in muscle
     models. The force-velocity curve is dimensionless: force is normalized to
     maximum isometric force and velocity is normalized to the maximum muscle
@@ -380,6 +383,8 @@ private:
     void buildCurve();
 
     SmoothSegmentedFunction m_curve;
+
+    friend class Millard2012EquilibriumMuscle;
 };
 
 }
@@ -36,6 +36,9 @@
 #endif
 
 namespace OpenSim {
+
+class Millard2012EquilibriumMuscle;
+
 /** This class serves as a serializable ForceVelocityInverseCurve for use in
     equilibrium muscle models. The inverse force-velocity curve is
     dimensionless: force is normalized to maximum isometric force and velocity
@@ -348,6 +351,8 @@ private:
 
     SmoothSegmentedFunction   m_curve;
 
+    friend class Millard2012EquilibriumMuscle;
+
 };
 
 }
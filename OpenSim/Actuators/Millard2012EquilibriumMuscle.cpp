@@ -55,6 +55,7 @@ void Millard2012EquilibriumMuscle::constructProperties()
     constructProperty_ForceVelocityCurve(ForceVelocityCurve());
     constructProperty_FiberForceLengthCurve(FiberForceLengthCurve());
     constructProperty_TendonForceLengthCurve(TendonForceLengthCurve());
+    constructProperty_use_curve_lookup_tables(false);
 
     setMinControl(get_minimum_activation());
 }
@@ -277,6 +278,16 @@ void Millard2012EquilibriumMuscle::extendFinalizeFromProperties()
     fpeCurve.ensureCurveUpToDate();
     fseCurve.ensureCurveUpToDate();
 
+    // Build (or remove) the lookup tables of the curves. A curve that was
+    // just rebuilt has no table, and a curve that was not keeps its table.
+    for (SmoothSegmentedFunction* curve : {&falCurve.m_curve, &fvCurve.m_curve,
+            &fvInvCurve.m_curve, &fpeCurve.m_curve, &fseCurve.m_curve}) {
+        if (!get_use_curve_lookup_tables())
+            curve->clearLookupTable();
+        else if (!curve->isLookupTableAvailable())
+            curve->buildLookupTable();
+    }
+
     // Propagate properties down to pennation model subcomponent. If any of the
     // new property values are invalid, restore the subcomponent's current
     // property values (to avoid throwing again when the subcomponent's
@@ -381,6 +392,9 @@ const TendonForceLengthCurve& Millard2012EquilibriumMuscle::
 getTendonForceLengthCurve() const
 {   return get_TendonForceLengthCurve(); }
 
+bool Millard2012EquilibriumMuscle::getUseCurveLookupTables() const
+{   return get_use_curve_lookup_tables(); }
+
 const MuscleFixedWidthPennationModel& Millard2012EquilibriumMuscle::
 getPennationModel() const
 { return getMemberSubcomponent<MuscleFixedWidthPennationModel>(penMdlIdx); }
@@ -509,6 +523,10 @@ void Millard2012EquilibriumMuscle::setTendonForceLengthCurve(
 TendonForceLengthCurve& aTendonForceLengthCurve)
 {   set_TendonForceLengthCurve(aTendonForceLengthCurve); }
 
+void Millard2012EquilibriumMuscle::setUseCurveLookupTables(
+bool useLookupTables)
+{   set_use_curve_lookup_tables(useLookupTables); }
+
 void Millard2012EquilibriumMuscle::
 setFiberLength(SimTK::State& s, double fiberLength) const
 {
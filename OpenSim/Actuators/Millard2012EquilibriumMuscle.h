@@ -53,6 +53,8 @@
 
 namespace OpenSim {
 
+class Millard2012FiberEquilibriumSolver;
+
 //==============================================================================
 //                         Millard2012EquilibriumMuscle
 //==============================================================================
@@ -226,6 +228,10 @@ public:
         "Passive-force-length curve.");
     OpenSim_DECLARE_UNNAMED_PROPERTY(TendonForceLengthCurve,
         "Tendon-force-length curve.");
+    OpenSim_DECLARE_PROPERTY(use_curve_lookup_tables, bool,
+        "Evaluate the muscle curves with lookup tables that are built when "
+        "the muscle is finalized, rather than solving for the parameter of "
+        "the Bezier curves at every evaluation (default: false).");
 
 //==============================================================================
 // OUTPUTS
@@ -298,6 +304,9 @@ public:
     const FiberForceLengthCurve& getFiberForceLengthCurve() const;
     /** @returns The TendonForceLengthCurve used by this model. */
     const TendonForceLengthCurve& getTendonForceLengthCurve() const;
+    /** @returns A boolean indicating whether the muscle curves are evaluated
+    with lookup tables. */
+    bool getUseCurveLookupTables() const;
 
     /** @returns The MuscleFixedWidthPennationModel owned by this model. */
     const MuscleFixedWidthPennationModel& getPennationModel() const;
@@ -409,6 +418,14 @@ public:
     void setTendonForceLengthCurve(
         TendonForceLengthCurve& aTendonForceLengthCurve);
 
+    /** @param useLookupTables Evaluate the active-force-length,
+    force-velocity, force-velocity-inverse, fiber-force-length, and
+    tendon-force-length curves with lookup tables (see
+    SmoothSegmentedFunction::buildLookupTable()). The tables are built when
+    the muscle is finalized, and the errors of the curves and of their first
+    two derivatives are at most 1e-8 relative to the magnitude of each. */
+    void setUseCurveLookupTables(bool useLookupTables);
+
     /** @param[out] s The state of the system.
         @param fiberLength The desired fiber length (m). */
     void setFiberLength(SimTK::State& s, double fiberLength) const;
@@ -438,6 +455,9 @@ public:
         @param solveForVelocity  Flag indicating to solve for fiber velocity,
                                  which by default is false (zero fiber-velocity)
         @throws MuscleCannotEquilibrate
+        @see Millard2012FiberEquilibriumSolver to compute the equilibrium of
+             all muscles of a model together, e.g., for each frame of a
+             trajectory.
     */
     void computeFiberEquilibrium(SimTK::State& s, 
                                  bool solveForVelocity = false) const;
@@ -554,6 +574,9 @@ protected:
     void computeStateVariableDerivatives(const SimTK::State& s) const override;
 
 private:
+    // Solves the equilibrium of many muscles with the helpers below.
+    friend class Millard2012FiberEquilibriumSolver;
+
     // The name used to access the activation state.
     static const std::string STATE_ACTIVATION_NAME;
     // The name used to access the fiber length state.
@@ -0,0 +1,355 @@
+/* -------------------------------------------------------------------------- *
+ *               OpenSim:  Millard2012FiberEquilibriumSolver.cpp              *
+ * -------------------------------------------------------------------------- *
+ * The OpenSim API is a toolkit for musculoskeletal modeling and simulation.  *
+ * See http://opensim.stanford.edu and the NOTICE file for more information.  *
+ * OpenSim is developed at Stanford University and supported by the US        *
+ * National Institutes of Health (U54 GM072970, R24 HD065690) and by DARPA    *
+ * through the Warrior Web program.                                           *
+ *                                                                            *
+ * Copyright (c) 2005-2021 Stanford University and the Authors                *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+#include "Millard2012FiberEquilibriumSolver.h"
+
+#include "Millard2012EquilibriumMuscle.h"
+
+#include <OpenSim/Simulation/Model/Model.h>
+
+#include <sstream>
+
+using namespace OpenSim;
+
+namespace {
+// Same as in Millard2012EquilibriumMuscle::computeFiberEquilibrium().
+const int MAX_ITERATIONS = 200;
+} // anonymous namespace
+
+Millard2012FiberEquilibriumSolver::Millard2012FiberEquilibriumSolver(
+        const Model& model)
+        : m_model(&model) {
+    for (const auto& muscle :
+            model.getComponentList<Millard2012EquilibriumMuscle>()) {
+        // computeFiberEquilibrium() does nothing for rigid tendons.
+        if (!muscle.get_ignore_tendon_compliance()) {
+            m_muscles.emplace_back(&muscle);
+        }
+    }
+    const int n = getNumMuscles();
+    m_previousFiberLength.assign(n, SimTK::NaN);
+    m_status.assign(n, Skipped);
+    m_numIterations.assign(n, 0);
+    m_errorMessage.resize(n);
+    m_activation.resize(n);
+    m_pathLength.resize(n);
+    m_pathLengtheningSpeed.resize(n);
+    m_isStatic.resize(n);
+    m_tolerance.resize(n);
+    m_fiberLength.resize(n);
+    m_error.resize(n);
+    m_errorDerivative.resize(n);
+    m_normTendonForce.resize(n);
+    m_forceVelocityMultiplier.resize(n);
+    m_fiberVelocity.resize(n);
+    m_normFiberVelocity.resize(n);
+    m_lowerBracket.resize(n);
+    m_hasLowerBracket.resize(n);
+    m_upperBracket.resize(n);
+    m_previousError.resize(n);
+}
+
+void Millard2012FiberEquilibriumSolver::resetWarmStart() {
+    m_previousFiberLength.assign(getNumMuscles(), SimTK::NaN);
+}
+
+const Millard2012EquilibriumMuscle& Millard2012FiberEquilibriumSolver::
+getMuscle(int i) const {
+    OPENSIM_THROW_IF(i < 0 || i >= getNumMuscles(), IndexOutOfRange,
+            (size_t)i, 0, (size_t)getNumMuscles() - 1);
+    return *m_muscles[i];
+}
+
+bool Millard2012FiberEquilibriumSolver::hasMuscle(const Muscle& muscle) const {
+    for (const auto& m : m_muscles) {
+        if (static_cast<const Muscle*>(m.get()) == &muscle) return true;
+    }
+    return false;
+}
+
+void Millard2012FiberEquilibriumSolver::solve(
+        SimTK::State& s, bool solveForVelocity) {
+    m_model->getMultibodySystem().realize(s, SimTK::Stage::Velocity);
+
+    const int n = getNumMuscles();
+    std::vector<int> active;
+    for (int i = 0; i < n; ++i) {
+        const Millard2012EquilibriumMuscle& muscle = *m_muscles[i];
+        m_errorMessage[i].clear();
+        m_numIterations[i] = 0;
+        if (!muscle.appliesForce(s)) {
+            m_status[i] = Skipped;
+            continue;
+        }
+        m_activation[i] = muscle.getActivation(s);
+        m_pathLength[i] = muscle.getLength(s);
+        m_pathLengtheningSpeed[i] =
+                solveForVelocity ? muscle.getLengtheningSpeed(s) : 0;
+        m_isStatic[i] = !solveForVelocity ||
+                        std::abs(m_pathLengtheningSpeed[i]) <
+                                SimTK::SignificantReal;
+        m_tolerance[i] = std::max(1e-8 * muscle.getMaxIsometricForce(),
+                SimTK::SignificantReal * 10);
+        initialize(i, m_warmStart);
+        active.push_back(i);
+    }
+    iterate(active);
+
+    // If a warm start failed, try again from the default initial guess.
+    active.clear();
+    for (int i = 0; i < n; ++i) {
+        if ((m_status[i] == MaxIterationsReached || m_status[i] == Error) &&
+                m_warmStart && !SimTK::isNaN(m_previousFiberLength[i])) {
+            m_errorMessage[i].clear();
+            initialize(i, false);
+            active.push_back(i);
+        }
+    }
+    iterate(active);
+
+    // Set the solutions and report the muscles that failed.
+    int firstFailure = -1;
+    for (int i = 0; i < n; ++i) {
+        const Millard2012EquilibriumMuscle& muscle = *m_muscles[i];
+        const double fiso = muscle.getMaxIsometricForce();
+        switch (m_status[i]) {
+        case Converged:
+            if (muscle.isFiberStateClamped(
+                        m_fiberLength[i], m_normFiberVelocity[i])) {
+                m_fiberLength[i] = muscle.getMinimumFiberLength();
+            }
+            muscle.setActuation(s, m_normTendonForce[i] * fiso);
+            muscle.setFiberLength(s, m_fiberLength[i]);
+            m_previousFiberLength[i] = m_fiberLength[i];
+            break;
+
+        case FiberAtLowerBound:
+            log_warn("Millard2012EquilibriumMuscle static solution: '{}' is "
+                     "at its minimum fiber length of {}.",
+                    muscle.getName(), m_fiberLength[i]);
+            muscle.setActuation(s, m_normTendonForce[i] * fiso);
+            muscle.setFiberLength(s, m_fiberLength[i]);
+            m_previousFiberLength[i] = m_fiberLength[i];
+            break;
+
+        case MaxIterationsReached: {
+            std::ostringstream ss;
+            ss << "\n  Solution error " << std::abs(m_error[i])
+               << " exceeds tolerance of " << m_tolerance[i] << "\n"
+               << "  Newton iterations reached limit of " << MAX_ITERATIONS
+               << "\n"
+               << "  Activation is " << m_activation[i] << "\n"
+               << "  Fiber length is " << m_fiberLength[i] << "\n";
+            m_errorMessage[i] = ss.str();
+            m_previousFiberLength[i] = SimTK::NaN;
+            if (firstFailure < 0) firstFailure = i;
+            break;
+        }
+
+        case Error:
+            m_previousFiberLength[i] = SimTK::NaN;
+            if (firstFailure < 0) firstFailure = i;
+            break;
+
+        default:
+            break;
+        }
+    }
+
+    if (firstFailure >= 0) {
+        throw MuscleCannotEquilibrate(__FILE__, __LINE__, __func__,
+                *m_muscles[firstFailure], m_errorMessage[firstFailure]);
+    }
+}
+
+void Millard2012FiberEquilibriumSolver::initialize(int i, bool warmStart) {
+    const Millard2012EquilibriumMuscle& muscle = *m_muscles[i];
+    m_status[i] = Running;
+    if (warmStart && !SimTK::isNaN(m_previousFiberLength[i])) {
+        m_fiberLength[i] = muscle.clampFiberLength(m_previousFiberLength[i]);
+    } else {
+        // Begin with a small tendon force, as estimateMuscleFiberState() does.
+        m_fiberLength[i] = muscle.clampFiberLength(
+                muscle.getPennationModel().calcFiberLength(m_pathLength[i],
+                        muscle.getTendonSlackLength() * 1.01));
+    }
+    // The first guess of the fiber velocity is static.
+    m_forceVelocityMultiplier[i] = 1.0;
+    m_fiberVelocity[i] = 0;
+    m_normFiberVelocity[i] = 0;
+    m_lowerBracket[i] = muscle.getMinimumFiberLength();
+    m_hasLowerBracket[i] = false;
+    m_upperBracket[i] = SimTK::Infinity;
+    m_previousError[i] = SimTK::Infinity;
+}
+
+void Millard2012FiberEquilibriumSolver::evaluate(int i, double fiberLength) {
+    // See Millard2012EquilibriumMuscle::estimateMuscleFiberState().
+    const Millard2012EquilibriumMuscle& muscle = *m_muscles[i];
+    const MuscleFixedWidthPennationModel& penMdl = muscle.getPennationModel();
+    const TendonForceLengthCurve& fseCurve =
+            muscle.get_TendonForceLengthCurve();
+    const double tsl = muscle.getTendonSlackLength();
+    const double ofl = muscle.getOptimalFiberLength();
+    const double fiso = muscle.getMaxIsometricForce();
+    const double ma = m_activation[i];
+    const double lce = fiberLength;
+
+    // Position level.
+    const double phi = penMdl.calcPennationAngle(lce);
+    const double cosphi = cos(phi);
+    const double sinphi = sin(phi);
+    const double tl = m_pathLength[i] - lce * cosphi;
+    const double lceN = lce / ofl;
+    const double tlN = tl / tsl;
+
+    // Multipliers.
+    const double fal = muscle.get_ActiveForceLengthCurve().calcValue(lceN);
+    const double fpe = muscle.get_FiberForceLengthCurve().calcValue(lceN);
+    const double fse = fseCurve.calcValue(tlN);
+
+    // Partial derivatives of the error, using the previous estimate of the
+    // fiber velocity.
+    double& fv = m_forceVelocityMultiplier[i];
+    double& dlceN = m_normFiberVelocity[i];
+    const double Fm = muscle.calcFiberForce(fiso, ma, fal, fv, fpe, dlceN)[0];
+    const double dFm_dlce = muscle.calcFiberStiffness(fiso, ma, fv, lceN, ofl);
+    const double dFmAT_dlce = muscle.calc_DFiberForceAT_DFiberLength(
+            Fm, dFm_dlce, lce, sinphi, cosphi);
+    const double dFt_d_tl = fseCurve.calcDerivative(tlN, 1) * fiso / tsl;
+    const double dFt_d_lce = muscle.calc_DTendonForce_DFiberLength(
+            dFt_d_tl, lce, sinphi, cosphi);
+
+    // Share the lengthening speed between the fiber and the tendon according
+    // to their relative stiffnesses.
+    if (!m_isStatic[i]) {
+        const double dml = m_pathLengtheningSpeed[i];
+        const double dFmAT_dlceAT = muscle.calc_DFiberForceAT_DFiberLengthAT(
+                dFmAT_dlce, sinphi, cosphi, lce);
+        double dtl = dml;
+        if (std::abs(dFmAT_dlceAT + dFt_d_tl) > SimTK::SignificantReal &&
+                tlN > 1.0) {
+            dtl = dFmAT_dlceAT / (dFmAT_dlceAT + dFt_d_tl) * dml;
+        }
+        m_fiberVelocity[i] = penMdl.calcFiberVelocity(cosphi, dml, dtl);
+        dlceN = m_fiberVelocity[i] / (muscle.getMaxContractionVelocity() * ofl);
+        fv = muscle.get_ForceVelocityCurve().calcValue(dlceN);
+    }
+
+    m_fiberLength[i] = lce;
+    m_error[i] =
+            muscle.calcFiberForce(fiso, ma, fal, fv, fpe, dlceN)[0] * cosphi -
+            fse * fiso;
+    m_errorDerivative[i] = dFmAT_dlce - dFt_d_lce;
+    m_normTendonForce[i] = fse;
+
+    // Update the bracket.
+    if (m_error[i] < 0) {
+        m_lowerBracket[i] = lce;
+        m_hasLowerBracket[i] = true;
+    } else if (m_error[i] > 0) {
+        m_upperBracket[i] = lce;
+    }
+}
+
+double Millard2012FiberEquilibriumSolver::calcNextFiberLength(int i) const {
+    const double lce = m_fiberLength[i];
+    const double lo = m_lowerBracket[i];
+    const double hi = m_upperBracket[i];
+    const bool hasLo = m_hasLowerBracket[i] != 0;
+    const bool hasHi = hi < SimTK::Infinity;
+    const double newton = lce - m_error[i] / m_errorDerivative[i];
+
+    // Bisect if the Newton step leaves the bracket, or if it did not at least
+    // halve the error in the previous iteration.
+    const bool newtonInBracket = !SimTK::isNaN(newton) &&
+                                 (!hasLo || newton > lo) &&
+                                 (!hasHi || newton < hi);
+    const bool slow =
+            std::abs(m_error[i]) > 0.5 * std::abs(m_previousError[i]);
+    if (hasLo && hasHi && (!newtonInBracket || slow)) {
+        return 0.5 * (lo + hi);
+    }
+    if (newtonInBracket) {
+        // The fiber cannot be shorter than its minimum length.
+        return std::max(newton, m_muscles[i]->getMinimumFiberLength());
+    }
+    // Only one side of the bracket is known and the Newton step points away
+    // from the root (e.g., on the descending limb of the active
+    // force-length curve).
+    double step = std::abs(newton - lce);
+    if (SimTK::isNaN(step)) step = 0.1 * lce;
+    step = std::max(step,
+            m_muscles[i]->getOptimalFiberLength() * SimTK::SqrtEps);
+    if (hasHi) return std::max(lce - step, 0.5 * (lo + hi));
+    return lce + step;
+}
+
+void Millard2012FiberEquilibriumSolver::iterate(std::vector<int> active) {
+    for (int i : active) {
+        try {
+            evaluate(i, m_fiberLength[i]);
+        } catch (const std::exception& x) {
+            m_status[i] = Error;
+            m_errorMessage[i] = "Internal exception encountered.\n" +
+                                std::string{x.what()};
+        }
+    }
+
+    int iter = 0;
+    while (true) {
+        // Remove the muscles that are done.
+        std::vector<int> running;
+        for (int i : active) {
+            if (m_status[i] != Running) continue;
+            const double minLength = m_muscles[i]->getMinimumFiberLength();
+            if (std::abs(m_error[i]) < m_tolerance[i]) {
+                m_status[i] = Converged;
+            } else if (m_fiberLength[i] <= minLength && m_error[i] > 0) {
+                // The fiber force exceeds the tendon force even at the
+                // minimum fiber length.
+                m_status[i] = FiberAtLowerBound;
+            } else if (iter >= MAX_ITERATIONS) {
+                m_status[i] = MaxIterationsReached;
+            } else {
+                running.push_back(i);
+            }
+        }
+        if (running.empty()) break;
+
+        // Take one step for each muscle.
+        for (int i : running) {
+            try {
+                const double next = calcNextFiberLength(i);
+                m_previousError[i] = m_error[i];
+                evaluate(i, next);
+                ++m_numIterations[i];
+            } catch (const std::exception& x) {
+                m_status[i] = Error;
+                m_errorMessage[i] = "Internal exception encountered.\n" +
+                                    std::string{x.what()};
+            }
+        }
+        active.swap(running);
+        ++iter;
+    }
+}
@@ -0,0 +1,155 @@
+#ifndef OPENSIM_MILLARD2012FIBEREQUILIBRIUMSOLVER_H
+#define OPENSIM_MILLARD2012FIBEREQUILIBRIUMSOLVER_H
+/* -------------------------------------------------------------------------- *
+ *                OpenSim:  Millard2012FiberEquilibriumSolver.h               *
+ * -------------------------------------------------------------------------- *
+ * The OpenSim API is a toolkit for musculoskeletal modeling and simulation.  *
+ * See http://opensim.stanford.edu and the NOTICE file for more information.  *
+ * OpenSim is developed at Stanford University and supported by the US        *
+ * National Institutes of Health (U54 GM072970, R24 HD065690) and by DARPA    *
+ * through the Warrior Web program.                                           *
+ *                                                                            *
+ * Copyright (c) 2005-2021 Stanford University and the Authors                *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+#include <OpenSim/Actuators/osimActuatorsDLL.h>
+
+#include <SimTKcommon/internal/ReferencePtr.h>
+#include <SimTKcommon/internal/State.h>
+
+#include <string>
+#include <vector>
+
+namespace OpenSim {
+
+class Model;
+class Muscle;
+class Millard2012EquilibriumMuscle;
+
+/** Solve the fiber equilibrium of all Millard2012EquilibriumMuscle%s with a
+compliant tendon in a model together, as
+Millard2012EquilibriumMuscle::computeFiberEquilibrium() does for one muscle.
+
+The muscles are iterated in lockstep: each iteration takes one step for every
+muscle that has not yet converged. Each step is a Newton step on the
+equilibrium error (fiber force along the tendon minus tendon force) with
+respect to fiber length, safeguarded by bisection: the solver keeps the
+fiber lengths at which the error was last found to be negative and positive,
+and bisects between them when a Newton step would leave this bracket or does
+not reduce the error fast enough. The tolerance (1e-8 times the maximum
+isometric force), the limit of 200 iterations, the handling of the minimum
+fiber length, and the reported warnings and exceptions are the same as for
+computeFiberEquilibrium().
+
+When the solver is used repeatedly (e.g., for each frame of a trajectory in
+AnalyzeTool), each muscle starts from the fiber length found for it in the
+previous call to solve() (see setWarmStart()), which usually converges in a
+few iterations. Otherwise, or if a warm-started solve fails, the muscle starts
+from the same initial guess as computeFiberEquilibrium().
+
+@code
+Millard2012FiberEquilibriumSolver solver(model);
+for (auto& state : states) {
+    solver.solve(state);
+}
+@endcode
+
+The model must outlive the solver, and the solver must be recreated if
+muscles are added to or removed from the model. */
+class OSIMACTUATORS_API Millard2012FiberEquilibriumSolver {
+public:
+    explicit Millard2012FiberEquilibriumSolver(const Model& model);
+
+    /// Start each muscle from its solution of the previous call to solve()
+    /// (default: true).
+    void setWarmStart(bool tf) { m_warmStart = tf; }
+    bool getWarmStart() const { return m_warmStart; }
+    /// Forget the solutions of previous calls to solve(), so that the next
+    /// call starts from the default initial guess.
+    void resetWarmStart();
+
+    /// The number of muscles whose equilibrium this solver computes (the
+    /// Millard2012EquilibriumMuscle%s whose ignore_tendon_compliance
+    /// property is false).
+    int getNumMuscles() const { return (int)m_muscles.size(); }
+    const Millard2012EquilibriumMuscle& getMuscle(int i) const;
+    /// Whether the equilibrium of this muscle is computed by this solver.
+    bool hasMuscle(const Muscle& muscle) const;
+
+    /// Compute the equilibrium fiber lengths of all muscles that apply force,
+    /// and set the fiber length and actuation of each muscle in the state.
+    /// If solveForVelocity is true, the lengthening speed of each muscle is
+    /// shared between the fiber and the tendon (see
+    /// Millard2012EquilibriumMuscle::computeFiberEquilibrium()); otherwise,
+    /// the fiber velocity is zero.
+    /// @throws MuscleCannotEquilibrate for the first muscle that could not
+    ///     be equilibrated, after all other muscles have been equilibrated.
+    void solve(SimTK::State& s, bool solveForVelocity = false);
+
+    /// The number of iterations taken for muscle i in the last call to
+    /// solve().
+    int getNumIterations(int i) const { return m_numIterations.at(i); }
+
+private:
+    enum Status {
+        Skipped,
+        Running,
+        Converged,
+        FiberAtLowerBound,
+        MaxIterationsReached,
+        Error
+    };
+
+    void initialize(int i, bool warmStart);
+    void evaluate(int i, double fiberLength);
+    double calcNextFiberLength(int i) const;
+    void iterate(std::vector<int> active);
+
+    SimTK::ReferencePtr<const Model> m_model;
+    std::vector<SimTK::ReferencePtr<const Millard2012EquilibriumMuscle>>
+            m_muscles;
+    bool m_warmStart = true;
+
+    // One element per muscle.
+    // -----------------------
+    // Solutions of the previous call to solve(), or NaN.
+    std::vector<double> m_previousFiberLength;
+    std::vector<Status> m_status;
+    std::vector<int> m_numIterations;
+    std::vector<std::string> m_errorMessage;
+    // Inputs.
+    std::vector<double> m_activation;
+    std::vector<double> m_pathLength;
+    std::vector<double> m_pathLengtheningSpeed;
+    std::vector<char> m_isStatic;
+    std::vector<double> m_tolerance;
+    // The current iterate and its equilibrium error.
+    std::vector<double> m_fiberLength;
+    std::vector<double> m_error;
+    std::vector<double> m_errorDerivative;
+    std::vector<double> m_normTendonForce;
+    std::vector<double> m_forceVelocityMultiplier;
+    std::vector<double> m_fiberVelocity;
+    std::vector<double> m_normFiberVelocity;
+    // The bracket: the error is negative at the lower fiber length (if
+    // m_hasLowerBracket) and positive at the upper fiber length (if finite).
+    std::vector<double> m_lowerBracket;
+    std::vector<char> m_hasLowerBracket;
+    std::vector<double> m_upperBracket;
+    // The error of the previous iterate.
+    std::vector<double> m_previousError;
+};
+
+} // namespace OpenSim
+
+#endif // OPENSIM_MILLARD2012FIBEREQUILIBRIUMSOLVER_H
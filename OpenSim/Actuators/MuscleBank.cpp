@@ -0,0 +1,574 @@
+/* -------------------------------------------------------------------------- *
+ *                         OpenSim:  MuscleBank.cpp                           *
+ * -------------------------------------------------------------------------- *
+ * The OpenSim API is a toolkit for musculoskeletal modeling and simulation.  *
+ * See http://opensim.stanford.edu and the NOTICE file for more information.  *
+ * OpenSim is developed at Stanford University and supported by the US        *
+ * National Institutes of Health (U54 GM072970, R24 HD065690) and by DARPA    *
+ * through the Warrior Web program.                                           *
+ *                                                                            *
+ * Copyright (c) 2005-2021 Stanford University and the Authors                *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+#include "MuscleBank.h"
+
+#include "DeGrooteFregly2016Muscle.h"
+
+#include <OpenSim/Simulation/Model/Model.h>
+
+using namespace OpenSim;
+
+using DGF = DeGrooteFregly2016Muscle;
+
+namespace {
+
+// Columns of the workspace. Each pass gathers its inputs into these columns
+// (from the state and from the cache of the earlier passes), so a column
+// only holds valid data during the pass that fills it.
+enum WorkspaceColumn {
+    // Inputs from the state.
+    MuscleTendonLength,
+    MuscleTendonVelocity,
+    Activation,
+    NormTendonForce,
+    NormTendonForceDerivative,
+    // MuscleLengthInfo.
+    NormTendonLength,
+    TendonLength,
+    FiberLengthAlongTendon,
+    FiberLength,
+    NormFiberLength,
+    CosPennationAngle,
+    SinPennationAngle,
+    PennationAngle,
+    PassiveForceMultiplier,
+    ActiveForceLengthMultiplier,
+    // FiberVelocityInfo.
+    ForceVelocityMultiplier,
+    NormFiberVelocity,
+    FiberVelocity,
+    FiberVelocityAlongTendon,
+    TendonVelocity,
+    NormTendonVelocity,
+    PennationAngularVelocity,
+    // MuscleDynamicsInfo.
+    ActiveFiberForce,
+    ConPassiveFiberForce,
+    NonConPassiveFiberForce,
+    FiberForce,
+    FiberForceAlongTendon,
+    DynamicsNormTendonForce,
+    TendonForce,
+    FiberStiffness,
+    PartialPennationAnglePartialFiberLength,
+    PartialFiberForceAlongTendonPartialFiberLength,
+    FiberStiffnessAlongTendon,
+    TendonStiffness,
+    MuscleStiffness,
+    PartialTendonForcePartialFiberLength,
+    NumWorkspaceColumns
+};
+
+const std::string LENGTH_INFO_NAME("lengthInfo");
+const std::string VELOCITY_INFO_NAME("velInfo");
+const std::string DYNAMICS_INFO_NAME("dynamicsInfo");
+
+} // anonymous namespace
+
+const DeGrooteFregly2016Muscle& MuscleBank::getMuscle(int i) const {
+    OPENSIM_THROW_IF(i < 0 || i >= getNumMuscles(), IndexOutOfRange,
+            (size_t)i, 0, (size_t)getNumMuscles() - 1);
+    return *m_muscles[i];
+}
+
+void MuscleBank::extendConnectToModel(Model& model) {
+    Super::extendConnectToModel(model);
+
+    m_muscles.clear();
+    m_maxIsometricForce.clear();
+    m_optimalFiberLength.clear();
+    m_tendonSlackLength.clear();
+    m_fiberWidth.clear();
+    m_squareFiberWidth.clear();
+    m_maxContractionVelocity.clear();
+    m_kT.clear();
+    m_activeForceWidthScale.clear();
+    m_fiberDamping.clear();
+    m_passiveFiberStrain.clear();
+    m_passiveForceOffset.clear();
+    m_passiveForceDenom.clear();
+    m_ignoreTendonCompliance.clear();
+    m_isTendonDynamicsExplicit.clear();
+    m_ignorePassiveFiberForce.clear();
+
+    for (auto& muscle : model.updComponentList<DGF>()) {
+        OPENSIM_THROW_IF_FRMOBJ(!muscle.m_muscleBank.empty() &&
+                        muscle.m_muscleBank.get() != this,
+                Exception,
+                "Muscle '{}' already belongs to MuscleBank '{}'; a model "
+                "should contain at most one MuscleBank.",
+                muscle.getAbsolutePathString(),
+                muscle.m_muscleBank->getAbsolutePathString());
+        muscle.m_muscleBank.reset(this);
+        m_muscles.emplace_back(&muscle);
+
+        // The muscle computed these in extendFinalizeFromProperties().
+        m_maxIsometricForce.push_back(muscle.get_max_isometric_force());
+        m_optimalFiberLength.push_back(muscle.get_optimal_fiber_length());
+        m_tendonSlackLength.push_back(muscle.get_tendon_slack_length());
+        m_fiberWidth.push_back(muscle.m_fiberWidth);
+        m_squareFiberWidth.push_back(muscle.m_squareFiberWidth);
+        m_maxContractionVelocity.push_back(
+                muscle.m_maxContractionVelocityInMetersPerSecond);
+        m_kT.push_back(muscle.m_kT);
+        m_activeForceWidthScale.push_back(
+                muscle.get_active_force_width_scale());
+        m_fiberDamping.push_back(muscle.get_fiber_damping());
+        const double e0 = muscle.get_passive_fiber_strain_at_one_norm_force();
+        m_passiveFiberStrain.push_back(e0);
+        const double offset =
+                exp(DGF::kPE * (DGF::m_minNormFiberLength - 1.0) / e0);
+        m_passiveForceOffset.push_back(offset);
+        m_passiveForceDenom.push_back(exp(DGF::kPE) - offset);
+        m_ignoreTendonCompliance.push_back(
+                muscle.get_ignore_tendon_compliance());
+        m_isTendonDynamicsExplicit.push_back(
+                muscle.m_isTendonDynamicsExplicit);
+        m_ignorePassiveFiberForce.push_back(
+                muscle.get_ignore_passive_fiber_force());
+    }
+}
+
+void MuscleBank::extendAddToSystem(SimTK::MultibodySystem& system) const {
+    Super::extendAddToSystem(system);
+    m_workspaceCV = addCacheVariable("workspace",
+            SimTK::Matrix(getNumMuscles(), NumWorkspaceColumns),
+            SimTK::Stage::Velocity);
+}
+
+void MuscleBank::computeMuscleLengthInfo(const SimTK::State& s) const {
+    const int n = getNumMuscles();
+    bool anyInvalid = false;
+    for (int i = 0; i < n && !anyInvalid; ++i) {
+        anyInvalid = !m_muscles[i]->isCacheVariableValid(s, LENGTH_INFO_NAME);
+    }
+    if (!anyInvalid) return;
+
+    // The columns of the workspace are contiguous.
+    SimTK::Matrix& ws = updCacheVariableValue(s, m_workspaceCV);
+    double* mtLength = &ws(0, MuscleTendonLength);
+    double* normTendonForce = &ws(0, NormTendonForce);
+    double* normTendonLength = &ws(0, NormTendonLength);
+    double* tendonLength = &ws(0, TendonLength);
+    double* fiberLengthAlongTendon = &ws(0, FiberLengthAlongTendon);
+    double* fiberLength = &ws(0, FiberLength);
+    double* normFiberLength = &ws(0, NormFiberLength);
+    double* cosPenn = &ws(0, CosPennationAngle);
+    double* sinPenn = &ws(0, SinPennationAngle);
+    double* penn = &ws(0, PennationAngle);
+    double* passiveMult = &ws(0, PassiveForceMultiplier);
+    double* activeMult = &ws(0, ActiveForceLengthMultiplier);
+
+    // Gather the inputs.
+    for (int i = 0; i < n; ++i) {
+        const DGF& muscle = *m_muscles[i];
+        mtLength[i] = muscle.getLength(s);
+        normTendonForce[i] = m_ignoreTendonCompliance[i]
+                                     ? SimTK::NaN
+                                     : muscle.getNormalizedTendonForce(s);
+    }
+
+    // Tendon (see DeGrooteFregly2016Muscle::calcMuscleLengthInfoHelper()).
+    for (int i = 0; i < n; ++i) {
+        normTendonLength[i] = m_ignoreTendonCompliance[i]
+                ? 1.0
+                : log((1.0 / DGF::c1) * (normTendonForce[i] + DGF::c3)) /
+                                  m_kT[i] +
+                          DGF::c2;
+        tendonLength[i] = m_tendonSlackLength[i] * normTendonLength[i];
+    }
+
+    // Fiber and pennation.
+    for (int i = 0; i < n; ++i) {
+        fiberLengthAlongTendon[i] = mtLength[i] - tendonLength[i];
+        fiberLength[i] = sqrt(SimTK::square(fiberLengthAlongTendon[i]) +
+                              m_squareFiberWidth[i]);
+        normFiberLength[i] = fiberLength[i] / m_optimalFiberLength[i];
+        cosPenn[i] = fiberLengthAlongTendon[i] / fiberLength[i];
+        sinPenn[i] = m_fiberWidth[i] / fiberLength[i];
+        penn[i] = asin(sinPenn[i]);
+    }
+
+    // Multipliers.
+    for (int i = 0; i < n; ++i) {
+        passiveMult[i] = m_ignorePassiveFiberForce[i]
+                ? 0
+                : (exp(DGF::kPE * (normFiberLength[i] - 1.0) /
+                           m_passiveFiberStrain[i]) -
+                          m_passiveForceOffset[i]) /
+                          m_passiveForceDenom[i];
+        const double x =
+                (normFiberLength[i] - 1.0) / m_activeForceWidthScale[i] + 1.0;
+        activeMult[i] = DGF::calcGaussianLikeCurve(
+                                x, DGF::b11, DGF::b21, DGF::b31, DGF::b41) +
+                        DGF::calcGaussianLikeCurve(
+                                x, DGF::b12, DGF::b22, DGF::b32, DGF::b42) +
+                        DGF::calcGaussianLikeCurve(
+                                x, DGF::b13, DGF::b23, DGF::b33, DGF::b43);
+    }
+
+    // Scatter the results to the cache of each muscle.
+    for (int i = 0; i < n; ++i) {
+        const DGF& muscle = *m_muscles[i];
+        if (muscle.isCacheVariableValid(s, LENGTH_INFO_NAME)) continue;
+        Muscle::MuscleLengthInfo& mli = muscle.updMuscleLengthInfo(s);
+        mli.normTendonLength = normTendonLength[i];
+        mli.tendonStrain = normTendonLength[i] - 1.0;
+        mli.tendonLength = tendonLength[i];
+        mli.fiberLengthAlongTendon = fiberLengthAlongTendon[i];
+        mli.fiberLength = fiberLength[i];
+        mli.normFiberLength = normFiberLength[i];
+        mli.cosPennationAngle = cosPenn[i];
+        mli.sinPennationAngle = sinPenn[i];
+        mli.pennationAngle = penn[i];
+        mli.fiberPassiveForceLengthMultiplier = passiveMult[i];
+        mli.fiberActiveForceLengthMultiplier = activeMult[i];
+        muscle.markCacheVariableValid(s, LENGTH_INFO_NAME);
+
+        if (tendonLength[i] < m_tendonSlackLength[i]) {
+            log_info("DeGrooteFregly2016Muscle '{}' is buckling (length < "
+                     "tendon_slack_length) at time {} s.",
+                    muscle.getName(), s.getTime());
+        }
+    }
+}
+
+void MuscleBank::computeFiberVelocityInfo(const SimTK::State& s) const {
+    const int n = getNumMuscles();
+    bool anyInvalid = false;
+    for (int i = 0; i < n && !anyInvalid; ++i) {
+        anyInvalid =
+                !m_muscles[i]->isCacheVariableValid(s, VELOCITY_INFO_NAME);
+    }
+    if (!anyInvalid) return;
+
+    computeMuscleLengthInfo(s);
+
+    SimTK::Matrix& ws = updCacheVariableValue(s, m_workspaceCV);
+    double* mtVelocity = &ws(0, MuscleTendonVelocity);
+    double* activation = &ws(0, Activation);
+    double* normTendonForce = &ws(0, NormTendonForce);
+    double* normTendonForceDeriv = &ws(0, NormTendonForceDerivative);
+    double* normTendonLength = &ws(0, NormTendonLength);
+    double* fiberLengthAlongTendon = &ws(0, FiberLengthAlongTendon);
+    double* fiberLength = &ws(0, FiberLength);
+    double* cosPenn = &ws(0, CosPennationAngle);
+    double* passiveMult = &ws(0, PassiveForceMultiplier);
+    double* activeMult = &ws(0, ActiveForceLengthMultiplier);
+    double* fvMult = &ws(0, ForceVelocityMultiplier);
+    double* normFiberVelocity = &ws(0, NormFiberVelocity);
+    double* fiberVelocity = &ws(0, FiberVelocity);
+    double* fiberVelocityAlongTendon = &ws(0, FiberVelocityAlongTendon);
+    double* tendonVelocity = &ws(0, TendonVelocity);
+    double* normTendonVelocity = &ws(0, NormTendonVelocity);
+    double* pennAngularVelocity = &ws(0, PennationAngularVelocity);
+
+    // Gather the inputs.
+    for (int i = 0; i < n; ++i) {
+        const DGF& muscle = *m_muscles[i];
+        const Muscle::MuscleLengthInfo& mli = muscle.getMuscleLengthInfo(s);
+        normTendonLength[i] = mli.normTendonLength;
+        fiberLengthAlongTendon[i] = mli.fiberLengthAlongTendon;
+        fiberLength[i] = mli.fiberLength;
+        cosPenn[i] = mli.cosPennationAngle;
+        passiveMult[i] = mli.fiberPassiveForceLengthMultiplier;
+        activeMult[i] = mli.fiberActiveForceLengthMultiplier;
+        mtVelocity[i] = muscle.getLengtheningSpeed(s);
+        activation[i] = muscle.getActivation(s);
+        normTendonForce[i] = SimTK::NaN;
+        normTendonForceDeriv[i] = SimTK::NaN;
+        if (!m_ignoreTendonCompliance[i]) {
+            if (m_isTendonDynamicsExplicit[i]) {
+                normTendonForce[i] = muscle.getNormalizedTendonForce(s);
+            } else {
+                normTendonForceDeriv[i] =
+                        muscle.getNormalizedTendonForceDerivative(s);
+            }
+        }
+    }
+
+    // See DeGrooteFregly2016Muscle::calcFiberVelocityInfoHelper().
+    for (int i = 0; i < n; ++i) {
+        if (m_isTendonDynamicsExplicit[i] && !m_ignoreTendonCompliance[i]) {
+            const double normFiberForce = normTendonForce[i] / cosPenn[i];
+            fvMult[i] = (normFiberForce - passiveMult[i]) /
+                        (activation[i] * activeMult[i]);
+            normFiberVelocity[i] = DGF::calcForceVelocityInverseCurve(fvMult[i]);
+            fiberVelocity[i] =
+                    normFiberVelocity[i] * m_maxContractionVelocity[i];
+            fiberVelocityAlongTendon[i] = fiberVelocity[i] / cosPenn[i];
+            tendonVelocity[i] = mtVelocity[i] - fiberVelocityAlongTendon[i];
+            normTendonVelocity[i] = tendonVelocity[i] / m_tendonSlackLength[i];
+        } else {
+            normTendonVelocity[i] = m_ignoreTendonCompliance[i]
+                    ? 0.0
+                    : normTendonForceDeriv[i] /
+                              (DGF::c1 * m_kT[i] *
+                                      exp(m_kT[i] * (normTendonLength[i] -
+                                                            DGF::c2)));
+            tendonVelocity[i] = m_tendonSlackLength[i] * normTendonVelocity[i];
+            fiberVelocityAlongTendon[i] = mtVelocity[i] - tendonVelocity[i];
+            fiberVelocity[i] = fiberVelocityAlongTendon[i] * cosPenn[i];
+            normFiberVelocity[i] =
+                    fiberVelocity[i] / m_maxContractionVelocity[i];
+            fvMult[i] = DGF::calcForceVelocityMultiplier(normFiberVelocity[i]);
+        }
+    }
+    for (int i = 0; i < n; ++i) {
+        const double tanPenn = m_fiberWidth[i] / fiberLengthAlongTendon[i];
+        pennAngularVelocity[i] = -fiberVelocity[i] / fiberLength[i] * tanPenn;
+    }
+
+    // Scatter the results to the cache of each muscle.
+    for (int i = 0; i < n; ++i) {
+        const DGF& muscle = *m_muscles[i];
+        if (muscle.isCacheVariableValid(s, VELOCITY_INFO_NAME)) continue;
+        Muscle::FiberVelocityInfo& fvi = muscle.updFiberVelocityInfo(s);
+        fvi.fiberForceVelocityMultiplier = fvMult[i];
+        fvi.normFiberVelocity = normFiberVelocity[i];
+        fvi.fiberVelocity = fiberVelocity[i];
+        fvi.fiberVelocityAlongTendon = fiberVelocityAlongTendon[i];
+        fvi.tendonVelocity = tendonVelocity[i];
+        fvi.normTendonVelocity = normTendonVelocity[i];
+        fvi.pennationAngularVelocity = pennAngularVelocity[i];
+        muscle.markCacheVariableValid(s, VELOCITY_INFO_NAME);
+
+        if (normFiberVelocity[i] < -1.0) {
+            log_info("DeGrooteFregly2016Muscle '{}' is exceeding maximum "
+                     "contraction velocity at time {} s.",
+                    muscle.getName(), s.getTime());
+        }
+    }
+}
+
+void MuscleBank::computeMuscleDynamicsInfo(const SimTK::State& s) const {
+    const int n = getNumMuscles();
+    bool anyInvalid = false;
+    for (int i = 0; i < n && !anyInvalid; ++i) {
+        anyInvalid =
+                !m_muscles[i]->isCacheVariableValid(s, DYNAMICS_INFO_NAME);
+    }
+    if (!anyInvalid) return;
+
+    computeFiberVelocityInfo(s);
+
+    SimTK::Matrix& ws = updCacheVariableValue(s, m_workspaceCV);
+    double* mtVelocity = &ws(0, MuscleTendonVelocity);
+    double* activation = &ws(0, Activation);
+    double* normTendonForce = &ws(0, NormTendonForce);
+    double* normTendonLength = &ws(0, NormTendonLength);
+    double* fiberLength = &ws(0, FiberLength);
+    double* normFiberLength = &ws(0, NormFiberLength);
+    double* cosPenn = &ws(0, CosPennationAngle);
+    double* sinPenn = &ws(0, SinPennationAngle);
+    double* passiveMult = &ws(0, PassiveForceMultiplier);
+    double* activeMult = &ws(0, ActiveForceLengthMultiplier);
+    double* fvMult = &ws(0, ForceVelocityMultiplier);
+    double* normFiberVelocity = &ws(0, NormFiberVelocity);
+    double* fiberVelocity = &ws(0, FiberVelocity);
+    double* tendonVelocity = &ws(0, TendonVelocity);
+    double* activeFiberForce = &ws(0, ActiveFiberForce);
+    double* conPassiveFiberForce = &ws(0, ConPassiveFiberForce);
+    double* nonConPassiveFiberForce = &ws(0, NonConPassiveFiberForce);
+    double* fiberForce = &ws(0, FiberForce);
+    double* fiberForceAlongTendon = &ws(0, FiberForceAlongTendon);
+    double* dynNormTendonForce = &ws(0, DynamicsNormTendonForce);
+    double* tendonForce = &ws(0, TendonForce);
+    double* fiberStiffness = &ws(0, FiberStiffness);
+    double* partialPennPartialFiberLength =
+            &ws(0, PartialPennationAnglePartialFiberLength);
+    double* partialFiberForceAlongTendonPartialFiberLength =
+            &ws(0, PartialFiberForceAlongTendonPartialFiberLength);
+    double* fiberStiffnessAlongTendon = &ws(0, FiberStiffnessAlongTendon);
+    double* tendonStiffness = &ws(0, TendonStiffness);
+    double* muscleStiffness = &ws(0, MuscleStiffness);
+    double* partialTendonForcePartialFiberLength =
+            &ws(0, PartialTendonForcePartialFiberLength);
+
+    // Gather the inputs.
+    for (int i = 0; i < n; ++i) {
+        const DGF& muscle = *m_muscles[i];
+        const Muscle::MuscleLengthInfo& mli = muscle.getMuscleLengthInfo(s);
+        const Muscle::FiberVelocityInfo& fvi = muscle.getFiberVelocityInfo(s);
+        normTendonLength[i] = mli.normTendonLength;
+        fiberLength[i] = mli.fiberLength;
+        normFiberLength[i] = mli.normFiberLength;
+        cosPenn[i] = mli.cosPennationAngle;
+        sinPenn[i] = mli.sinPennationAngle;
+        passiveMult[i] = mli.fiberPassiveForceLengthMultiplier;
+        activeMult[i] = mli.fiberActiveForceLengthMultiplier;
+        fvMult[i] = fvi.fiberForceVelocityMultiplier;
+        normFiberVelocity[i] = fvi.normFiberVelocity;
+        fiberVelocity[i] = fvi.fiberVelocity;
+        tendonVelocity[i] = fvi.tendonVelocity;
+        mtVelocity[i] = muscle.getLengtheningSpeed(s);
+        activation[i] = muscle.getActivation(s);
+        normTendonForce[i] = m_ignoreTendonCompliance[i]
+                                     ? SimTK::NaN
+                                     : muscle.getNormalizedTendonForce(s);
+    }
+
+    // Forces (see DeGrooteFregly2016Muscle::calcFiberForce() and
+    // calcMuscleDynamicsInfoHelper()).
+    for (int i = 0; i < n; ++i) {
+        const double maxIsometricForce = m_maxIsometricForce[i];
+        activeFiberForce[i] = maxIsometricForce *
+                              (activation[i] * activeMult[i] * fvMult[i]);
+        conPassiveFiberForce[i] = maxIsometricForce * passiveMult[i];
+        nonConPassiveFiberForce[i] =
+                maxIsometricForce * m_fiberDamping[i] * normFiberVelocity[i];
+        fiberForce[i] = activeFiberForce[i] + conPassiveFiberForce[i] +
+                        nonConPassiveFiberForce[i];
+        fiberForceAlongTendon[i] = fiberForce[i] * cosPenn[i];
+        if (m_ignoreTendonCompliance[i]) {
+            dynNormTendonForce[i] =
+                    fiberForce[i] / maxIsometricForce * cosPenn[i];
+            tendonForce[i] = fiberForceAlongTendon[i];
+        } else {
+            dynNormTendonForce[i] = normTendonForce[i];
+            tendonForce[i] = maxIsometricForce * normTendonForce[i];
+        }
+    }
+
+    // Fiber stiffness (see DeGrooteFregly2016Muscle::calcFiberStiffness()).
+    for (int i = 0; i < n; ++i) {
+        const double scale = m_activeForceWidthScale[i];
+        const double x = (normFiberLength[i] - 1.0) / scale + 1.0;
+        const double activeMultDeriv =
+                (1.0 / scale) *
+                (DGF::calcGaussianLikeCurveDerivative(
+                         x, DGF::b11, DGF::b21, DGF::b31, DGF::b41) +
+                        DGF::calcGaussianLikeCurveDerivative(
+                                x, DGF::b12, DGF::b22, DGF::b32, DGF::b42) +
+                        DGF::calcGaussianLikeCurveDerivative(
+                                x, DGF::b13, DGF::b23, DGF::b33, DGF::b43));
+        const double e0 = m_passiveFiberStrain[i];
+        const double passiveMultDeriv = m_ignorePassiveFiberForce[i]
+                ? 0
+                : (DGF::kPE * exp((DGF::kPE * (normFiberLength[i] - 1)) / e0)) /
+                          (e0 * m_passiveForceDenom[i]);
+        const double partialNormFiberLengthPartialFiberLength =
+                1.0 / m_optimalFiberLength[i];
+        fiberStiffness[i] =
+                m_maxIsometricForce[i] *
+                (activation[i] * (partialNormFiberLengthPartialFiberLength *
+                                         activeMultDeriv) *
+                                fvMult[i] +
+                        partialNormFiberLengthPartialFiberLength *
+                                passiveMultDeriv);
+    }
+
+    // Stiffnesses along the tendon.
+    for (int i = 0; i < n; ++i) {
+        const double fiberWidth = m_fiberWidth[i];
+        partialPennPartialFiberLength[i] =
+                (-fiberWidth / SimTK::square(fiberLength[i])) /
+                sqrt(1.0 - SimTK::square(fiberWidth / fiberLength[i]));
+        const double partialCosPennPartialFiberLength =
+                -sinPenn[i] * partialPennPartialFiberLength[i];
+        partialFiberForceAlongTendonPartialFiberLength[i] =
+                fiberStiffness[i] * cosPenn[i] +
+                fiberForce[i] * partialCosPennPartialFiberLength;
+        const double partialFiberLengthAlongTendonPartialFiberLength =
+                cosPenn[i] - fiberLength[i] * sinPenn[i] *
+                                     partialPennPartialFiberLength[i];
+        fiberStiffnessAlongTendon[i] =
+                partialFiberForceAlongTendonPartialFiberLength[i] *
+                (1.0 / partialFiberLengthAlongTendonPartialFiberLength);
+
+        if (m_ignoreTendonCompliance[i]) {
+            tendonStiffness[i] = SimTK::Infinity;
+            muscleStiffness[i] = fiberStiffnessAlongTendon[i];
+        } else {
+            tendonStiffness[i] =
+                    (m_maxIsometricForce[i] / m_tendonSlackLength[i]) *
+                    (DGF::c1 * m_kT[i] *
+                            exp(m_kT[i] * (normTendonLength[i] - DGF::c2)));
+            muscleStiffness[i] =
+                    (fiberStiffnessAlongTendon[i] * tendonStiffness[i]) /
+                    (fiberStiffnessAlongTendon[i] + tendonStiffness[i]);
+        }
+        partialTendonForcePartialFiberLength[i] =
+                tendonStiffness[i] *
+                (fiberLength[i] * sinPenn[i] *
+                                partialPennPartialFiberLength[i] -
+                        cosPenn[i]);
+    }
+
+    // Scatter the results to the cache of each muscle.
+    for (int i = 0; i < n; ++i) {
+        const DGF& muscle = *m_muscles[i];
+        if (!muscle.isCacheVariableValid(s, DYNAMICS_INFO_NAME)) {
+            Muscle::MuscleDynamicsInfo& mdi = muscle.updMuscleDynamicsInfo(s);
+            mdi.activation = activation[i];
+            mdi.fiberForce = fiberForce[i];
+            mdi.activeFiberForce = activeFiberForce[i];
+            mdi.passiveFiberForce =
+                    conPassiveFiberForce[i] + nonConPassiveFiberForce[i];
+            mdi.normFiberForce = fiberForce[i] / m_maxIsometricForce[i];
+            mdi.fiberForceAlongTendon = fiberForceAlongTendon[i];
+            mdi.normTendonForce = dynNormTendonForce[i];
+            mdi.tendonForce = tendonForce[i];
+            mdi.fiberStiffness = fiberStiffness[i];
+            mdi.fiberStiffnessAlongTendon = fiberStiffnessAlongTendon[i];
+            mdi.tendonStiffness = tendonStiffness[i];
+            mdi.muscleStiffness = muscleStiffness[i];
+            mdi.fiberActivePower =
+                    -(activeFiberForce[i] + nonConPassiveFiberForce[i]) *
+                    fiberVelocity[i];
+            mdi.fiberPassivePower = -conPassiveFiberForce[i] * fiberVelocity[i];
+            mdi.tendonPower = -tendonForce[i] * tendonVelocity[i];
+            mdi.musclePower = -tendonForce[i] * mtVelocity[i];
+
+            mdi.userDefinedDynamicsExtras.resize(5);
+            mdi.userDefinedDynamicsExtras[DGF::m_mdi_passiveFiberElasticForce] =
+                    conPassiveFiberForce[i];
+            mdi.userDefinedDynamicsExtras[DGF::m_mdi_passiveFiberDampingForce] =
+                    nonConPassiveFiberForce[i];
+            mdi.userDefinedDynamicsExtras
+                    [DGF::m_mdi_partialPennationAnglePartialFiberLength] =
+                    partialPennPartialFiberLength[i];
+            mdi.userDefinedDynamicsExtras
+                    [DGF::m_mdi_partialFiberForceAlongTendonPartialFiberLength] =
+                    partialFiberForceAlongTendonPartialFiberLength[i];
+            mdi.userDefinedDynamicsExtras
+                    [DGF::m_mdi_partialTendonForcePartialFiberLength] =
+                    partialTendonForcePartialFiberLength[i];
+            muscle.markCacheVariableValid(s, DYNAMICS_INFO_NAME);
+        }
+
+        // In implicit mode, the dynamics info above is computed with the
+        // implicit form of the model, so it also gives the equilibrium
+        // residual (see DeGrooteFregly2016Muscle::calcEquilibriumResidual()).
+        if (!m_ignoreTendonCompliance[i] && !m_isTendonDynamicsExplicit[i] &&
+                !muscle.isCacheVariableValid(
+                        s, DGF::RESIDUAL_NORMALIZED_TENDON_FORCE_NAME)) {
+            muscle.setCacheVariableValue(s,
+                    DGF::RESIDUAL_NORMALIZED_TENDON_FORCE_NAME,
+                    normTendonForce[i] -
+                            fiberForceAlongTendon[i] / m_maxIsometricForce[i]);
+            muscle.markCacheVariableValid(
+                    s, DGF::RESIDUAL_NORMALIZED_TENDON_FORCE_NAME);
+        }
+    }
+}
@@ -0,0 +1,119 @@
+#ifndef OPENSIM_MUSCLEBANK_H
+#define OPENSIM_MUSCLEBANK_H
+/* -------------------------------------------------------------------------- *
+ *                         OpenSim:  MuscleBank.h                             *
+ * -------------------------------------------------------------------------- *
+ * The OpenSim API is a toolkit for musculoskeletal modeling and simulation.  *
+ * See http://opensim.stanford.edu and the NOTICE file for more information.  *
+ * OpenSim is developed at Stanford University and supported by the US        *
+ * National Institutes of Health (U54 GM072970, R24 HD065690) and by DARPA    *
+ * through the Warrior Web program.                                           *
+ *                                                                            *
+ * Copyright (c) 2005-2021 Stanford University and the Authors                *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+#include <OpenSim/Actuators/osimActuatorsDLL.h>
+
+#include <OpenSim/Simulation/Model/ModelComponent.h>
+
+namespace OpenSim {
+
+class DeGrooteFregly2016Muscle;
+
+/** Compute the length, velocity, and dynamics information of all
+DeGrooteFregly2016Muscle%s in a model together, rather than muscle by muscle.
+
+When a MuscleBank is part of a model, the first DeGrooteFregly2016Muscle whose
+MuscleLengthInfo, FiberVelocityInfo, or MuscleDynamicsInfo is requested for a
+state has the bank compute that information for every muscle at once: the
+inputs of all muscles (lengths, speeds, activations, and tendon states) are
+gathered into contiguous arrays, the curves and equilibrium equations of the
+muscle model are evaluated for all muscles in one pass over these arrays, and
+the results are stored in the usual cache variables of each muscle. The
+other muscles then find their information in the cache. The muscle-tendon
+equilibrium residual of muscles in implicit tendon compliance mode is cached
+in the same pass. The results are the same as without the bank (up to
+rounding), so all outputs and getters of the muscles remain valid; the bank
+only removes the per-muscle overhead of computing them one at a time, which
+matters for models with many muscles (e.g., in MocoInverse).
+
+@code
+model.addComponent(new MuscleBank());
+@endcode
+
+The bank contains all DeGrooteFregly2016Muscle%s in the model when the model
+is connected (e.g., in initSystem()). A model should contain at most one
+MuscleBank. Muscles of other types are not affected. */
+class OSIMACTUATORS_API MuscleBank : public ModelComponent {
+    OpenSim_DECLARE_CONCRETE_OBJECT(MuscleBank, ModelComponent);
+
+public:
+    MuscleBank() = default;
+
+    /// The number of muscles in the bank.
+    int getNumMuscles() const { return (int)m_muscles.size(); }
+    /// The muscle with index i in the bank.
+    const DeGrooteFregly2016Muscle& getMuscle(int i) const;
+
+    /// @name Batch computations
+    /// Each of these computes the information for all muscles in the bank,
+    /// and stores it in the cache variables of the muscles whose cache
+    /// variable is not already valid. The muscles call these methods
+    /// themselves; you do not need to call them.
+    /// @{
+    /// Requires the state to be realized to Position.
+    void computeMuscleLengthInfo(const SimTK::State& s) const;
+    /// Requires the state to be realized to Velocity.
+    void computeFiberVelocityInfo(const SimTK::State& s) const;
+    /// Requires the state to be realized to Velocity. This also caches the
+    /// muscle-tendon equilibrium residual of muscles that use implicit
+    /// tendon compliance dynamics.
+    void computeMuscleDynamicsInfo(const SimTK::State& s) const;
+    /// @}
+
+protected:
+    void extendConnectToModel(Model& model) override;
+    void extendAddToSystem(SimTK::MultibodySystem& system) const override;
+
+private:
+    std::vector<SimTK::ReferencePtr<const DeGrooteFregly2016Muscle>> m_muscles;
+
+    // Parameters of the muscles, one element per muscle.
+    // --------------------------------------------------
+    std::vector<double> m_maxIsometricForce;
+    std::vector<double> m_optimalFiberLength;
+    std::vector<double> m_tendonSlackLength;
+    std::vector<double> m_fiberWidth;
+    std::vector<double> m_squareFiberWidth;
+    std::vector<double> m_maxContractionVelocity;
+    std::vector<double> m_kT;
+    std::vector<double> m_activeForceWidthScale;
+    std::vector<double> m_fiberDamping;
+    std::vector<double> m_passiveFiberStrain;
+    // Offset and denominator of the passive force-length curve.
+    std::vector<double> m_passiveForceOffset;
+    std::vector<double> m_passiveForceDenom;
+    std::vector<char> m_ignoreTendonCompliance;
+    std::vector<char> m_isTendonDynamicsExplicit;
+    std::vector<char> m_ignorePassiveFiberForce;
+
+    // The inputs and intermediate results of the batch computations, one
+    // column per quantity (see MuscleBank.cpp), so that each quantity is
+    // contiguous for all muscles. This is a cache variable so that one model
+    // can be used with several states at the same time.
+    mutable CacheVariable<SimTK::Matrix> m_workspaceCV;
+};
+
+} // namespace OpenSim
+
+#endif // OPENSIM_MUSCLEBANK_H
@@ -58,6 +58,7 @@
 #include "Millard2012EquilibriumMuscle.h"
 #include "Millard2012AccelerationMuscle.h"
 #include "DeGrooteFregly2016Muscle.h"
+#include "MuscleBank.h"
 
 #include "ModelOperators.h"
 
@@ -111,6 +112,7 @@ OSIMACTUATORS_API void RegisterTypes_osimActuators()
     Object::RegisterType(Millard2012EquilibriumMuscle());
     Object::RegisterType(Millard2012AccelerationMuscle());        
     Object::RegisterType(DeGrooteFregly2016Muscle());
+    Object::RegisterType(MuscleBank());
 
     Object::registerType(ModelProcessor());
     Object::registerType(ModOpIgnoreActivationDynamics());
@@ -36,6 +36,9 @@
 #endif
 
 namespace OpenSim {
+
+class Millard2012EquilibriumMuscle;
+
 /** This class serves as a serializable TendonForceLengthCurve for use in muscle
     models. The tendon-force-length curve is dimensionless: force is normalized
     to maximum isometric force and length is normalized to tendon slack length.
@@ -369,6 +372,8 @@ private:
 
     SmoothSegmentedFunction m_curve;
 
+    friend class Millard2012EquilibriumMuscle;
+
     double m_normForceAtToeEndInUse;
     double m_stiffnessAtOneNormForceInUse;
     double m_curvinessInUse;
@@ -22,6 +22,7 @@
  * -------------------------------------------------------------------------- */
 
 #include <OpenSim/Actuators/DeGrooteFregly2016Muscle.h>
+#include <OpenSim/Actuators/MuscleBank.h>
 #include <OpenSim/Common/CommonUtilities.h>
 #include <OpenSim/Common/STOFileAdapter.h>
 #include <OpenSim/Moco/osimMoco.h>
@@ -1085,3 +1086,121 @@ TEST_CASE("DeGrooteFregly2016Muscle basics") {
         CHECK(state.getY()[2] == Approx(0.451));
     }
 }
+
+TEST_CASE("MuscleBank") {
+    // Muscles with different settings, to cover each branch of the batch
+    // computations.
+    Model model;
+    model.setName("muscles");
+    auto* body = new Body("body", 0.5, SimTK::Vec3(0), SimTK::Inertia(0));
+    model.addComponent(body);
+    auto* joint = new SliderJoint("joint", model.getGround(), *body);
+    auto& coord = joint->updCoordinate(SliderJoint::Coord::TranslationX);
+    coord.setName("x");
+    model.addComponent(joint);
+    auto addMuscle = [&](const std::string& name, bool ignoreTendonCompliance,
+                             const std::string& mode, double pennation,
+                             double damping, bool ignorePassive) {
+        auto* muscle = new DeGrooteFregly2016Muscle();
+        muscle->setName(name);
+        muscle->set_max_isometric_force(500);
+        muscle->set_optimal_fiber_length(0.1);
+        muscle->set_tendon_slack_length(0.2);
+        muscle->set_ignore_tendon_compliance(ignoreTendonCompliance);
+        muscle->set_tendon_compliance_dynamics_mode(mode);
+        muscle->set_pennation_angle_at_optimal(pennation);
+        muscle->set_fiber_damping(damping);
+        muscle->set_ignore_passive_fiber_force(ignorePassive);
+        muscle->addNewPathPoint("origin", model.updGround(), SimTK::Vec3(0));
+        muscle->addNewPathPoint("insertion", *body, SimTK::Vec3(0));
+        model.addComponent(muscle);
+    };
+    addMuscle("rigid", true, "explicit", 0, 0.01, false);
+    addMuscle("explicit", false, "explicit", 0.1, 0.01, false);
+    addMuscle("implicit", false, "implicit", 0.2, 0.05, false);
+    addMuscle("no_passive", false, "explicit", 0, 0, true);
+    model.finalizeConnections();
+
+    Model modelWithBank(model);
+    auto* bank = new MuscleBank();
+    bank->setName("bank");
+    modelWithBank.addComponent(bank);
+
+    auto createState = [](Model& model) {
+        SimTK::State state = model.initSystem();
+        const auto& x = model.getComponent<Coordinate>("joint/x");
+        x.setValue(state, 0.31);
+        x.setSpeedValue(state, -0.3);
+        for (const auto& muscle :
+                model.getComponentList<DeGrooteFregly2016Muscle>()) {
+            muscle.setActivation(state, 0.6);
+            if (muscle.get_ignore_tendon_compliance()) continue;
+            muscle.setStateVariableValue(state, "normalized_tendon_force", 0.4);
+            if (muscle.get_tendon_compliance_dynamics_mode() == "implicit") {
+                muscle.setDiscreteVariableValue(
+                        state, "implicitderiv_normalized_tendon_force", 0.8);
+            }
+        }
+        model.realizeDynamics(state);
+        return state;
+    };
+    const SimTK::State state = createState(model);
+    const SimTK::State stateWithBank = createState(modelWithBank);
+    CHECK(bank->getNumMuscles() == 4);
+
+    auto compare = [](double actual, double expected) {
+        CHECK(actual == Approx(expected).epsilon(1e-12).margin(1e-12));
+    };
+    for (const auto& muscle :
+            model.getComponentList<DeGrooteFregly2016Muscle>()) {
+        CAPTURE(muscle.getName());
+        const auto& muscleWithBank =
+                modelWithBank.getComponent<DeGrooteFregly2016Muscle>(
+                        muscle.getAbsolutePath());
+        const auto& s = state;
+        const auto& sb = stateWithBank;
+        // Length.
+        compare(muscleWithBank.getTendonLength(sb), muscle.getTendonLength(s));
+        compare(muscleWithBank.getFiberLength(sb), muscle.getFiberLength(s));
+        compare(muscleWithBank.getPennationAngle(sb),
+                muscle.getPennationAngle(s));
+        compare(muscleWithBank.getActiveForceLengthMultiplier(sb),
+                muscle.getActiveForceLengthMultiplier(s));
+        compare(muscleWithBank.getPassiveForceMultiplier(sb),
+                muscle.getPassiveForceMultiplier(s));
+        // Velocity.
+        compare(muscleWithBank.getFiberVelocity(sb),
+                muscle.getFiberVelocity(s));
+        compare(muscleWithBank.getTendonVelocity(sb),
+                muscle.getTendonVelocity(s));
+        compare(muscleWithBank.getPennationAngularVelocity(sb),
+                muscle.getPennationAngularVelocity(s));
+        compare(muscleWithBank.getForceVelocityMultiplier(sb),
+                muscle.getForceVelocityMultiplier(s));
+        // Dynamics.
+        compare(muscleWithBank.getFiberForce(sb), muscle.getFiberForce(s));
+        compare(muscleWithBank.getTendonForce(sb), muscle.getTendonForce(s));
+        compare(muscleWithBank.getPassiveFiberElasticForce(sb),
+                muscle.getPassiveFiberElasticForce(s));
+        compare(muscleWithBank.getPassiveFiberDampingForce(sb),
+                muscle.getPassiveFiberDampingForce(s));
+        compare(muscleWithBank.getFiberStiffnessAlongTendon(sb),
+                muscle.getFiberStiffnessAlongTendon(s));
+        compare(muscleWithBank.getMuscleStiffness(sb),
+                muscle.getMuscleStiffness(s));
+        compare(muscleWithBank.getFiberActivePower(sb),
+                muscle.getFiberActivePower(s));
+        compare(muscleWithBank.getMusclePower(sb), muscle.getMusclePower(s));
+        if (muscle.get_tendon_compliance_dynamics_mode() == "implicit") {
+            compare(muscleWithBank.getImplicitResidualNormalizedTendonForce(sb),
+                    muscle.getImplicitResidualNormalizedTendonForce(s));
+        }
+    }
+
+    SECTION("At most one bank") {
+        auto* otherBank = new MuscleBank();
+        otherBank->setName("other_bank");
+        modelWithBank.addComponent(otherBank);
+        CHECK_THROWS_AS(modelWithBank.initSystem(), Exception);
+    }
+}
@@ -901,6 +901,95 @@ void testMillard2012EquilibriumMuscle()
         muscle->computeInitialFiberEquilibrium(state);
     }
 
+    // Solving the equilibrium of several muscles together must give the same
+    // fiber lengths as solving for each muscle on its own, and warm starting
+    // from a previous solution must take fewer iterations.
+    {
+        Model model;
+
+        const double pathLengths[] = {0.28, 0.31, 0.33, 0.36};
+        const double pennationAngles[] = {0., 0.1, 0.3, 0.};
+        const double activations[] = {0.05, 0.5, 1.0, 0.7};
+        std::vector<Millard2012EquilibriumMuscle*> muscles;
+        for (int i = 0; i < 4; ++i) {
+            auto muscle = new Millard2012EquilibriumMuscle(
+                    "muscle" + std::to_string(i), 100., 0.1, 0.2,
+                    pennationAngles[i]);
+            muscle->addNewPathPoint("p1", model.updGround(), SimTK::Vec3(0));
+            muscle->addNewPathPoint("p2", model.updGround(),
+                    SimTK::Vec3(0, 0, pathLengths[i]));
+            model.addForce(muscle);
+            muscles.push_back(muscle);
+        }
+        // A muscle with a rigid tendon has no fiber equilibrium to solve.
+        auto rigid = new Millard2012EquilibriumMuscle("rigid", 100., 0.1, 0.2,
+                0.);
+        rigid->set_ignore_tendon_compliance(true);
+        rigid->addNewPathPoint("p1", model.updGround(), SimTK::Vec3(0));
+        rigid->addNewPathPoint("p2", model.updGround(),
+                SimTK::Vec3(0, 0, 0.3));
+        model.addForce(rigid);
+
+        SimTK::State& state = model.initSystem();
+        for (int i = 0; i < 4; ++i) {
+            muscles[i]->setActivation(state, activations[i]);
+        }
+        SimTK::State stateSingle = state;
+
+        Millard2012FiberEquilibriumSolver solver(model);
+        ASSERT(solver.getNumMuscles() == 4, __FILE__, __LINE__,
+                "Expected the solver to skip the rigid-tendon muscle.");
+        ASSERT(!solver.hasMuscle(*rigid), __FILE__, __LINE__,
+                "Expected the solver to skip the rigid-tendon muscle.");
+        solver.solve(state);
+        std::vector<int> coldIterations;
+        for (int i = 0; i < 4; ++i) {
+            coldIterations.push_back(solver.getNumIterations(i));
+        }
+
+        model.realizeVelocity(stateSingle);
+        for (auto* muscle : muscles) {
+            muscle->computeFiberEquilibrium(stateSingle);
+        }
+
+        model.realizeDynamics(state);
+        for (auto* muscle : muscles) {
+            const double tol = 1e-6 * muscle->getMaxIsometricForce();
+            ASSERT_EQUAL<double>(muscle->getTendonForce(state),
+                    muscle->getActiveFiberForceAlongTendon(state) +
+                    muscle->getPassiveFiberForceAlongTendon(state),
+                    tol, __FILE__, __LINE__,
+                    "Tendon force does not equal fiber force along tendon.");
+            ASSERT_EQUAL<double>(muscle->getFiberLength(stateSingle),
+                    muscle->getFiberLength(state), 1e-6, __FILE__, __LINE__,
+                    "Fiber length differs from computeFiberEquilibrium().");
+        }
+
+        // Solve again after a small change in activation.
+        for (int i = 0; i < 4; ++i) {
+            muscles[i]->setActivation(state, activations[i] + 0.01);
+        }
+        solver.solve(state);
+        model.realizeDynamics(state);
+        int numColdIterations = 0;
+        int numWarmIterations = 0;
+        for (int i = 0; i < 4; ++i) {
+            numColdIterations += coldIterations[i];
+            numWarmIterations += solver.getNumIterations(i);
+            ASSERT(solver.getNumIterations(i) <= coldIterations[i],
+                    __FILE__, __LINE__,
+                    "Expected no more iterations when warm starting.");
+            const double tol = 1e-6 * muscles[i]->getMaxIsometricForce();
+            ASSERT_EQUAL<double>(muscles[i]->getTendonForce(state),
+                    muscles[i]->getActiveFiberForceAlongTendon(state) +
+                    muscles[i]->getPassiveFiberForceAlongTendon(state),
+                    tol, __FILE__, __LINE__,
+                    "Tendon force does not equal fiber force along tendon.");
+        }
+        ASSERT(numWarmIterations < numColdIterations, __FILE__, __LINE__,
+                "Expected fewer iterations when warm starting.");
+    }
+
     // Test exception handling when invalid properties are propagated to
     // MuscleFixedWidthPennationModel and MuscleFirstOrderActivationDynamicModel
     // subcomponents.
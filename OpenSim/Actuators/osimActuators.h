@@ -38,8 +38,10 @@
 #include "Thelen2003Muscle.h"
 #include "RigidTendonMuscle.h"
 #include "Millard2012EquilibriumMuscle.h"
+#include "Millard2012FiberEquilibriumSolver.h"
 #include "Millard2012AccelerationMuscle.h"
 #include "DeGrooteFregly2016Muscle.h"
+#include "MuscleBank.h"
 
 #include "McKibbenActuator.h"
 
@@ -677,6 +677,20 @@ end(const SimTK::State&s )
 
     return(0);
 }
+//_____________________________________________________________________________
+/**
+ * Get the storages of the positions, velocities, and accelerations.
+ */
+ArrayPtrs<Storage>& BodyKinematics::
+getStorageList()
+{
+    _storageList.setMemoryOwner(false);
+    _storageList.setSize(0);
+    if(_pStore) _storageList.append(_pStore);
+    if(_vStore) _storageList.append(_vStore);
+    if(_aStore) _storageList.append(_aStore);
+    return _storageList;
+}
 
 
 
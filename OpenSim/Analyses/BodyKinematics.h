@@ -122,6 +122,8 @@ public:
         step(const SimTK::State& s, int setNumber ) override;
     int
         end(const SimTK::State& s ) override;
+    bool isFrameIndependent() const override { return true; }
+    ArrayPtrs<Storage>& getStorageList() override;
 protected:
     virtual int
         record(const SimTK::State& s );
@@ -701,6 +701,18 @@ end(const SimTK::State&s)
 
     return(0);
 }
+//_____________________________________________________________________________
+/**
+ * Get the storages of the reaction loads.
+ */
+ArrayPtrs<Storage>& JointReaction::
+getStorageList()
+{
+    _storageList.setMemoryOwner(false);
+    _storageList.setSize(0);
+    _storageList.append(&_storeReactionLoads);
+    return _storageList;
+}
 
 
 
@@ -37,6 +37,84 @@
 using namespace OpenSim;
 using namespace std;
 
+namespace {
+//_____________________________________________________________________________
+/**
+ * Solve the quadratic program
+ *
+ *     minimize    sum_i x_i^2
+ *     subject to  A x = b  and  lower <= x <= upper
+ *
+ * with a primal-dual active-set method. The variables in the active set are
+ * held at their bounds, and the other (free) variables take the minimum-norm
+ * solution of the equality constraints, x_free = ~A_free * lambda. A variable
+ * is in the active set of the next iteration if (~A * lambda)_i, its value
+ * at the minimum without bounds, is outside its bounds. The solution is found
+ * once the active set does not change; with a good initial guess for the
+ * active set, this takes only a few iterations.
+ *
+ * @param activeSet For each variable, -1 or 1 if it is held at its lower or
+ * upper bound, and 0 if it is free. On entry, the initial guess (e.g., the
+ * active set at the previous time); on return, the active set of x.
+ * @return false if the active set did not settle within maxIterations, or if
+ * the equality constraints cannot be satisfied.
+ */
+bool solveQuadraticProgram(const SimTK::Matrix& A, const SimTK::Vector& b,
+        const SimTK::Vector& lower, const SimTK::Vector& upper,
+        int maxIterations, std::vector<int>& activeSet, SimTK::Vector& x)
+{
+    const int nc = A.nrow();
+    const int nx = A.ncol();
+    if(nc == 0) return false;
+
+    x.resize(nx);
+    SimTK::Vector r, xFree, lambda(nc);
+    std::vector<int> freeIndices;
+    for(int iter=0; iter<maxIterations; iter++) {
+        freeIndices.clear();
+        r = b;
+        for(int i=0; i<nx; i++) {
+            if(activeSet[i] == 0) {
+                freeIndices.push_back(i);
+            } else {
+                x[i] = activeSet[i] < 0 ? lower[i] : upper[i];
+                r -= A(i) * x[i];
+            }
+        }
+
+        const int nf = (int)freeIndices.size();
+        lambda = 0;
+        if(nf > 0) {
+            SimTK::Matrix AFree(nc, nf);
+            for(int k=0; k<nf; k++) AFree(k) = A(freeIndices[k]);
+            SimTK::FactorQTZ factorA(AFree);
+            factorA.solve(r, xFree);
+            SimTK::Matrix AFreeTranspose = ~AFree;
+            SimTK::FactorQTZ factorAT(AFreeTranspose);
+            factorAT.solve(xFree, lambda);
+            for(int k=0; k<nf; k++) x[freeIndices[k]] = xFree[k];
+        }
+
+        const SimTK::Vector unbounded = ~A * lambda;
+        bool changed = false;
+        for(int i=0; i<nx; i++) {
+            int status = 0;
+            if(unbounded[i] < lower[i]) status = -1;
+            else if(unbounded[i] > upper[i]) status = 1;
+            if(status != activeSet[i]) {
+                activeSet[i] = status;
+                changed = true;
+            }
+        }
+        if(!changed) {
+            const SimTK::Vector residual = A * x - b;
+            return residual.normInf() <= SimTK::SqrtEps*(1.0 + b.normInf());
+        }
+    }
+    return false;
+}
+} // anonymous namespace
+
 //=============================================================================
 // CONSTRUCTOR(S) AND DESTRUCTOR
 //=============================================================================
@@ -61,6 +139,8 @@ StaticOptimization::StaticOptimization(Model *aModel) :
     _useMusclePhysiology(_useMusclePhysiologyProp.getValueBool()),
     _convergenceCriterion(_convergenceCriterionProp.getValueDbl()),
     _maximumIterations(_maximumIterationsProp.getValueInt()),
+    _useActiveSetSolver(_useActiveSetSolverProp.getValueBool()),
+    _activeSetMaximumIterations(_activeSetMaximumIterationsProp.getValueInt()),
     _modelWorkingCopy(NULL)
 {
     setNull();
@@ -82,6 +162,8 @@ StaticOptimization::StaticOptimization(const StaticOptimization &aStaticOptimiza
     _useMusclePhysiology(_useMusclePhysiologyProp.getValueBool()),
     _convergenceCriterion(_convergenceCriterionProp.getValueDbl()),
     _maximumIterations(_maximumIterationsProp.getValueInt()),
+    _useActiveSetSolver(_useActiveSetSolverProp.getValueBool()),
+    _activeSetMaximumIterations(_activeSetMaximumIterationsProp.getValueInt()),
     _modelWorkingCopy(NULL)
 {
     setNull();
@@ -108,12 +190,16 @@ operator=(const StaticOptimization &aStaticOptimization)
     // BASE CLASS
     Analysis::operator=(aStaticOptimization);
 
-    _modelWorkingCopy = aStaticOptimization._modelWorkingCopy;
+    // Each copy makes its own working copy of the model in begin().
+    delete _modelWorkingCopy;
+    _modelWorkingCopy = NULL;
     _numCoordinateActuators = aStaticOptimization._numCoordinateActuators;
     _useModelForceSet = aStaticOptimization._useModelForceSet;
     _activationExponent=aStaticOptimization._activationExponent;
     _convergenceCriterion=aStaticOptimization._convergenceCriterion;
     _maximumIterations=aStaticOptimization._maximumIterations;
+    _useActiveSetSolver=aStaticOptimization._useActiveSetSolver;
+    _activeSetMaximumIterations=aStaticOptimization._activeSetMaximumIterations;
     _forceReporter = nullptr;
     _useMusclePhysiology=aStaticOptimization._useMusclePhysiology;
     return(*this);
@@ -138,6 +224,10 @@ void StaticOptimization::setNull()
     _numCoordinateActuators = 0;
     _convergenceCriterion = 1e-4;
     _maximumIterations = 100;
+    _useActiveSetSolver = false;
+    _activeSetMaximumIterations = 100;
+    _numActiveSetSolverSolutions = 0;
+    _numActiveSetSolverFailures = 0;
     _forceReporter = nullptr;
     setName("StaticOptimization");
 }
@@ -173,6 +263,22 @@ setupProperties()
         "An integer for setting the maximum number of iterations the optimizer can use at each time.  ");
     _maximumIterationsProp.setName("optimizer_max_iterations");
     _propertySet.append(&_maximumIterationsProp);
+
+    _useActiveSetSolverProp.setComment(
+        "If true and activation_exponent is 2, solve each time as a quadratic "
+        "program with an active-set solver warm-started from the previous "
+        "time, rather than with the general-purpose optimizer (IPOPT), which "
+        "is only used if the active-set solver fails. This is much faster for "
+        "long trials.");
+    _useActiveSetSolverProp.setName("use_active_set_solver");
+    _propertySet.append(&_useActiveSetSolverProp);
+
+    _activeSetMaximumIterationsProp.setComment(
+        "The maximum number of changes to the active set that the active-set "
+        "solver can make at each time (see use_active_set_solver). "
+        "optimizer_max_iterations applies only to the optimizer.");
+    _activeSetMaximumIterationsProp.setName("active_set_max_iterations");
+    _propertySet.append(&_activeSetMaximumIterationsProp);
 }
 
 //=============================================================================
@@ -339,30 +445,6 @@ record(const SimTK::State& s)
     target.setActivationExponent(_activationExponent);
     target.setDX(_numericalDerivativeStepSize);
 
-    // Pick optimizer algorithm
-    SimTK::OptimizerAlgorithm algorithm = SimTK::InteriorPoint;
-    //SimTK::OptimizerAlgorithm algorithm = SimTK::CFSQP;
-
-    // Optimizer
-    SimTK::Optimizer *optimizer = new SimTK::Optimizer(target, algorithm);
-
-    // Optimizer options
-    //cout<<"\nSetting optimizer print level to "<<_printLevel<<".\n";
-    optimizer->setDiagnosticsLevel(_printLevel);
-    //cout<<"Setting optimizer convergence criterion to "<<_convergenceCriterion<<".\n";
-    optimizer->setConvergenceTolerance(_convergenceCriterion);
-    //cout<<"Setting optimizer maximum iterations to "<<_maximumIterations<<".\n";
-    optimizer->setMaxIterations(_maximumIterations);
-    optimizer->useNumericalGradient(false);
-    optimizer->useNumericalJacobian(false);
-    if(algorithm == SimTK::InteriorPoint) {
-        // Some IPOPT-specific settings
-        optimizer->setLimitedMemoryHistory(500); // works well for our small systems
-        optimizer->setAdvancedBoolOption("warm_start",true);
-        optimizer->setAdvancedRealOption("obj_scaling_factor",1);
-        optimizer->setAdvancedRealOption("nlp_scaling_max_gradient",1);
-    }
-
     // Parameter bounds
     SimTK::Vector lowerBounds(na), upperBounds(na);
     for(int i=0,j=0;i<fs.getSize();i++) {
@@ -379,9 +461,32 @@ record(const SimTK::State& s)
     _parameters = 0; // Set initial guess to zeros
 
     // Static optimization
+    // With an activation exponent of 2, the problem is a quadratic program
+    // with linear constraints, which the active-set solver handles directly.
+    bool useActiveSetSolver = _useActiveSetSolver && _activationExponent == 2;
+    target.setComputeConstraintMatrixFromForces(useActiveSetSolver);
     _modelWorkingCopy->getMultibodySystem().realize(sWorkingCopy,SimTK::Stage::Velocity);
     target.prepareToOptimize(sWorkingCopy, &_parameters[0]);
 
+    bool solved = false;
+    if(useActiveSetSolver) {
+        if((int)_activeSet.size() != na) _activeSet.assign(na, 0);
+        // The constraints are constraintMatrix * x + constraintVector = 0.
+        solved = solveQuadraticProgram(target.getConstraintMatrix(),
+                -target.getConstraintVector(), lowerBounds, upperBounds,
+                _activeSetMaximumIterations, _activeSet, _parameters);
+        if(solved) {
+            ++_numActiveSetSolverSolutions;
+        } else {
+            ++_numActiveSetSolverFailures;
+            log_debug("StaticOptimization.record: The active-set solver "
+                      "could not find a solution at time = {}. Using the "
+                      "optimizer instead.", s.getTime());
+            _parameters = 0;
+            _activeSet.assign(na, 0);
+        }
+    }
+
     //LARGE_INTEGER start;
     //LARGE_INTEGER stop;
     //LARGE_INTEGER frequency;
@@ -389,84 +494,110 @@ record(const SimTK::State& s)
     //QueryPerformanceFrequency(&frequency);
     //QueryPerformanceCounter(&start);
 
-    try {
-        target.setCurrentState( &sWorkingCopy );
-        optimizer->optimize(_parameters);
-    }
-    catch (const SimTK::Exception::Base& ex) {
-        log_warn(ex.getMessage());
-        log_warn("OPTIMIZATION FAILED...");
-        log_warn("StaticOptimization.record: The optimizer could not find a "
-                 "solution at time = {}.",
-                s.getTime());
-
-        double tolBounds = 1e-1;
-        bool weakModel = false;
-        string msgWeak = "The model appears too weak for static optimization.\nTry increasing the strength and/or range of the following force(s):\n";
-        for(int a=0;a<na;a++) {
-            Actuator* act = dynamic_cast<Actuator*>(&_forceSet->get(a));
-            if( act ) {
-                Muscle*  mus = dynamic_cast<Muscle*>(&_forceSet->get(a));
-                if(mus==NULL) {
-                    if(_parameters(a) < (lowerBounds(a)+tolBounds)) {
-                        msgWeak += "   ";
-                        msgWeak += act->getName();
-                        msgWeak += " approaching lower bound of ";
-                        ostringstream oLower;
-                        oLower << lowerBounds(a);
-                        msgWeak += oLower.str();
-                        msgWeak += "\n";
-                        weakModel = true;
-                    } else if(_parameters(a) > (upperBounds(a)-tolBounds)) {
-                        msgWeak += "   ";
-                        msgWeak += act->getName();
-                        msgWeak += " approaching upper bound of ";
-                        ostringstream oUpper;
-                        oUpper << upperBounds(a);
-                        msgWeak += oUpper.str();
-                        msgWeak += "\n";
-                        weakModel = true;
-                    } 
-                } else {
-                    if(_parameters(a) > (upperBounds(a)-tolBounds)) {
-                        msgWeak += "   ";
-                        msgWeak += mus->getName();
-                        msgWeak += " approaching upper bound of ";
-                        ostringstream o;
-                        o << upperBounds(a);
-                        msgWeak += o.str();
-                        msgWeak += "\n";
-                        weakModel = true;
+    if(!solved) {
+        // Pick optimizer algorithm
+        SimTK::OptimizerAlgorithm algorithm = SimTK::InteriorPoint;
+        //SimTK::OptimizerAlgorithm algorithm = SimTK::CFSQP;
+
+        // Optimizer
+        SimTK::Optimizer *optimizer = new SimTK::Optimizer(target, algorithm);
+
+        // Optimizer options
+        //cout<<"\nSetting optimizer print level to "<<_printLevel<<".\n";
+        optimizer->setDiagnosticsLevel(_printLevel);
+        //cout<<"Setting optimizer convergence criterion to "<<_convergenceCriterion<<".\n";
+        optimizer->setConvergenceTolerance(_convergenceCriterion);
+        //cout<<"Setting optimizer maximum iterations to "<<_maximumIterations<<".\n";
+        optimizer->setMaxIterations(_maximumIterations);
+        optimizer->useNumericalGradient(false);
+        optimizer->useNumericalJacobian(false);
+        if(algorithm == SimTK::InteriorPoint) {
+            // Some IPOPT-specific settings
+            optimizer->setLimitedMemoryHistory(500); // works well for our small systems
+            optimizer->setAdvancedBoolOption("warm_start",true);
+            optimizer->setAdvancedRealOption("obj_scaling_factor",1);
+            optimizer->setAdvancedRealOption("nlp_scaling_max_gradient",1);
+        }
+
+        try {
+            target.setCurrentState( &sWorkingCopy );
+            optimizer->optimize(_parameters);
+        }
+        catch (const SimTK::Exception::Base& ex) {
+            log_warn(ex.getMessage());
+            log_warn("OPTIMIZATION FAILED...");
+            log_warn("StaticOptimization.record: The optimizer could not find a "
+                     "solution at time = {}.",
+                    s.getTime());
+
+            double tolBounds = 1e-1;
+            bool weakModel = false;
+            string msgWeak = "The model appears too weak for static optimization.\nTry increasing the strength and/or range of the following force(s):\n";
+            for(int a=0;a<na;a++) {
+                Actuator* act = dynamic_cast<Actuator*>(&_forceSet->get(a));
+                if( act ) {
+                    Muscle*  mus = dynamic_cast<Muscle*>(&_forceSet->get(a));
+                    if(mus==NULL) {
+                        if(_parameters(a) < (lowerBounds(a)+tolBounds)) {
+                            msgWeak += "   ";
+                            msgWeak += act->getName();
+                            msgWeak += " approaching lower bound of ";
+                            ostringstream oLower;
+                            oLower << lowerBounds(a);
+                            msgWeak += oLower.str();
+                            msgWeak += "\n";
+                            weakModel = true;
+                        } else if(_parameters(a) > (upperBounds(a)-tolBounds)) {
+                            msgWeak += "   ";
+                            msgWeak += act->getName();
+                            msgWeak += " approaching upper bound of ";
+                            ostringstream oUpper;
+                            oUpper << upperBounds(a);
+                            msgWeak += oUpper.str();
+                            msgWeak += "\n";
+                            weakModel = true;
+                        } 
+                    } else {
+                        if(_parameters(a) > (upperBounds(a)-tolBounds)) {
+                            msgWeak += "   ";
+                            msgWeak += mus->getName();
+                            msgWeak += " approaching upper bound of ";
+                            ostringstream o;
+                            o << upperBounds(a);
+                            msgWeak += o.str();
+                            msgWeak += "\n";
+                            weakModel = true;
+                        }
                     }
                 }
             }
-        }
-        if(weakModel) log_warn(msgWeak);
-
-        if(!weakModel) {
-            double tolConstraints = 1e-6;
-            bool incompleteModel = false;
-            string msgIncomplete = "The model appears unsuitable for static optimization.\nTry appending the model with additional force(s) or locking joint(s) to reduce the following acceleration constraint violation(s):\n";
-            SimTK::Vector constraints;
-            target.constraintFunc(_parameters,true,constraints);
-
-            auto coordinates = _modelWorkingCopy->getCoordinatesInMultibodyTreeOrder();
-
-            for(int acc=0;acc<nacc;acc++) {
-                if(fabs(constraints(acc)) > tolConstraints) {
-                    const Coordinate& coord = *coordinates[_accelerationIndices[acc]];
-                    msgIncomplete += "   ";
-                    msgIncomplete += coord.getName();
-                    msgIncomplete += ": constraint violation = ";
-                    ostringstream o;
-                    o << constraints(acc);
-                    msgIncomplete += o.str();
-                    msgIncomplete += "\n";
-                    incompleteModel = true;
+            if(weakModel) log_warn(msgWeak);
+
+            if(!weakModel) {
+                double tolConstraints = 1e-6;
+                bool incompleteModel = false;
+                string msgIncomplete = "The model appears unsuitable for static optimization.\nTry appending the model with additional force(s) or locking joint(s) to reduce the following acceleration constraint violation(s):\n";
+                SimTK::Vector constraints;
+                target.constraintFunc(_parameters,true,constraints);
+
+                auto coordinates = _modelWorkingCopy->getCoordinatesInMultibodyTreeOrder();
+
+                for(int acc=0;acc<nacc;acc++) {
+                    if(fabs(constraints(acc)) > tolConstraints) {
+                        const Coordinate& coord = *coordinates[_accelerationIndices[acc]];
+                        msgIncomplete += "   ";
+                        msgIncomplete += coord.getName();
+                        msgIncomplete += ": constraint violation = ";
+                        ostringstream o;
+                        o << constraints(acc);
+                        msgIncomplete += o.str();
+                        msgIncomplete += "\n";
+                        incompleteModel = true;
+                    }
                 }
+                _forceReporter->step(sWorkingCopy, 1);
+                if(incompleteModel) log_warn(msgIncomplete);
             }
-            _forceReporter->step(sWorkingCopy, 1);
-            if(incompleteModel) log_warn(msgIncomplete);
         }
     }
 
@@ -592,6 +723,14 @@ int StaticOptimization::begin(const SimTK::State& s )
 
         _parameters.resize(_modelWorkingCopy->getNumControls());
         _parameters = 0;
+        _activeSet.clear();
+        _numActiveSetSolverSolutions = 0;
+        _numActiveSetSolverFailures = 0;
+        if(_useActiveSetSolver && _activationExponent != 2) {
+            log_warn("StaticOptimization: The active-set solver requires an "
+                     "activation exponent of 2, but it is {}. Using the "
+                     "optimizer instead.", _activationExponent);
+        }
     }
 
     _statesSplineSet=GCVSplineSet(5,_statesStore);
@@ -665,8 +804,28 @@ int StaticOptimization::end( const SimTK::State& s )
 
     record(s);
 
+    if(_numActiveSetSolverFailures > 0) {
+        log_info("StaticOptimization: The active-set solver failed at {} of "
+                 "{} times; the optimizer was used at those times.",
+                _numActiveSetSolverFailures,
+                _numActiveSetSolverSolutions + _numActiveSetSolverFailures);
+    }
+
     return(0);
 }
+//_____________________________________________________________________________
+/**
+ * Get the storages of the activations and forces.
+ */
+ArrayPtrs<Storage>& StaticOptimization::
+getStorageList()
+{
+    _storageList.setMemoryOwner(false);
+    _storageList.setSize(0);
+    if(_activationStorage) _storageList.append(_activationStorage);
+    if(_forceReporter) _storageList.append(getForceStorage());
+    return _storageList;
+}
 
 
 //=============================================================================
@@ -29,6 +29,7 @@
 //=============================================================================
 #include "osimAnalysesDLL.h"
 #include <memory>
+#include <vector>
 #include <OpenSim/Simulation/Model/Analysis.h>
 #include <OpenSim/Common/GCVSplineSet.h>
 #include "ForceReporter.h"
@@ -76,6 +77,12 @@ protected:
     PropertyInt _maximumIterationsProp;
     int &_maximumIterations;
 
+    PropertyBool _useActiveSetSolverProp;
+    bool &_useActiveSetSolver;
+
+    PropertyInt _activeSetMaximumIterationsProp;
+    int &_activeSetMaximumIterations;
+
     Storage *_activationStorage;
     Storage *_forceStorage;
     GCVSplineSet _statesSplineSet;
@@ -83,6 +90,14 @@ protected:
     Array<int> _accelerationIndices;
 
     SimTK::Vector _parameters;
+    /** For each parameter, -1 or 1 if it was at its lower or upper bound in
+    the solution of the active-set solver for the previous time, and 0
+    otherwise. */
+    std::vector<int> _activeSet;
+    /** Number of times solved by the active-set solver, and number of times
+    at which it failed and the optimizer was used instead, since begin(). */
+    int _numActiveSetSolverSolutions;
+    int _numActiveSetSolverFailures;
 
     bool _ownsForceSet;
     ForceSet* _forceSet;
@@ -135,6 +150,25 @@ public:
     double getConvergenceCriterion() { return _convergenceCriterion; }
     void setMaxIterations( const int maxIt) { _maximumIterations = maxIt; }
     int getMaxIterations() {return _maximumIterations; }
+    /** If true and the activation exponent is 2, each time is solved as a
+    quadratic program by an active-set solver that starts from the active set
+    of the previous time, instead of by the general-purpose optimizer (IPOPT).
+    The constraint matrix is assembled from the generalized forces of the
+    actuators. The optimizer is still used for a time at which the active-set
+    solver fails. */
+    void setUseActiveSetSolver(const bool useIt) { _useActiveSetSolver = useIt; }
+    bool getUseActiveSetSolver() const { return _useActiveSetSolver; }
+    /** Maximum number of changes to the active set at each time for the
+    active-set solver. This is separate from the maximum number of iterations
+    of the optimizer (setMaxIterations()). */
+    void setActiveSetMaxIterations(const int maxIt) { _activeSetMaximumIterations = maxIt; }
+    int getActiveSetMaxIterations() const { return _activeSetMaximumIterations; }
+    /** Number of times since begin() that were solved by the active-set
+    solver. */
+    int getNumActiveSetSolverSolutions() const { return _numActiveSetSolverSolutions; }
+    /** Number of times since begin() at which the active-set solver failed
+    and the optimizer was used instead. */
+    int getNumActiveSetSolverFailures() const { return _numActiveSetSolverFailures; }
     //--------------------------------------------------------------------------
     // ANALYSIS
     //--------------------------------------------------------------------------
@@ -144,6 +178,8 @@ public:
         step(const SimTK::State& s, int setNumber ) override;
     int
         end(const SimTK::State& s ) override;
+    bool isFrameIndependent() const override { return true; }
+    ArrayPtrs<Storage>& getStorageList() override;
 protected:
     virtual int
         record(const SimTK::State& s );
@@ -30,6 +30,7 @@
 // INCLUDES
 //=============================================================================
 #include <OpenSim/Simulation/Model/Model.h>
+#include <OpenSim/Actuators/CoordinateActuator.h>
 #include "StaticOptimizationTarget.h"
 
 using namespace OpenSim;
@@ -121,6 +122,11 @@ prepareToOptimize(SimTK::State& s, double *x)
     _constraintMatrix.resize(nc,np);
     _constraintVector.resize(nc);
 
+    if(_computeConstraintMatrixFromForces) {
+        assembleConstraintMatrixFromForces(s);
+        return false;
+    }
+
     Vector pVector(np), cVector(nc);
 
     // Build linear constraint matrix and constant constraint vector
@@ -138,6 +144,84 @@ prepareToOptimize(SimTK::State& s, double *x)
     // return false to indicate that we still need to proceed with optimization
     return false;
 }
+//______________________________________________________________________________
+/**
+ * Compute the linear constraint matrix and constant constraint vector without
+ * realizing the model once per parameter.
+ *
+ * The generalized accelerations are an affine function of the applied
+ * generalized forces, so the column of the constraint matrix for a parameter
+ * is the change in the constrained accelerations caused by the forces its
+ * actuator applies when the parameter is 1. For a muscle, these are the
+ * forces of its path at a tension equal to its optimal force (i.e., the
+ * moment arms times the optimal force); for a coordinate actuator, it is the
+ * optimal force applied to its coordinate. The accelerations are obtained
+ * from the matter subsystem directly, so no force element is evaluated again.
+ * The columns of other actuators are computed by perturbing the parameter, as
+ * in prepareToOptimize().
+ */
+void StaticOptimizationTarget::
+assembleConstraintMatrixFromForces(SimTK::State& s)
+{
+    const SimTK::SimbodyMatterSubsystem& matter = _model->getMatterSubsystem();
+    int np = getNumParameters();
+    int nc = getNumConstraints();
+
+    Vector pVector(np), cVector(nc);
+
+    // Constant constraint vector, with all actuators off. This realizes the
+    // state to Acceleration, which calcAcceleration() requires.
+    pVector = 0;
+    computeConstraintVector(s, pVector, _constraintVector);
+
+    const SimTK::Vector_<SimTK::SpatialVec> noBodyForces(
+            matter.getNumBodies(),
+            SimTK::SpatialVec(SimTK::Vec3(0), SimTK::Vec3(0)));
+    SimTK::Vector_<SimTK::SpatialVec> bodyForces, A_GB;
+    Vector mobilityForces, udot0, udot;
+    matter.calcAcceleration(s, Vector(s.getNU(), 0.0), noBodyForces,
+            udot0, A_GB);
+
+    const ForceSet& fSet = _model->getForceSet();
+    for(int i=0, p=0; i<fSet.getSize(); i++) {
+        const ScalarActuator* act =
+                dynamic_cast<const ScalarActuator*>(&fSet.get(i));
+        if(!act) continue;
+
+        const Muscle* mus = dynamic_cast<const Muscle*>(act);
+        const CoordinateActuator* coordAct =
+                dynamic_cast<const CoordinateActuator*>(act);
+        if(mus || (coordAct && coordAct->getCoordinate())) {
+            bodyForces = noBodyForces;
+            mobilityForces.resize(s.getNU());
+            mobilityForces = 0;
+            if(mus) {
+                mus->getGeometryPath().addInEquivalentForces(s,
+                        _optimalForce[p], bodyForces, mobilityForces);
+            } else {
+                const Coordinate& coord = *coordAct->getCoordinate();
+                matter.addInMobilityForce(s, coord.getBodyIndex(),
+                        SimTK::MobilizerUIndex(coord.getMobilizerQIndex()),
+                        _optimalForce[p], mobilityForces);
+            }
+            matter.calcAcceleration(s, mobilityForces, bodyForces, udot,
+                    A_GB);
+            // The constraints are the target minus the actual accelerations.
+            for(int c=0; c<nc; c++) {
+                const int u = _accelerationIndices[c];
+                _constraintMatrix(c,p) = udot0[u] - udot[u];
+            }
+        } else {
+            pVector[p] = 1;
+            computeConstraintVector(s, pVector, cVector);
+            for(int c=0; c<nc; c++)
+                _constraintMatrix(c,p) = (cVector[c] - _constraintVector[c]);
+            pVector[p] = 0;
+        }
+        p++;
+    }
+}
+
 //==============================================================================
 // SET AND GET
 //==============================================================================
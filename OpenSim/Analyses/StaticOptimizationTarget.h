@@ -64,6 +64,7 @@ private:
     
     SimTK::Matrix _constraintMatrix;
     SimTK::Vector _constraintVector;
+    bool _computeConstraintMatrixFromForces = false;
 
     const Storage *_statesStore;
     GCVSplineSet _statesSplineSet;
@@ -96,6 +97,19 @@ public:
     double getActivationExponent() const { return _activationExponent; }
     void setCurrentState( const SimTK::State* state) { _currentState = state; }
     const SimTK::State* getCurrentState() const { return _currentState; }
+    /** If true, prepareToOptimize() computes the columns of the linear
+    constraint matrix that belong to muscles and coordinate actuators from the
+    generalized forces each of them applies, rather than by realizing the
+    model to Acceleration once per parameter (default: false). Other
+    actuators are always perturbed. */
+    void setComputeConstraintMatrixFromForces(bool tf)
+    {   _computeConstraintMatrixFromForces = tf; }
+    /** The linear acceleration constraints computed by prepareToOptimize():
+    the constraints are getConstraintMatrix() * x + getConstraintVector(). */
+    const SimTK::Matrix& getConstraintMatrix() const
+    {   return _constraintMatrix; }
+    const SimTK::Vector& getConstraintVector() const
+    {   return _constraintVector; }
 
     // UTILITY
     void validatePerturbationSize(double &aSize);
@@ -123,6 +137,7 @@ public:
 
 private:
     void computeConstraintVector(SimTK::State& s, const SimTK::Vector &x, SimTK::Vector &c) const;
+    void assembleConstraintMatrixFromForces(SimTK::State& s);
     void computeAcceleration(SimTK::State& s, const SimTK::Vector &aF,SimTK::Vector &rAccel) const;
     void cumulativeTime(double &aTime, double aIncrement);
 };
@@ -26,6 +26,7 @@
 #include "DelimFileAdapter.h"
 #include "STOFileAdapter.h"
 #include "CSVFileAdapter.h"
+#include "BSTOFileAdapter.h"
 
 #if defined (WITH_EZC3D) || defined (WITH_BTK)
 
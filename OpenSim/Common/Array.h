@@ -32,6 +32,7 @@
 #include <iostream>
 #include "Logger.h"
 #include <sstream>
+#include <utility>
 
 static const int Array_CAPMIN = 1;
 
@@ -127,6 +128,20 @@ Array(const Array<T> &aArray)
     setNull();
     *this = aArray;
 }
+#ifndef SWIG
+//_____________________________________________________________________________
+/**
+ * Move constructor. The elements of aArray are taken over without copying
+ * them, and aArray is left empty.
+ *
+ * @param aArray Array to be moved.
+ */
+Array(Array<T> &&aArray)
+{
+    setNull();
+    swap(aArray);
+}
+#endif
 
 private:
 //_____________________________________________________________________________
@@ -140,6 +155,18 @@ void setNull()
     _capacity = 0;
     _array = NULL;
 }
+//_____________________________________________________________________________
+/**
+ * Exchange all member variables with those of another array.
+ */
+void swap(Array<T> &aArray)
+{
+    std::swap(_size, aArray._size);
+    std::swap(_capacity, aArray._capacity);
+    std::swap(_capacityIncrement, aArray._capacityIncrement);
+    std::swap(_defaultValue, aArray._defaultValue);
+    std::swap(_array, aArray._array);
+}
 
 
 //=============================================================================
@@ -207,6 +234,21 @@ Array<T>& operator=(const Array<T> &aArray)
 
     return(*this);
 }
+#ifndef SWIG
+//_____________________________________________________________________________
+/**
+ * Move assignment. The elements of aArray are taken over without copying
+ * them.
+ *
+ * @param aArray Array to be moved.
+ * @return Reference to this array.
+ */
+Array<T>& operator=(Array<T> &&aArray)
+{
+    if(this != &aArray) swap(aArray);
+    return(*this);
+}
+#endif
 
 //-----------------------------------------------------------------------------
 // EQUALITY (==)
@@ -347,9 +389,11 @@ bool ensureCapacity(int aCapacity)
         return(false);
     }
 
-    // COPY CURRENT ARRAY
+    // MOVE CURRENT ARRAY
+    // The elements are moved rather than copied, so that growing an array
+    // of arrays (e.g., the rows of a Storage) does not copy their contents.
     if(_array!=NULL) {
-        for(i=0;i<_size;i++) newArray[i] = _array[i];
+        for(i=0;i<_size;i++) newArray[i] = std::move(_array[i]);
         for(i=_size;i<aCapacity;i++) newArray[i] = _defaultValue;
         delete []_array;  _array=NULL;
     } else {
@@ -386,8 +430,8 @@ void trim()
         return;
     }
 
-    // COPY CURRENT ARRAY
-    for(i=0;i<_size;i++) array[i] = _array[i];
+    // MOVE CURRENT ARRAY
+    for(i=0;i<_size;i++) array[i] = std::move(_array[i]);
 
     // DELETE OLD ARRAY
     delete[] _array;
@@ -608,7 +652,7 @@ int insert(int aIndex,const T &aValue)
     // SHIFT ARRAY
     int i;
     for(i=_size;i>aIndex;i--) {
-        _array[i] = _array[i-1];
+        _array[i] = std::move(_array[i-1]);
     }
 
     // SET
@@ -650,7 +694,7 @@ int remove(int aIndex)
     int i;
     _size--;
     for(i=aIndex;i<_size;i++) {
-        _array[i] = _array[i+1];
+        _array[i] = std::move(_array[i+1]);
     }
     _array[_size] = _defaultValue;
 
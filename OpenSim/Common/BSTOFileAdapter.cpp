@@ -0,0 +1,512 @@
+/* -------------------------------------------------------------------------- *
+ *                         OpenSim:  BSTOFileAdapter.cpp                      *
+ * -------------------------------------------------------------------------- *
+ * The OpenSim API is a toolkit for musculoskeletal modeling and simulation.  *
+ * See http://opensim.stanford.edu and the NOTICE file for more information.  *
+ * OpenSim is developed at Stanford University and supported by the US        *
+ * National Institutes of Health (U54 GM072970, R24 HD065690) and by DARPA    *
+ * through the Warrior Web program.                                           *
+ *                                                                            *
+ * Copyright (c) 2005-2021 Stanford University and the Authors                *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+#include "BSTOFileAdapter.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+
+using namespace OpenSim;
+
+// Layout of a BSTO file (all numbers in the byte order of the writer):
+//
+//  - FileHeader (48 bytes).
+//  - uint64 number of metadata entries, then each key and value as a string
+//    (uint64 number of characters, then the characters).
+//  - The column labels (excluding "time"), as strings.
+//  - Padding to a multiple of 8 bytes.
+//  - The block index: for each chunk of rows, for each column (the time
+//    column first), the offset of the block from the start of the file and
+//    the number of bytes in the block (uint64 each).
+//  - The blocks, each padded to a multiple of 8 bytes. An uncompressed block
+//    contains the values of one column for the rows of one chunk.
+
+namespace {
+
+const char fileMagic[8] = {'O', 'S', 'I', 'M', 'B', 'S', 'T', 'O'};
+const uint32_t fileVersion = 1;
+const uint32_t byteOrderMark = 0x01020304;
+
+enum Compression : uint32_t {
+    NoCompression = 0,
+    XORShuffleRLE = 1
+};
+
+struct FileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t byteOrder;
+    uint64_t numRows;
+    uint64_t numColumns; // excluding the time column.
+    uint64_t numRowsPerChunk;
+    uint32_t compression;
+    uint32_t reserved;
+};
+static_assert(sizeof(FileHeader) == 48, "Unexpected padding in FileHeader.");
+
+struct BlockInfo {
+    uint64_t offset;
+    uint64_t size;
+};
+
+/// Everything in the file except the blocks.
+struct Layout {
+    FileHeader header;
+    std::vector<std::pair<std::string, std::string>> metadata;
+    std::vector<std::string> labels;
+    std::vector<BlockInfo> blocks;
+
+    uint64_t getNumChunks() const {
+        if (header.numRows == 0) return 0;
+        return (header.numRows - 1) / header.numRowsPerChunk + 1;
+    }
+    const BlockInfo& getBlock(uint64_t chunk, uint64_t column) const {
+        return blocks[chunk * (header.numColumns + 1) + column];
+    }
+    uint64_t getNumRowsInChunk(uint64_t chunk) const {
+        return std::min(header.numRowsPerChunk,
+                header.numRows - chunk * header.numRowsPerChunk);
+    }
+};
+
+template <typename T>
+void writeValue(std::ostream& stream, const T& value) {
+    stream.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+void writeString(std::ostream& stream, const std::string& str) {
+    writeValue(stream, static_cast<uint64_t>(str.size()));
+    stream.write(str.data(), str.size());
+}
+
+void writePadding(std::ostream& stream, uint64_t size) {
+    const char zeros[8] = {};
+    if (size % 8) stream.write(zeros, 8 - size % 8);
+}
+
+template <typename T>
+T readValue(std::istream& stream, const std::string& fileName) {
+    T value;
+    OPENSIM_THROW_IF(!stream.read(reinterpret_cast<char*>(&value), sizeof(T)),
+            InvalidBSTOFile, fileName, "Unexpected end of file.");
+    return value;
+}
+
+std::string readString(std::istream& stream, const std::string& fileName,
+        uint64_t fileSize) {
+    const auto size = readValue<uint64_t>(stream, fileName);
+    OPENSIM_THROW_IF(size > fileSize, InvalidBSTOFile, fileName,
+            "Unexpected end of file.");
+    std::string str(static_cast<size_t>(size), '\0');
+    OPENSIM_THROW_IF(!stream.read(&str[0], str.size()), InvalidBSTOFile,
+            fileName, "Unexpected end of file.");
+    return str;
+}
+
+Layout readLayout(std::istream& stream, const std::string& fileName) {
+    stream.seekg(0, std::ios::end);
+    const auto fileSize = static_cast<uint64_t>(stream.tellg());
+    stream.seekg(0);
+    OPENSIM_THROW_IF(fileSize == 0, FileIsEmpty, fileName);
+
+    Layout layout;
+    FileHeader& header = layout.header;
+    header = readValue<FileHeader>(stream, fileName);
+    OPENSIM_THROW_IF(std::memcmp(header.magic, fileMagic, 8) != 0,
+            InvalidBSTOFile, fileName, "The file does not start with "
+            "'OSIMBSTO'.");
+    OPENSIM_THROW_IF(header.version > fileVersion, InvalidBSTOFile, fileName,
+            "The file has version " + std::to_string(header.version) +
+            ", but this version of OpenSim can only read up to version " +
+            std::to_string(fileVersion) + ".");
+    OPENSIM_THROW_IF(header.byteOrder != byteOrderMark, InvalidBSTOFile,
+            fileName, "The file was written on a machine with a different "
+            "byte order.");
+    OPENSIM_THROW_IF(header.compression != NoCompression &&
+                     header.compression != XORShuffleRLE,
+            InvalidBSTOFile, fileName, "Unrecognized compression method.");
+    OPENSIM_THROW_IF(header.numRowsPerChunk == 0 ||
+                     header.numRows > fileSize ||
+                     header.numColumns > fileSize,
+            InvalidBSTOFile, fileName, "Invalid table dimensions.");
+
+    const auto numMetadata = readValue<uint64_t>(stream, fileName);
+    OPENSIM_THROW_IF(numMetadata > fileSize, InvalidBSTOFile, fileName,
+            "Unexpected end of file.");
+    for (uint64_t i = 0; i < numMetadata; ++i) {
+        auto key = readString(stream, fileName, fileSize);
+        auto value = readString(stream, fileName, fileSize);
+        layout.metadata.emplace_back(std::move(key), std::move(value));
+    }
+    for (uint64_t i = 0; i < header.numColumns; ++i) {
+        layout.labels.push_back(readString(stream, fileName, fileSize));
+    }
+    const auto position = static_cast<uint64_t>(stream.tellg());
+    if (position % 8) stream.seekg(8 - position % 8, std::ios::cur);
+
+    const uint64_t numBlocks =
+            layout.getNumChunks() * (header.numColumns + 1);
+    OPENSIM_THROW_IF(numBlocks * sizeof(BlockInfo) > fileSize,
+            InvalidBSTOFile, fileName, "Unexpected end of file.");
+    layout.blocks.resize(static_cast<size_t>(numBlocks));
+    OPENSIM_THROW_IF(numBlocks && !stream.read(
+                    reinterpret_cast<char*>(layout.blocks.data()),
+                    numBlocks * sizeof(BlockInfo)),
+            InvalidBSTOFile, fileName, "Unexpected end of file.");
+    for (const auto& block : layout.blocks) {
+        OPENSIM_THROW_IF(block.offset > fileSize ||
+                         block.size > fileSize - block.offset,
+                InvalidBSTOFile, fileName, "Unexpected end of file.");
+    }
+    return layout;
+}
+
+/// Encode the values: XOR each value with the previous one, group the bytes
+/// of the results by significance (most significant first), and run-length
+/// encode runs of zero bytes. Each run starts with a control byte c: if
+/// c < 128, c + 1 literal bytes follow; otherwise, the run is c - 126 zero
+/// bytes.
+void compress(const double* values, size_t numValues,
+        std::vector<unsigned char>& planes, std::vector<char>& encoded) {
+    planes.resize(8 * numValues);
+    uint64_t previous = 0;
+    for (size_t i = 0; i < numValues; ++i) {
+        uint64_t bits;
+        std::memcpy(&bits, &values[i], sizeof(bits));
+        const uint64_t x = bits ^ previous;
+        previous = bits;
+        for (size_t b = 0; b < 8; ++b) {
+            planes[b * numValues + i] =
+                    static_cast<unsigned char>(x >> (8 * (7 - b)));
+        }
+    }
+
+    encoded.clear();
+    const size_t size = planes.size();
+    size_t i = 0;
+    while (i < size) {
+        size_t run = 0;
+        while (i + run < size && run < 129 && planes[i + run] == 0) ++run;
+        if (run >= 2) {
+            encoded.push_back(static_cast<char>(126 + run));
+            i += run;
+            continue;
+        }
+        const size_t start = i;
+        while (i < size && i - start < 128 &&
+                !(planes[i] == 0 && i + 1 < size && planes[i + 1] == 0)) {
+            ++i;
+        }
+        encoded.push_back(static_cast<char>(i - start - 1));
+        encoded.insert(encoded.end(), planes.begin() + start,
+                planes.begin() + i);
+    }
+}
+
+/// Decode values encoded with compress().
+void decompress(const char* data, size_t size, size_t numValues,
+        std::vector<unsigned char>& planes, double* values,
+        const std::string& fileName) {
+    planes.resize(8 * numValues);
+    size_t out = 0;
+    size_t in = 0;
+    while (in < size) {
+        const auto control = static_cast<unsigned char>(data[in++]);
+        if (control < 128) {
+            const size_t length = size_t(control) + 1;
+            OPENSIM_THROW_IF(in + length > size || out + length > planes.size(),
+                    InvalidBSTOFile, fileName, "Corrupt compressed block.");
+            std::memcpy(&planes[out], data + in, length);
+            in += length;
+            out += length;
+        } else {
+            const size_t length = size_t(control) - 126;
+            OPENSIM_THROW_IF(out + length > planes.size(), InvalidBSTOFile,
+                    fileName, "Corrupt compressed block.");
+            std::memset(&planes[out], 0, length);
+            out += length;
+        }
+    }
+    OPENSIM_THROW_IF(out != planes.size(), InvalidBSTOFile, fileName,
+            "Corrupt compressed block.");
+
+    uint64_t previous = 0;
+    for (size_t i = 0; i < numValues; ++i) {
+        uint64_t x = 0;
+        for (size_t b = 0; b < 8; ++b) {
+            x = (x << 8) | planes[b * numValues + i];
+        }
+        const uint64_t bits = x ^ previous;
+        previous = bits;
+        std::memcpy(&values[i], &bits, sizeof(bits));
+    }
+}
+
+/// Read one block (the values of one column in one chunk) into `values`.
+void readBlock(std::istream& stream, const Layout& layout, uint64_t chunk,
+        uint64_t column, std::vector<char>& buffer,
+        std::vector<unsigned char>& planes, double* values,
+        const std::string& fileName) {
+    const BlockInfo& block = layout.getBlock(chunk, column);
+    const auto numValues =
+            static_cast<size_t>(layout.getNumRowsInChunk(chunk));
+    stream.seekg(static_cast<std::streamoff>(block.offset));
+    if (layout.header.compression == NoCompression) {
+        OPENSIM_THROW_IF(block.size != 8 * numValues, InvalidBSTOFile,
+                fileName, "Unexpected size of a block.");
+        OPENSIM_THROW_IF(numValues && !stream.read(
+                        reinterpret_cast<char*>(values), block.size),
+                InvalidBSTOFile, fileName, "Unexpected end of file.");
+    } else {
+        buffer.resize(static_cast<size_t>(block.size));
+        OPENSIM_THROW_IF(block.size && !stream.read(buffer.data(), block.size),
+                InvalidBSTOFile, fileName, "Unexpected end of file.");
+        decompress(buffer.data(), buffer.size(), numValues, planes, values,
+                fileName);
+    }
+}
+
+} // anonymous namespace
+
+BSTOFileAdapter*
+BSTOFileAdapter::clone() const {
+    return new BSTOFileAdapter{*this};
+}
+
+const std::string
+BSTOFileAdapter::tableString() {
+    return "table";
+}
+
+void
+BSTOFileAdapter::write(const TimeSeriesTable& table,
+                       const std::string& fileName) {
+    InputTables tables{};
+    tables.emplace(tableString(), &table);
+    BSTOFileAdapter{}.extendWrite(tables, fileName);
+}
+
+void
+BSTOFileAdapter::writeTable(const TimeSeriesTable& table,
+                            const std::string& fileName) const {
+    InputTables tables{};
+    tables.emplace(tableString(), &table);
+    extendWrite(tables, fileName);
+}
+
+void
+BSTOFileAdapter::setNumRowsPerChunk(int numRows) {
+    OPENSIM_THROW_IF(numRows < 1, InvalidArgument,
+            "Expected the number of rows per chunk to be positive, but got " +
+            std::to_string(numRows) + ".");
+    _numRowsPerChunk = numRows;
+}
+
+std::vector<double>
+BSTOFileAdapter::readColumn(const std::string& fileName,
+                            const std::string& columnLabel) {
+    OPENSIM_THROW_IF(fileName.empty(),
+                     EmptyFileName);
+    std::ifstream in_stream{fileName, std::ios::binary};
+    OPENSIM_THROW_IF(!in_stream.good(),
+                     FileDoesNotExist,
+                     fileName);
+
+    const Layout layout = readLayout(in_stream, fileName);
+    uint64_t column = 0;
+    if (columnLabel != "time") {
+        const auto it = std::find(layout.labels.begin(), layout.labels.end(),
+                columnLabel);
+        OPENSIM_THROW_IF(it == layout.labels.end(), KeyMissing, columnLabel);
+        column = static_cast<uint64_t>(it - layout.labels.begin()) + 1;
+    }
+
+    std::vector<double> values(static_cast<size_t>(layout.header.numRows));
+    std::vector<char> buffer;
+    std::vector<unsigned char> planes;
+    for (uint64_t chunk = 0; chunk < layout.getNumChunks(); ++chunk) {
+        readBlock(in_stream, layout, chunk, column, buffer, planes,
+                values.data() + chunk * layout.header.numRowsPerChunk,
+                fileName);
+    }
+    return values;
+}
+
+BSTOFileAdapter::OutputTables
+BSTOFileAdapter::extendRead(const std::string& fileName) const {
+    OPENSIM_THROW_IF(fileName.empty(),
+                     EmptyFileName);
+    std::ifstream in_stream{fileName, std::ios::binary};
+    OPENSIM_THROW_IF(!in_stream.good(),
+                     FileDoesNotExist,
+                     fileName);
+
+    const Layout layout = readLayout(in_stream, fileName);
+    const auto numRows = static_cast<size_t>(layout.header.numRows);
+    const auto numColumns = static_cast<int>(layout.header.numColumns);
+
+    std::vector<double> time(numRows);
+    SimTK::Matrix matrix(static_cast<int>(numRows), numColumns);
+    std::vector<double> values;
+    std::vector<char> buffer;
+    std::vector<unsigned char> planes;
+    for (uint64_t chunk = 0; chunk < layout.getNumChunks(); ++chunk) {
+        const auto firstRow = static_cast<size_t>(
+                chunk * layout.header.numRowsPerChunk);
+        const auto numRowsInChunk =
+                static_cast<size_t>(layout.getNumRowsInChunk(chunk));
+        readBlock(in_stream, layout, chunk, 0, buffer, planes,
+                time.data() + firstRow, fileName);
+        values.resize(numRowsInChunk);
+        for (int icol = 0; icol < numColumns; ++icol) {
+            readBlock(in_stream, layout, chunk, icol + 1, buffer, planes,
+                    values.data(), fileName);
+            for (size_t i = 0; i < numRowsInChunk; ++i) {
+                matrix(static_cast<int>(firstRow + i), icol) = values[i];
+            }
+        }
+    }
+
+    ValueArrayDictionary keyValuePairs;
+    for (const auto& keyValue : layout.metadata) {
+        keyValuePairs.setValueForKey(keyValue.first, keyValue.second);
+    }
+    auto table = std::make_shared<TimeSeriesTable>(time, matrix,
+            layout.labels);
+    table->updTableMetaData() = keyValuePairs;
+
+    OutputTables output_tables{};
+    output_tables.emplace(tableString(), table);
+    return output_tables;
+}
+
+void
+BSTOFileAdapter::extendWrite(const InputTables& absTables,
+                             const std::string& fileName) const {
+    OPENSIM_THROW_IF(absTables.empty(),
+                     NoTableFound);
+
+    const TimeSeriesTable* table{};
+    try {
+        auto abs_table = absTables.at(tableString());
+        table = dynamic_cast<const TimeSeriesTable*>(abs_table);
+    } catch(std::out_of_range&) {
+        OPENSIM_THROW(KeyMissing,
+                      tableString());
+    }
+    OPENSIM_THROW_IF(table == nullptr,
+                     IncorrectTableType,
+                     "Expected a TimeSeriesTable (of doubles).");
+
+    OPENSIM_THROW_IF(fileName.empty(),
+                     EmptyFileName);
+
+    std::ofstream out_stream{fileName, std::ios::binary};
+    OPENSIM_THROW_IF(!out_stream.good(), Exception,
+            "Could not open file '" + fileName + "' for writing.");
+
+    FileHeader header{};
+    std::memcpy(header.magic, fileMagic, 8);
+    header.version = fileVersion;
+    header.byteOrder = byteOrderMark;
+    header.numRows = table->getNumRows();
+    header.numColumns = table->getNumColumns();
+    header.numRowsPerChunk = static_cast<uint64_t>(_numRowsPerChunk);
+    header.compression = _compress ? XORShuffleRLE : NoCompression;
+    writeValue(out_stream, header);
+
+    // Only metadata with string values can be written (as for STO files).
+    std::vector<std::pair<std::string, std::string>> metadata;
+    for (const auto& key : table->getTableMetaDataKeys()) {
+        try {
+            metadata.emplace_back(key,
+                    table->getTableMetaData<std::string>(key));
+        } catch(const InvalidTemplateArgument&) {}
+    }
+    writeValue(out_stream, static_cast<uint64_t>(metadata.size()));
+    for (const auto& keyValue : metadata) {
+        writeString(out_stream, keyValue.first);
+        writeString(out_stream, keyValue.second);
+    }
+    if (header.numColumns) {
+        for (const auto& label : table->getColumnLabels()) {
+            writeString(out_stream, label);
+        }
+    }
+    writePadding(out_stream, static_cast<uint64_t>(out_stream.tellp()));
+
+    // Leave space for the block index, which we fill in after writing the
+    // blocks.
+    Layout layout;
+    layout.header = header;
+    layout.blocks.resize(static_cast<size_t>(
+            layout.getNumChunks() * (header.numColumns + 1)));
+    const auto indexPosition = out_stream.tellp();
+    if (!layout.blocks.empty()) {
+        out_stream.write(reinterpret_cast<const char*>(layout.blocks.data()),
+                layout.blocks.size() * sizeof(BlockInfo));
+    }
+
+    const auto& time = table->getIndependentColumn();
+    const auto& matrix = table->getMatrix();
+    std::vector<double> values;
+    std::vector<unsigned char> planes;
+    std::vector<char> encoded;
+    for (uint64_t chunk = 0; chunk < layout.getNumChunks(); ++chunk) {
+        const auto firstRow = static_cast<size_t>(
+                chunk * header.numRowsPerChunk);
+        const auto numRowsInChunk =
+                static_cast<size_t>(layout.getNumRowsInChunk(chunk));
+        values.resize(numRowsInChunk);
+        for (uint64_t column = 0; column <= header.numColumns; ++column) {
+            for (size_t i = 0; i < numRowsInChunk; ++i) {
+                values[i] = column == 0
+                        ? time[firstRow + i]
+                        : matrix(static_cast<int>(firstRow + i),
+                                 static_cast<int>(column - 1));
+            }
+            BlockInfo& block = layout.blocks[static_cast<size_t>(
+                    chunk * (header.numColumns + 1) + column)];
+            block.offset = static_cast<uint64_t>(out_stream.tellp());
+            if (_compress) {
+                compress(values.data(), values.size(), planes, encoded);
+                block.size = encoded.size();
+                out_stream.write(encoded.data(), encoded.size());
+            } else {
+                block.size = 8 * values.size();
+                out_stream.write(reinterpret_cast<const char*>(values.data()),
+                        block.size);
+            }
+            writePadding(out_stream, block.size);
+        }
+    }
+
+    if (!layout.blocks.empty()) {
+        out_stream.seekp(indexPosition);
+        out_stream.write(reinterpret_cast<const char*>(layout.blocks.data()),
+                layout.blocks.size() * sizeof(BlockInfo));
+    }
+    OPENSIM_THROW_IF(!out_stream.good(), Exception,
+            "Failed to write file '" + fileName + "'.");
+}
@@ -0,0 +1,128 @@
+/* -------------------------------------------------------------------------- *
+ *                          OpenSim:  BSTOFileAdapter.h                       *
+ * -------------------------------------------------------------------------- *
+ * The OpenSim API is a toolkit for musculoskeletal modeling and simulation.  *
+ * See http://opensim.stanford.edu and the NOTICE file for more information.  *
+ * OpenSim is developed at Stanford University and supported by the US        *
+ * National Institutes of Health (U54 GM072970, R24 HD065690) and by DARPA    *
+ * through the Warrior Web program.                                           *
+ *                                                                            *
+ * Copyright (c) 2005-2021 Stanford University and the Authors                *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+#ifndef OPENSIM_BSTO_FILE_ADAPTER_H_
+#define OPENSIM_BSTO_FILE_ADAPTER_H_
+
+#include "FileAdapter.h"
+#include "TimeSeriesTable.h"
+
+namespace OpenSim {
+
+class InvalidBSTOFile : public IOError {
+public:
+    InvalidBSTOFile(const std::string& file,
+                    size_t line,
+                    const std::string& func,
+                    const std::string& filename,
+                    const std::string& reason) :
+        IOError(file, line, func) {
+        std::string msg = "File '" + filename + "' is not a valid BSTO file. ";
+        msg += reason;
+
+        addMessage(msg);
+    }
+};
+
+/** BSTOFileAdapter is a FileAdapter that reads and writes TimeSeriesTable%s in
+a binary, column-major format (file extension .bsto). Compared to STO files,
+BSTO files are smaller, are faster to read and write, and store every number
+exactly (there is no loss of precision). Tables are read from and written to
+BSTO files wherever a file name with the .bsto extension is given to
+TimeSeriesTable, Storage, FileAdapter::writeFile(), or
+MocoTrajectory::write(), so tools can write their results in this format by
+using the .bsto extension for their output files.
+
+The file contains a header with the metadata of the table (only metadata
+whose values are strings, as for STO files) and the column labels, followed by
+the data in chunks of rows (see setNumRowsPerChunk()). Within each chunk, the
+values of each column (including the time column) are stored contiguously as
+float64 numbers. An index in the header gives the location of each column of
+each chunk, so readColumn() can read a single column without reading the rest
+of the file. Without compression, every column block starts at a multiple of 8
+bytes from the start of the file, so a memory-mapped file can be accessed
+directly as arrays of doubles.
+
+With compression (see setCompressionEnabled()), each column block is encoded
+losslessly: each value is XOR'ed with the previous value in the column, the
+bytes of the result are grouped by significance, and runs of zero bytes are
+run-length encoded. This works well for smooth trajectories, whose
+consecutive values share their sign, exponent, and leading mantissa bits.
+
+All numbers are stored in the byte order of the machine that wrote the file;
+reading a file written on a machine with a different byte order is not
+supported.                                                                    */
+class OSIMCOMMON_API BSTOFileAdapter : public FileAdapter {
+public:
+    BSTOFileAdapter()                                   = default;
+    BSTOFileAdapter(const BSTOFileAdapter&)             = default;
+    BSTOFileAdapter(BSTOFileAdapter&&)                  = default;
+    BSTOFileAdapter& operator=(const BSTOFileAdapter&)  = default;
+    BSTOFileAdapter& operator=(BSTOFileAdapter&&)       = default;
+    ~BSTOFileAdapter()                                  = default;
+
+    BSTOFileAdapter* clone() const override;
+
+    /** Key used for table associative array returned/accepted by write/read. */
+    static const std::string tableString();
+
+    /** Write a BSTO file (without compression).                              */
+    static
+    void write(const TimeSeriesTable& table, const std::string& fileName);
+
+    /** Write a BSTO file using the compression and chunk size settings of
+    this adapter.                                                             */
+    void writeTable(const TimeSeriesTable& table,
+                    const std::string& fileName) const;
+
+    /** Read the values of a single column from a BSTO file, without reading
+    the other columns. Use the label "time" to read the time column.         */
+    static
+    std::vector<double> readColumn(const std::string& fileName,
+                                   const std::string& columnLabel);
+
+    /** Compress the column blocks of files written with this adapter
+    (default: false). Compressed files cannot be memory-mapped.              */
+    void setCompressionEnabled(bool enabled) { _compress = enabled; }
+    bool getCompressionEnabled() const { return _compress; }
+
+    /** The number of rows in each chunk of files written with this adapter
+    (default: 4096).                                                          */
+    void setNumRowsPerChunk(int numRows);
+    int getNumRowsPerChunk() const { return _numRowsPerChunk; }
+
+protected:
+    /** Implementation of the read functionality.                             */
+    OutputTables extendRead(const std::string& fileName) const override;
+
+    /** Implementation of the write functionality.                            */
+    void extendWrite(const InputTables& tables,
+                     const std::string& fileName) const override;
+
+private:
+    bool _compress = false;
+    int _numRowsPerChunk = 4096;
+};
+
+} // namespace OpenSim
+
+#endif // OPENSIM_BSTO_FILE_ADAPTER_H_
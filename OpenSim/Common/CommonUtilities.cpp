@@ -26,11 +26,13 @@
 #include "PiecewiseLinearFunction.h"
 #include "STOFileAdapter.h"
 #include "TimeSeriesTable.h"
+#include <atomic>
 #include <chrono>
 #include <ctime>
 #include <iomanip>
 #include <memory>
 #include <sstream>
+#include <thread>
 
 #include <SimTKcommon/internal/Pathname.h>
 
@@ -183,3 +185,186 @@ SimTK::Real OpenSim::solveBisection(
     }
     return midpoint;
 }
+
+int OpenSim::findInterval(const double* knots, int n, double x, int hint) {
+    if (hint >= 0 && hint < n - 1) {
+        if (x >= knots[hint] && x <= knots[hint + 1]) return hint;
+        if (hint < n - 2 && x > knots[hint + 1] && x <= knots[hint + 2])
+            return hint + 1;
+    }
+    int k, i = 0;
+    int j = n;
+    while (true) {
+        k = (i + j) / 2;
+        if (x < knots[k])
+            j = k;
+        else if (x > knots[k + 1])
+            i = k;
+        else
+            break;
+    }
+    return k;
+}
+
+struct OpenSim::WorkStealingThreadPool::Impl {
+    // The iterations that a worker has yet to evaluate. The worker takes
+    // iterations from the front, and other workers steal from the back.
+    struct Range {
+        std::mutex mutex;
+        int begin = 0;
+        int end = 0;
+    };
+
+    explicit Impl(int numThreads) {
+        for (int i = 0; i < numThreads; ++i) {
+            ranges.push_back(OpenSim::make_unique<Range>());
+        }
+        for (int worker = 1; worker < numThreads; ++worker) {
+            threads.emplace_back(&Impl::runThread, this, worker);
+        }
+    }
+
+    ~Impl() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            shutdown = true;
+        }
+        startCondition.notify_all();
+        for (auto& thread : threads) thread.join();
+    }
+
+    // The main function of each thread other than the calling thread.
+    void runThread(int worker) {
+        int64_t lastJob = 0;
+        while (true) {
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                startCondition.wait(lock,
+                        [&] { return shutdown || job != lastJob; });
+                if (shutdown) return;
+                lastJob = job;
+            }
+            runWorker(worker);
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                --numActiveThreads;
+            }
+            doneCondition.notify_one();
+        }
+    }
+
+    void runWorker(int worker) {
+        int index;
+        while (!failed && (takeOwn(worker, index) || steal(worker, index))) {
+            try {
+                (*function)(worker, index);
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (!exception) exception = std::current_exception();
+                failed = true;
+            }
+        }
+    }
+
+    bool takeOwn(int worker, int& index) {
+        Range& own = *ranges[worker];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (own.begin >= own.end) return false;
+        index = own.begin++;
+        return true;
+    }
+
+    bool steal(int worker, int& index) {
+        const int numWorkers = (int)ranges.size();
+        for (int offset = 1; offset < numWorkers; ++offset) {
+            Range& victim = *ranges[(worker + offset) % numWorkers];
+            int begin;
+            int end;
+            {
+                std::lock_guard<std::mutex> lock(victim.mutex);
+                const int remaining = victim.end - victim.begin;
+                if (remaining <= 0) continue;
+                end = victim.end;
+                begin = end - (remaining + 1) / 2;
+                victim.end = begin;
+            }
+            // Our own range is empty, so no other worker can steal from it
+            // before we refill it.
+            Range& own = *ranges[worker];
+            std::lock_guard<std::mutex> lock(own.mutex);
+            index = begin;
+            own.begin = begin + 1;
+            own.end = end;
+            return true;
+        }
+        return false;
+    }
+
+    std::vector<std::unique_ptr<Range>> ranges;
+    std::vector<std::thread> threads;
+
+    // Serializes calls to parallelFor().
+    std::mutex parallelForMutex;
+
+    // The members below are guarded by `mutex`.
+    std::mutex mutex;
+    std::condition_variable startCondition;
+    std::condition_variable doneCondition;
+    int64_t job = 0;
+    bool shutdown = false;
+    int numActiveThreads = 0;
+    const std::function<void(int, int)>* function = nullptr;
+    std::exception_ptr exception;
+
+    std::atomic<bool> failed{false};
+};
+
+OpenSim::WorkStealingThreadPool::WorkStealingThreadPool(int numThreads) {
+    OPENSIM_THROW_IF(numThreads < 1, Exception,
+            "Expected numThreads >= 1, but got {}.", numThreads);
+    m_impl = OpenSim::make_unique<Impl>(numThreads);
+}
+
+OpenSim::WorkStealingThreadPool::~WorkStealingThreadPool() = default;
+
+int OpenSim::WorkStealingThreadPool::getNumThreads() const {
+    return (int)m_impl->ranges.size();
+}
+
+void OpenSim::WorkStealingThreadPool::parallelFor(int numIterations,
+        const std::function<void(int worker, int index)>& function) {
+    if (numIterations <= 0) return;
+    auto& impl = *m_impl;
+    std::lock_guard<std::mutex> parallelForLock(impl.parallelForMutex);
+
+    // Give each worker a contiguous range of the iterations.
+    const int numWorkers = getNumThreads();
+    for (int worker = 0; worker < numWorkers; ++worker) {
+        auto& range = *impl.ranges[worker];
+        std::lock_guard<std::mutex> lock(range.mutex);
+        range.begin = (int)((int64_t)numIterations * worker / numWorkers);
+        range.end = (int)((int64_t)numIterations * (worker + 1) / numWorkers);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(impl.mutex);
+        impl.function = &function;
+        impl.exception = nullptr;
+        impl.failed = false;
+        impl.numActiveThreads = (int)impl.threads.size();
+        ++impl.job;
+    }
+    impl.startCondition.notify_all();
+
+    impl.runWorker(0);
+
+    std::exception_ptr exception;
+    {
+        std::unique_lock<std::mutex> lock(impl.mutex);
+        impl.doneCondition.wait(
+                lock, [&] { return impl.numActiveThreads == 0; });
+        impl.function = nullptr;
+        exception = impl.exception;
+    }
+    if (exception) std::rethrow_exception(exception);
+}
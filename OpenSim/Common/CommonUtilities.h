@@ -124,6 +124,16 @@ SimTK::Real solveBisection(std::function<double(const double&)> calcResidual,
         double left, double right, const double& tolerance = 1e-6,
         int maxIterations = 1000);
 
+/// Find the index k of the interval such that
+/// knots[k] <= x <= knots[k+1], given n increasing knots and
+/// knots[0] <= x <= knots[n-1]. If the interval `hint` or the interval after
+/// it contains x, it is returned without a search; this is the case when
+/// sorted values are evaluated one after the other and the hint is the
+/// interval of the previous value. Otherwise, a binary search is used.
+/// @ingroup commonutil
+OSIMCOMMON_API
+int findInterval(const double* knots, int n, double x, int hint = -1);
+
 /// This class lets you store objects of a single type for reuse by multiple
 /// threads, ensuring threadsafe access to each of those objects.
 /// @ingroup commonutil
@@ -165,6 +175,44 @@ private:
     std::condition_variable m_inventoryMonitor;
 };
 
+/// This class evaluates the iterations of a loop in parallel on a fixed set of
+/// threads, balancing the load with work stealing: each thread starts with a
+/// contiguous range of the iterations, and a thread that runs out of work
+/// takes the second half of the remaining range of another thread. This keeps
+/// all threads busy when the cost of the iterations varies (e.g., grid points
+/// with and without foot contact). The threads are created in the constructor
+/// and are reused by every call to parallelFor().
+/// @ingroup commonutil
+class OSIMCOMMON_API WorkStealingThreadPool {
+public:
+    /// The thread that calls parallelFor() also evaluates iterations, so the
+    /// pool creates `numThreads - 1` threads.
+    explicit WorkStealingThreadPool(int numThreads);
+    ~WorkStealingThreadPool();
+    WorkStealingThreadPool(const WorkStealingThreadPool&) = delete;
+    WorkStealingThreadPool& operator=(const WorkStealingThreadPool&) = delete;
+
+    /// The number of threads that evaluate iterations, including the thread
+    /// that calls parallelFor().
+    int getNumThreads() const;
+
+    /// Invoke `function(worker, index)` for each index in [0, numIterations)
+    /// and wait until all iterations are done. The `worker` argument is in
+    /// [0, getNumThreads()) and identifies the thread evaluating the
+    /// iteration; no two threads have the same worker index during a call, so
+    /// you can use it to index per-thread resources (e.g., entries taken from
+    /// a ThreadsafeJar). If an iteration throws an exception, the remaining
+    /// iterations are skipped and the first exception is rethrown from
+    /// parallelFor(). Calls from multiple threads are serialized; do not call
+    /// parallelFor() from within `function`.
+    void parallelFor(int numIterations,
+            const std::function<void(int worker, int index)>& function);
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> m_impl;
+};
+
 } // namespace OpenSim
 
 #endif // OPENSIM_COMMONUTILITIES_H_
@@ -23,9 +23,16 @@
  * limitations under the License.                                             *
  * -------------------------------------------------------------------------- */
 #include <queue>
+#include <atomic>
+#include <chrono>
 #include <condition_variable>
+#include <memory>
+#include <thread>
+#include <vector>
 #include <SimTKcommon.h>
 #include <OpenSim/Common/osimCommonDLL.h>
+#include <OpenSim/Common/Exception.h>
+#include <OpenSim/Common/SPSCRingBuffer.h>
 
 namespace OpenSim {
 
@@ -47,7 +54,8 @@ template <class U>
 class DataQueueEntry_ {
 public:
     DataQueueEntry_(double timeStamp, const SimTK::RowVectorView_<U>& data)
-            : _timeStamp(timeStamp), _data(data){};
+            : _timeStamp(timeStamp), _data(data),
+              _pushTime(std::chrono::steady_clock::now()){};
     DataQueueEntry_(const DataQueueEntry_& other)       = default;
     DataQueueEntry_(DataQueueEntry_&&)                  = default;
     DataQueueEntry_& operator=(const DataQueueEntry_&)  = default;
@@ -55,10 +63,17 @@ public:
 
     double getTimeStamp() const { return _timeStamp; };
     SimTK::RowVectorView_<U> getData() const { return _data; };
+    /** The (steady clock) time at which the entry was created. */
+    std::chrono::steady_clock::time_point getPushTime() const {
+        return _pushTime;
+    }
 
 private:
     double _timeStamp;
-    SimTK::RowVectorView_<U> _data;
+    // The entry owns a copy of the data, so that the data outlives the
+    // caller's row.
+    SimTK::RowVector_<U> _data;
+    std::chrono::steady_clock::time_point _pushTime;
 };
 /**
  * DataQueue is a wrapper around the std::queue customized to handle data 
@@ -68,6 +83,30 @@ private:
  * making sure order is preserved.
  * timestamp is required to pass in data so that clients can enforce order,
  * however timestamp is not used/order-enforced internally.
+ *
+ * A default-constructed queue is unbounded: its memory grows with the number
+ * of entries, push_back() never waits or drops entries, and producers and
+ * consumers share one mutex.
+ *
+ * A queue constructed with a capacity is bounded, for high-rate streams
+ * (e.g., many sensors sampled at several hundred Hz). The entries are stored
+ * in the preallocated slots of an SPSCRingBuffer_, so once each slot has held
+ * a row of a given size no memory is allocated per entry, and producers never
+ * share a lock with consumers. Several producers (e.g., one per sensor) or
+ * several consumers are serialized among themselves. Entries pushed by one
+ * thread are popped in the order they were pushed. When the queue is full,
+ * push_back() follows the OverflowPolicy:
+ *  - Block: wait until a consumer makes room (no data is lost). Only use this
+ *    if another thread pops the entries: a thread that pushes more than
+ *    getCapacity() entries before popping any waits forever.
+ *  - Throw: throw an Exception (no data is lost, and a consumer that falls
+ *    behind, or a single thread that pushes too many entries, is reported
+ *    instead of waited for).
+ *  - DropOldest: discard the oldest entry to make room, so that the queue
+ *    always holds the newest data. Only in this case does a producer wait
+ *    for a consumer that is popping an entry.
+ *  - DropNewest: discard the entry being pushed.
+ * The number of discarded entries is available from getNumDropped().
  */
 // @TODO Test support of multiple consumers. 
 template<class T> class DataQueue_ {
@@ -75,59 +114,226 @@ template<class T> class DataQueue_ {
 // METHODS
 //=============================================================================
 public:
+    enum class OverflowPolicy { Block, Throw, DropOldest, DropNewest };
+
     //--------------------------------------------------------------------------
     // CONSTRUCTION
     //--------------------------------------------------------------------------
     virtual ~DataQueue_() {}
     
     DataQueue_()                                = default;
+    /** Create a bounded queue that holds up to `capacity` entries. The slots
+    are preallocated for rows of `numColumns` elements. */
+    explicit DataQueue_(std::size_t capacity,
+            OverflowPolicy policy = OverflowPolicy::Block,
+            int numColumns = 0)
+            : m_capacity(capacity), m_policy(policy),
+              m_numColumns(numColumns) {
+        OPENSIM_THROW_IF(capacity < 1, Exception,
+                "Expected capacity to be at least 1, but got {}.", capacity);
+        createRing();
+    }
     // using compiler generated methods here is problematic due to mutex 
+    // A copy of a bounded queue has the same capacity and policy, but is
+    // empty. Copying must not happen while entries are being pushed or
+    // popped.
     DataQueue_(const DataQueue_& other){ 
-        m_data_queue = other.m_data_queue;
+        *this = other;
     };
     DataQueue_(DataQueue_&& other){ 
-        m_data_queue = other.m_data_queue;
+        *this = other;
     };
     DataQueue_& operator=(const DataQueue_& other) { 
+        if (this == &other) return (*this);
         m_data_queue = other.m_data_queue;
+        m_capacity = other.m_capacity;
+        m_policy = other.m_policy;
+        m_numColumns = other.m_numColumns;
+        m_numDropped = 0;
+        createRing();
         return (*this);
     };
 
+    /** The maximum number of entries, or 0 if the queue is unbounded. */
+    std::size_t getCapacity() const { return m_capacity; }
+    OverflowPolicy getOverflowPolicy() const { return m_policy; }
+
     //--------------------------------------------------------------------------
     // DataQueue Interface
     //--------------------------------------------------------------------------
-    // push data and associated timestamp to the end of the queue
-    void push_back(const double time, const SimTK::RowVectorView_<T>& data) { 
-        SimTK::RowVector_<T>* deepCopy = new SimTK::RowVector_<T>(data);
-        std::unique_lock<std::mutex> mlock(m_mutex);
-        m_data_queue.push(DataQueueEntry_<T>(time, *deepCopy));
-        mlock.unlock();     // unlock before notificiation to minimize mutex con
-        m_cond.notify_one(); 
+    /** Push data and associated timestamp to the end of the queue, following
+    the OverflowPolicy if a bounded queue is full.
+    @returns false if the data was dropped (DropNewest only).
+    @throws Exception if the queue is full and the policy is Throw. */
+    bool push_back(const double time, const SimTK::RowVectorView_<T>& data) { 
+        if (!m_ring) {
+            DataQueueEntry_<T> entry(time, data);
+            std::unique_lock<std::mutex> mlock(m_mutex);
+            m_data_queue.push(std::move(entry));
+            mlock.unlock(); // unlock before notificiation to minimize mutex con
+            m_cond.notify_one(); 
+            return true;
+        }
+        std::lock_guard<std::mutex> pushLock(m_pushMutex);
+        const auto write = [&](Slot& slot) {
+            slot.time = time;
+            slot.data = data;
+            slot.pushTime = std::chrono::steady_clock::now();
+        };
+        int numAttempts = 0;
+        while (!m_ring->tryPushWith(write)) {
+            switch (m_policy) {
+            case OverflowPolicy::DropNewest:
+                ++m_numDropped;
+                return false;
+            case OverflowPolicy::DropOldest: {
+                // Act as a consumer to discard the oldest entry. A consumer
+                // may have popped it first, in which case there is room now.
+                std::lock_guard<std::mutex> popLock(m_popMutex);
+                if (m_ring->tryPopWith([](const Slot&) {})) ++m_numDropped;
+                break;
+            }
+            case OverflowPolicy::Block:
+                backOff(numAttempts++);
+                break;
+            case OverflowPolicy::Throw:
+                OPENSIM_THROW(Exception,
+                        "Cannot push an entry for time {}: the queue is full "
+                        "(capacity {}).", time, m_capacity);
+            }
+        }
+        return true;
     }
-    // pop the front of the queue and return data and associated timestamp
+    // pop the front of the queue and return data and associated timestamp,
+    // waiting for an entry if the queue is empty
     void pop_front(double& time, SimTK::RowVector_<T>& data) { 
+        if (m_ring) {
+            int numAttempts = 0;
+            while (!try_pop_front(time, data)) { backOff(numAttempts++); }
+            return;
+        }
         std::unique_lock<std::mutex> mlock(m_mutex);
         while (m_data_queue.empty()) { m_cond.wait(mlock); }
-        DataQueueEntry_<SimTK::Rotation> frontEntry = m_data_queue.front();
+        DataQueueEntry_<T> frontEntry = std::move(m_data_queue.front());
         m_data_queue.pop();
         mlock.unlock(); 
         time = frontEntry.getTimeStamp();
         data = frontEntry.getData();
     }
-    // check if the queue is empty
-    bool isEmpty() { 
-        bool status = false;
-        std::unique_lock<std::mutex> mlock(m_mutex);
-        status = m_data_queue.empty();
-        mlock.unlock(); 
-        return status;
+    /** Pop the front of the queue if the queue is not empty. If `pushTime`
+    is given, it is set to the (steady clock) time at which the entry was
+    pushed.
+    @returns false if the queue is empty (time and data are unchanged). */
+    bool try_pop_front(double& time, SimTK::RowVector_<T>& data,
+            std::chrono::steady_clock::time_point* pushTime = nullptr) {
+        if (m_ring) {
+            std::lock_guard<std::mutex> popLock(m_popMutex);
+            return m_ring->tryPopWith([&](const Slot& slot) {
+                time = slot.time;
+                data = slot.data;
+                if (pushTime) *pushTime = slot.pushTime;
+            });
+        }
+        std::lock_guard<std::mutex> mlock(m_mutex);
+        if (m_data_queue.empty()) return false;
+        const DataQueueEntry_<T>& frontEntry = m_data_queue.front();
+        time = frontEntry.getTimeStamp();
+        data = frontEntry.getData();
+        if (pushTime) *pushTime = frontEntry.getPushTime();
+        m_data_queue.pop();
+        return true;
     }
+    /** Pop up to maxEntries entries from the front of the queue, without
+    waiting, into the first elements of `times` and `data`. The vectors are
+    grown to at least maxEntries elements but never shrunk, so a consumer
+    that keeps the vectors between calls reuses their rows instead of
+    allocating memory.
+    @returns the number of entries popped. */
+    std::size_t pop_front_batch(std::size_t maxEntries,
+            std::vector<double>& times,
+            std::vector<SimTK::RowVector_<T>>& data) {
+        if (times.size() < maxEntries) times.resize(maxEntries);
+        if (data.size() < maxEntries) data.resize(maxEntries);
+        std::size_t numPopped = 0;
+        while (numPopped < maxEntries &&
+                try_pop_front(times[numPopped], data[numPopped])) {
+            ++numPopped;
+        }
+        return numPopped;
+    }
+    /** Discard all entries but the newest one, so that the next entry popped
+    is the newest data.
+    @returns the number of entries discarded. */
+    std::size_t discard_all_but_latest() {
+        if (m_ring) {
+            std::lock_guard<std::mutex> popLock(m_popMutex);
+            return m_ring->discardAllButLatest();
+        }
+        std::lock_guard<std::mutex> mlock(m_mutex);
+        std::size_t numDiscarded = 0;
+        while (m_data_queue.size() > 1) {
+            m_data_queue.pop();
+            ++numDiscarded;
+        }
+        return numDiscarded;
+    }
+
+    /** The number of entries in the queue. With concurrent producers or
+    consumers, the result may be outdated by the time it is used. */
+    std::size_t size() const {
+        if (m_ring) return m_ring->size();
+        std::lock_guard<std::mutex> mlock(m_mutex);
+        return m_data_queue.size();
+    }
+    // check if the queue is empty
+    bool isEmpty() const { return size() == 0; }
+
+    /** The number of entries discarded because a bounded queue was full. */
+    std::size_t getNumDropped() const { return m_numDropped; }
+
 private:
+    struct Slot {
+        double time = SimTK::NaN;
+        SimTK::RowVector_<T> data;
+        std::chrono::steady_clock::time_point pushTime;
+    };
+
+    // Create the slots of a bounded queue; an unbounded queue has none.
+    void createRing() {
+        if (m_capacity == 0) {
+            m_ring.reset();
+            return;
+        }
+        Slot prototype;
+        prototype.data.resize(m_numColumns);
+        m_ring.reset(new SPSCRingBuffer_<Slot>(m_capacity, prototype));
+    }
+
+    // Spin briefly, then sleep, so that waiting for a slow thread does not
+    // occupy a core.
+    static void backOff(int numAttempts) {
+        if (numAttempts < 100) {
+            std::this_thread::yield();
+        } else {
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+        }
+    }
+
     // As of now we use std::queue but other data structures could be used as well
     std::queue<DataQueueEntry_<T>> m_data_queue;
-    std::mutex m_mutex;
+    mutable std::mutex m_mutex;
     std::condition_variable m_cond;
 
+    // Bounded mode, if m_capacity is at least 1.
+    std::size_t m_capacity = 0;
+    OverflowPolicy m_policy = OverflowPolicy::Block;
+    int m_numColumns = 0;
+    std::unique_ptr<SPSCRingBuffer_<Slot>> m_ring;
+    // The ring buffer has one producer and one consumer at a time.
+    std::mutex m_pushMutex;
+    std::mutex m_popMutex;
+    std::atomic<std::size_t> m_numDropped{0};
+
     //=============================================================================
 };  // END of class templatized DataQueue_<T>
 //=============================================================================
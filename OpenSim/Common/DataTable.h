@@ -34,8 +34,11 @@ in-memory container for data access and manipulation.                         */
 #include "SimTKcommon/internal/Quaternion.h"
 #include <OpenSim/Common/IO.h>
 
+#include <atomic>
 #include <iomanip>
+#include <mutex>
 #include <numeric>
+#include <vector>
 
 namespace OpenSim {
 
@@ -47,6 +50,17 @@ columns, which together form a matrix, can be configured using ETY (template
 param). Independent and dependent columns can contain metadata. DataTable_ as a 
 whole can contain metadata.
 
+The dependent data is stored column-major, so each dependent column (see
+getDependentColumnAtIndex()) is contiguous in memory: its elements can be
+passed to filters and splines without copying (e.g., with
+`getDependentColumnAtIndex(i).getContiguousScalarData()`). Rows added with
+appendRow() are collected in a growing buffer and moved into the matrix in
+one step the next time the dependent data is accessed, so building a table
+row by row takes time proportional to its size. This step is guarded by a
+lock, so a table can be read from multiple threads at the same time (as long
+as no thread modifies it). Views of rows, columns, or the matrix remain valid
+until the table is next modified.
+
 \tparam ETX Type of each element of the column holding independent data.
 \tparam ETY Type of each element of the underlying matrix holding dependent 
             data.                                                             */
@@ -74,10 +88,38 @@ public:
     typedef SimTK::MatrixView_<ETY>    MatrixView;
 
     DataTable_()                             = default;
-    DataTable_(const DataTable_&)            = default;
-    DataTable_(DataTable_&&)                 = default;
-    DataTable_& operator=(const DataTable_&) = default;
-    DataTable_& operator=(DataTable_&&)      = default;
+    // Copying or moving a table first moves the rows that were appended to
+    // the source into its matrix, so only the matrices are copied.
+    DataTable_(const DataTable_& that) : AbstractDataTable(that) {
+        that.flushAppendedRows();
+        _indData = that._indData;
+        _depData = that._depData;
+    }
+    DataTable_(DataTable_&& that) : AbstractDataTable(std::move(that)) {
+        that.flushAppendedRows();
+        _indData = std::move(that._indData);
+        _depData = std::move(that._depData);
+    }
+    DataTable_& operator=(const DataTable_& that) {
+        if(this != &that) {
+            that.flushAppendedRows();
+            AbstractDataTable::operator=(that);
+            _indData = that._indData;
+            _depData = that._depData;
+            clearAppendedRows();
+        }
+        return *this;
+    }
+    DataTable_& operator=(DataTable_&& that) {
+        if(this != &that) {
+            that.flushAppendedRows();
+            AbstractDataTable::operator=(std::move(that));
+            _indData = std::move(that._indData);
+            _depData = std::move(that._depData);
+            clearAppendedRows();
+        }
+        return *this;
+    }
     ~DataTable_()                            = default;
 
     std::shared_ptr<AbstractDataTable> clone() const override {
@@ -662,21 +704,34 @@ public:
                              static_cast<size_t>(depRow.ncol()));
         }
 
-        _indData.push_back(indRow);
-
-        if(_depData.nrow() == 0) {
+        if(_depData.nrow() == 0 && _appendedRows.empty()) {
             _depData.resize(1, depRow.size());
+            _depData.updRow(0) = depRow;
+        } else {
+            OPENSIM_THROW_IF(depRow.ncol() != _depData.ncol(),
+                             IncorrectNumColumns,
+                             static_cast<size_t>(_depData.ncol()),
+                             static_cast<size_t>(depRow.ncol()));
+            if(_depData.ncol() == 0) {
+                _depData.resizeKeep(_depData.nrow() + 1, 0);
+            } else {
+                // Resizing _depData copies all of its rows, so collect the
+                // appended rows and move them into _depData all at once when
+                // the dependent data is next accessed.
+                for(int c = 0; c < depRow.ncol(); ++c)
+                    _appendedRows.push_back(depRow[c]);
+                _hasAppendedRows.store(true, std::memory_order_release);
+            }
         }
-        else 
-            _depData.resizeKeep(_depData.nrow() + 1, _depData.ncol());
-            
-        _depData.updRow(_depData.nrow() - 1) = depRow;
+
+        _indData.push_back(indRow);
     }
 
     /** Get row at index.                                                     
 
     \throws RowIndexOutOfRange If index is out of range.                      */
     const RowVectorView getRowAtIndex(size_t index) const {
+        flushAppendedRows();
         OPENSIM_THROW_IF(isRowIndexOutOfRange(index),
                          RowIndexOutOfRange, 
                          index, 0, static_cast<unsigned>(_indData.size() - 1));
@@ -692,6 +747,7 @@ public:
     \throws KeyNotFound If the independent column has no entry with given
                         value.                                                */
     const RowVectorView getRow(const ETX& ind) const {
+        flushAppendedRows();
         auto iter = std::find(_indData.cbegin(), _indData.cend(), ind);
 
         OPENSIM_THROW_IF(iter == _indData.cend(),
@@ -704,6 +760,7 @@ public:
 
     \throws RowIndexOutOfRange If the index is out of range.                  */
     RowVectorView updRowAtIndex(size_t index) {
+        flushAppendedRows();
         OPENSIM_THROW_IF(isRowIndexOutOfRange(index),
                          RowIndexOutOfRange, 
                          index, 0, static_cast<unsigned>(_indData.size() - 1));
@@ -719,6 +776,7 @@ public:
     \throws KeyNotFound If the independent column has no entry with given
                         value.                                                */
     RowVectorView updRow(const ETX& ind) {
+        flushAppendedRows();
         auto iter = std::find(_indData.cbegin(), _indData.cend(), ind);
 
         OPENSIM_THROW_IF(iter == _indData.cend(),
@@ -781,6 +839,7 @@ public:
 
     \throws RowIndexOutOfRange If the index is out of range.                  */
     void removeRowAtIndex(size_t index) {
+        flushAppendedRows();
         OPENSIM_THROW_IF(isRowIndexOutOfRange(index),
                          RowIndexOutOfRange, 
                          index, 0, static_cast<unsigned>(_indData.size() - 1));
@@ -930,6 +989,7 @@ public:
                           rows.                                               */
     void appendColumn(const std::string& columnLabel,
                       const VectorView& depCol) {
+        flushAppendedRows();
         OPENSIM_THROW_IF(getNumRows() == 0,
                          InvalidCall,
                          "DataTable must have one or more rows before we can "
@@ -952,6 +1012,7 @@ public:
 
     \throws ColumnIndexOutOfRange If the index is out of range.                  */
         void removeColumnAtIndex(size_t index) {
+        flushAppendedRows();
         OPENSIM_THROW_IF(isColumnIndexOutOfRange(index),
             ColumnIndexOutOfRange,
             index, 0, static_cast<unsigned>(_depData.ncol() - 1));
@@ -993,6 +1054,7 @@ public:
     \throws ColumnIndexOutOfRange If index is out of range for number of columns
                                   in the table.                               */
     VectorView getDependentColumnAtIndex(size_t index) const {
+        flushAppendedRows();
         OPENSIM_THROW_IF(isEmpty(), EmptyTable);
         OPENSIM_THROW_IF(isColumnIndexOutOfRange(index),
                          ColumnIndexOutOfRange, index, 0,
@@ -1006,6 +1068,7 @@ public:
     \throws KeyNotFound If columnLabel is not found to be label of any existing
                         column.                                               */
     VectorView getDependentColumn(const std::string& columnLabel) const {
+        flushAppendedRows();
         return _depData.col(static_cast<int>(getColumnIndex(columnLabel)));
     }
 
@@ -1015,6 +1078,7 @@ public:
     \throws ColumnIndexOutOfRange If index is out of range for number of columns
                                   in the table.                               */
     VectorView updDependentColumnAtIndex(size_t index) {
+        flushAppendedRows();
         OPENSIM_THROW_IF(isEmpty(), EmptyTable);
         OPENSIM_THROW_IF(isColumnIndexOutOfRange(index),
                          ColumnIndexOutOfRange, index, 0,
@@ -1028,6 +1092,7 @@ public:
     \throws KeyNotFound If columnLabel is not found to be label of any existing
                         column.                                               */
     VectorView updDependentColumn(const std::string& columnLabel) {
+        flushAppendedRows();
         return _depData.updCol(static_cast<int>(getColumnIndex(columnLabel)));
     }
 
@@ -1038,6 +1103,7 @@ public:
     \throws InvalidRow If this operation invalidates the row. Validation is
                        performed by derived classes.                          */
     void setIndependentValueAtIndex(size_t rowIndex, const ETX& value) {
+        flushAppendedRows();
         OPENSIM_THROW_IF(isEmpty(), EmptyTable);
         OPENSIM_THROW_IF(isRowIndexOutOfRange(rowIndex),
                          RowIndexOutOfRange, 
@@ -1057,6 +1123,7 @@ public:
 
     /** Get a read-only view to the underlying matrix.                        */
     const MatrixView& getMatrix() const {
+        flushAppendedRows();
         return _depData.getAsMatrixView();
     }
 
@@ -1072,6 +1139,7 @@ public:
                               size_t columnStart,
                               size_t numRows,
                               size_t numColumns) const {
+        flushAppendedRows();
         OPENSIM_THROW_IF(numRows == 0 || numColumns == 0,
                          InvalidArgument,
                          "Either numRows or numColumns is zero.");
@@ -1101,6 +1169,7 @@ public:
 
     /** Get a writable view to the underlying matrix.                         */
     MatrixView& updMatrix() {
+        flushAppendedRows();
         return _depData.updAsMatrixView();
     }
 
@@ -1116,6 +1185,7 @@ public:
                               size_t columnStart,
                               size_t numRows,
                               size_t numColumns) {
+        flushAppendedRows();
         OPENSIM_THROW_IF(numRows == 0 || numColumns == 0,
                          InvalidArgument,
                          "Either numRows or numColumns is zero.");
@@ -1552,16 +1622,18 @@ protected:
 
     /** Check if column index is out of range.                                */
     bool isColumnIndexOutOfRange(size_t index) const {
+        flushAppendedRows();
         return index >= static_cast<size_t>(_depData.ncol());
     }
 
     /** Get number of rows.                                                   */
     size_t implementGetNumRows() const override {
-        return _depData.nrow();
+        return _indData.size();
     }
 
     /** Get number of columns.                                                */
     size_t implementGetNumColumns() const override {
+        flushAppendedRows();
         return _depData.ncol();
     }
 
@@ -1617,6 +1689,7 @@ protected:
                 "Leading/trailing spaces are not permitted in column labels.");
         }
 
+        flushAppendedRows();
         OPENSIM_THROW_IF(_depData.ncol() != 0 && 
                          numCols != static_cast<unsigned>(_depData.ncol()),
                          IncorrectMetaDataLength, "labels", 
@@ -1661,8 +1734,45 @@ protected:
         return M * N;
     }
 
+    /** Move the rows collected by appendRow() into _depData. This is
+    called by all functions that access _depData, except appendRow(). The
+    const functions of a table may be called from multiple threads, so the
+    rows are moved while holding a lock, and _hasAppendedRows lets the calls
+    that find nothing to move skip the lock.                                 */
+    void flushAppendedRows() const {
+        if(!_hasAppendedRows.load(std::memory_order_acquire)) return;
+        std::lock_guard<std::mutex> lock(_appendedRowsMutex);
+        if(!_hasAppendedRows.load(std::memory_order_relaxed)) return;
+        const int numColumns = _depData.ncol();
+        const int numRows = _depData.nrow();
+        const int numAppended = (int)_appendedRows.size() / numColumns;
+        _depData.resizeKeep(numRows + numAppended, numColumns);
+        // Fill one (contiguous) column at a time.
+        for(int c = 0; c < numColumns; ++c) {
+            auto column = _depData.updCol(c);
+            for(int r = 0; r < numAppended; ++r)
+                column[numRows + r] = _appendedRows[r * numColumns + c];
+        }
+        // Release the memory, since the table may not grow further.
+        std::vector<ETY>().swap(_appendedRows);
+        _hasAppendedRows.store(false, std::memory_order_release);
+    }
+
+    /** Discard the rows collected by appendRow().                           */
+    void clearAppendedRows() {
+        std::vector<ETY>().swap(_appendedRows);
+        _hasAppendedRows.store(false, std::memory_order_release);
+    }
+
     std::vector<ETX>    _indData;
-    SimTK::Matrix_<ETY> _depData;
+    // Mutable so that const accessors can move appended rows into it.
+    mutable SimTK::Matrix_<ETY> _depData;
+    // Rows appended since _depData was last accessed, one after the other.
+    mutable std::vector<ETY> _appendedRows;
+    // Whether _appendedRows is not empty, and the lock held while the rows
+    // are moved into _depData.
+    mutable std::atomic<bool> _hasAppendedRows{false};
+    mutable std::mutex _appendedRowsMutex;
 };  // DataTable_
 
 
@@ -29,8 +29,13 @@
 #include "TimeSeriesTable.h"
 #include "OpenSim/Common/IO.h"
 
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
 #include <string>
 #include <fstream>
+#include <iterator>
 #include <regex>
 
 namespace OpenSim {
@@ -78,7 +83,12 @@ set the delimiters appropriately for the files they parse. The read/write
 functions return/accept a specific type of DataTable referred to as Table in 
 this class.                                                                   
 Header in the file is assumed to end with string "endheader" occupying a full
-line.                                                                         */
+line.                                                                         
+When T is double, the data rows (which can make up a file of several
+gigabytes, e.g., marker or EMG data) are read into memory with a single read
+and the numbers are parsed in place, without creating a string for each line
+or token. Tables with composite element types (e.g., SimTK::Vec3) are read one
+line at a time.                                                               */
 template<typename T>
 class DelimFileAdapter : public FileAdapter {
     static_assert(std::is_same<T, double           >::value ||
@@ -162,6 +172,32 @@ private:
     readElems_impl(const std::vector<std::string>& tokens,
                    SimTK::Vec<M>) const;
 
+    /** Following overloads read the rows of data that follow the column
+    labels into the time column and the matrix. The overload for double
+    parses the numbers in place; the other overload reads one line at a time
+    and uses readElems().                                                     */
+    template<typename U>
+    inline void readRows_impl(std::istream& stream,
+                              const std::string& fileName,
+                              size_t& lineNum,
+                              size_t numColumns,
+                              std::vector<double>& timeVec,
+                              SimTK::Matrix_<T>& matrix,
+                              U) const;
+    inline void readRows_impl(std::istream& stream,
+                              const std::string& fileName,
+                              size_t& lineNum,
+                              size_t numColumns,
+                              std::vector<double>& timeVec,
+                              SimTK::Matrix_<double>& matrix,
+                              double) const;
+
+    /** Parse a number from the characters in [begin, end), which must be
+    followed by a character that cannot be part of a number (e.g., a
+    delimiter, a newline, or the null character). This gives the same result
+    as std::stod() (and throws the same exceptions) without allocating.       */
+    static inline double parseDouble(const char* begin, const char* end);
+
     /** Following overloads implement writeElem().                            */
     inline void writeElem_impl(std::ostream& stream,
                                const double& elem,
@@ -401,22 +437,47 @@ DelimFileAdapter<T>::extendRead(const std::string& fileName) const {
                      column_labels[0]);
     column_labels.erase(column_labels.begin());
 
+    std::vector<double> timeVec;
+    SimTK::Matrix_<T> matrix;
+    readRows_impl(in_stream, fileName, line_num, column_labels.size(),
+                  timeVec, matrix, T{});
+
+    // Create the table and update other metadata from above
+    auto table = 
+        std::make_shared<TimeSeriesTable_<T>>(timeVec, matrix, column_labels);
+    table->updTableMetaData() = keyValuePairs;
+
+    OutputTables output_tables{};
+    output_tables.emplace(tableString(), table);
+
+    return output_tables;
+}
+
+template<typename T>
+template<typename U>
+void
+DelimFileAdapter<T>::readRows_impl(std::istream& in_stream,
+                                   const std::string& fileName,
+                                   size_t& line_num,
+                                   size_t numColumns,
+                                   std::vector<double>& timeVec,
+                                   SimTK::Matrix_<T>& matrix,
+                                   U) const {
     // Read the rows one at a time and fill up the time column container and
     // the data container. Start with a reasonable initial capacity for
     // tradeoff between a small file and larger files. 100 worked well for
     // a 50 MB file with ~80000 lines.
-    std::vector<double> timeVec;
     int initCapacity = 100;
-    int ncol = static_cast<int>(column_labels.size());
+    int ncol = static_cast<int>(numColumns);
     timeVec.reserve(initCapacity);
-    SimTK::Matrix_<T> matrix(initCapacity, ncol);
+    matrix.resize(initCapacity, ncol);
     
     // Initialize current row and capacity
     int curCapacity = initCapacity;
     int curRow = 0;
 
     // Start looping through each line
-    auto row = nextLine();
+    auto row = getNextLine(in_stream, _delimitersRead);
     while (!row.empty()) {
         ++line_num;
         
@@ -434,32 +495,139 @@ DelimFileAdapter<T>::extendRead(const std::string& fileName) const {
 
         auto row_vector = readElems(row);
 
-        OPENSIM_THROW_IF(row_vector.size() != (int)column_labels.size(),
+        OPENSIM_THROW_IF(row_vector.size() != ncol,
             RowLengthMismatch,
             fileName,
             line_num,
-            column_labels.size(),
+            numColumns,
             static_cast<size_t>(row_vector.size()));
         
         matrix.updRow(curRow) = std::move(row_vector);
 
-        row = nextLine();
+        row = getNextLine(in_stream, _delimitersRead);
         ++curRow;
     }
 
     // Resize the matrix down to the correct number of rows.
     // This is necessary until Simbody issue #401 is addressed.
     matrix.resizeKeep(curRow, ncol);
+}
 
-    // Create the table and update other metadata from above
-    auto table = 
-        std::make_shared<TimeSeriesTable_<T>>(timeVec, matrix, column_labels);
-    table->updTableMetaData() = keyValuePairs;
+template<typename T>
+void
+DelimFileAdapter<T>::readRows_impl(std::istream& in_stream,
+                                   const std::string& fileName,
+                                   size_t& line_num,
+                                   size_t numColumns,
+                                   std::vector<double>& timeVec,
+                                   SimTK::Matrix_<double>& matrix,
+                                   double) const {
+    // Read the rest of the file into a single buffer. The buffer is
+    // null-terminated, so parsing a number always stops inside it.
+    std::string buffer{};
+    const auto begin = in_stream.tellg();
+    in_stream.seekg(0, std::ios::end);
+    const auto end = in_stream.tellg();
+    if(begin != std::streampos(-1) && end != std::streampos(-1)) {
+        in_stream.seekg(begin);
+        buffer.resize(static_cast<size_t>(end - begin));
+        in_stream.read(&buffer[0], buffer.size());
+        // With CRLF line endings, text mode may read fewer characters.
+        buffer.resize(static_cast<size_t>(in_stream.gcount()));
+    }
 
-    OutputTables output_tables{};
-    output_tables.emplace(tableString(), table);
+    // Every row except possibly the last ends with a newline, so we can size
+    // the containers once.
+    const int ncol = static_cast<int>(numColumns);
+    const int maxRows = 
+        static_cast<int>(std::count(buffer.begin(), buffer.end(), '\n')) + 1;
+    timeVec.reserve(maxRows);
+    matrix.resize(maxRows, ncol);
+
+    bool isDelimiter[256] = {};
+    for(const char ch : _delimitersRead)
+        isDelimiter[static_cast<unsigned char>(ch)] = true;
+
+    // The tokens of each line are found as in FileAdapter::tokenize(): the
+    // text between consecutive delimiters is a token (even if empty), and the
+    // text after the last delimiter is a token if it is not empty.
+    int curRow = 0;
+    const char* pos = buffer.c_str();
+    const char* const bufferEnd = pos + buffer.size();
+    while(pos < bufferEnd) {
+        const char* lineEnd = static_cast<const char*>(
+                std::memchr(pos, '\n', bufferEnd - pos));
+        const char* const next = lineEnd ? lineEnd + 1 : bufferEnd;
+        if(!lineEnd)
+            lineEnd = bufferEnd;
+        // Get rid of the extra \r if parsing a file with CRLF line endings.
+        if(lineEnd > pos && *(lineEnd - 1) == '\r')
+            --lineEnd;
+        // An empty line ends the data.
+        if(lineEnd == pos)
+            break;
+        ++line_num;
 
-    return output_tables;
+        size_t numTokens = 0;
+        const char* tokenBegin = pos;
+        while(true) {
+            const char* tokenEnd = tokenBegin;
+            while(tokenEnd < lineEnd &&
+                    !isDelimiter[static_cast<unsigned char>(*tokenEnd)])
+                ++tokenEnd;
+            if(tokenEnd == lineEnd && tokenBegin == lineEnd)
+                break;
+
+            // Time is column 0.
+            const double value = parseDouble(tokenBegin, tokenEnd);
+            if(numTokens == 0)
+                timeVec.push_back(value);
+            else if(numTokens <= numColumns)
+                matrix(curRow, static_cast<int>(numTokens - 1)) = value;
+            ++numTokens;
+
+            if(tokenEnd == lineEnd)
+                break;
+            tokenBegin = tokenEnd + 1;
+        }
+
+        OPENSIM_THROW_IF(numTokens - 1 != numColumns,
+            RowLengthMismatch,
+            fileName,
+            line_num,
+            numColumns,
+            numTokens - 1);
+
+        pos = next;
+        ++curRow;
+    }
+
+    // Resize the matrix down to the correct number of rows.
+    matrix.resizeKeep(curRow, ncol);
+}
+
+template<typename T>
+double
+DelimFileAdapter<T>::parseDouble(const char* begin, const char* end) {
+    const auto isSpace = [](char ch) {
+        return ch == ' ' || ch == '\t' || ch == '\r' || ch == '\n';
+    };
+    while(begin < end && isSpace(*begin))
+        ++begin;
+    while(end > begin && isSpace(*(end - 1)))
+        --end;
+
+    char* parsedEnd = nullptr;
+    double value = SimTK::NaN;
+    if(begin < end) {
+        errno = 0;
+        value = std::strtod(begin, &parsedEnd);
+    }
+    // Let std::stod() create the exception for an invalid or out-of-range
+    // number.
+    if(begin == end || parsedEnd == begin || errno == ERANGE)
+        return std::stod(std::string(begin, end));
+    return value;
 }
 
 template<typename T>
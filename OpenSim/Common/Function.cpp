@@ -28,6 +28,9 @@
 
 // INCLUDES
 #include "Function.h"
+#include "Exception.h"
+
+#include <algorithm>
 
 
 using namespace OpenSim;
@@ -173,6 +176,68 @@ double Function::calcDerivative(const std::vector<int>& derivComponents, const V
     return _function->calcDerivative(derivComponents, x);
 }
 
+void Function::calcValues(const Vector& x, Vector& values, int derivOrder) const
+{
+    const int numArgs = std::max(getArgumentSize(), 1);
+    OPENSIM_THROW_IF_FRMOBJ(x.size() % numArgs != 0, Exception,
+            "Expected the size of x to be a multiple of the argument size {}, "
+            "but got {}.", numArgs, x.size());
+    const int n = x.size() / numArgs;
+    if (n == 0) {
+        values.resize(0);
+        return;
+    }
+
+    // Copy x if it is not contiguous (e.g., a row of a Matrix) or if it is
+    // also the output, so that the points can be passed as an array.
+    const bool copyX = !x.hasContiguousData() || &x == &values;
+    const Vector xCopy = copyX ? Vector(x) : Vector();
+    const double* xData = copyX ? &xCopy[0] : &x[0];
+    values.resize(n);
+    if (values.hasContiguousData()) {
+        calcValues(xData, n, &values[0], derivOrder);
+    } else {
+        Vector valuesContiguous(n);
+        calcValues(xData, n, &valuesContiguous[0], derivOrder);
+        values = valuesContiguous;
+    }
+}
+
+void Function::calcValues(const double* x, int n, double* values,
+        int derivOrder) const
+{
+    OPENSIM_THROW_IF_FRMOBJ(n < 0, Exception,
+            "Expected the number of points to be non-negative, but got {}.", n);
+    OPENSIM_THROW_IF_FRMOBJ(derivOrder < 0, Exception,
+            "Expected derivOrder to be non-negative, but got {}.", derivOrder);
+    OPENSIM_THROW_IF_FRMOBJ(derivOrder > getMaxDerivativeOrder(), Exception,
+            "Expected derivOrder to be at most {}, but got {}.",
+            getMaxDerivativeOrder(), derivOrder);
+    OPENSIM_THROW_IF_FRMOBJ(derivOrder > 0 && getArgumentSize() > 1,
+            Exception,
+            "Derivatives can only be calculated for many points at once for "
+            "functions of one argument, but this function has {} arguments.",
+            getArgumentSize());
+    if (n == 0) return;
+    implementCalcValues(x, n, values, derivOrder);
+}
+
+void Function::implementCalcValues(const double* x, int n, double* values,
+        int derivOrder) const
+{
+    const int numArgs = getArgumentSize();
+    const int stride = std::max(numArgs, 1);
+    // Reuse the argument and the derivative components for all points.
+    Vector arg(numArgs);
+    const std::vector<int> derivComponents(derivOrder, 0);
+    for (int i = 0; i < n; ++i) {
+        for (int j = 0; j < numArgs; ++j)
+            arg[j] = x[i * stride + j];
+        values[i] = derivOrder == 0 ? calcValue(arg)
+                                    : calcDerivative(derivComponents, arg);
+    }
+}
+
 int Function::getArgumentSize() const
 {
     if (_function == NULL)
@@ -114,6 +114,36 @@ public:
      * @param x                the Vector of input arguments.  Its size must equal the value returned by getArgumentSize().
      */
     virtual double calcDerivative(const std::vector<int>& derivComponents, const SimTK::Vector& x) const;
+    /**
+     * Calculate the value (derivOrder = 0) or a derivative of this function
+     * at many points with a single call. The results are the same as calling
+     * calcValue() or calcDerivative() at each point, but there is no per-call
+     * overhead, and functions such as splines reuse work from one point to
+     * the next (e.g., the interval that contains the previous point), which
+     * pays off the most when the points are sorted.
+     *
+     * For a function of one argument, x contains one argument per point,
+     * values is resized to the size of x, and derivOrder is the order of the
+     * derivative with respect to that argument. For a function of more than
+     * one argument, x contains the getArgumentSize() arguments of each point
+     * one after the other, and only values (derivOrder = 0) are supported.
+     *
+     * @param x          the arguments of the points.
+     * @param values     the value or derivative of the function at each point.
+     * @param derivOrder the order of the derivative; must not exceed
+     *                   getMaxDerivativeOrder().
+     */
+    void calcValues(const SimTK::Vector& x, SimTK::Vector& values,
+            int derivOrder = 0) const;
+#ifndef SWIG
+    /**
+     * Same as above, for n points whose arguments start at x. The n results
+     * are written to the array starting at values, which must not overlap
+     * with x.
+     */
+    void calcValues(const double* x, int n, double* values,
+            int derivOrder = 0) const;
+#endif
     /**
      * Get the number of components expected in the input vector.
      */
@@ -135,6 +165,16 @@ protected:
      */
     void resetFunction();
 
+    /**
+     * Evaluate n points for calcValues(), which has already checked the
+     * arguments (x contains n points of getArgumentSize() arguments each, and
+     * derivOrder is 0 if there is more than one argument). The default
+     * implementation calls calcValue() or calcDerivative() for each point;
+     * override this to evaluate many points more efficiently.
+     */
+    virtual void implementCalcValues(const double* x, int n, double* values,
+            int derivOrder) const;
+
 //=============================================================================
 };  // END class Function
 
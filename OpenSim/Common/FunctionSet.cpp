@@ -140,17 +140,30 @@ evaluate(Array<double> &rValues,int aDerivOrder,double aX) const
     int size = getSize();
     rValues.setSize(size);
 
-    int i;
-    for(i=0;i<size;i++) {
-        Function& func = get(i);
+    const SimTK::Vector arg(1, aX);
+    const std::vector<int> derivComponents(aDerivOrder, 0);
+    for(int i=0;i<size;i++) {
+        const Function& func = get(i);
         if (aDerivOrder==0)
-            rValues[i] = func.calcValue(SimTK::Vector(1,aX));
-        else {
-            std::vector<int> derivComponents;
-            for(int j=0; j<aDerivOrder; j++)
-                derivComponents.push_back(0);
-            rValues[i] = func.calcDerivative(derivComponents, SimTK::Vector(1,aX));
-
-        }
+            rValues[i] = func.calcValue(arg);
+        else
+            rValues[i] = func.calcDerivative(derivComponents, arg);
+    }
+}
+
+void FunctionSet::
+evaluate(SimTK::Vector& rValues, int aDerivOrder, double aX) const
+{
+    const int size = getSize();
+    rValues.resize(size);
+
+    const SimTK::Vector arg(1, aX);
+    const std::vector<int> derivComponents(aDerivOrder, 0);
+    for (int i = 0; i < size; ++i) {
+        const Function& func = get(i);
+        if (aDerivOrder == 0)
+            rValues[i] = func.calcValue(arg);
+        else
+            rValues[i] = func.calcDerivative(derivComponents, arg);
     }
 }
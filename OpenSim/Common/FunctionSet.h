@@ -75,6 +75,14 @@ public:
     virtual void
         evaluate(Array<double> &rValues,int aDerivOrder,
         double aX=0.0) const;
+    /**
+     * Evaluate all the functions in the set (or their derivatives) at the
+     * same value of the independent variable, e.g., all controls at one
+     * time. rValues is resized to the size of the set. The argument passed
+     * to the functions is created once for all functions.
+     */
+    void evaluate(SimTK::Vector& rValues, int aDerivOrder,
+            double aX = 0.0) const;
 
 //=============================================================================
 };  // END class FunctionSet
@@ -580,6 +580,25 @@ addPoint(double aX, double aY)
     return i;
 }
 
+void GCVSpline::implementCalcValues(const double* x, int n, double* values,
+        int derivOrder) const
+{
+    // The coefficients are computed when the SimTK::Function is created.
+    if (_function == NULL)
+        _function = createSimTKFunction();
+
+    // splder() uses 2*m doubles of workspace, where m is the half order,
+    // and updates the index of the interval containing the current value,
+    // so the search for each value starts from the interval of the previous
+    // value.
+    std::vector<double> work(2 * _halfOrder);
+    int interval = 1;
+    for (int i = 0; i < n; ++i) {
+        values[i] = splder(derivOrder, _halfOrder, _x.getSize(), x[i], &_x[0],
+                &_coefficients[0], &interval, work.data());
+    }
+}
+
 SimTK::Function* GCVSpline::createSimTKFunction() const {
     int degree = _halfOrder*2-1;
     Vector x(_x.getSize());
@@ -233,6 +233,9 @@ public:
     //--------------------------------------------------------------------------
     // EVALUATION
     //--------------------------------------------------------------------------
+protected:
+    void implementCalcValues(const double* x, int n, double* values,
+            int derivOrder) const override;
 
 //=============================================================================
 };  // END class GCVSpline
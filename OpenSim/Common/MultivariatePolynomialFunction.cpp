@@ -20,6 +20,9 @@
 
 #include "Exception.h"
 
+#include <algorithm>
+#include <vector>
+
 using namespace OpenSim;
 
 template <class T>
@@ -184,3 +187,52 @@ SimTK::Function* MultivariatePolynomialFunction::createSimTKFunction() const {
     return new SimTKMultivariatePolynomial<SimTK::Real>(
             get_coefficients(), get_dimension(), getOrder());
 }
+
+void MultivariatePolynomialFunction::implementCalcValues(const double* x,
+        int n, double* values, int derivOrder) const {
+    // calcValues() only allows derivatives if there is at most one argument.
+    if (derivOrder > 0) {
+        Super::implementCalcValues(x, n, values, derivOrder);
+        return;
+    }
+    const SimTK::Vector& coefficients = get_coefficients();
+    const int dimension = get_dimension();
+    const int order = get_order();
+    const int stride = std::max(dimension, 1);
+    // powers[i * (order + 1) + e] is x[i]^e for the current point; the powers
+    // of unused components stay 1.
+    std::vector<double> powers(4 * (order + 1), 1.0);
+    for (int p = 0; p < n; ++p) {
+        const double* xp = x + p * stride;
+        for (int i = 0; i < dimension; ++i) {
+            double* powersi = &powers[i * (order + 1)];
+            for (int e = 1; e <= order; ++e) {
+                powersi[e] = powersi[e - 1] * xp[i];
+            }
+        }
+        const double* powers0 = &powers[0];
+        const double* powers1 = &powers[order + 1];
+        const double* powers2 = &powers[2 * (order + 1)];
+        const double* powers3 = &powers[3 * (order + 1)];
+        double value = 0;
+        int coeff_nr = 0;
+        for (int nq0 = 0; nq0 < order + 1; ++nq0) {
+            const int nq2_s = dimension < 2 ? 0 : order - nq0;
+            for (int nq1 = 0; nq1 < nq2_s + 1; ++nq1) {
+                const int nq3_s = dimension < 3 ? 0 : order - nq0 - nq1;
+                for (int nq2 = 0; nq2 < nq3_s + 1; ++nq2) {
+                    const int nq4_s =
+                            dimension < 4 ? 0 : order - nq0 - nq1 - nq2;
+                    const double valueP012 =
+                            powers0[nq0] * powers1[nq1] * powers2[nq2];
+                    for (int nq3 = 0; nq3 < nq4_s + 1; ++nq3) {
+                        value += valueP012 * powers3[nq3] *
+                                 coefficients[coeff_nr];
+                        ++coeff_nr;
+                    }
+                }
+            }
+        }
+        values[p] = value;
+    }
+}
@@ -98,6 +98,12 @@ public:
     /// Return function
     SimTK::Function* createSimTKFunction() const override;
 
+protected:
+    /// Values are computed from a table of the powers of the arguments of
+    /// each point, rather than with std::pow() for every term.
+    void implementCalcValues(const double* x, int n, double* values,
+            int derivOrder) const override;
+
 private:
     void constructProperties() {
         constructProperty_coefficients(SimTK::Vector(0));
@@ -28,6 +28,9 @@
 #include "FunctionAdapter.h"
 #include "SimmMacros.h"
 #include "XYFunctionInterface.h"
+#include "CommonUtilities.h"
+
+#include <algorithm>
 
 
 using namespace OpenSim;
@@ -506,6 +509,38 @@ double PiecewiseLinearFunction::calcDerivative(const std::vector<int>& derivComp
     return _b[k];
 }
 
+void PiecewiseLinearFunction::implementCalcValues(const double* x, int n,
+        double* values, int derivOrder) const
+{
+    if (derivOrder > 1) {
+        std::fill(values, values + n, 0.0);
+        return;
+    }
+
+    const int size = _x.getSize();
+    const double* knots = _x.get();
+    int k = 0;
+    for (int p = 0; p < n; ++p) {
+        const double aX = x[p];
+
+        // Outside of the range of the function, extrapolate with the slope
+        // at the end point, as in calcValue().
+        double dx;
+        if (aX < knots[0] || EQUAL_WITHIN_ERROR(aX, knots[0])) {
+            k = 0;
+            dx = aX < knots[0] ? aX - knots[0] : 0.0;
+        } else if (aX > knots[size-1] || EQUAL_WITHIN_ERROR(aX,knots[size-1])) {
+            k = size-1;
+            dx = aX > knots[size-1] ? aX - knots[size-1] : 0.0;
+        } else {
+            k = findInterval(knots, size, aX, k);
+            dx = aX - knots[k];
+        }
+
+        values[p] = derivOrder == 0 ? _y[k] + dx * _b[k] : _b[k];
+    }
+}
+
 int PiecewiseLinearFunction::getArgumentSize() const
 {
     return 1;
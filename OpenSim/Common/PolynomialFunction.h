@@ -27,6 +27,8 @@
 // INCLUDES
 #include <OpenSim/Common/Function.h>
 
+#include <algorithm>
+
 namespace OpenSim {
 
 //=============================================================================
@@ -100,6 +102,26 @@ public:
         return new SimTK::Function::Polynomial(get_coefficients());
     }
 
+protected:
+    /** Evaluate with Horner's method, one coefficient at a time for all
+     * points, so that the loop over the points has no dependencies between
+     * iterations and can be vectorized by the compiler. */
+    void implementCalcValues(const double* x, int n, double* values,
+            int derivOrder) const override
+    {
+        const SimTK::Vector& coefficients = get_coefficients();
+        const int degree = coefficients.size() - 1;
+        std::fill(values, values + n, 0.0);
+        for (int i = 0; i <= degree - derivOrder; ++i) {
+            // Coefficient of the derivOrder-th derivative of x^(degree-i).
+            double c = coefficients[i];
+            for (int m = 0; m < derivOrder; ++m)
+                c *= degree - i - m;
+            for (int p = 0; p < n; ++p)
+                values[p] = values[p] * x[p] + c;
+        }
+    }
+
 private:
     /**
     * Construct the serializable property member variables and
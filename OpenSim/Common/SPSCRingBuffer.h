@@ -0,0 +1,173 @@
+#ifndef OPENSIM_SPSC_RING_BUFFER_H_
+#define OPENSIM_SPSC_RING_BUFFER_H_
+/* -------------------------------------------------------------------------- *
+ *                        OpenSim:  SPSCRingBuffer.h                          *
+ * -------------------------------------------------------------------------- *
+ * The OpenSim API is a toolkit for musculoskeletal modeling and simulation.  *
+ * See http://opensim.stanford.edu and the NOTICE file for more information.  *
+ * OpenSim is developed at Stanford University and supported by the US        *
+ * National Institutes of Health (U54 GM072970, R24 HD065690) and by DARPA    *
+ * through the Warrior Web program.                                           *
+ *                                                                            *
+ * Copyright (c) 2005-2021 Stanford University and the Authors                *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+#include "Exception.h"
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+namespace OpenSim {
+
+/**
+ * A fixed-capacity, lock-free queue for passing data from exactly one
+ * producer thread to exactly one consumer thread (e.g., from a thread reading
+ * a live marker stream to a thread solving inverse kinematics).
+ *
+ * Neither tryPush() nor tryPop() blocks or allocates memory: a full buffer
+ * rejects new entries and an empty buffer returns nothing, and the caller
+ * decides whether to wait, retry, or drop data. Entries are copy-assigned into
+ * and out of preallocated slots, so for types such as SimTK::RowVector_ the
+ * slots reuse their memory if they are initialized with a prototype of the
+ * right size.
+ *
+ * Only the producer thread may call tryPush() and tryPushWith(), and only the
+ * consumer thread may call tryPop(), tryPopWith(), tryPopLatest(), and
+ * discardAllButLatest(); size() and isEmpty() may be called from either
+ * thread, but the result can be outdated by the time it is used. DataQueue_
+ * uses this buffer for its bounded mode, in which it serializes multiple
+ * producers or consumers.
+ *
+ * @code
+ * SPSCRingBuffer_<double> buffer(64);
+ * // producer thread
+ * if (!buffer.tryPush(value)) { ++numDropped; }
+ * // consumer thread
+ * double value;
+ * while (buffer.tryPop(value)) { process(value); }
+ * @endcode
+ */
+template <class T>
+class SPSCRingBuffer_ {
+public:
+    /** Create a buffer that holds up to `capacity` entries. Each slot is
+    initialized with `prototype`. */
+    explicit SPSCRingBuffer_(std::size_t capacity, const T& prototype = T())
+            : m_slots(capacity + 1, prototype) {
+        OPENSIM_THROW_IF(capacity < 1, Exception,
+                "Expected capacity to be at least 1, but got {}.", capacity);
+    }
+
+    SPSCRingBuffer_(const SPSCRingBuffer_&) = delete;
+    SPSCRingBuffer_& operator=(const SPSCRingBuffer_&) = delete;
+
+    /** The maximum number of entries in the buffer. */
+    std::size_t getCapacity() const { return m_slots.size() - 1; }
+
+    /** Producer only. Append a copy of `value`, unless the buffer is full.
+    @returns false if the buffer is full (`value` is not added). */
+    bool tryPush(const T& value) {
+        return tryPushWith([&value](T& slot) { slot = value; });
+    }
+
+    /** Producer only. Like tryPush(), but the entry is written in place by
+    calling `write(slot)` with the free slot, which avoids copying an entry
+    that is assembled from several values.
+    @returns false if the buffer is full (`write` is not called). */
+    template <class Write>
+    bool tryPushWith(Write&& write) {
+        const std::size_t tail = m_tail.load(std::memory_order_relaxed);
+        const std::size_t next = increment(tail);
+        if (next == m_head.load(std::memory_order_acquire)) return false;
+        write(m_slots[tail]);
+        m_tail.store(next, std::memory_order_release);
+        return true;
+    }
+
+    /** Consumer only. Remove the oldest entry and copy it into `value`.
+    @returns false if the buffer is empty (`value` is unchanged). */
+    bool tryPop(T& value) {
+        return tryPopWith([&value](const T& slot) { value = slot; });
+    }
+
+    /** Consumer only. Like tryPop(), but the oldest entry is passed to
+    `read(slot)` before it is removed, so that the caller can copy only the
+    parts it needs.
+    @returns false if the buffer is empty (`read` is not called). */
+    template <class Read>
+    bool tryPopWith(Read&& read) {
+        const std::size_t head = m_head.load(std::memory_order_relaxed);
+        if (head == m_tail.load(std::memory_order_acquire)) return false;
+        read(static_cast<const T&>(m_slots[head]));
+        m_head.store(increment(head), std::memory_order_release);
+        return true;
+    }
+
+    /** Consumer only. Remove all entries and copy the newest one into
+    `value`. The number of older entries that were discarded is returned in
+    `numDiscarded`.
+    @returns false if the buffer is empty (`value` is unchanged). */
+    bool tryPopLatest(T& value, std::size_t& numDiscarded) {
+        numDiscarded = 0;
+        const std::size_t head = m_head.load(std::memory_order_relaxed);
+        const std::size_t tail = m_tail.load(std::memory_order_acquire);
+        if (head == tail) return false;
+        const std::size_t latest = tail == 0 ? m_slots.size() - 1 : tail - 1;
+        numDiscarded = distance(head, latest);
+        value = m_slots[latest];
+        m_head.store(tail, std::memory_order_release);
+        return true;
+    }
+
+    /** Consumer only. Discard all entries but the newest one.
+    @returns the number of entries discarded. */
+    std::size_t discardAllButLatest() {
+        const std::size_t head = m_head.load(std::memory_order_relaxed);
+        const std::size_t tail = m_tail.load(std::memory_order_acquire);
+        if (head == tail) return 0;
+        const std::size_t latest = tail == 0 ? m_slots.size() - 1 : tail - 1;
+        m_head.store(latest, std::memory_order_release);
+        return distance(head, latest);
+    }
+
+    /** The number of entries in the buffer. */
+    std::size_t size() const {
+        return distance(m_head.load(std::memory_order_acquire),
+                m_tail.load(std::memory_order_acquire));
+    }
+
+    bool isEmpty() const { return size() == 0; }
+
+private:
+    std::size_t increment(std::size_t index) const {
+        return index + 1 == m_slots.size() ? 0 : index + 1;
+    }
+    std::size_t distance(std::size_t from, std::size_t to) const {
+        return to >= from ? to - from : to + m_slots.size() - from;
+    }
+
+    // One more slot than the capacity, so that a full buffer can be
+    // distinguished from an empty one.
+    std::vector<T> m_slots;
+    // The next slot to read; written only by the consumer.
+    std::atomic<std::size_t> m_head{0};
+    // Keep the two indices on separate cache lines so that the producer and
+    // consumer do not invalidate each other's cache line on every operation.
+    char m_padding[64];
+    // The next slot to write; written only by the producer.
+    std::atomic<std::size_t> m_tail{0};
+};
+
+} // namespace OpenSim
+
+#endif // OPENSIM_SPSC_RING_BUFFER_H_
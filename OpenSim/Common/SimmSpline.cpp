@@ -28,6 +28,9 @@
 #include "SimmMacros.h"
 #include "XYFunctionInterface.h"
 #include "FunctionAdapter.h"
+#include "CommonUtilities.h"
+
+#include <algorithm>
 
 
 using namespace OpenSim;
@@ -670,6 +673,54 @@ double SimmSpline::calcDerivative(const std::vector<int>& derivComponents, const
       return (2.0*_c[k] + 6.0*dx*_d[k]);
 }
 
+void SimmSpline::implementCalcValues(const double* x, int n, double* values,
+        int derivOrder) const
+{
+    // NOT A NUMBER
+    if(!_y.getSize() || !_b.getSize() || !_c.getSize() || !_d.getSize()) {
+        std::fill(values, values + n, SimTK::NaN);
+        return;
+    }
+
+    const int size = _x.getSize();
+    const double* knots = _x.get();
+    int k = 0;
+    for (int p = 0; p < n; ++p) {
+        const double aX = x[p];
+
+        // Extrapolate with the slope at the end points, as in calcValue().
+        if (aX < knots[0] || aX > knots[size-1]) {
+            const int e = aX < knots[0] ? 0 : size-1;
+            if (derivOrder == 0)
+                values[p] = _y[e] + (aX - knots[e])*_b[e];
+            else if (derivOrder == 1)
+                values[p] = _b[e];
+            else
+                values[p] = 0.0;
+            continue;
+        }
+
+        double dx;
+        if (EQUAL_WITHIN_ERROR(aX,knots[0])) {
+            k = 0;
+            dx = 0.0;
+        } else if (EQUAL_WITHIN_ERROR(aX,knots[size-1])) {
+            k = size-1;
+            dx = 0.0;
+        } else {
+            k = findInterval(knots, size, aX, k);
+            dx = aX - knots[k];
+        }
+
+        if (derivOrder == 0)
+            values[p] = _y[k] + dx*(_b[k] + dx*(_c[k] + dx*_d[k]));
+        else if (derivOrder == 1)
+            values[p] = _b[k] + dx*(2.0*_c[k] + 3.0*dx*_d[k]);
+        else
+            values[p] = 2.0*_c[k] + 6.0*dx*_d[k];
+    }
+}
+
 int SimmSpline::getArgumentSize() const
 {
     return 1;
@@ -126,6 +126,10 @@ public:
 
     void updateFromXMLNode(SimTK::Xml::Element& aNode, int versionNumber=-1) override;
 
+protected:
+    void implementCalcValues(const double* x, int n, double* values,
+            int derivOrder) const override;
+
 private:
     void calcCoefficients();
 //=============================================================================
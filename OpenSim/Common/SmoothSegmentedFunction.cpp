@@ -24,6 +24,8 @@
 // INCLUDES
 //=============================================================================
 #include "SmoothSegmentedFunction.h"
+#include "Logger.h"
+#include <algorithm>
 #include <fstream>
 #include "simmath/internal/SplineFitter.h"
 
@@ -39,6 +41,10 @@ static double UTOL = (double)SimTK::Eps*1e2;
 static double INTTOL = (double)SimTK::Eps*1e2;
 static int MAXITER = 20;
 static int NUM_SAMPLE_PTS = 100;
+// The number of intervals per Bezier section of a lookup table starts at
+// LOOKUP_MIN_INTERVALS and is doubled until the tolerance is met.
+static int LOOKUP_MIN_INTERVALS = 16;
+static int LOOKUP_MAX_INTERVALS = 4096;
 //=============================================================================
 // UTILITY FUNCTIONS
 //=============================================================================
@@ -202,6 +208,8 @@ double SmoothSegmentedFunction::calcValue(double x) const
     double yVal = 0;
     if(x >= _x0 && x <= _x1 )
     {
+        if(!_lookupTable.empty())
+            return calcLookupTableDerivative(x, 0);
         int idx  = SegmentedQuinticBezierToolkit::calcIndex(x,_mXVec);
         double u = SegmentedQuinticBezierToolkit::
                  calcU(x,_mXVec[idx], _arraySplineUX[idx], UTOL,MAXITER);
@@ -270,6 +278,8 @@ double SmoothSegmentedFunction::calcDerivative(double x, int order) const
                 yVal = calcValue(x);
     }else{
             if(x >= _x0 && x <= _x1){        
+                if(!_lookupTable.empty() && order <= 2)
+                    return calcLookupTableDerivative(x, order);
                 int idx  = SegmentedQuinticBezierToolkit::calcIndex(x,_mXVec);
                 double u = SegmentedQuinticBezierToolkit::
                                 calcU(x,_mXVec[idx], _arraySplineUX[idx], 
@@ -323,6 +333,148 @@ double SmoothSegmentedFunction::
     return calcDerivative(ax(0), derivComponents.size());
 }
 
+//=============================================================================
+// LOOKUP TABLE
+//=============================================================================
+bool SmoothSegmentedFunction::buildLookupTable(double tolerance)
+{
+    SimTK_ERRCHK2_ALWAYS(tolerance > 0,
+        "SmoothSegmentedFunction::buildLookupTable",
+        "%s: tolerance must be positive, but %f was entered",
+        _name.c_str(), tolerance);
+
+    const int numSections = (int)_mXVec.size();
+    if(numSections == 0) return false;
+
+    std::vector<LookupTableSection> table(numSections);
+    std::vector<SimTK::Vec3> nodes;
+    for(int s=0; s < numSections; s++){
+        LookupTableSection& section = table[s];
+        const double xBegin = _mXVec[s](0);
+        const double xEnd   = _mXVec[s](_mXVec[s].size()-1);
+        section.xBegin = xBegin;
+
+        double prevError = SimTK::Infinity;
+        for(int n = LOOKUP_MIN_INTERVALS; ; n *= 2){
+            section.numIntervals = n;
+            section.width = (xEnd-xBegin)/n;
+            section.invWidth = 1.0/section.width;
+            const double h = section.width;
+
+            // The value and derivatives at the ends of the intervals, and the
+            // largest magnitude of each, which scales the error.
+            nodes.resize(n+1);
+            SimTK::Vec3 scale(1.0);
+            for(int j=0; j <= n; j++){
+                nodes[j] = calcSectionValueAndDerivatives(s,
+                        j == n ? xEnd : xBegin + j*h);
+                for(int k=0; k < 3; k++)
+                    scale[k] = std::max(scale[k], std::abs(nodes[j][k]));
+            }
+
+            // Quintic Hermite interpolation in t, with the derivatives
+            // scaled to the width of the interval.
+            section.coefficients.resize(6*n);
+            for(int i=0; i < n; i++){
+                const double dy  = nodes[i+1][0] - nodes[i][0];
+                const double d0  = nodes[i][1]*h;
+                const double d1  = nodes[i+1][1]*h;
+                const double dd0 = nodes[i][2]*h*h;
+                const double dd1 = nodes[i+1][2]*h*h;
+                double* c = &section.coefficients[6*i];
+                c[0] = nodes[i][0];
+                c[1] = d0;
+                c[2] = 0.5*dd0;
+                c[3] =  10*dy - 6*d0 - 4*d1 - 1.5*dd0 + 0.5*dd1;
+                c[4] = -15*dy + 8*d0 + 7*d1 + 1.5*dd0 -     dd1;
+                c[5] =   6*dy - 3*d0 - 3*d1 - 0.5*dd0 + 0.5*dd1;
+            }
+
+            // Check the error inside of each interval.
+            double error = 0;
+            for(int i=0; i < n; i++){
+                const double* c = &section.coefficients[6*i];
+                for(double t : {0.25, 0.5, 0.75}){
+                    const SimTK::Vec3 exact =
+                        calcSectionValueAndDerivatives(s, xBegin + (i+t)*h);
+                    const double approx[3] = {
+                        ((((c[5]*t + c[4])*t + c[3])*t + c[2])*t + c[1])*t
+                            + c[0],
+                        ((((5*c[5]*t + 4*c[4])*t + 3*c[3])*t + 2*c[2])*t
+                            + c[1])/h,
+                        (((20*c[5]*t + 12*c[4])*t + 6*c[3])*t + 2*c[2])/(h*h)};
+                    for(int k=0; k < 3; k++){
+                        error = std::max(error,
+                                std::abs(approx[k]-exact[k])/scale[k]);
+                    }
+                }
+            }
+
+            if(error <= tolerance) break;
+            // Past some point, refining only adds rounding error.
+            if(error >= prevError || 2*n > LOOKUP_MAX_INTERVALS){
+                log_warn("{}: Could not build a lookup table with a relative "
+                    "error of {} (the smallest error was {}); the curve will "
+                    "be evaluated exactly.", _name, tolerance,
+                    std::min(error, prevError));
+                _lookupTable.clear();
+                return false;
+            }
+            prevError = error;
+        }
+    }
+    _lookupTable = std::move(table);
+    return true;
+}
+
+void SmoothSegmentedFunction::clearLookupTable()
+{
+    _lookupTable.clear();
+}
+
+bool SmoothSegmentedFunction::isLookupTableAvailable() const
+{
+    return !_lookupTable.empty();
+}
+
+double SmoothSegmentedFunction::
+    calcLookupTableDerivative(double x, int order) const
+{
+    // There are only a few sections, so a linear search is fastest.
+    int s = 0;
+    const int lastSection = (int)_lookupTable.size()-1;
+    while(s < lastSection && x > _lookupTable[s+1].xBegin) s++;
+    const LookupTableSection& section = _lookupTable[s];
+
+    double t = (x - section.xBegin)*section.invWidth;
+    const int i = std::min(std::max((int)t, 0), section.numIntervals-1);
+    t -= i;
+    const double* c = &section.coefficients[6*i];
+    switch(order){
+        case 0:
+            return ((((c[5]*t + c[4])*t + c[3])*t + c[2])*t + c[1])*t + c[0];
+        case 1:
+            return ((((5*c[5]*t + 4*c[4])*t + 3*c[3])*t + 2*c[2])*t + c[1])
+                    *section.invWidth;
+        default:
+            return (((20*c[5]*t + 12*c[4])*t + 6*c[3])*t + 2*c[2])
+                    *section.invWidth*section.invWidth;
+    }
+}
+
+SimTK::Vec3 SmoothSegmentedFunction::
+    calcSectionValueAndDerivatives(int s, double x) const
+{
+    const double u = SegmentedQuinticBezierToolkit::
+        calcU(x, _mXVec[s], _arraySplineUX[s], UTOL, MAXITER);
+    return SimTK::Vec3(
+        SegmentedQuinticBezierToolkit::calcQuinticBezierCurveVal(u,_mYVec[s]),
+        SegmentedQuinticBezierToolkit::
+            calcQuinticBezierCurveDerivDYDX(u, _mXVec[s], _mYVec[s], 1),
+        SegmentedQuinticBezierToolkit::
+            calcQuinticBezierCurveDerivDYDX(u, _mXVec[s], _mYVec[s], 2));
+}
+
 /*Detailed Computational Costs
 ________________________________________________________________________
 If x is in the Bezier Curve, and dy/dx is being evaluated
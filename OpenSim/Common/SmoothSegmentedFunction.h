@@ -24,6 +24,7 @@
  * -------------------------------------------------------------------------- */
 #include "osimCommonDLL.h"
 #include "SegmentedQuinticBezierToolkit.h"
+#include <vector>
 
 namespace OpenSim { 
 
@@ -132,6 +133,46 @@ namespace OpenSim {
        using Function_<double>::calcDerivative;
 #endif
 
+       /**Tabulate the curve so that calcValue() and calcDerivative() (up to
+       the second derivative) are evaluated with an indexed lookup, instead of
+       solving for the Bezier parameter u with Newton's method at every call.
+       The table is built once, and is meant for curves that are evaluated
+       many times (e.g., the curves of a muscle during a simulation).
+
+       Each Bezier section is divided into intervals of equal width. In each
+       interval, the curve is approximated by the quintic polynomial that
+       matches the value and the first two derivatives of the curve at both
+       ends of the interval, so the approximation is continuous to the second
+       derivative. The number of intervals is doubled until the errors of the
+       value and of the first and second derivatives, checked at three points
+       in each interval, are at most `tolerance` times the largest magnitude
+       of that quantity in the section (or `tolerance`, if that magnitude is
+       less than 1). The linear extrapolation outside of the curve domain and
+       the integral are not affected.
+
+       @param tolerance The relative error bound of the table.
+       @throws OpenSim::Exception
+        -If tolerance is not positive
+       @return true if the table meets the tolerance. Otherwise (e.g., if
+               rounding errors dominate before the tolerance is met), no table
+               is built, and the curve is evaluated exactly.
+
+       <B>Computational Costs</B>
+       \verbatim
+            x in curve domain  : ~25 flops
+            building the table : ~2,000 exact evaluations per Bezier section
+       \endverbatim
+       */
+       bool buildLookupTable(double tolerance = 1e-8);
+
+       /**Remove the table built by buildLookupTable(), so that the curve is
+       evaluated exactly.*/
+       void clearLookupTable();
+
+       /**@return true if the curve is evaluated with a lookup table (see
+       buildLookupTable()).*/
+       bool isLookupTableAvailable() const;
+
 
        /**This will return the value of the integral of this objects curve 
        evaluated at x. 
@@ -344,6 +385,31 @@ namespace OpenSim {
         bool _intx0x1;
         /**The name of the function**/
         std::string _name;
+
+        /**The lookup table of one Bezier section (see buildLookupTable()).*/
+        struct LookupTableSection {
+            /**The start of the section*/
+            double xBegin;
+            /**The width of each interval, and its inverse*/
+            double width;
+            double invWidth;
+            int numIntervals;
+            /**The 6 coefficients (lowest order first) of the quintic
+            polynomial of each interval i, in terms of
+            t = (x-xBegin)/width - i, stored one interval after the other*/
+            std::vector<double> coefficients;
+        };
+        /**The lookup table of each Bezier section. This is empty if the
+        curve is evaluated exactly*/
+        std::vector<LookupTableSection> _lookupTable;
+
+        /**Evaluates the value, or the first or second derivative (order 0 to
+        2), of the curve using the lookup table, for x in the curve domain*/
+        double calcLookupTableDerivative(double x, int order) const;
+
+        /**Evaluates the value and the first and second derivatives of the
+        Bezier curve of section s exactly (with a single solve for u)*/
+        SimTK::Vec3 calcSectionValueAndDerivatives(int s, double x) const;
             
         /**No human should be constructing a SmoothSegmentedFunction, so the
         constructor is made private so that mere mortals cannot look at it. 
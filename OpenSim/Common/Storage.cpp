@@ -29,6 +29,7 @@
 // INCLUDES
 #include "Storage.h"
 
+#include "BSTOFileAdapter.h"
 #include "CommonUtilities.h"
 #include "GCVSpline.h"
 #include "GCVSplineSet.h"
@@ -41,11 +42,36 @@
 #include "StateVector.h"
 #include "TableUtilities.h"
 #include "TimeSeriesTable.h"
+#include <algorithm>
 #include <iostream>
 
 using namespace OpenSim;
 using namespace std;
 
+// Hide this function from other translation units.
+namespace {
+    /** Index of the first row at or after aBegin whose time is later than aT,
+     * or the number of rows if there is none. The times of the rows must be
+     * nondecreasing. */
+    int findFirstRowAfter(const Array<StateVector>& rows, int aBegin,
+            double aT) {
+        // Lookups usually step forward through time from the previous
+        // index, so check the next rows before bisecting.
+        const int size = rows.getSize();
+        int lo = aBegin;
+        for(const int end = std::min(aBegin+2,size); lo<end; lo++) {
+            if(aT<rows[lo].getTime()) return(lo);
+        }
+        int hi = size;
+        while(lo<hi) {
+            const int mid = lo + (hi-lo)/2;
+            if(aT<rows[mid].getTime()) hi = mid;
+            else lo = mid+1;
+        }
+        return(lo);
+    }
+}
+
 void convertTableToStorage(const AbstractDataTable* table, Storage& sto)
 {
     sto.purge();
@@ -1423,7 +1449,7 @@ crop(const double newStartTime, const double newFinalTime)
     }
     if (startindex!=0){
         for(int i=0; i<finalindex-startindex+1; i++)
-            _storage[i]=_storage[startindex+i];
+            _storage[i]=std::move(_storage[startindex+i]);
     }
     _storage.setSize(numRowsToKeep);
 }
@@ -1486,15 +1512,25 @@ append(double aT,int aN,const double *aY,bool aCheckForDuplicateTime)
     if(aN<0) return(_storage.getSize());
 
     // APPEND
-    StateVector vec(aT, SimTK::Vector_<double>(aN, aY));
-    append(vec,aCheckForDuplicateTime);
+    // The data is written directly into the new (or duplicate-time) row,
+    // whose StateVector already exists in the capacity of _storage, so no
+    // temporary StateVector is created and copied.
     // TODO: use some tolerance when checking for duplicate time?
-    /*
-    if(aCheckForDuplicateTime && _storage.getSize() && _storage.getLast().getTime()==vec.getTime())
-        _storage.getLast() = vec;
-    else
-        _storage.append(vec);
-    */
+    if(!(aCheckForDuplicateTime && _storage.getSize() &&
+            _storage.getLast().getTime()==aT)) {
+        _storage.setSize(_storage.getSize()+1);
+    }
+    StateVector& vec = _storage.updLast();
+    vec.setTime(aT);
+    Array<double>& data = vec.getData();
+    data.ensureCapacity(aN+1);
+    data.setSize(aN);
+    for(int i=0;i<aN;i++) data[i] = aY[i];
+
+    if (_fp!=0){
+        vec.print(_fp);
+        fflush(_fp);
+    }
     return(_storage.getSize());
 }
 //_____________________________________________________________________________
@@ -2475,10 +2511,11 @@ lowpassFIR(int aOrder,double aCutoffFrequency)
  * Find the index of the storage element that occurred immediately before
  * or at time aT ( aT <= getTime(index) ).
  *
- * This method can be much more efficient than findIndex(aT) if a good guess
- * is made for aI.
- * If aI corresponds to a state which occurred later than aT, an exhaustive
- * search is performed by calling findIndex(aT).
+ * This method can be more efficient than findIndex(aT) if a good guess
+ * is made for aI (e.g., the index found for the previous time when stepping
+ * forward through time).
+ * If aI corresponds to a state which occurred later than aT, the search
+ * starts with the first stored state.
  *
  * @param aI Index at which to start searching.
  * @param aT Time.
@@ -2491,14 +2528,10 @@ findIndex(int aI,double aT) const
     // MAKE SURE aI IS VALID
     if(_storage.getSize()<=0) return(-1);
     if((aI>=_storage.getSize())||(aI<0)) aI=0;
-    if(getStateVector(aI)->getTime()>aT) aI=0;
+    if(_storage[aI].getTime()>aT) aI=0;
 
     // SEARCH
-    //cout << "Storage.findIndex: starting at " << aI << endl;
-    int i;
-    for(i=aI;i<_storage.getSize();i++) {
-        if(aT<getStateVector(i)->getTime()) break;
-    }
+    int i = findFirstRowAfter(_storage,aI,aT);
     _lastI = i-1;
     if(_lastI<0) _lastI=0;
     return(_lastI);
@@ -2508,8 +2541,8 @@ findIndex(int aI,double aT) const
  * Find the index of the storage element that occurred immediately before
  * or at a specified time ( getTime(index) <= aT ).
  *
- * This method is not very efficient because it always starts its search
- * with the first stored state.
+ * The times of the stored states must be nondecreasing; the index is found
+ * by bisection.
  *
  * @param aT Time.
  * @return Index preceding or at time aT.  If aT is less than the earliest
@@ -2519,10 +2552,7 @@ int Storage::
 findIndex(double aT) const
 {
     if(_storage.getSize()<=0) return(-1);
-    int i;
-    for(i=0;i<_storage.getSize();i++) {
-        if(aT<getStateVector(i)->getTime()) break;
-    }
+    int i = findFirstRowAfter(_storage,0,aT);
     _lastI = i-1;
     if(_lastI<0) _lastI=0;
     return(_lastI);
@@ -2707,6 +2737,14 @@ setOutputFileName(const std::string& aFileName)
 bool Storage::
 print(const string &aFileName,const string &aMode, const string& aComment) const
 {
+    // Binary STO files are written by BSTOFileAdapter.
+    if(IO::EndsWith(IO::Lowercase(aFileName), ".bsto")) {
+        OPENSIM_THROW_IF(aMode != "w", Exception,
+                "Storage.print: cannot append to BSTO file '{}'.", aFileName);
+        BSTOFileAdapter::write(exportToTable(), aFileName);
+        return(true);
+    }
+
     // OPEN THE FILE
     FILE *fp = IO::OpenFile(aFileName,aMode);
     if(fp==NULL) return(false);
@@ -146,11 +146,14 @@ void TableUtilities::filterLowpass(
     if (dtAvg - dtMin > SimTK::Eps) {
         table = resampleWithInterval(table, dtMin);
     }
+    const int numFilteredRows = (int)table.getNumRows();
 
-    SimTK::Vector filtered(numRows);
+    // The columns of the table are contiguous, so they are filtered without
+    // copying them.
+    SimTK::Vector filtered(numFilteredRows);
     for (int icol = 0; icol < (int)table.getNumColumns(); ++icol) {
         SimTK::VectorView column = table.getDependentColumnAtIndex(icol);
-        Signal::LowpassIIR(dtMin, cutoffFreq, numRows,
+        Signal::LowpassIIR(dtMin, cutoffFreq, numFilteredRows,
                 column.getContiguousScalarData(),
                 filtered.updContiguousScalarData());
         table.updDependentColumnAtIndex(icol) = filtered;
@@ -242,9 +245,8 @@ TimeSeriesTable TableUtilities::resample(
 
     // Copy over metadata.
     TimeSeriesTable out = in;
-    for (int irow = (int)out.getNumRows() - 1; irow >= 0; --irow) {
-        out.removeRowAtIndex(irow);
-    }
+    out._indData.clear();
+    out._depData.resize(0, out._depData.ncol());
 
     std::unique_ptr<FunctionSet> functions =
             createFunctionSet<FunctionType>(in);
@@ -255,7 +257,6 @@ TimeSeriesTable TableUtilities::resample(
         for (int icol = 0; icol < functions->getSize(); ++icol) {
             row(icol) = functions->get(icol).calcValue(curTime);
         }
-        // Not efficient!
         out.appendRow(curTime[0], row);
     }
     return out;
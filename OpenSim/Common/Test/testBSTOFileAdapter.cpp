@@ -0,0 +1,134 @@
+/* -------------------------------------------------------------------------- *
+ *                          OpenSim:  testBSTOFileAdapter.cpp                 *
+ * -------------------------------------------------------------------------- *
+ * The OpenSim API is a toolkit for musculoskeletal modeling and simulation.  *
+ * See http://opensim.stanford.edu and the NOTICE file for more information.  *
+ * OpenSim is developed at Stanford University and supported by the US        *
+ * National Institutes of Health (U54 GM072970, R24 HD065690) and by DARPA    *
+ * through the Warrior Web program.                                           *
+ *                                                                            *
+ * Copyright (c) 2005-2021 Stanford University and the Authors                *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+#include "OpenSim/Common/Adapters.h"
+#include "OpenSim/Common/Storage.h"
+#include <fstream>
+
+#define CATCH_CONFIG_MAIN
+#include <OpenSim/Auxiliary/catch.hpp>
+
+using namespace OpenSim;
+
+namespace {
+TimeSeriesTable createTable(int numRows) {
+    std::vector<double> time(numRows);
+    SimTK::Matrix matrix(numRows, 3);
+    for (int i = 0; i < numRows; ++i) {
+        time[i] = 0.01 * i;
+        matrix(i, 0) = std::sin(time[i]);
+        matrix(i, 1) = i % 7 == 0 ? SimTK::NaN : 1e-300 * i;
+        matrix(i, 2) = i % 2 == 0 ? -SimTK::Infinity : 42.0;
+    }
+    TimeSeriesTable table(time, matrix, {"sin", "tiny", "special"});
+    table.addTableMetaData("inDegrees", std::string("no"));
+    table.addTableMetaData("header", std::string("testing BSTO"));
+    return table;
+}
+
+void checkEqual(const TimeSeriesTable& expected,
+        const TimeSeriesTable& actual, bool checkHeader = true) {
+    REQUIRE(actual.getNumRows() == expected.getNumRows());
+    REQUIRE(actual.getColumnLabels() == expected.getColumnLabels());
+    CHECK(actual.getIndependentColumn() == expected.getIndependentColumn());
+    for (int i = 0; i < (int)expected.getNumRows(); ++i) {
+        for (int j = 0; j < (int)expected.getNumColumns(); ++j) {
+            const double e = expected.getMatrix()(i, j);
+            const double a = actual.getMatrix()(i, j);
+            if (SimTK::isNaN(e)) {
+                CHECK(SimTK::isNaN(a));
+            } else {
+                CHECK(a == e);
+            }
+        }
+    }
+    CHECK(actual.getTableMetaDataAsString("inDegrees") == "no");
+    if (checkHeader) {
+        CHECK(actual.getTableMetaDataAsString("header") == "testing BSTO");
+    }
+}
+}
+
+TEST_CASE("BSTOFileAdapter round trip") {
+    const std::string filename = "testing_bsto.bsto";
+    for (int numRows : {0, 1, 100, 1000}) {
+        const auto table = createTable(numRows);
+        for (bool compress : {false, true}) {
+            for (int numRowsPerChunk : {1, 64, 4096}) {
+                CAPTURE(numRows, compress, numRowsPerChunk);
+                BSTOFileAdapter adapter;
+                adapter.setCompressionEnabled(compress);
+                adapter.setNumRowsPerChunk(numRowsPerChunk);
+                adapter.writeTable(table, filename);
+                checkEqual(table, TimeSeriesTable(filename));
+
+                CHECK(BSTOFileAdapter::readColumn(filename, "time") ==
+                        table.getIndependentColumn());
+                const auto sin = BSTOFileAdapter::readColumn(filename, "sin");
+                REQUIRE((int)sin.size() == numRows);
+                for (int i = 0; i < numRows; ++i) {
+                    CHECK(sin[i] == table.getDependentColumn("sin")[i]);
+                }
+                CHECK_THROWS_AS(
+                        BSTOFileAdapter::readColumn(filename, "unknown"),
+                        KeyMissing);
+            }
+        }
+    }
+    CHECK_THROWS_AS(BSTOFileAdapter().setNumRowsPerChunk(0), InvalidArgument);
+}
+
+TEST_CASE("BSTOFileAdapter through Storage and FileAdapter") {
+    const auto table = createTable(50);
+    FileAdapter::writeFile({{"table", &table}}, "testing_bsto_generic.bsto");
+    checkEqual(table, TimeSeriesTable("testing_bsto_generic.bsto"));
+
+    Storage sto("testing_bsto_generic.bsto");
+    CHECK(sto.getSize() == 50);
+    sto.print("testing_bsto_storage.bsto");
+    checkEqual(table, TimeSeriesTable("testing_bsto_storage.bsto"), false);
+    CHECK_THROWS_AS(sto.print("testing_bsto_storage.bsto", "a"), Exception);
+}
+
+TEST_CASE("BSTOFileAdapter rejects invalid files") {
+    const std::string filename = "testing_bsto_invalid.bsto";
+    {
+        std::ofstream file(filename, std::ios::binary);
+        file << "endheader\ntime\ta\n0\t1\n";
+    }
+    CHECK_THROWS_AS(TimeSeriesTable(filename), InvalidBSTOFile);
+
+    // A truncated file.
+    const auto table = createTable(100);
+    BSTOFileAdapter::write(table, filename);
+    std::string contents;
+    {
+        std::ifstream file(filename, std::ios::binary);
+        contents.assign(std::istreambuf_iterator<char>(file),
+                std::istreambuf_iterator<char>());
+    }
+    {
+        std::ofstream file(filename, std::ios::binary);
+        file.write(contents.data(), contents.size() / 2);
+    }
+    CHECK_THROWS_AS(TimeSeriesTable(filename), InvalidBSTOFile);
+}
@@ -0,0 +1,65 @@
+/* -------------------------------------------------------------------------- *
+ *                     OpenSim:  testCommonUtilities.cpp                      *
+ * -------------------------------------------------------------------------- *
+ * The OpenSim API is a toolkit for musculoskeletal modeling and simulation.  *
+ * See http://opensim.stanford.edu and the NOTICE file for more information.  *
+ * OpenSim is developed at Stanford University and supported by the US        *
+ * National Institutes of Health (U54 GM072970, R24 HD065690) and by DARPA    *
+ * through the Warrior Web program.                                           *
+ *                                                                            *
+ * Copyright (c) 2005-2021 Stanford University and the Authors                *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+
+#include <OpenSim/Common/CommonUtilities.h>
+#include <OpenSim/Common/Exception.h>
+#include <atomic>
+#include <vector>
+
+#define CATCH_CONFIG_MAIN
+#include <OpenSim/Auxiliary/catch.hpp>
+
+using namespace OpenSim;
+
+TEST_CASE("WorkStealingThreadPool") {
+    CHECK_THROWS(WorkStealingThreadPool(0));
+    for (int numThreads : {1, 2, 4}) {
+        CAPTURE(numThreads);
+        WorkStealingThreadPool pool(numThreads);
+        CHECK(pool.getNumThreads() == numThreads);
+        // Reuse the pool to ensure the threads wake up for each call.
+        for (int numIterations : {0, 1, 3, 1000}) {
+            CAPTURE(numIterations);
+            std::vector<std::atomic<int>> counts(numIterations);
+            for (auto& count : counts) count = 0;
+            std::atomic<bool> validWorker(true);
+            pool.parallelFor(numIterations, [&](int worker, int index) {
+                if (worker < 0 || worker >= numThreads) validWorker = false;
+                ++counts[index];
+            });
+            CHECK(validWorker);
+            for (const auto& count : counts) CHECK(count == 1);
+        }
+        CHECK_THROWS_WITH(pool.parallelFor(100,
+                                  [](int, int index) {
+                                      if (index == 50) {
+                                          throw Exception("iteration 50");
+                                      }
+                                  }),
+                Catch::Contains("iteration 50"));
+        // The pool is still usable after an exception.
+        std::atomic<int> sum(0);
+        pool.parallelFor(10, [&](int, int index) { sum += index; });
+        CHECK(sum == 45);
+    }
+}
@@ -0,0 +1,217 @@
+/* -------------------------------------------------------------------------- *
+ *                        OpenSim:  testDataQueue.cpp                         *
+ * -------------------------------------------------------------------------- *
+ * The OpenSim API is a toolkit for musculoskeletal modeling and simulation.  *
+ * See http://opensim.stanford.edu and the NOTICE file for more information.  *
+ * OpenSim is developed at Stanford University and supported by the US        *
+ * National Institutes of Health (U54 GM072970, R24 HD065690) and by DARPA    *
+ * through the Warrior Web program.                                           *
+ *                                                                            *
+ * Copyright (c) 2005-2021 Stanford University and the Authors                *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+#include <OpenSim/Common/DataQueue.h>
+#include <thread>
+
+#define CATCH_CONFIG_MAIN
+#include <OpenSim/Auxiliary/catch.hpp>
+
+using namespace OpenSim;
+
+namespace {
+SimTK::RowVector row(double value) { return SimTK::RowVector(3, value); }
+}
+
+TEST_CASE("DataQueue_ copies the pushed data") {
+    DataQueue_<SimTK::Vec3> queue;
+    {
+        SimTK::RowVector_<SimTK::Vec3> data(2, SimTK::Vec3(1, 2, 3));
+        queue.push_back(0.5, data);
+    }
+    double time;
+    SimTK::RowVector_<SimTK::Vec3> data;
+    queue.pop_front(time, data);
+    CHECK(time == 0.5);
+    REQUIRE(data.size() == 2);
+    CHECK(data[1] == SimTK::Vec3(1, 2, 3));
+    CHECK(queue.isEmpty());
+}
+
+TEST_CASE("Bounded DataQueue_ push and pop") {
+    DataQueue_<double> queue(4);
+    CHECK(queue.getCapacity() == 4);
+    CHECK(queue.isEmpty());
+
+    double time = -1;
+    SimTK::RowVector data;
+    CHECK_FALSE(queue.try_pop_front(time, data));
+    CHECK(time == -1);
+
+    // Wrap around the end of the slots several times.
+    for (int i = 0; i < 10; ++i) {
+        CHECK(queue.push_back(i, row(i)));
+        CHECK(queue.push_back(i + 0.5, row(i + 0.5)));
+        queue.pop_front(time, data);
+        CHECK(time == i / 2.0);
+        CHECK(data[2] == i / 2.0);
+    }
+    CHECK(queue.size() == 10);
+}
+
+TEST_CASE("Bounded DataQueue_ overflow policies") {
+    using Policy = DataQueue_<double>::OverflowPolicy;
+    double time;
+    SimTK::RowVector data;
+
+    SECTION("DropNewest") {
+        DataQueue_<double> queue(3, Policy::DropNewest);
+        for (int i = 0; i < 3; ++i) CHECK(queue.push_back(i, row(i)));
+        CHECK_FALSE(queue.push_back(3, row(3)));
+        CHECK(queue.getNumDropped() == 1);
+        queue.pop_front(time, data);
+        CHECK(time == 0);
+    }
+    SECTION("DropOldest") {
+        DataQueue_<double> queue(3, Policy::DropOldest);
+        for (int i = 0; i < 5; ++i) CHECK(queue.push_back(i, row(i)));
+        CHECK(queue.getNumDropped() == 2);
+        CHECK(queue.size() == 3);
+        for (int i = 2; i < 5; ++i) {
+            queue.pop_front(time, data);
+            CHECK(time == i);
+            CHECK(data[0] == i);
+        }
+    }
+    SECTION("Throw") {
+        // One thread pushes more entries than the capacity.
+        DataQueue_<double> queue(3, Policy::Throw);
+        for (int i = 0; i < 3; ++i) CHECK(queue.push_back(i, row(i)));
+        CHECK_THROWS_AS(queue.push_back(3, row(3)), Exception);
+        CHECK(queue.size() == 3);
+        CHECK(queue.getNumDropped() == 0);
+        queue.pop_front(time, data);
+        CHECK(time == 0);
+        CHECK(queue.push_back(3, row(3)));
+    }
+    SECTION("Block") {
+        DataQueue_<double> queue(2, Policy::Block);
+        CHECK(queue.push_back(0, row(0)));
+        CHECK(queue.push_back(1, row(1)));
+        // The third push waits until the consumer makes room.
+        std::thread producer([&]() { queue.push_back(2, row(2)); });
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        CHECK(queue.size() == 2);
+        for (int i = 0; i < 3; ++i) {
+            queue.pop_front(time, data);
+            CHECK(time == i);
+        }
+        producer.join();
+        CHECK(queue.getNumDropped() == 0);
+    }
+}
+
+TEST_CASE("Bounded DataQueue_ batch pop") {
+    DataQueue_<double> queue(8);
+    std::vector<double> times;
+    std::vector<SimTK::RowVector> data;
+    CHECK(queue.pop_front_batch(4, times, data) == 0);
+    CHECK(times.size() >= 4);
+
+    for (int i = 0; i < 6; ++i) queue.push_back(i, row(i));
+    CHECK(queue.pop_front_batch(4, times, data) == 4);
+    for (int i = 0; i < 4; ++i) {
+        CHECK(times[i] == i);
+        CHECK(data[i][1] == i);
+    }
+    CHECK(queue.pop_front_batch(4, times, data) == 2);
+    CHECK(times[0] == 4);
+    CHECK(times[1] == 5);
+    CHECK(queue.isEmpty());
+}
+
+TEST_CASE("Bounded DataQueue_ copy is empty") {
+    DataQueue_<double> queue(5,
+            DataQueue_<double>::OverflowPolicy::DropOldest);
+    queue.push_back(0, row(0));
+    DataQueue_<double> copy(queue);
+    CHECK(copy.getCapacity() == 5);
+    CHECK(copy.getOverflowPolicy() ==
+            DataQueue_<double>::OverflowPolicy::DropOldest);
+    CHECK(copy.isEmpty());
+    CHECK(queue.size() == 1);
+
+    // An unbounded queue is copied with its entries.
+    DataQueue_<double> unbounded;
+    unbounded.push_back(0, row(0));
+    DataQueue_<double> unboundedCopy(unbounded);
+    CHECK(unboundedCopy.getCapacity() == 0);
+    CHECK(unboundedCopy.size() == 1);
+
+    CHECK_THROWS_AS(DataQueue_<double>(0), Exception);
+}
+
+TEST_CASE("Bounded DataQueue_ multiple producers") {
+    const int numProducers = 4;
+    const int numEntriesPerProducer = 20000;
+    DataQueue_<double> queue(16);
+
+    std::vector<std::thread> producers;
+    for (int p = 0; p < numProducers; ++p) {
+        producers.emplace_back([&, p]() {
+            SimTK::RowVector data(2);
+            for (int i = 0; i < numEntriesPerProducer; ++i) {
+                data[0] = p;
+                data[1] = i;
+                queue.push_back(i, data);
+            }
+        });
+    }
+
+    // Every entry arrives exactly once, and the entries of each producer
+    // arrive in order.
+    std::vector<int> next(numProducers, 0);
+    bool inOrder = true;
+    double time;
+    SimTK::RowVector data;
+    for (int n = 0; n < numProducers * numEntriesPerProducer; ++n) {
+        queue.pop_front(time, data);
+        const int p = (int)data[0];
+        inOrder = inOrder && (int)data[1] == next[p] && time == next[p];
+        ++next[p];
+    }
+    for (auto& producer : producers) producer.join();
+    CHECK(inOrder);
+    for (int p = 0; p < numProducers; ++p) {
+        CHECK(next[p] == numEntriesPerProducer);
+    }
+    CHECK(queue.isEmpty());
+}
+
+TEST_CASE("DataQueue_ discards all but the latest entry") {
+    double time;
+    SimTK::RowVector data;
+    std::chrono::steady_clock::time_point pushTime;
+    for (std::size_t capacity : {0, 8}) {
+        DataQueue_<double> queue = capacity == 0 ? DataQueue_<double>()
+                                                 : DataQueue_<double>(capacity);
+        CHECK(queue.discard_all_but_latest() == 0);
+        const auto before = std::chrono::steady_clock::now();
+        for (int i = 0; i < 5; ++i) queue.push_back(i, row(i));
+        CHECK(queue.discard_all_but_latest() == 4);
+        REQUIRE(queue.try_pop_front(time, data, &pushTime));
+        CHECK(time == 4);
+        CHECK(data[0] == 4);
+        CHECK(pushTime >= before);
+        CHECK_FALSE(queue.try_pop_front(time, data));
+    }
+}
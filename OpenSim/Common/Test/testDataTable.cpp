@@ -21,6 +21,7 @@
  * limitations under the License.                                             *
  * -------------------------------------------------------------------------- */
 #include <iostream>
+#include <thread>
 
 #include <OpenSim/Auxiliary/auxiliaryTestFunctions.h>
 #define CATCH_CONFIG_MAIN
@@ -785,6 +786,74 @@ TEST_CASE("DataTable") {
     }
 }
 
+TEST_CASE("DataTable appendRow") {
+    // Rows are collected by appendRow() and moved into the matrix when the
+    // data is next accessed; all accessors must see the appended rows.
+    const int numColumns = 3;
+    TimeSeriesTable_<Vec3> table;
+    table.setColumnLabels({"a", "b", "c"});
+    auto value = [](int irow, int icol) {
+        return Vec3(irow, icol, irow * numColumns + icol);
+    };
+    auto appendRows = [&](int begin, int end) {
+        RowVector_<Vec3> row(numColumns);
+        for (int irow = begin; irow < end; ++irow) {
+            for (int icol = 0; icol < numColumns; ++icol)
+                row[icol] = value(irow, icol);
+            table.appendRow(0.01 * irow, row);
+        }
+    };
+
+    appendRows(0, 500);
+    CHECK(table.getNumRows() == 500);
+    CHECK(table.getNumColumns() == numColumns);
+    // A copy made before the rows are moved into the matrix has the rows.
+    const TimeSeriesTable_<Vec3> copy(table);
+    const auto column = copy.getDependentColumnAtIndex(1);
+    REQUIRE(column.size() == 500);
+    for (int irow = 0; irow < 500; ++irow)
+        CHECK(column[irow] == value(irow, 1));
+
+    // Interleave appending and accessing rows.
+    appendRows(500, 510);
+    CHECK(table.getRowAtIndex(505)[2] == value(505, 2));
+    appendRows(510, 1000);
+    CHECK(table.getNearestRow(9.99)[0] == value(999, 0));
+    CHECK(table.getMatrix().nrow() == 1000);
+    for (int irow = 0; irow < 1000; ++irow) {
+        for (int icol = 0; icol < numColumns; ++icol) {
+            CHECK(table.getMatrix().getElt(irow, icol) == value(irow, icol));
+        }
+    }
+    // Columns are contiguous.
+    const auto columnC = table.getDependentColumn("c");
+    CHECK(&columnC[999] == &columnC[0] + 999);
+
+    // Appended rows must have the same number of columns.
+    appendRows(1000, 1001);
+    CHECK_THROWS_AS(table.appendRow(20.0, RowVector_<Vec3>(2, Vec3(0))),
+            IncorrectNumColumns);
+    CHECK(table.getNumRows() == 1001);
+    CHECK(table.getIndependentColumn().back() == Approx(10.0));
+
+    // Threads that read the table at the same time all see the appended
+    // rows.
+    appendRows(1001, 2000);
+    const auto& constTable = table;
+    std::vector<int> numCorrect(4, 0);
+    std::vector<std::thread> threads;
+    for (int ithread = 0; ithread < 4; ++ithread) {
+        threads.emplace_back([&, ithread] {
+            for (int irow = 0; irow < 2000; ++irow) {
+                if (constTable.getRowAtIndex(irow)[1] == value(irow, 1))
+                    ++numCorrect[ithread];
+            }
+        });
+    }
+    for (auto& thread : threads) thread.join();
+    for (int n : numCorrect) CHECK(n == 2000);
+}
+
 TEST_CASE("TableUtilities::checkNonUniqueLabels") {
     CHECK_THROWS_AS(TableUtilities::checkNonUniqueLabels({"a", "a"}),
                     NonUniqueLabels);
@@ -861,6 +930,15 @@ TEST_CASE("TableUtilities::filterLowpass") {
     }
 }
 
+TEST_CASE("TableUtilities::filterLowpass with nonuniform times") {
+    // The table is resampled to the smallest time step before filtering.
+    TimeSeriesTable table(std::vector<double>{0, 0.5, 1, 1.25, 1.5, 2});
+    table.appendColumn("a", {1.0, 1.0, 1.0, 1.0, 1.0, 1.0});
+    TableUtilities::filterLowpass(table, 0.1);
+    REQUIRE(table.getNumRows() == 9);
+    CHECK(table.getIndependentColumn().back() == Approx(2.0));
+}
+
 TEST_CASE("TableUtilities::pad") {
     Storage sto("test.sto");
     TimeSeriesTable paddedTable = sto.exportToTable();
@@ -24,9 +24,14 @@
 #include "ComponentsForTesting.h"
 
 #include <OpenSim/Common/CommonUtilities.h>
+#include <OpenSim/Common/Constant.h>
+#include <OpenSim/Common/FunctionSet.h>
+#include <OpenSim/Common/GCVSpline.h>
 #include <OpenSim/Common/MultivariatePolynomialFunction.h>
+#include <OpenSim/Common/PiecewiseLinearFunction.h>
 #include <OpenSim/Common/Reporter.h>
 #include <OpenSim/Common/SignalGenerator.h>
+#include <OpenSim/Common/SimmSpline.h>
 #include <OpenSim/Common/Sine.h>
 
 #define CATCH_CONFIG_MAIN
@@ -153,6 +158,123 @@ TEST_CASE("MultivariatePolynomialFunction") {
     }
 }
 
+TEST_CASE("Function::calcValues") {
+    // Compare calcValues() to calcValue() and calcDerivative() at each point.
+    const auto checkCalcValues = [](const OpenSim::Function& f,
+            const SimTK::Vector& x, int maxDerivOrder) {
+        for (int d = 0; d <= maxDerivOrder; ++d) {
+            SimTK::Vector values;
+            f.calcValues(x, values, d);
+            REQUIRE(values.size() == x.size());
+            const std::vector<int> derivComponents(d, 0);
+            for (int i = 0; i < x.size(); ++i) {
+                const SimTK::Vector arg(1, x[i]);
+                const double expected = d == 0
+                        ? f.calcValue(arg)
+                        : f.calcDerivative(derivComponents, arg);
+                CHECK(values[i] == Approx(expected).margin(1e-10));
+            }
+        }
+    };
+
+    const int numKnots = 6;
+    const double knotsX[numKnots] = {0, 0.2, 0.3, 0.5, 0.8, 1};
+    const double knotsY[numKnots] = {0.1, 0.7, -0.3, 0.2, 0.9, 0.4};
+    // Sorted points (including knots), then unsorted points.
+    const SimTK::Vector x = createVector({0, 0.1, 0.2, 0.25, 0.3, 0.5, 0.55,
+            0.9, 1, 0.75, 0.05, 0.6, 0.3, 0.95});
+    // The same, with points outside of the range of the knots.
+    const SimTK::Vector xOutside = createVector({-0.5, -0.1, 0, 0.1, 0.25, 0.9,
+            1, 1.5, 0.4, -0.2, 2, 0.85});
+
+    SECTION("SimmSpline") {
+        SimmSpline f(numKnots, knotsX, knotsY);
+        checkCalcValues(f, x, 2);
+        checkCalcValues(f, xOutside, 2);
+    }
+    SECTION("PiecewiseLinearFunction") {
+        PiecewiseLinearFunction f(numKnots, knotsX, knotsY);
+        checkCalcValues(f, x, 2);
+        checkCalcValues(f, xOutside, 2);
+    }
+    SECTION("GCVSpline") {
+        GCVSpline f(5, numKnots, knotsX, knotsY);
+        checkCalcValues(f, x, 3);
+    }
+    SECTION("PolynomialFunction") {
+        PolynomialFunction f(createVector({2, -1, 0.5, 3}));
+        checkCalcValues(f, xOutside, 3);
+    }
+    SECTION("Constant") {
+        checkCalcValues(Constant(2.5), x, 1);
+    }
+    SECTION("MultivariatePolynomialFunction") {
+        MultivariatePolynomialFunction f(
+                createVector({1, -2, 0.5, 3, 0.25, -1}), 2, 2);
+        // Three points of two arguments each.
+        const SimTK::Vector points = createVector({0.3, 7.3, -1, 2, 0.5, 0.5});
+        SimTK::Vector values;
+        f.calcValues(points, values);
+        REQUIRE(values.size() == 3);
+        for (int i = 0; i < 3; ++i) {
+            const SimTK::Vector arg = points(2 * i, 2);
+            CHECK(values[i] == Approx(f.calcValue(arg)).margin(1e-10));
+        }
+        CHECK_THROWS_WITH(f.calcValues(points, values, 1),
+                Catch::Contains("functions of one argument"));
+        CHECK_THROWS_WITH(f.calcValues(createVector({0.3, 7.3, -1}), values),
+                Catch::Contains("multiple of the argument size"));
+    }
+    SECTION("Input errors") {
+        SimmSpline f(numKnots, knotsX, knotsY);
+        SimTK::Vector values;
+        CHECK_THROWS_WITH(f.calcValues(x, values, 3),
+                Catch::Contains("Expected derivOrder to be at most 2"));
+        CHECK_THROWS_WITH(f.calcValues(x, values, -1),
+                Catch::Contains("Expected derivOrder to be non-negative"));
+    }
+}
+
+TEST_CASE("FunctionSet::evaluate") {
+    const int numKnots = 3;
+    const double knotsX[numKnots] = {0, 0.5, 1};
+    const double knotsY[numKnots] = {1, -1, 2};
+    FunctionSet set;
+    set.adoptAndAppend(new SimmSpline(numKnots, knotsX, knotsY));
+    set.adoptAndAppend(new PiecewiseLinearFunction(numKnots, knotsX, knotsY));
+    set.adoptAndAppend(new Constant(3.0));
+
+    for (int d = 0; d <= 2; ++d) {
+        SimTK::Vector values;
+        set.evaluate(values, d, 0.35);
+        Array<double> arrayValues;
+        set.evaluate(arrayValues, d, 0.35);
+        REQUIRE(values.size() == set.getSize());
+        REQUIRE(arrayValues.getSize() == set.getSize());
+        for (int i = 0; i < set.getSize(); ++i) {
+            CHECK(values[i] == set.evaluate(i, d, 0.35));
+            CHECK(arrayValues[i] == values[i]);
+        }
+    }
+}
+
+TEST_CASE("findInterval()") {
+    const double knots[] = {0.0, 1.0, 2.0, 4.0, 8.0};
+    const int n = 5;
+    // Without a hint, and with a hint that is wrong or out of range, the
+    // interval is found by binary search.
+    for (int hint : {-1, 0, 3, 4, 10}) {
+        CHECK(findInterval(knots, n, 0.5, hint) == 0);
+        CHECK(findInterval(knots, n, 3.0, hint) == 2);
+        CHECK(findInterval(knots, n, 7.9, hint) == 3);
+    }
+    // The hint and the interval after it are checked first.
+    CHECK(findInterval(knots, n, 1.5, 1) == 1);
+    CHECK(findInterval(knots, n, 2.5, 1) == 2);
+    CHECK(findInterval(knots, n, 1.0, 1) == 1);
+    CHECK(findInterval(knots, n, 1.0, 0) == 0);
+}
+
 TEST_CASE("solveBisection()") {
 
     auto calcResidual = [](const SimTK::Real& x) { return x - 3.78; };
@@ -82,6 +82,37 @@ int main() {
                 SimTK::Eps, __FILE__, __LINE__,
                 "Duplicate GCVSpline failed to reproduce identical first derivative.");
         }
+
+        // Evaluating many values at once gives the same values and
+        // derivatives, for sorted and unsorted values.
+        SimTK::Vector times(3*(size-1) + 1);
+        for (int i = 0; i < times.size(); ++i) {
+            times[i] = dt / 3 * i;
+        }
+        SimTK::Vector unsortedTimes(times.size());
+        for (int i = 0; i < times.size(); ++i) {
+            unsortedTimes[i] = times[(7*i) % times.size()];
+        }
+        for (const SimTK::Vector& ts : {times, unsortedTimes}) {
+            for (int d = 0; d <= 2; ++d) {
+                SimTK::Vector values;
+                spline.calcValues(ts, values, d);
+                ASSERT(values.size() == ts.size());
+                const std::vector<int> derivs(d, 0);
+                for (int i = 0; i < ts.size(); ++i) {
+                    t[0] = ts[i];
+                    const double expected = d == 0 ? spline.calcValue(t)
+                            : spline.calcDerivative(derivs, t);
+                    ASSERT_EQUAL(expected, values[i],
+                        1e-10 * std::pow(omega, d), __FILE__, __LINE__,
+                        "GCVSpline::calcValues() differs from "
+                        "calcValue()/calcDerivative().");
+                }
+            }
+        }
+        SimTK::Vector values;
+        ASSERT_THROW(Exception, spline.calcValues(times, values, -1));
+        cout << "GCVSpline successfully evaluated many values at once." << endl;
     }
     catch(const Exception& e) {
         e.print(cerr);
@@ -0,0 +1,130 @@
+/* -------------------------------------------------------------------------- *
+ *                      OpenSim:  testSPSCRingBuffer.cpp                      *
+ * -------------------------------------------------------------------------- *
+ * The OpenSim API is a toolkit for musculoskeletal modeling and simulation.  *
+ * See http://opensim.stanford.edu and the NOTICE file for more information.  *
+ * OpenSim is developed at Stanford University and supported by the US        *
+ * National Institutes of Health (U54 GM072970, R24 HD065690) and by DARPA    *
+ * through the Warrior Web program.                                           *
+ *                                                                            *
+ * Copyright (c) 2005-2021 Stanford University and the Authors                *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+
+#include <OpenSim/Common/SPSCRingBuffer.h>
+#include <SimTKcommon/internal/BigMatrix.h>
+#include <thread>
+
+#define CATCH_CONFIG_MAIN
+#include <OpenSim/Auxiliary/catch.hpp>
+
+using namespace OpenSim;
+
+TEST_CASE("SPSCRingBuffer_ push and pop") {
+    SPSCRingBuffer_<int> buffer(3);
+    CHECK(buffer.getCapacity() == 3);
+    CHECK(buffer.isEmpty());
+
+    int value = -1;
+    CHECK_FALSE(buffer.tryPop(value));
+    CHECK(value == -1);
+
+    CHECK(buffer.tryPush(1));
+    CHECK(buffer.tryPush(2));
+    CHECK(buffer.tryPush(3));
+    CHECK(buffer.size() == 3);
+    // The buffer is full, so the newest entry is rejected.
+    CHECK_FALSE(buffer.tryPush(4));
+
+    CHECK(buffer.tryPop(value));
+    CHECK(value == 1);
+    CHECK(buffer.tryPush(4));
+
+    // Wrap around the end of the slots several times.
+    for (int expected = 2; expected < 20; ++expected) {
+        CHECK(buffer.tryPop(value));
+        CHECK(value == expected);
+        CHECK(buffer.tryPush(expected + 3));
+    }
+    CHECK(buffer.size() == 3);
+}
+
+TEST_CASE("SPSCRingBuffer_ latest entry") {
+    SPSCRingBuffer_<int> buffer(4);
+    int value = -1;
+    std::size_t numDiscarded = 99;
+    CHECK_FALSE(buffer.tryPopLatest(value, numDiscarded));
+    CHECK(numDiscarded == 0);
+    CHECK(buffer.discardAllButLatest() == 0);
+
+    // Put the entries across the end of the slots.
+    for (int i = 0; i < 3; ++i) {
+        buffer.tryPush(i);
+        buffer.tryPop(value);
+    }
+    for (int i = 10; i < 14; ++i) CHECK(buffer.tryPush(i));
+
+    SECTION("tryPopLatest") {
+        CHECK(buffer.tryPopLatest(value, numDiscarded));
+        CHECK(value == 13);
+        CHECK(numDiscarded == 3);
+        CHECK(buffer.isEmpty());
+    }
+    SECTION("discardAllButLatest") {
+        CHECK(buffer.discardAllButLatest() == 3);
+        CHECK(buffer.size() == 1);
+        CHECK(buffer.tryPop(value));
+        CHECK(value == 13);
+        CHECK(buffer.isEmpty());
+    }
+}
+
+TEST_CASE("SPSCRingBuffer_ uses the prototype for its slots") {
+    SPSCRingBuffer_<SimTK::Vector> buffer(2, SimTK::Vector(3, 0.0));
+    SimTK::Vector value(3, 0.0);
+    CHECK(buffer.tryPush(SimTK::Vector(3, 1.5)));
+    CHECK(buffer.tryPop(value));
+    CHECK(value.size() == 3);
+    CHECK(value[2] == 1.5);
+}
+
+TEST_CASE("SPSCRingBuffer_ invalid capacity") {
+    CHECK_THROWS_AS(SPSCRingBuffer_<int>(0), Exception);
+}
+
+TEST_CASE("SPSCRingBuffer_ producer and consumer threads") {
+    const int numValues = 100000;
+    SPSCRingBuffer_<int> buffer(16);
+
+    std::thread producer([&]() {
+        for (int i = 0; i < numValues; ++i) {
+            while (!buffer.tryPush(i)) std::this_thread::yield();
+        }
+    });
+
+    // Every value arrives exactly once and in order.
+    int expected = 0;
+    bool inOrder = true;
+    while (expected < numValues) {
+        int value;
+        if (buffer.tryPop(value)) {
+            inOrder = inOrder && value == expected;
+            ++expected;
+        } else {
+            std::this_thread::yield();
+        }
+    }
+    producer.join();
+    CHECK(inOrder);
+    CHECK(buffer.isEmpty());
+}
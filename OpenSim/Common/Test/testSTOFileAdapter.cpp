@@ -353,3 +353,54 @@ TEST_CASE("Trimming whitespace in metadata values") {
 
 
 
+
+TEST_CASE("Parsing rows of doubles in place") {
+    const std::string filename = "testing_parse_in_place.sto";
+    {
+        // CRLF line endings, whitespace around numbers, a trailing delimiter,
+        // a row without a newline, and special values.
+        std::ofstream file(filename, std::ios::binary);
+        file << "parse_in_place\r\nversion=1\r\nnRows=3\r\nnColumns=3\r\n"
+             << "inDegrees=no\r\nendheader\r\n"
+             << "time\ta\tb\r\n"
+             << "0.0\t1.5\t-2e-3\r\n"
+             << " 0.5 \t nan\t1e300\t\r\n"
+             << "1.0\t-inf\t3";
+    }
+    TimeSeriesTable table(filename);
+    REQUIRE(table.getNumRows() == 3);
+    REQUIRE(table.getNumColumns() == 2);
+    CHECK(table.getColumnLabels() == std::vector<std::string>{"a", "b"});
+    CHECK(table.getIndependentColumn() == std::vector<double>{0, 0.5, 1});
+    CHECK(table.getMatrix()(0, 0) == 1.5);
+    CHECK(table.getMatrix()(0, 1) == -2e-3);
+    CHECK(SimTK::isNaN(table.getMatrix()(1, 0)));
+    CHECK(table.getMatrix()(1, 1) == 1e300);
+    CHECK(table.getMatrix()(2, 0) == -SimTK::Infinity);
+    CHECK(table.getMatrix()(2, 1) == 3);
+    CHECK(table.getTableMetaDataAsString("inDegrees") == "no");
+
+    // An empty line ends the data.
+    {
+        std::ofstream file(filename);
+        file << "endheader\ntime\ta\n0\t1\n1\t2\n\n2\t3\n";
+    }
+    CHECK(TimeSeriesTable(filename).getNumRows() == 2);
+
+    // Rows with the wrong number of columns or with invalid numbers.
+    {
+        std::ofstream file(filename);
+        file << "endheader\ntime\ta\tb\n0\t1\t2\n1\t2\n";
+    }
+    CHECK_THROWS_AS(TimeSeriesTable(filename), RowLengthMismatch);
+    {
+        std::ofstream file(filename);
+        file << "endheader\ntime\ta\tb\n0\t1\t\t2\n";
+    }
+    CHECK_THROWS_AS(TimeSeriesTable(filename), std::invalid_argument);
+    {
+        std::ofstream file(filename);
+        file << "endheader\ntime\ta\n0\tabc\n";
+    }
+    CHECK_THROWS_AS(TimeSeriesTable(filename), std::invalid_argument);
+}
@@ -1132,6 +1132,53 @@ void testMonotonicity(SimTK::Matrix mcfSample)
     cout << endl;
 }
 
+/*
+ 5. The lookup table of a MuscleCurveFunction will be tested against the
+    curve it approximates: the value, first and second derivatives must agree
+    to within the requested tolerance, relative to the largest magnitude of
+    each, across the domain of the curve and in the linear extrapolation.
+*/
+void testLookupTable(const SmoothSegmentedFunction& mcf, double tol)
+{
+    cout << "   TEST: Lookup table " << endl;
+    SmoothSegmentedFunction table(mcf);
+    SimTK_TEST(!table.isLookupTableAvailable());
+    SimTK_TEST(table.buildLookupTable(tol));
+    SimTK_TEST(table.isLookupTableAvailable());
+
+    SimTK::Vec2 domain = mcf.getCurveDomain();
+    double range = domain(1) - domain(0);
+    int numPts = 2000;
+    SimTK::Vec3 maxMag(1.0);
+    SimTK::Vec3 maxErr(0.0);
+    for(int i=0; i<=numPts; i++){
+        double x = domain(0) - 0.1*range + 1.2*range*i/numPts;
+        for(int order=0; order<=2; order++){
+            double exact = order == 0 ? mcf.calcValue(x)
+                                      : mcf.calcDerivative(x,order);
+            double approx = order == 0 ? table.calcValue(x)
+                                       : table.calcDerivative(x,order);
+            maxMag(order) = max(maxMag(order), abs(exact));
+            maxErr(order) = max(maxErr(order), abs(approx-exact));
+        }
+    }
+    // The table checks its error at a few points per interval only, so
+    // allow a small margin at the points in between.
+    for(int order=0; order<=2; order++){
+        SimTK_TEST(maxErr(order) <= 2*tol*maxMag(order));
+    }
+
+    table.clearLookupTable();
+    SimTK_TEST(!table.isLookupTableAvailable());
+    double xMid = 0.5*(domain(0)+domain(1));
+    SimTK_TEST_EQ_TOL(table.calcValue(xMid), mcf.calcValue(xMid), 1e-12);
+
+    printf("   passed: lookup table agrees with the curve to %e\n"
+           "           (relative errors %e, %e and %e)\n",
+           tol, maxErr(0)/maxMag(0), maxErr(1)/maxMag(1), maxErr(2)/maxMag(2));
+    cout << endl;
+}
+
 //______________________________________________________________________________
 /**
  * Create a muscle bench marking system. The bench mark consists of a single muscle 
@@ -1219,6 +1266,8 @@ int main(int argc, char* argv[])
             testMuscleCurveC2Continuity(tendonCurve,tendonCurveSample);
         //4. Test for monotonicity where appropriate
             testMonotonicity(tendonCurveSample);
+        //Test the lookup table used by Millard2012EquilibriumMuscle
+            testLookupTable(tendonCurve,1e-8);
 
         //5. Testing Exceptions
             cout << endl;
@@ -1289,6 +1338,8 @@ int main(int argc, char* argv[])
         //4. Test for monotonicity where appropriate
 
             testMonotonicity(fiberFLCurveSample);
+        //Test the lookup table used by Millard2012EquilibriumMuscle
+            testLookupTable(fiberFLCurve,1e-8);
 
         //5. Testing Exceptions
             cout << endl;
@@ -1585,6 +1636,8 @@ int main(int argc, char* argv[])
         //4. Test for monotonicity where appropriate
 
             testMonotonicity(fiberFVCurveSample);
+        //Test the lookup table used by Millard2012EquilibriumMuscle
+            testLookupTable(fiberFVCurve,1e-8);
         //5. Exception testing
             cout << endl;    
             cout << "   Exception Testing" << endl;
@@ -1696,6 +1749,8 @@ int main(int argc, char* argv[])
         //4. Test for monotonicity where appropriate
 
             testMonotonicity(fiberFVInvCurveSample);
+        //Test the lookup table used by Millard2012EquilibriumMuscle
+            testLookupTable(fiberFVInvCurve,1e-8);
 
         //5. Testing the exceptions
 
@@ -1842,6 +1897,8 @@ int main(int argc, char* argv[])
 
         //3. Test numerically to see if the curve is C2 continuous
             testMuscleCurveC2Continuity(fiberfalCurve,fiberfalCurveSample);
+        //Test the lookup table used by Millard2012EquilibriumMuscle
+            testLookupTable(fiberfalCurve,1e-8);
 
             //fiberfalCurve.MuscleCurveToCSVFile("C:/mjhmilla/Stanford/dev");
        
@@ -20,6 +20,7 @@
  * limitations under the License.                                             *
  * -------------------------------------------------------------------------- */
 
+#include <algorithm>
 #include <fstream>
 #include <OpenSim/Common/Storage.h>
 #include <OpenSim/Auxiliary/auxiliaryTestFunctions.h>
@@ -170,6 +171,67 @@ void testStorageGetStateIndexBackwardsCompatibility() {
     // TODO: Put XML document version in Storage header.
 }
 
+void testStorageAppendAndFindIndex() {
+    // Rows appended one at a time are stored correctly when the Storage
+    // grows, and lookups by time agree with a linear search.
+    Storage sto(2);
+    const int numRows = 1000;
+    for (int i = 0; i < numRows; ++i) {
+        // Every fifth time is repeated in the next row.
+        const double time = 0.01 * (i - i / 5);
+        const double data[] = {(double)i, 2.0 * i, 3.0 * i};
+        sto.append(time, 3, data, false);
+    }
+    ASSERT(sto.getSize() == numRows);
+    for (int i = 0; i < numRows; ++i) {
+        double value;
+        sto.getData(i, 2, value);
+        ASSERT_EQUAL<double>(3.0 * i, value, 0);
+    }
+
+    for (int k = -10; k < 900; ++k) {
+        const double time = 0.00999 * k;
+        int expected = 0;
+        for (int i = 0; i < numRows; ++i) {
+            if (time < sto.getStateVector(i)->getTime()) break;
+            expected = i;
+        }
+        ASSERT(sto.findIndex(time) == expected);
+        // Lookups that start at a later or an earlier index.
+        ASSERT(sto.findIndex(numRows / 2, time) == expected);
+        ASSERT(sto.findIndex(std::max(expected - 1, 0), time) == expected);
+    }
+
+    // Linear interpolation between rows.
+    Array<double> data(0.0, 3);
+    sto.getDataAtTime(0.005, 3, data);
+    ASSERT_EQUAL<double>(0.5, data[0], 1e-12);
+    ASSERT_EQUAL<double>(1.5, data[2], 1e-12);
+
+    // Appending with the same time as the last row replaces the last row.
+    const double last[] = {-1, -2, -3};
+    const double lastTime = sto.getLastTime();
+    sto.append(lastTime, 3, last);
+    ASSERT(sto.getSize() == numRows);
+    double value;
+    sto.getData(numRows - 1, 1, value);
+    ASSERT_EQUAL<double>(-2, value, 0);
+
+    // Interpolating at new times inserts rows in order.
+    Array<double> times;
+    times.append(0.015);
+    times.append(0.025);
+    sto.interpolateAt(times);
+    ASSERT(sto.getSize() == numRows + 2);
+    ASSERT(sto.findIndex(0.015) == 2);
+    sto.getData(2, 0, value);
+    ASSERT_EQUAL<double>(1.5, value, 1e-12);
+    for (int i = 1; i < sto.getSize(); ++i) {
+        ASSERT(sto.getStateVector(i - 1)->getTime() <=
+               sto.getStateVector(i)->getTime());
+    }
+}
+
 int main() {
     SimTK_START_TEST("testStorage");
 
@@ -194,6 +256,8 @@ int main() {
         SimTK_SUBTEST(testStorageLegacy);
 
         SimTK_SUBTEST(testStorageGetStateIndexBackwardsCompatibility);
+
+        SimTK_SUBTEST(testStorageAppendAndFindIndex);
     SimTK_END_TEST();
 }
 
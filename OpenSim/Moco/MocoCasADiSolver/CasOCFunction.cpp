@@ -20,6 +20,20 @@
 
 #include "CasOCProblem.h"
 
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <limits>
+#include <numeric>
+#include <sstream>
+#include <thread>
+#ifdef _WIN32
+    #include <process.h>
+#else
+    #include <unistd.h>
+#endif
+
 using namespace CasOC;
 
 casadi::Sparsity calcJacobianSparsityWithPerturbation(const VectorDM& x0s,
@@ -73,10 +87,138 @@ casadi::Sparsity calcJacobianSparsityWithPerturbation(const VectorDM& x0s,
     return combinedSparsity;
 }
 
+/// Read a sparsity pattern written by writeSparsity(). This returns false if
+/// the file does not exist or does not contain a pattern with the expected
+/// dimensions, in which case the caller should detect the sparsity instead.
+bool readSparsity(const std::string& fileName, casadi_int expectedNumRows,
+        casadi_int expectedNumCols, casadi::Sparsity& sparsity) {
+    std::ifstream file(fileName);
+    if (!file) return false;
+    auto ignoreFile = [&fileName]() {
+        std::cout << "[CasOC] Ignoring invalid sparsity cache file '"
+                  << fileName << "'." << std::endl;
+        return false;
+    };
+    casadi_int numRows, numCols, numNonzeros;
+    if (!(file >> numRows >> numCols >> numNonzeros)) return ignoreFile();
+    if (numRows != expectedNumRows || numCols != expectedNumCols ||
+            numNonzeros < 0) {
+        return ignoreFile();
+    }
+    std::vector<casadi_int> rows(numNonzeros);
+    std::vector<casadi_int> cols(numNonzeros);
+    for (casadi_int k = 0; k < numNonzeros; ++k) {
+        if (!(file >> rows[k] >> cols[k])) return ignoreFile();
+        if (rows[k] < 0 || rows[k] >= numRows || cols[k] < 0 ||
+                cols[k] >= numCols) {
+            return ignoreFile();
+        }
+    }
+    sparsity = casadi::Sparsity::triplet(numRows, numCols, rows, cols);
+    std::cout << "[CasOC] Read sparsity cache file '" << fileName << "'."
+              << std::endl;
+    return true;
+}
+
+/// Write the dimensions and the (row, column) indices of the nonzeros of
+/// `sparsity` to a text file. We write to a temporary file first so that
+/// other processes using the same cache never read a partial file. The name
+/// of the temporary file contains the process and thread IDs, so that
+/// processes (or threads) writing the same cache file at the same time do
+/// not write to the same temporary file.
+void writeSparsity(const std::string& fileName,
+        const casadi::Sparsity& sparsity) {
+    std::vector<casadi_int> rows, cols;
+    sparsity.get_triplet(rows, cols);
+    std::ostringstream tempFileName;
+#ifdef _WIN32
+    tempFileName << fileName << "." << _getpid();
+#else
+    tempFileName << fileName << "." << getpid();
+#endif
+    tempFileName << "." << std::this_thread::get_id() << ".tmp";
+    auto warn = [&fileName]() {
+        std::cout << "[CasOC] Warning: could not write sparsity cache file '"
+                  << fileName << "'." << std::endl;
+    };
+    {
+        std::ofstream file(tempFileName.str());
+        if (!file) return warn();
+        file << sparsity.size1() << " " << sparsity.size2() << " "
+             << rows.size() << "\n";
+        for (std::size_t k = 0; k < rows.size(); ++k) {
+            file << rows[k] << " " << cols[k] << "\n";
+        }
+        file.close();
+        if (!file) {
+            std::remove(tempFileName.str().c_str());
+            return warn();
+        }
+    }
+    // If another process wrote the cache file first, std::rename() may fail
+    // (e.g., on Windows); the existing file has the same pattern.
+    if (std::rename(tempFileName.str().c_str(), fileName.c_str()) != 0) {
+        std::remove(tempFileName.str().c_str());
+        return warn();
+    }
+    std::cout << "[CasOC] Wrote sparsity cache file '" << fileName << "'."
+              << std::endl;
+}
+
+JacobianColoring::JacobianColoring(const casadi::Sparsity& sparsity)
+        : m_sparsity(sparsity), m_colors(sparsity.size2(), -1) {
+    const auto numCols = (int)sparsity.size2();
+    const auto colind = sparsity.get_colind();
+    const auto row = sparsity.get_row();
+    // The transpose gives us the columns with a nonzero in each row.
+    const auto transpose = sparsity.T();
+    const auto rowind = transpose.get_colind();
+    const auto col = transpose.get_row();
+
+    // Columns with many nonzeros are the most constrained, so we color them
+    // first.
+    std::vector<int> order(numCols);
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&](int a, int b) {
+        return colind[a + 1] - colind[a] > colind[b + 1] - colind[b];
+    });
+
+    // forbidden[c] == j means color c is used by a column that shares a row
+    // with column j.
+    std::vector<int> forbidden(numCols, -1);
+    for (const int j : order) {
+        for (auto k = colind[j]; k < colind[j + 1]; ++k) {
+            const auto i = row[k];
+            for (auto l = rowind[i]; l < rowind[i + 1]; ++l) {
+                const int color = m_colors[col[l]];
+                if (color >= 0) forbidden[color] = j;
+            }
+        }
+        int color = 0;
+        while (forbidden[color] == j) ++color;
+        m_colors[j] = color;
+        m_numColors = std::max(m_numColors, color + 1);
+    }
+}
+
 casadi::Sparsity Function::get_jacobian_sparsity() const {
     using casadi::DM;
     using casadi::Slice;
 
+    if (m_jacobianSparsity) return *m_jacobianSparsity;
+
+    std::string cacheFile;
+    if (!m_casProblem->getSparsityCachePrefix().empty()) {
+        cacheFile = m_casProblem->getSparsityCachePrefix() + "_" + name() +
+                    ".sparsity";
+        casadi::Sparsity cached;
+        if (readSparsity(cacheFile, nnz_out(), nnz_in(), cached)) {
+            m_jacobianSparsity =
+                    OpenSim::make_unique<casadi::Sparsity>(cached);
+            return *m_jacobianSparsity;
+        }
+    }
+
     auto function = [this](const casadi::DM& x, casadi::DM& y) {
         // Split input into separate DMs.
         std::vector<casadi::DM> in(this->n_in());
@@ -100,8 +242,276 @@ casadi::Sparsity Function::get_jacobian_sparsity() const {
 
     const VectorDM x0s = getSubsetPointsForSparsityDetection();
 
-    return calcJacobianSparsityWithPerturbation(
-            x0s, (int)this->nnz_out(), function);
+    m_jacobianSparsity = OpenSim::make_unique<casadi::Sparsity>(
+            calcJacobianSparsityWithPerturbation(
+                    x0s, (int)this->nnz_out(), function));
+    if (!cacheFile.empty()) writeSparsity(cacheFile, *m_jacobianSparsity);
+    return *m_jacobianSparsity;
+}
+
+bool Function::has_forward(casadi_int) const {
+    return m_casProblem->getFiniteDifferenceColoring() &&
+           has_jacobian_sparsity();
+}
+
+casadi::Function Function::get_forward(casadi_int nfwd,
+        const std::string& name, const std::vector<std::string>& inames,
+        const std::vector<std::string>& onames,
+        const casadi::Dict& opts) const {
+    auto forward = OpenSim::make_unique<FiniteDifferenceForward>();
+    forward->constructFunction(*this, (int)nfwd, name, inames, onames, opts);
+    casadi::Function out = *forward;
+    m_forwardFunctions.push_back(std::move(forward));
+    return out;
+}
+
+const JacobianColoring& Function::getJacobianColoring() const {
+    if (!m_jacobianColoring) {
+        m_jacobianColoring = OpenSim::make_unique<JacobianColoring>(
+                get_jacobian_sparsity());
+    }
+    return *m_jacobianColoring;
+}
+
+void Function::evalConcatenated(
+        const std::vector<double>& x, std::vector<double>& y) const {
+    VectorDM in(n_in());
+    auto xit = x.begin();
+    for (int iin = 0; iin < (int)in.size(); ++iin) {
+        const auto& sparsity = sparsity_in(iin);
+        in[iin] = casadi::DM(sparsity,
+                std::vector<double>(xit, xit + sparsity.nnz()));
+        xit += sparsity.nnz();
+    }
+    const VectorDM out = eval(in);
+    y.clear();
+    for (const auto& output : out) {
+        const auto& nonzeros = output.nonzeros();
+        y.insert(y.end(), nonzeros.begin(), nonzeros.end());
+    }
+}
+
+namespace {
+/// The relative step size that balances truncation and round-off error.
+double calcFiniteDifferenceStep(const std::string& scheme) {
+    const double eps = std::numeric_limits<double>::epsilon();
+    return scheme == "central" ? std::cbrt(eps) : std::sqrt(eps);
+}
+
+/// Perturb each variable ix by steps[ix] * direction[ix] and store in `diff`
+/// the difference of the outputs: f(x0 + dx) - f(x0 - dx) (central),
+/// f(x0 + dx) - y0 (forward), or y0 - f(x0 - dx) (backward).
+void calcFiniteDifference(const FiniteDifferenceFunction& function,
+        const std::string& scheme, const std::vector<double>& x0,
+        const std::vector<double>& y0, const std::vector<double>& direction,
+        const std::vector<double>& steps, std::vector<double>& diff) {
+    const auto numX = x0.size();
+    std::vector<double> x(numX);
+    std::vector<double> yPlus;
+    std::vector<double> yMinus;
+    if (scheme == "backward") {
+        yPlus = y0;
+    } else {
+        for (std::size_t ix = 0; ix < numX; ++ix) {
+            x[ix] = x0[ix] + steps[ix] * direction[ix];
+        }
+        function(x, yPlus);
+    }
+    if (scheme == "forward") {
+        yMinus = y0;
+    } else {
+        for (std::size_t ix = 0; ix < numX; ++ix) {
+            x[ix] = x0[ix] - steps[ix] * direction[ix];
+        }
+        function(x, yMinus);
+    }
+    diff.resize(y0.size());
+    for (std::size_t iy = 0; iy < y0.size(); ++iy) {
+        diff[iy] = yPlus[iy] - yMinus[iy];
+    }
+}
+} // anonymous namespace
+
+std::vector<double> CasOC::calcFiniteDifferenceJacobian(
+        const FiniteDifferenceFunction& function,
+        const JacobianColoring& coloring, const std::string& scheme,
+        const std::vector<double>& x0, const std::vector<double>& y0) {
+    const auto& sparsity = coloring.getSparsity();
+    const auto colind = sparsity.get_colind();
+    const auto row = sparsity.get_row();
+    const auto& colors = coloring.getColors();
+    const auto numX = (int)x0.size();
+    OPENSIM_THROW_IF(numX != sparsity.size2() || (casadi_int)y0.size() !=
+                sparsity.size1(), OpenSim::Exception,
+            "Expected {} inputs and {} outputs, but got {} and {}.",
+            sparsity.size2(), sparsity.size1(), numX, y0.size());
+
+    // Steps relative to the magnitude of each variable, so that the
+    // perturbation is not lost to round-off for large variables.
+    const double h = calcFiniteDifferenceStep(scheme);
+    std::vector<double> steps(numX);
+    for (int ix = 0; ix < numX; ++ix) {
+        steps[ix] = h * std::max(1.0, std::abs(x0[ix]));
+    }
+    const double factor = scheme == "central" ? 2 : 1;
+
+    std::vector<double> jacobian(sparsity.nnz());
+    std::vector<double> direction(numX);
+    std::vector<double> diff;
+    for (int color = 0; color < coloring.getNumColors(); ++color) {
+        for (int ix = 0; ix < numX; ++ix) {
+            direction[ix] = colors[ix] == color ? 1.0 : 0.0;
+        }
+        calcFiniteDifference(function, scheme, x0, y0, direction, steps, diff);
+        // Each row depends on at most one column of this color.
+        for (int ix = 0; ix < numX; ++ix) {
+            if (colors[ix] != color) continue;
+            for (auto k = colind[ix]; k < colind[ix + 1]; ++k) {
+                jacobian[k] = diff[row[k]] / (factor * steps[ix]);
+            }
+        }
+    }
+    return jacobian;
+}
+
+void FiniteDifferenceForward::constructFunction(const Function& function,
+        int numDirections, const std::string& name,
+        const std::vector<std::string>& inames,
+        const std::vector<std::string>& onames, casadi::Dict opts) {
+    m_function = &function;
+    m_numDirections = numDirections;
+    m_inames = inames;
+    m_onames = onames;
+    // Higher-order derivatives (e.g., for an exact Hessian) use CasADi's
+    // finite differences.
+    opts["enable_fd"] = true;
+    opts["fd_method"] = function.getFiniteDifferenceScheme();
+    this->construct(name, opts);
+}
+
+casadi_int FiniteDifferenceForward::get_n_in() {
+    return 2 * m_function->n_in() + m_function->n_out();
+}
+
+casadi::Sparsity FiniteDifferenceForward::get_sparsity_in(casadi_int i) {
+    const auto numIn = m_function->n_in();
+    const auto numOut = m_function->n_out();
+    if (i < numIn) return m_function->sparsity_in(i);
+    if (i < numIn + numOut) return m_function->sparsity_out(i - numIn);
+    return casadi::Sparsity::repmat(
+            m_function->sparsity_in(i - numIn - numOut), 1, m_numDirections);
+}
+
+casadi::Sparsity FiniteDifferenceForward::get_sparsity_out(casadi_int i) {
+    return casadi::Sparsity::repmat(
+            m_function->sparsity_out(i), 1, m_numDirections);
+}
+
+VectorDM FiniteDifferenceForward::eval(const VectorDM& args) const {
+    const auto numIn = (int)m_function->n_in();
+    const auto numOut = (int)m_function->n_out();
+    const auto numX = (int)m_function->nnz_in();
+    const auto numY = (int)m_function->nnz_out();
+    const int numDir = m_numDirections;
+
+    // Concatenate the nominal inputs, the nominal outputs, and the seeds.
+    // The nonzeros of each seed are stored direction by direction.
+    std::vector<double> x0;
+    x0.reserve(numX);
+    for (int iin = 0; iin < numIn; ++iin) {
+        const auto& nonzeros = args[iin].nonzeros();
+        x0.insert(x0.end(), nonzeros.begin(), nonzeros.end());
+    }
+    std::vector<double> y0;
+    y0.reserve(numY);
+    for (int iout = 0; iout < numOut; ++iout) {
+        const auto& nonzeros = args[numIn + iout].nonzeros();
+        y0.insert(y0.end(), nonzeros.begin(), nonzeros.end());
+    }
+    // seeds[idir * numX + ix].
+    std::vector<double> seeds(numDir * numX);
+    {
+        int offset = 0;
+        for (int iin = 0; iin < numIn; ++iin) {
+            const auto& nonzeros = args[numIn + numOut + iin].nonzeros();
+            const auto nnz = (int)m_function->nnz_in(iin);
+            for (int idir = 0; idir < numDir; ++idir) {
+                std::copy_n(nonzeros.begin() + idir * nnz, nnz,
+                        seeds.begin() + idir * numX + offset);
+            }
+            offset += nnz;
+        }
+    }
+
+    const FiniteDifferenceFunction function =
+            [this](const std::vector<double>& x, std::vector<double>& y) {
+                m_function->evalConcatenated(x, y);
+            };
+    const std::string& scheme = m_function->getFiniteDifferenceScheme();
+
+    // sensitivities[idir * numY + iy].
+    std::vector<double> sensitivities(numDir * numY, 0);
+    const auto& coloring = m_function->getJacobianColoring();
+    if (coloring.getNumColors() < numDir) {
+        // Compute the sparse Jacobian with one perturbation per color, then
+        // multiply the Jacobian by the seeds.
+        const auto& sparsity = coloring.getSparsity();
+        const auto colind = sparsity.get_colind();
+        const auto row = sparsity.get_row();
+        const std::vector<double> jacobian = calcFiniteDifferenceJacobian(
+                function, coloring, scheme, x0, y0);
+        for (int idir = 0; idir < numDir; ++idir) {
+            for (int ix = 0; ix < numX; ++ix) {
+                const double seed = seeds[idir * numX + ix];
+                if (seed == 0) continue;
+                for (auto k = colind[ix]; k < colind[ix + 1]; ++k) {
+                    sensitivities[idir * numY + row[k]] += jacobian[k] * seed;
+                }
+            }
+        }
+    } else {
+        // Perturb along each seed. As for the Jacobian, the step is relative
+        // to the magnitude of the perturbed variables, and the largest
+        // component of the seed is perturbed by that step.
+        const double h = calcFiniteDifferenceStep(scheme);
+        std::vector<double> direction(numX);
+        std::vector<double> steps(numX);
+        std::vector<double> diff;
+        for (int idir = 0; idir < numDir; ++idir) {
+            std::copy_n(seeds.begin() + idir * numX, numX, direction.begin());
+            double maxSeed = 0;
+            double maxX = 1;
+            for (int ix = 0; ix < numX; ++ix) {
+                if (direction[ix] == 0) continue;
+                maxSeed = std::max(maxSeed, std::abs(direction[ix]));
+                maxX = std::max(maxX, std::abs(x0[ix]));
+            }
+            if (maxSeed == 0) continue;
+            const double step = h * maxX / maxSeed;
+            std::fill(steps.begin(), steps.end(), step);
+            calcFiniteDifference(
+                    function, scheme, x0, y0, direction, steps, diff);
+            const double denom = scheme == "central" ? 2 * step : step;
+            for (int iy = 0; iy < numY; ++iy) {
+                sensitivities[idir * numY + iy] = diff[iy] / denom;
+            }
+        }
+    }
+
+    // Split the sensitivities into the outputs.
+    VectorDM out(numOut);
+    int offset = 0;
+    for (int iout = 0; iout < numOut; ++iout) {
+        const auto nnz = (int)m_function->nnz_out(iout);
+        std::vector<double> nonzeros(numDir * nnz);
+        for (int idir = 0; idir < numDir; ++idir) {
+            std::copy_n(sensitivities.begin() + idir * numY + offset, nnz,
+                    nonzeros.begin() + idir * nnz);
+        }
+        out[iout] = casadi::DM(sparsity_out(iout), nonzeros);
+        offset += nnz;
+    }
+    return out;
 }
 
 void Function::constructFunction(const Problem* casProblem,
@@ -205,6 +615,124 @@ VectorDM EndpointConstraint::eval(const VectorDM& args) const {
     return out;
 }
 
+void MultibodySystemBatch::constructFunction(const Problem* casProblem,
+        const std::string& name, const Function& pointFunction,
+        int numPoints) {
+    OPENSIM_THROW_IF(numPoints < 1, OpenSim::Exception,
+            "Expected numPoints >= 1 but got {}.", numPoints);
+    m_pointFunction = &pointFunction;
+    m_numPoints = numPoints;
+    // The Jacobian sparsity is obtained from the point function, so we do
+    // not need our own points for sparsity detection.
+    Function::constructFunction(casProblem, name,
+            pointFunction.getFiniteDifferenceScheme(),
+            std::make_shared<const std::vector<VariablesDM>>());
+}
+
+casadi::Sparsity MultibodySystemBatch::get_sparsity_in(casadi_int i) {
+    const auto pointSparsity = Function::get_sparsity_in(i);
+    return casadi::Sparsity::dense(pointSparsity.size1(), m_numPoints);
+}
+
+casadi::Sparsity MultibodySystemBatch::get_sparsity_out(casadi_int i) {
+    const auto pointSparsity = m_pointFunction->sparsity_out(i);
+    return casadi::Sparsity::dense(
+            pointSparsity.size1(), pointSparsity.size2() * m_numPoints);
+}
+
+casadi::Sparsity MultibodySystemBatch::get_jacobian_sparsity() const {
+    const Function& point = *m_pointFunction;
+    const casadi::Sparsity pointSparsity =
+            point.has_jacobian_sparsity()
+                    ? point.get_jacobian_sparsity()
+                    : casadi::Sparsity::dense(point.nnz_out(), point.nnz_in());
+
+    // Each input (output) of this function holds the corresponding input
+    // (output) of the point function for all points, one point after another.
+    // For each column (row) of the point Jacobian, compute the index of the
+    // corresponding column (row) of the batch Jacobian for the first point,
+    // and the stride between consecutive points.
+    auto createIndexMap = [this](const std::vector<casadi_int>& argSizes,
+                                  std::vector<casadi_int>& first,
+                                  std::vector<casadi_int>& stride) {
+        casadi_int offset = 0;
+        for (const auto& size : argSizes) {
+            for (casadi_int k = 0; k < size; ++k) {
+                first.push_back(offset * m_numPoints + k);
+                stride.push_back(size);
+            }
+            offset += size;
+        }
+    };
+    std::vector<casadi_int> inSizes;
+    for (casadi_int iin = 0; iin < point.n_in(); ++iin) {
+        inSizes.push_back(point.nnz_in(iin));
+    }
+    std::vector<casadi_int> outSizes;
+    for (casadi_int iout = 0; iout < point.n_out(); ++iout) {
+        outSizes.push_back(point.nnz_out(iout));
+    }
+    std::vector<casadi_int> colFirst, colStride, rowFirst, rowStride;
+    createIndexMap(inSizes, colFirst, colStride);
+    createIndexMap(outSizes, rowFirst, rowStride);
+
+    const auto& colind = pointSparsity.get_colind();
+    const auto& row = pointSparsity.get_row();
+    std::vector<casadi_int> batchRows;
+    std::vector<casadi_int> batchCols;
+    batchRows.reserve(pointSparsity.nnz() * m_numPoints);
+    batchCols.reserve(pointSparsity.nnz() * m_numPoints);
+    for (casadi_int j = 0; j < pointSparsity.size2(); ++j) {
+        for (casadi_int k = colind[j]; k < colind[j + 1]; ++k) {
+            const casadi_int i = row[k];
+            for (int ipoint = 0; ipoint < m_numPoints; ++ipoint) {
+                batchRows.push_back(rowFirst[i] + ipoint * rowStride[i]);
+                batchCols.push_back(colFirst[j] + ipoint * colStride[j]);
+            }
+        }
+    }
+    return casadi::Sparsity::triplet(
+            nnz_out(), nnz_in(), batchRows, batchCols);
+}
+
+template <bool CalcKCErrors>
+VectorDM MultibodySystemExplicitBatch<CalcKCErrors>::eval(
+        const VectorDM& args) const {
+    Problem::ContinuousBatchInput input{args.at(0), args.at(1), args.at(2),
+            args.at(3), args.at(4), args.at(5)};
+    VectorDM out((int)n_out());
+    for (casadi_int i = 0; i < n_out(); ++i) {
+        out[i] = casadi::DM(sparsity_out(i));
+    }
+    Problem::MultibodySystemExplicitOutput output{out[0], out[1], out[2],
+            out[3]};
+    m_casProblem->calcMultibodySystemExplicitBatch(
+            input, CalcKCErrors, output);
+    return out;
+}
+
+template class CasOC::MultibodySystemExplicitBatch<false>;
+template class CasOC::MultibodySystemExplicitBatch<true>;
+
+template <bool CalcKCErrors>
+VectorDM MultibodySystemImplicitBatch<CalcKCErrors>::eval(
+        const VectorDM& args) const {
+    Problem::ContinuousBatchInput input{args.at(0), args.at(1), args.at(2),
+            args.at(3), args.at(4), args.at(5)};
+    VectorDM out((int)n_out());
+    for (casadi_int i = 0; i < n_out(); ++i) {
+        out[i] = casadi::DM(sparsity_out(i));
+    }
+    Problem::MultibodySystemImplicitOutput output{out[0], out[1], out[2],
+            out[3]};
+    m_casProblem->calcMultibodySystemImplicitBatch(
+            input, CalcKCErrors, output);
+    return out;
+}
+
+template class CasOC::MultibodySystemImplicitBatch<false>;
+template class CasOC::MultibodySystemImplicitBatch<true>;
+
 template <bool CalcKCErrors>
 casadi::Sparsity MultibodySystemExplicit<CalcKCErrors>::get_sparsity_out(
         casadi_int i) {
@@ -244,6 +772,17 @@ VectorDM MultibodySystemExplicit<CalcKCErrors>::eval(
     return out;
 }
 
+template <bool CalcKCErrors>
+std::unique_ptr<Function>
+MultibodySystemExplicit<CalcKCErrors>::createBatchFunction(
+        int numPoints) const {
+    auto batch = OpenSim::make_unique<
+            MultibodySystemExplicitBatch<CalcKCErrors>>();
+    batch->constructFunction(m_casProblem,
+            fmt::format("{}_batch{}", name(), numPoints), *this, numPoints);
+    return std::move(batch);
+}
+
 template class CasOC::MultibodySystemExplicit<false>;
 template class CasOC::MultibodySystemExplicit<true>;
 
@@ -330,5 +869,16 @@ VectorDM MultibodySystemImplicit<CalcKCErrors>::eval(
     return out;
 }
 
+template <bool CalcKCErrors>
+std::unique_ptr<Function>
+MultibodySystemImplicit<CalcKCErrors>::createBatchFunction(
+        int numPoints) const {
+    auto batch = OpenSim::make_unique<
+            MultibodySystemImplicitBatch<CalcKCErrors>>();
+    batch->constructFunction(m_casProblem,
+            fmt::format("{}_batch{}", name(), numPoints), *this, numPoints);
+    return std::move(batch);
+}
+
 template class CasOC::MultibodySystemImplicit<false>;
 template class CasOC::MultibodySystemImplicit<true>;
@@ -21,6 +21,9 @@
 #include "CasOCIterate.h"
 
 #include <OpenSim/Common/Exception.h>
+#include <OpenSim/Moco/osimMocoDLL.h>
+#include <functional>
+#include <memory>
 
 namespace CasOC {
 
@@ -28,6 +31,44 @@ class Problem;
 
 using VectorDM = std::vector<casadi::DM>;
 
+/// A Curtis-Powell-Reid coloring of the columns of a Jacobian sparsity
+/// pattern: no two columns of the same color have a nonzero in the same row.
+/// Perturbing all columns of one color at once therefore yields each of their
+/// nonzeros without interference, and a Jacobian can be obtained from one
+/// finite difference per color rather than one per column. We color the
+/// columns greedily, in order of decreasing number of nonzeros.
+class OSIMMOCO_API JacobianColoring {
+public:
+    JacobianColoring() = default;
+    explicit JacobianColoring(const casadi::Sparsity& sparsity);
+    const casadi::Sparsity& getSparsity() const { return m_sparsity; }
+    int getNumColors() const { return m_numColors; }
+    /// The color of each column of the sparsity pattern.
+    const std::vector<int>& getColors() const { return m_colors; }
+
+private:
+    casadi::Sparsity m_sparsity;
+    int m_numColors = 0;
+    std::vector<int> m_colors;
+};
+
+/// A function that evaluates the outputs `y` for the inputs `x`.
+using FiniteDifferenceFunction = std::function<void(
+        const std::vector<double>& x, std::vector<double>& y)>;
+
+/// Compute the nonzeros of the Jacobian of `function` at `x0`, with one
+/// finite difference per color of `coloring`; `y0` is the value of `function`
+/// at `x0`. The nonzeros are in the (column-major) order of
+/// coloring.getSparsity(). The scheme is "central", "forward", or
+/// "backward". Variable i is perturbed by h * max(1, |x0_i|), where h is the
+/// cube root (central) or square root (forward and backward) of machine
+/// epsilon, so that the perturbation of a large variable is not lost to
+/// round-off.
+OSIMMOCO_API std::vector<double> calcFiniteDifferenceJacobian(
+        const FiniteDifferenceFunction& function,
+        const JacobianColoring& coloring, const std::string& scheme,
+        const std::vector<double>& x0, const std::vector<double>& y0);
+
 class Function : public casadi::Callback {
 public:
     virtual ~Function() = default;
@@ -42,7 +83,7 @@ public:
         // Using "forward", iterations are 10x faster but problems are less
         // likely to converge.
     }
-    std::string getFiniteDifferenceScheme() {
+    std::string getFiniteDifferenceScheme() const {
         return m_finite_difference_scheme;
     }
     casadi_int get_n_in() override { return 6; }
@@ -62,6 +103,29 @@ public:
         return !m_fullPointsForSparsityDetection->empty();
     }
     casadi::Sparsity get_jacobian_sparsity() const override;
+    /// If finite difference coloring is enabled (see
+    /// Problem::getFiniteDifferenceColoring()) and the Jacobian sparsity is
+    /// available, CasADi obtains forward derivatives from get_forward()
+    /// instead of its own finite differences.
+    bool has_forward(casadi_int nfwd) const override;
+    /// This returns a FiniteDifferenceForward function.
+    casadi::Function get_forward(casadi_int nfwd, const std::string& name,
+            const std::vector<std::string>& inames,
+            const std::vector<std::string>& onames,
+            const casadi::Dict& opts) const override;
+    /// The coloring of the Jacobian sparsity pattern, computed on first use.
+    const JacobianColoring& getJacobianColoring() const;
+    /// Evaluate this function with the nonzeros of all inputs concatenated
+    /// into `x`, and store the nonzeros of all outputs, concatenated, in `y`.
+    void evalConcatenated(
+            const std::vector<double>& x, std::vector<double>& y) const;
+    /// Create a function that evaluates this function at `numPoints` points
+    /// in a single call (see MultibodySystemBatch). This returns nullptr if
+    /// this function does not support batch evaluation.
+    virtual std::unique_ptr<Function> createBatchFunction(
+            int /*numPoints*/) const {
+        return nullptr;
+    }
 
 protected:
     const Problem* m_casProblem;
@@ -91,6 +155,45 @@ private:
 
     std::shared_ptr<const std::vector<VariablesDM>>
             m_fullPointsForSparsityDetection;
+
+    // Sparsity detection by perturbation is expensive, so we compute the
+    // Jacobian sparsity once and reuse it for the coloring.
+    mutable std::unique_ptr<casadi::Sparsity> m_jacobianSparsity;
+    mutable std::unique_ptr<JacobianColoring> m_jacobianColoring;
+    // CasADi holds only a raw pointer to a Callback, so we must keep the
+    // forward derivative functions alive.
+    mutable std::vector<std::unique_ptr<casadi::Callback>> m_forwardFunctions;
+};
+
+/// This function computes forward directional derivatives of a
+/// CasOC::Function with finite differences, using the Jacobian coloring of the
+/// function. Each call computes `nfwd` directional derivatives. If there are
+/// fewer colors than directions, we compute the sparse Jacobian with one
+/// finite difference per color and multiply it by the seeds; otherwise, we
+/// perturb along each seed direction directly. The inputs are the function's
+/// inputs, its outputs, and the seeds (one column block per direction); the
+/// outputs are the sensitivities (CasADi's convention for forward
+/// derivatives).
+class FiniteDifferenceForward : public casadi::Callback {
+public:
+    void constructFunction(const Function& function, int numDirections,
+            const std::string& name, const std::vector<std::string>& inames,
+            const std::vector<std::string>& onames, casadi::Dict opts);
+    casadi_int get_n_in() override;
+    casadi_int get_n_out() override { return m_function->n_out(); }
+    std::string get_name_in(casadi_int i) override { return m_inames.at(i); }
+    std::string get_name_out(casadi_int i) override {
+        return m_onames.at(i);
+    }
+    casadi::Sparsity get_sparsity_in(casadi_int i) override;
+    casadi::Sparsity get_sparsity_out(casadi_int i) override;
+    VectorDM eval(const VectorDM& args) const override;
+
+private:
+    const Function* m_function = nullptr;
+    int m_numDirections = -1;
+    std::vector<std::string> m_inames;
+    std::vector<std::string> m_onames;
 };
 
 class PathConstraint : public Function {
@@ -251,6 +354,46 @@ public:
 
 };
 
+/// This function evaluates a multibody system function (the "point function")
+/// at a block of points in a single call. Each input and output has one
+/// column per point. Compared to casadi::Function::map() on the point
+/// function, this avoids dispatching a callback for each point and lets the
+/// Problem reuse its model and state across the block. The Jacobian sparsity
+/// is block diagonal, with the point function's Jacobian sparsity as the
+/// block, so finite differences perturb all points at once.
+class MultibodySystemBatch : public Function {
+public:
+    void constructFunction(const Problem* casProblem, const std::string& name,
+            const Function& pointFunction, int numPoints);
+    int getNumPoints() const { return m_numPoints; }
+    casadi_int get_n_out() override final { return m_pointFunction->n_out(); }
+    std::string get_name_out(casadi_int i) override final {
+        return m_pointFunction->name_out(i);
+    }
+    casadi::Sparsity get_sparsity_in(casadi_int i) override final;
+    casadi::Sparsity get_sparsity_out(casadi_int i) override final;
+    bool has_jacobian_sparsity() const override final { return true; }
+    casadi::Sparsity get_jacobian_sparsity() const override final;
+
+protected:
+    const Function* m_pointFunction = nullptr;
+    int m_numPoints = -1;
+};
+
+/// This invokes CasOC::Problem::calcMultibodySystemExplicitBatch().
+template <bool CalcKCErrors>
+class MultibodySystemExplicitBatch : public MultibodySystemBatch {
+public:
+    VectorDM eval(const VectorDM& args) const override;
+};
+
+/// This invokes CasOC::Problem::calcMultibodySystemImplicitBatch().
+template <bool CalcKCErrors>
+class MultibodySystemImplicitBatch : public MultibodySystemBatch {
+public:
+    VectorDM eval(const VectorDM& args) const override;
+};
+
 /// This function should compute forward dynamics (explicit multibody dynamics),
 /// auxiliary explicit dynamics, and the errors for the kinematic constraints.
 template <bool CalcKCErrors>
@@ -268,6 +411,8 @@ public:
     }
     casadi::Sparsity get_sparsity_out(casadi_int i) override final;
     VectorDM eval(const VectorDM& args) const override;
+    std::unique_ptr<Function> createBatchFunction(
+            int numPoints) const override;
 };
 
 /// This function should compute a velocity correction term to make feasible
@@ -311,6 +456,8 @@ class MultibodySystemImplicit : public Function {
     }
     casadi::Sparsity get_sparsity_out(casadi_int i) override final;
     VectorDM eval(const VectorDM& args) const override;
+    std::unique_ptr<Function> createBatchFunction(
+            int numPoints) const override;
 };
 
 } // namespace CasOC
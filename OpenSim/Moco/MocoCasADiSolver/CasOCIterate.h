@@ -19,6 +19,7 @@
  * -------------------------------------------------------------------------- */
 
 #include <casadi/casadi.hpp>
+#include <map>
 
 namespace CasOC {
 
@@ -67,6 +68,25 @@ struct Iterate {
     Iterate resample(const casadi::DM& newTimes) const;
 };
 
+/// The multipliers (dual variables) of the nonlinear program. A Solution
+/// contains these, and they can be provided to Solver::solve() to warm-start
+/// the optimization solver.
+struct NLPMultipliers {
+    /// Multipliers for the bounds on the variables, with the same layout as
+    /// the variables of a solution (e.g., `bounds.variables[states]` holds the
+    /// multipliers for the bounds on the states).
+    Iterate bounds;
+    /// Multipliers for the constraints, by constraint type (e.g., "defects"
+    /// or "path_<name>"). Each matrix has one row per equation and one column
+    /// per time in `constraint_times`.
+    std::map<std::string, casadi::DM> constraints;
+    /// Times at which the constraints apply, normalized to [0, 1]. Endpoint
+    /// constraints do not apply at a specific time, so their times are
+    /// empty.
+    std::map<std::string, casadi::DM> constraint_times;
+    bool empty() const { return constraints.empty(); }
+};
+
 /// This struct is used to return a solution to a problem. Use `stats`
 /// to check if the problem converged.
 using ObjectiveBreakdown = std::vector<std::pair<std::string, double>>;
@@ -74,6 +94,7 @@ struct Solution : public Iterate {
     casadi::Dict stats;
     double objective;
     ObjectiveBreakdown objective_breakdown;
+    NLPMultipliers nlp_multipliers;
 };
 
 } // namespace CasOC
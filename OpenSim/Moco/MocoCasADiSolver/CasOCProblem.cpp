@@ -38,6 +38,28 @@ Iterate Iterate::resample(const casadi::DM& newTimes) const {
     return OpenSim::convertToCasOCIterate(mocoIt);
 }
 
+void Problem::calcMultibodySystemExplicitBatch(
+        const ContinuousBatchInput& input, bool calcKCErrors,
+        MultibodySystemExplicitOutput& output) const {
+    forEachPointInBatch(input, output,
+            [&](const ContinuousInput& pointInput,
+                    MultibodySystemExplicitOutput& pointOutput) {
+                calcMultibodySystemExplicit(
+                        pointInput, calcKCErrors, pointOutput);
+            });
+}
+
+void Problem::calcMultibodySystemImplicitBatch(
+        const ContinuousBatchInput& input, bool calcKCErrors,
+        MultibodySystemImplicitOutput& output) const {
+    forEachPointInBatch(input, output,
+            [&](const ContinuousInput& pointInput,
+                    MultibodySystemImplicitOutput& pointOutput) {
+                calcMultibodySystemImplicit(
+                        pointInput, calcKCErrors, pointOutput);
+            });
+}
+
 std::vector<std::string>
 Problem::createKinematicConstraintEquationNamesImpl() const {
     std::vector<std::string> names(getNumKinematicConstraintEquations());
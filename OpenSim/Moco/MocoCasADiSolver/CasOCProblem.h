@@ -137,6 +137,17 @@ public:
         const casadi::DM& derivatives;
         const casadi::DM& parameters;
     };
+    /// Input for evaluating a function at a block of points at once. Each
+    /// matrix has one column per point, and the column of `times` gives the
+    /// time for that point.
+    struct ContinuousBatchInput {
+        const casadi::DM& times;
+        const casadi::DM& states;
+        const casadi::DM& controls;
+        const casadi::DM& multipliers;
+        const casadi::DM& derivatives;
+        const casadi::DM& parameters;
+    };
     struct CostInput {
         const double& initial_time;
         const casadi::DM& initial_states;
@@ -312,6 +323,22 @@ public:
             bool calcKCErrors, MultibodySystemExplicitOutput& output) const = 0;
     virtual void calcMultibodySystemImplicit(const ContinuousInput& input,
             bool calcKCErrors, MultibodySystemImplicitOutput& output) const = 0;
+    /// Evaluate calcMultibodySystemExplicit() at each column of the input.
+    /// Each output has one column per point. The default implementation
+    /// invokes calcMultibodySystemExplicit() once per point; override this to
+    /// share work across points.
+    virtual void calcMultibodySystemExplicitBatch(
+            const ContinuousBatchInput& input, bool calcKCErrors,
+            MultibodySystemExplicitOutput& output) const;
+    /// @copydoc calcMultibodySystemExplicitBatch()
+    virtual void calcMultibodySystemImplicitBatch(
+            const ContinuousBatchInput& input, bool calcKCErrors,
+            MultibodySystemImplicitOutput& output) const;
+    /// Return true if the calc...Batch() functions evaluate the points of a
+    /// batch in parallel. If so, the transcription passes all points to a
+    /// single call, instead of splitting the points into one batch per thread
+    /// and letting CasADi evaluate the batches in parallel.
+    virtual bool isBatchEvaluationParallel() const { return false; }
     virtual void calcVelocityCorrection(const double& time,
             const casadi::DM& multibody_states, const casadi::DM& slacks,
             const casadi::DM& parameters,
@@ -344,6 +371,107 @@ public:
             const CasOC::Iterate&) const {}
     /// @}
 
+protected:
+    /// This class evaluates individual points (columns) of a batch: it copies
+    /// the point's inputs into single-column inputs, invokes a single-point
+    /// function, and copies the single-column outputs into the point's column
+    /// of the batch output. The single-column inputs and outputs are
+    /// allocated once, in the constructor. To evaluate points of the same
+    /// batch on multiple threads, use one BatchPointEvaluator per thread.
+    /// TOutput is either MultibodySystemExplicitOutput or
+    /// MultibodySystemImplicitOutput.
+    template <typename TOutput>
+    class BatchPointEvaluator {
+    public:
+        BatchPointEvaluator(
+                const ContinuousBatchInput& batchInput, TOutput& batchOutput)
+                : m_batchInput(batchInput), m_batchOutput(batchOutput),
+                  m_states(zeroColumn(batchInput.states)),
+                  m_controls(zeroColumn(batchInput.controls)),
+                  m_multipliers(zeroColumn(batchInput.multipliers)),
+                  m_derivatives(zeroColumn(batchInput.derivatives)),
+                  m_parameters(zeroColumn(batchInput.parameters)),
+                  m_out0(zeroColumn(getMultibodyOutput(batchOutput))),
+                  m_out1(zeroColumn(batchOutput.auxiliary_derivatives)),
+                  m_out2(zeroColumn(batchOutput.auxiliary_residuals)),
+                  m_out3(zeroColumn(batchOutput.kinematic_constraint_errors)),
+                  m_pointInput{m_time, m_states, m_controls, m_multipliers,
+                          m_derivatives, m_parameters},
+                  m_pointOutput{m_out0, m_out1, m_out2, m_out3} {}
+        BatchPointEvaluator(const BatchPointEvaluator&) = delete;
+        BatchPointEvaluator& operator=(const BatchPointEvaluator&) = delete;
+
+        /// Evaluate point `ipoint` by invoking
+        /// `calcPoint(pointInput, pointOutput)`.
+        template <typename TCalcPoint>
+        void eval(int ipoint, TCalcPoint&& calcPoint) {
+            m_time = *(m_batchInput.times.ptr() + ipoint);
+            copyFromColumn(m_batchInput.states, ipoint, m_states);
+            copyFromColumn(m_batchInput.controls, ipoint, m_controls);
+            copyFromColumn(m_batchInput.multipliers, ipoint, m_multipliers);
+            copyFromColumn(m_batchInput.derivatives, ipoint, m_derivatives);
+            copyFromColumn(m_batchInput.parameters, ipoint, m_parameters);
+
+            calcPoint(m_pointInput, m_pointOutput);
+
+            copyToColumn(m_out0, ipoint, getMultibodyOutput(m_batchOutput));
+            copyToColumn(m_out1, ipoint, m_batchOutput.auxiliary_derivatives);
+            copyToColumn(m_out2, ipoint, m_batchOutput.auxiliary_residuals);
+            copyToColumn(m_out3, ipoint,
+                    m_batchOutput.kinematic_constraint_errors);
+        }
+
+    private:
+        static casadi::DM zeroColumn(const casadi::DM& batch) {
+            return casadi::DM::zeros(batch.rows(), 1);
+        }
+        static void copyFromColumn(
+                const casadi::DM& batch, int icol, casadi::DM& point) {
+            std::copy_n(batch.ptr() + icol * batch.rows(), batch.rows(),
+                    point.ptr());
+        }
+        static void copyToColumn(
+                const casadi::DM& point, int icol, casadi::DM& batch) {
+            std::copy_n(point.ptr(), batch.rows(),
+                    batch.ptr() + icol * batch.rows());
+        }
+
+        const ContinuousBatchInput& m_batchInput;
+        TOutput& m_batchOutput;
+        double m_time = 0;
+        casadi::DM m_states;
+        casadi::DM m_controls;
+        casadi::DM m_multipliers;
+        casadi::DM m_derivatives;
+        casadi::DM m_parameters;
+        casadi::DM m_out0;
+        casadi::DM m_out1;
+        casadi::DM m_out2;
+        casadi::DM m_out3;
+        const ContinuousInput m_pointInput;
+        TOutput m_pointOutput;
+    };
+
+    /// Evaluate each point of a batch, in order, on the calling thread. See
+    /// BatchPointEvaluator.
+    template <typename TOutput, typename TCalcPoint>
+    static void forEachPointInBatch(const ContinuousBatchInput& input,
+            TOutput& output, TCalcPoint&& calcPoint) {
+        BatchPointEvaluator<TOutput> evaluator(input, output);
+        for (int ipoint = 0; ipoint < (int)input.times.numel(); ++ipoint) {
+            evaluator.eval(ipoint, calcPoint);
+        }
+    }
+
+    static casadi::DM& getMultibodyOutput(
+            MultibodySystemExplicitOutput& output) {
+        return output.multibody_derivatives;
+    }
+    static casadi::DM& getMultibodyOutput(
+            MultibodySystemImplicitOutput& output) {
+        return output.multibody_residuals;
+    }
+
 public:
     /// Create an iterate with the variable names populated according to the
     /// variables added to this problem.
@@ -380,9 +508,12 @@ public:
     }
 
     void initialize(const std::string& finiteDiffScheme,
+            bool finiteDiffColoring, const std::string& sparsityCachePrefix,
             std::shared_ptr<const std::vector<VariablesDM>>
                     pointsForSparsityDetection) const {
         auto* mutThis = const_cast<Problem*>(this);
+        mutThis->m_finiteDifferenceColoring = finiteDiffColoring;
+        mutThis->m_sparsityCachePrefix = sparsityCachePrefix;
 
         {
             int index = 0;
@@ -472,6 +603,17 @@ public:
     int getNumParameters() const { return (int)m_paramInfos.size(); }
     int getNumMultipliers() const { return (int)m_multiplierInfos.size(); }
     std::string getDynamicsMode() const { return m_dynamicsMode; }
+    /// Whether CasOC::Function%s compute forward derivatives using a
+    /// coloring of their Jacobian sparsity (see FiniteDifferenceForward).
+    bool getFiniteDifferenceColoring() const {
+        return m_finiteDifferenceColoring;
+    }
+    /// If not empty, CasOC::Function%s store their detected Jacobian
+    /// sparsity in files whose names start with this prefix, and read the
+    /// sparsity from these files if they exist.
+    const std::string& getSparsityCachePrefix() const {
+        return m_sparsityCachePrefix;
+    }
     bool isDynamicsModeImplicit() const { return m_isDynamicsModeImplicit; }
     int getNumDerivatives() const {
         return getNumAccelerations() + getNumAuxiliaryResidualEquations();
@@ -617,6 +759,8 @@ private:
     std::vector<std::string> m_auxiliaryDerivativeNames;
     bool m_isDynamicsModeImplicit = false;
     bool m_prescribedKinematics = false;
+    bool m_finiteDifferenceColoring = false;
+    std::string m_sparsityCachePrefix;
     int m_numMultibodyDynamicsEquationsIfPrescribedKinematics = 0;
     Bounds m_kinematicConstraintBounds;
     std::vector<ControlInfo> m_controlInfos;
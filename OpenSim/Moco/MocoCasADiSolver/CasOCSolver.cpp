@@ -20,10 +20,28 @@
 #include "CasOCTranscription.h"
 #include "CasOCTrapezoidal.h"
 
+#include <OpenSim/Common/IO.h>
 #include <OpenSim/Moco/MocoUtilities.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
 
 using OpenSim::Exception;
 
+namespace {
+/// 64-bit FNV-1a hash. Unlike std::hash, this is the same on all platforms,
+/// so cached files remain valid across builds.
+std::uint64_t hashBytes(const void* data, std::size_t size,
+        std::uint64_t hash = 14695981039346656037ULL) {
+    const auto* bytes = static_cast<const unsigned char*>(data);
+    for (std::size_t i = 0; i < size; ++i) {
+        hash ^= bytes[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+} // namespace
+
 namespace CasOC {
 
 std::unique_ptr<Transcription> Solver::createTranscription() const {
@@ -68,7 +86,8 @@ void Solver::setParallelism(std::string parallelism, int numThreads) {
     m_numThreads = numThreads;
 }
 
-Solution Solver::solve(const Iterate& guess) const {
+Solution Solver::solve(
+        const Iterate& guess, const NLPMultipliers& multipliersGuess) const {
     auto transcription = createTranscription();
     auto pointsForSparsityDetection =
             std::make_shared<std::vector<VariablesDM>>();
@@ -91,10 +110,104 @@ Solution Solver::solve(const Iterate& guess) const {
                             .variables);
         }
     }
+    // The detected sparsity depends on the problem and solver settings
+    // (identified by the cache key), on how we choose the points at which we
+    // detect it, and on the points themselves.
+    std::string sparsityCachePrefix;
+    if (!m_sparsity_cache_directory.empty() &&
+            !pointsForSparsityDetection->empty()) {
+        auto hash = hashBytes(
+                m_sparsity_cache_key.data(), m_sparsity_cache_key.size());
+        hash = hashBytes(m_sparsity_detection.data(),
+                m_sparsity_detection.size(), hash);
+        hash = hashBytes(&m_sparsity_detection_random_count,
+                sizeof(m_sparsity_detection_random_count), hash);
+        for (const auto& point : *pointsForSparsityDetection) {
+            // VariablesDM is an unordered_map, so we visit the variables in
+            // a fixed order.
+            for (const Var var : {initial_time, final_time, states, controls,
+                         multipliers, slacks, derivatives, parameters}) {
+                if (point.count(var) == 0) continue;
+                const auto& nonzeros = point.at(var).nonzeros();
+                hash = hashBytes(nonzeros.data(),
+                        nonzeros.size() * sizeof(double), hash);
+            }
+        }
+        OpenSim::IO::makeDir(m_sparsity_cache_directory);
+        sparsityCachePrefix = fmt::format(
+                "{}/{:016x}", m_sparsity_cache_directory, hash);
+    }
     m_problem.initialize(m_finite_difference_scheme,
+            m_finite_difference_coloring, sparsityCachePrefix,
             std::const_pointer_cast<const std::vector<VariablesDM>>(
                     pointsForSparsityDetection));
-    return transcription->solve(guess);
+    return transcription->solve(guess, multipliersGuess);
+}
+
+std::vector<double> Solver::estimateMeshIntervalErrors(
+        const Iterate& solution) const {
+    const int numMeshIntervals = (int)m_mesh.size() - 1;
+    std::vector<double> bisectedMesh;
+    for (int imesh = 0; imesh < numMeshIntervals; ++imesh) {
+        bisectedMesh.push_back(m_mesh[imesh]);
+        bisectedMesh.push_back(0.5 * (m_mesh[imesh] + m_mesh[imesh + 1]));
+    }
+    bisectedMesh.push_back(m_mesh.back());
+    Solver bisected(*this);
+    bisected.setMesh(std::move(bisectedMesh));
+    const casadi::DM defects =
+            bisected.createTranscription()->evalDefects(solution);
+
+    // The defects for each state are stacked (e.g., Hermite interpolant
+    // defects followed by Simpson integration defects).
+    const int NS = m_problem.getNumStates();
+    std::vector<double> errors(numMeshIntervals, 0);
+    if (NS == 0) return errors;
+    const auto& states = solution.variables.at(Var::states);
+    std::vector<double> scale(NS, 1.0);
+    for (int is = 0; is < NS; ++is) {
+        for (int itime = 0; itime < states.columns(); ++itime) {
+            scale[is] = std::max(scale[is],
+                    1.0 + std::abs(states(is, itime).scalar()));
+        }
+    }
+    for (int imesh = 0; imesh < numMeshIntervals; ++imesh) {
+        for (int icol = 2 * imesh; icol < 2 * imesh + 2; ++icol) {
+            for (int irow = 0; irow < defects.rows(); ++irow) {
+                errors[imesh] = std::max(errors[imesh],
+                        std::abs(defects(irow, icol).scalar()) /
+                                scale[irow % NS]);
+            }
+        }
+    }
+    return errors;
+}
+
+std::vector<double> Solver::createRefinedMesh(
+        const std::vector<double>& errors, double tolerance) const {
+    OPENSIM_THROW_IF(errors.size() + 1 != m_mesh.size(), Exception,
+            "Expected {} mesh interval errors, but got {}.",
+            m_mesh.size() - 1, errors.size());
+    OPENSIM_THROW_IF(tolerance <= 0, Exception,
+            "Expected a positive tolerance, but got {}.", tolerance);
+    // The local error of the defects is O(h^3) for trapezoidal and O(h^5)
+    // for Hermite-Simpson.
+    const double order = m_transcriptionScheme == "trapezoidal" ? 3 : 5;
+    std::vector<double> mesh;
+    for (int imesh = 0; imesh < (int)errors.size(); ++imesh) {
+        int numSubintervals = 1;
+        if (errors[imesh] > tolerance) {
+            numSubintervals = (int)std::ceil(
+                    std::pow(errors[imesh] / tolerance, 1.0 / order));
+            numSubintervals = std::min(std::max(numSubintervals, 2), 5);
+        }
+        const double h = m_mesh[imesh + 1] - m_mesh[imesh];
+        for (int isub = 0; isub < numSubintervals; ++isub) {
+            mesh.push_back(m_mesh[imesh] + isub * h / numSubintervals);
+        }
+    }
+    mesh.push_back(m_mesh.back());
+    return mesh;
 }
 
 } // namespace CasOC
@@ -124,6 +124,18 @@ public:
         return m_finite_difference_scheme;
     }
 
+    /// Compute the forward derivatives of each CasOC::Function by perturbing
+    /// groups of structurally orthogonal columns of its Jacobian together
+    /// (Curtis-Powell-Reid coloring). This requires sparsity detection.
+    /// @note Default is false.
+    void setFiniteDifferenceColoring(bool tf) {
+        m_finite_difference_coloring = tf;
+    }
+    /// @copydoc setFiniteDifferenceColoring()
+    bool getFiniteDifferenceColoring() const {
+        return m_finite_difference_coloring;
+    }
+
     void setCallbackInterval(int callbackInterval) {
         m_callbackInterval = callbackInterval;
     }
@@ -144,6 +156,28 @@ public:
     }
     std::string getWriteSparsity() const { return m_write_sparsity; }
 
+    /// If this is set to a non-empty directory, the Jacobian sparsity
+    /// pattern detected for each CasOC::Function is saved to a file in this
+    /// directory, and later solves reuse the file instead of detecting the
+    /// sparsity again. Files are identified by a hash of the sparsity cache
+    /// key, the sparsity detection setting, and the points used for sparsity
+    /// detection. A file that cannot be read or whose dimensions do not match
+    /// the function is ignored, and the sparsity is detected (and the file
+    /// rewritten). This has no effect if sparsity detection is "none".
+    void setSparsityCacheDirectory(const std::string& directory) {
+        m_sparsity_cache_directory = directory;
+    }
+    std::string getSparsityCacheDirectory() const {
+        return m_sparsity_cache_directory;
+    }
+    /// A string that identifies everything other than the points for
+    /// sparsity detection that determines the sparsity of the
+    /// CasOC::Function%s (e.g., the model, the problem, and the solver
+    /// settings).
+    void setSparsityCacheKey(std::string key) {
+        m_sparsity_cache_key = std::move(key);
+    }
+
     /// Use this to tell CasADi to evaluate differential-algebraic equations,
     /// path constraints, integrands, etc. in parallel across grid points.
     /// "parallelism" is passed on directly to
@@ -154,6 +188,17 @@ public:
         return std::make_pair(m_parallelism, m_numThreads);
     }
 
+    /// Evaluate the multibody system at a block of grid points per function
+    /// call (see MultibodySystemBatch), rather than one grid point per call.
+    /// If running in parallel, the grid points are split into one block per
+    /// thread.
+    void setBatchMultibodyEvaluation(bool tf) {
+        m_batchMultibodyEvaluation = tf;
+    }
+    bool getBatchMultibodyEvaluation() const {
+        return m_batchMultibodyEvaluation;
+    }
+
     void setPluginOptions(casadi::Dict opts) {
         m_pluginOptions = std::move(opts);
     }
@@ -169,7 +214,32 @@ public:
     /// The contents of this iterate depends on the transcription scheme.
     Iterate createRandomIterateWithinBounds() const;
 
-    Solution solve(const Iterate& guess) const;
+    /// If provided, `multipliersGuess` (e.g., from the solution to a similar
+    /// problem) is the initial guess for the multipliers of the nonlinear
+    /// program. Use this with the IPOPT option "warm_start_init_point".
+    Solution solve(const Iterate& guess,
+            const NLPMultipliers& multipliersGuess = NLPMultipliers()) const;
+
+    /// @name Mesh refinement
+    /// @{
+
+    /// Estimate the error in each mesh interval of a solution from solve()
+    /// on the current mesh. We bisect each mesh interval and evaluate the
+    /// defects of the finer mesh at the interpolated solution, which
+    /// requires evaluating the dynamics at points at which the solution was
+    /// not collocated. The error for a mesh interval is the largest of these
+    /// defects (in either half), relative to one plus the largest magnitude
+    /// of the corresponding state.
+    std::vector<double> estimateMeshIntervalErrors(
+            const Iterate& solution) const;
+    /// Create a mesh in which each mesh interval whose error (see
+    /// estimateMeshIntervalErrors()) exceeds `tolerance` is divided into 2 to
+    /// 5 equal intervals, depending on the order of the transcription scheme
+    /// and how much the error exceeds the tolerance. The other mesh intervals
+    /// are unchanged.
+    std::vector<double> createRefinedMesh(
+            const std::vector<double>& errors, double tolerance) const;
+    /// @}
 
 private:
     std::unique_ptr<Transcription> createTranscription() const;
@@ -187,12 +257,16 @@ private:
     Bounds m_implicitMultibodyAccelerationBounds;
     Bounds m_implicitAuxiliaryDerivativeBounds;
     std::string m_finite_difference_scheme = "central";
+    bool m_finite_difference_coloring = false;
     std::string m_sparsity_detection = "none";
     std::string m_write_sparsity;
+    std::string m_sparsity_cache_directory;
+    std::string m_sparsity_cache_key;
     int m_callbackInterval = 0;
     int m_sparsity_detection_random_count = 3;
     std::string m_parallelism = "serial";
     int m_numThreads = 1;
+    bool m_batchMultibodyEvaluation = false;
     casadi::Dict m_pluginOptions;
     casadi::Dict m_solverOptions;
     std::string m_optimSolver;
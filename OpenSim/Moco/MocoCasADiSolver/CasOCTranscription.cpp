@@ -17,6 +17,8 @@
  * -------------------------------------------------------------------------- */
 #include "CasOCTranscription.h"
 
+#include <algorithm>
+
 using casadi::DM;
 using casadi::MX;
 using casadi::MXVector;
@@ -584,22 +586,15 @@ void Transcription::setObjectiveAndEndpointConstraints() {
     }
 }
 
-Solution Transcription::solve(const Iterate& guessOrig) {
-
-    // Define the NLP.
-    // ---------------
-    transcribe();
-
-    // Resample the guess.
-    // -------------------
-    const auto guessTimes = createTimes(guessOrig.variables.at(initial_time),
-            guessOrig.variables.at(final_time));
-    auto guess = guessOrig.resample(guessTimes);
+Iterate Transcription::resampleToGrid(const Iterate& iterate,
+        const casadi::DM& initialTime, const casadi::DM& finalTime) const {
+    const auto times = createTimes(initialTime, finalTime);
+    auto resampled = iterate.resample(times);
 
     // Adjust guesses for the slack variables to ensure they are the correct
     // length (i.e. slacks.size2() == m_numPointsIgnoringConstraints).
-    if (guess.variables.find(Var::slacks) != guess.variables.end()) {
-        auto& slacks = guess.variables.at(Var::slacks);
+    if (resampled.variables.find(Var::slacks) != resampled.variables.end()) {
+        auto& slacks = resampled.variables.at(Var::slacks);
 
         // If slack variables provided in the guess are equal to the grid
         // length, remove the elements on the mesh points where the slack
@@ -626,6 +621,151 @@ Solution Transcription::solve(const Iterate& guessOrig) {
                 "{}.",
                 m_numMeshInteriorPoints, slacks.size2());
     }
+    return resampled;
+}
+
+namespace {
+/// Linearly interpolate each row of `values`, whose columns correspond to
+/// `times`, at `newTimes`. Values outside the range of `times` are held
+/// constant.
+casadi::DM interpolateColumns(const casadi::DM& times, const casadi::DM& values,
+        const casadi::DM& newTimes) {
+    casadi::DM newValues = casadi::DM::zeros(values.rows(), newTimes.numel());
+    const auto numTimes = times.numel();
+    if (numTimes == 0 || values.rows() == 0) return newValues;
+    const std::vector<double> t = times.nonzeros();
+    for (casadi_int inew = 0; inew < newTimes.numel(); ++inew) {
+        const double time = newTimes(inew).scalar();
+        const auto upper = std::upper_bound(t.begin(), t.end(), time);
+        if (upper == t.begin()) {
+            newValues(casadi::Slice(), inew) = values(casadi::Slice(), 0);
+        } else if (upper == t.end()) {
+            newValues(casadi::Slice(), inew) =
+                    values(casadi::Slice(), numTimes - 1);
+        } else {
+            const auto i = (casadi_int)(upper - t.begin()) - 1;
+            const double fraction = (time - t[i]) / (t[i + 1] - t[i]);
+            newValues(casadi::Slice(), inew) =
+                    (1 - fraction) * values(casadi::Slice(), i) +
+                    fraction * values(casadi::Slice(), i + 1);
+        }
+    }
+    return newValues;
+}
+} // namespace
+
+NLPMultipliers Transcription::createNLPMultipliers(const casadi::DM& lamX,
+        const casadi::DM& lamG, const casadi::DM& times) const {
+    NLPMultipliers multipliers;
+    multipliers.bounds = m_problem.createIterate<Iterate>();
+    multipliers.bounds.variables = expandVariables(lamX);
+    multipliers.bounds.times = times;
+    auto constraints = expandConstraints(lamG);
+    forEachConstraintType(constraints,
+            [&](const std::string& name, const casadi::DM& values,
+                    const casadi::DM& constraintTimes) {
+                multipliers.constraints[name] = values;
+                multipliers.constraint_times[name] = constraintTimes;
+            });
+    return multipliers;
+}
+
+void Transcription::createMultipliersGuess(const NLPMultipliers& multipliers,
+        const casadi::DM& initialTime, const casadi::DM& finalTime,
+        casadi::DM& lamX0, casadi::DM& lamG0) const {
+    // Multipliers for constraints and bounds that apply at individual points
+    // in time scale with the length of the mesh intervals (through the
+    // quadrature of the objective), while the multipliers for the defects
+    // approximate the costates and do not. We account for a change in the
+    // number of mesh intervals (e.g., during mesh refinement), but not for
+    // changes in the relative lengths of mesh intervals.
+    // There is one defect time per mesh interval.
+    const auto numOldMeshIntervals =
+            multipliers.constraint_times.at("defects").numel();
+    const double intervalLengthRatio =
+            numOldMeshIntervals ? (double)numOldMeshIntervals /
+                                          (double)m_numMeshIntervals
+                                : 1.0;
+
+    // Bounds.
+    // -------
+    const auto& oldBounds = multipliers.bounds;
+    const auto& oldTimes = oldBounds.times;
+    Iterate normalizedBounds = oldBounds;
+    // Resample in normalized time, so that the multipliers do not depend on
+    // the time span of the previous solution.
+    const double oldInitialTime = oldTimes(0).scalar();
+    const double oldDuration = oldTimes(oldTimes.numel() - 1).scalar() -
+                               oldInitialTime;
+    if (oldDuration > 0) {
+        normalizedBounds.times = (oldTimes - oldInitialTime) / oldDuration;
+    }
+    const auto bounds =
+            resampleToGrid(normalizedBounds, casadi::DM(0.0), casadi::DM(1.0))
+                    .variables;
+    VariablesDM lamX = m_lowerBounds;
+    for (auto& entry : lamX) {
+        const Var var = entry.first;
+        auto& value = entry.second;
+        value = casadi::DM::zeros(value.size());
+        if (var == initial_time || var == final_time) {
+            // Resampling replaces these with times; use the originals.
+            if (oldBounds.variables.count(var)) {
+                value = oldBounds.variables.at(var);
+            }
+        } else if (bounds.count(var) && bounds.at(var).size() == value.size()) {
+            value = bounds.at(var);
+            if (var != parameters) value *= intervalLengthRatio;
+        }
+    }
+    lamX0 = flattenVariables(lamX);
+
+    // Constraints.
+    // ------------
+    Constraints<casadi::DM> lamG =
+            expandConstraints(casadi::DM::zeros(m_numConstraints, 1));
+    forEachConstraintType(lamG, [&](const std::string& name,
+                                        casadi::DM& values,
+                                        const casadi::DM& times) {
+        if (multipliers.constraints.count(name) == 0) return;
+        const auto& oldValues = multipliers.constraints.at(name);
+        if (oldValues.rows() != values.rows()) return;
+        if (times.is_empty()) {
+            values = oldValues;
+        } else {
+            values = interpolateColumns(
+                    multipliers.constraint_times.at(name), oldValues, times);
+            if (name != "defects") values *= intervalLengthRatio;
+        }
+    });
+    lamG0 = flattenConstraints(lamG);
+}
+
+casadi::DM Transcription::evalDefects(const Iterate& iterate) {
+    transcribe();
+    const auto resampled = resampleToGrid(iterate,
+            iterate.variables.at(initial_time),
+            iterate.variables.at(final_time));
+    casadi::Function defectsFunc("defects", {flattenVariables(m_vars)},
+            {m_constraints.defects});
+    casadi::DMVector out;
+    defectsFunc.call(
+            casadi::DMVector{flattenVariables(resampled.variables)}, out);
+    return out.at(0);
+}
+
+Solution Transcription::solve(const Iterate& guessOrig,
+        const NLPMultipliers& multipliersGuess) {
+
+    // Define the NLP.
+    // ---------------
+    transcribe();
+
+    // Resample the guess.
+    // -------------------
+    const auto guess = resampleToGrid(guessOrig,
+            guessOrig.variables.at(initial_time),
+            guessOrig.variables.at(final_time));
 
     // Create the CasADi NLP function.
     // -------------------------------
@@ -681,12 +821,18 @@ Solution Transcription::solve(const Iterate& guessOrig) {
     // Run the optimization (evaluate the CasADi NLP function).
     // --------------------------------------------------------
     // The inputs and outputs of nlpFunc are numeric (casadi::DM).
-    const casadi::DMDict nlpResult =
-            nlpFunc(casadi::DMDict{{"x0", flattenVariables(guess.variables)},
-                    {"lbx", flattenVariables(m_lowerBounds)},
-                    {"ubx", flattenVariables(m_upperBounds)},
-                    {"lbg", flattenConstraints(m_constraintsLowerBounds)},
-                    {"ubg", flattenConstraints(m_constraintsUpperBounds)}});
+    casadi::DMDict nlpArgs{{"x0", flattenVariables(guess.variables)},
+            {"lbx", flattenVariables(m_lowerBounds)},
+            {"ubx", flattenVariables(m_upperBounds)},
+            {"lbg", flattenConstraints(m_constraintsLowerBounds)},
+            {"ubg", flattenConstraints(m_constraintsUpperBounds)}};
+    if (!multipliersGuess.empty()) {
+        createMultipliersGuess(multipliersGuess,
+                guess.variables.at(initial_time),
+                guess.variables.at(final_time), nlpArgs["lam_x0"],
+                nlpArgs["lam_g0"]);
+    }
+    const casadi::DMDict nlpResult = nlpFunc(nlpArgs);
 
     // Create a CasOC::Solution.
     // -------------------------
@@ -704,6 +850,8 @@ Solution Transcription::solve(const Iterate& guessOrig) {
     solution.times = createTimes(
             solution.variables[initial_time], solution.variables[final_time]);
     solution.stats = nlpFunc.stats();
+    solution.nlp_multipliers = createNLPMultipliers(
+            nlpResult.at("lam_x"), nlpResult.at("lam_g"), solution.times);
 
     // Print breakdown of objective.
     printObjectiveBreakdown(solution, objectiveOut[0]);
@@ -1180,8 +1328,7 @@ casadi::MXVector Transcription::evalOnTrajectory(
         const casadi::Function& pointFunction, const std::vector<Var>& inputs,
         const casadi::Matrix<casadi_int>& timeIndices) const {
     auto parallelism = m_solver.getParallelism();
-    const auto trajFunc = pointFunction.map(
-            timeIndices.size2(), parallelism.first, parallelism.second);
+    const int numPoints = (int)timeIndices.size2();
 
     // Assemble input.
     // Add 1 for time input and 1 for parameters input.
@@ -1207,20 +1354,56 @@ casadi::MXVector Transcription::evalOnTrajectory(
     } else {
         OPENSIM_THROW(OpenSim::Exception, "Internal error.");
     }
-    MXVector mxOut;
-    trajFunc.call(mxIn, mxOut);
-    return mxOut;
-    // TODO: Avoid the overhead of map() if not running in parallel.
-    /* } else {
-    casadi::MXVector out(pointFunction.n_out());
-    for (int iout = 0; iout < (int)out.size(); ++iout) {
-    out[iout] = casadi::MX(pointFunction.sparsity_out(iout).rows(),
-    timeIndices.size2());
+
+    // Evaluate the points in blocks, one block per thread. If the number of
+    // points is not divisible by the number of blocks, we pad the input by
+    // repeating the last point, and discard the outputs for the padding. If
+    // the problem evaluates batches in parallel itself, we use a single block
+    // so that the problem can balance the load across its threads.
+    std::unique_ptr<Function> batchFunction;
+    const int numBlocks =
+            m_problem.isBatchEvaluationParallel()
+                    ? 1
+                    : std::max(1, std::min(parallelism.second, numPoints));
+    const int blockSize = (numPoints + numBlocks - 1) / numBlocks;
+    if (m_solver.getBatchMultibodyEvaluation()) {
+        if (const auto* casFunction =
+                        dynamic_cast<const Function*>(&pointFunction)) {
+            batchFunction = casFunction->createBatchFunction(blockSize);
+        }
+    }
+    if (!batchFunction) {
+        const auto trajFunc = pointFunction.map(
+                numPoints, parallelism.first, parallelism.second);
+        MXVector mxOut;
+        trajFunc.call(mxIn, mxOut);
+        return mxOut;
     }
-    for (int itime = 0; itime < timeIndices.size2(); ++itime) {
 
+    const int numPadding = numBlocks * blockSize - numPoints;
+    if (numPadding) {
+        for (auto& in : mxIn) {
+            const MX lastPoint = in(Slice(), numPoints - 1);
+            in = MX::horzcat({in, MX::repmat(lastPoint, 1, numPadding)});
+        }
     }
-    }*/
+    MXVector mxOut;
+    if (numBlocks == 1) {
+        batchFunction->call(mxIn, mxOut);
+    } else {
+        const auto trajFunc = batchFunction->map(
+                numBlocks, parallelism.first, parallelism.second);
+        trajFunc.call(mxIn, mxOut);
+    }
+    m_batchFunctions.push_back(std::move(batchFunction));
+    if (numPadding) {
+        for (auto& out : mxOut) {
+            if (!out.size2()) continue;
+            const MX outWithoutPadding = out(Slice(), Slice(0, numPoints));
+            out = outWithoutPadding;
+        }
+    }
+    return mxOut;
 }
 
 } // namespace CasOC
@@ -62,7 +62,17 @@ public:
         return meshIndices;
     }
 
-    Solution solve(const Iterate& guessOrig);
+    /// If `multipliersGuess` is not empty (e.g., the multipliers from the
+    /// solution to a similar problem), it is interpolated onto the grid of
+    /// this transcription and used as the initial guess for the multipliers
+    /// of the nonlinear program.
+    Solution solve(const Iterate& guessOrig,
+            const NLPMultipliers& multipliersGuess = NLPMultipliers());
+
+    /// Evaluate the defect constraints at `iterate` (e.g., a solution on a
+    /// different mesh), after resampling it onto the grid of this
+    /// transcription. The result has one column per mesh interval.
+    casadi::DM evalDefects(const Iterate& iterate);
 
 protected:
     /// This must be called in the constructor of derived classes so that
@@ -77,6 +87,9 @@ protected:
 
     /// We assume all functions depend on time and parameters.
     /// "inputs" is prepended by time and postpended (?) by parameters.
+    /// If the solver is set to use batch multibody evaluation and
+    /// pointFunction supports it, the points are evaluated in blocks using
+    /// pointFunction.createBatchFunction().
     casadi::MXVector evalOnTrajectory(const casadi::Function& pointFunction,
             const std::vector<Var>& inputs,
             const casadi::Matrix<casadi_int>& timeIndices) const;
@@ -137,6 +150,9 @@ private:
     VariablesDM m_upperBounds;
 
     casadi::DM m_meshIndicesMap;
+    // Batch functions created in evalOnTrajectory(); the NLP refers to these,
+    // so they must live as long as this transcription.
+    mutable std::vector<std::unique_ptr<Function>> m_batchFunctions;
     casadi::Matrix<casadi_int> m_gridIndices;
     casadi::Matrix<casadi_int> m_meshIndices;
     casadi::Matrix<casadi_int> m_meshInteriorIndices;
@@ -215,6 +231,59 @@ private:
         return out;
     }
 
+    /// Invoke `function(name, matrix, times)` on each type of constraint in
+    /// `constraints`, where `times` are the normalized times of the columns
+    /// of `matrix` (empty for endpoint constraints).
+    template <typename TFunction>
+    void forEachConstraintType(
+            Constraints<casadi::DM>& constraints, TFunction function) const {
+        const auto& mesh = m_solver.getMesh();
+        casadi::DM meshPoints(mesh);
+        auto meshIntervalMidpoints =
+                casadi::DM::zeros(m_numMeshIntervals, 1);
+        for (int imesh = 0; imesh < m_numMeshIntervals; ++imesh) {
+            meshIntervalMidpoints(imesh) =
+                    0.5 * (mesh[imesh] + mesh[imesh + 1]);
+        }
+        function("defects", constraints.defects, meshIntervalMidpoints);
+        function("multibody_residuals", constraints.multibody_residuals,
+                m_grid);
+        function("auxiliary_residuals", constraints.auxiliary_residuals,
+                m_grid);
+        function("kinematic", constraints.kinematic, meshPoints);
+        for (int ipc = 0; ipc < (int)constraints.path.size(); ++ipc) {
+            const auto& info = m_problem.getPathConstraintInfos()[ipc];
+            function("path_" + info.name, constraints.path[ipc], meshPoints);
+        }
+        function("interp_controls", constraints.interp_controls,
+                m_pointsForInterpControls);
+        for (int iec = 0; iec < (int)constraints.endpoint.size(); ++iec) {
+            const auto& info = m_problem.getEndpointConstraintInfos()[iec];
+            function("endpoint_" + info.name, constraints.endpoint[iec],
+                    casadi::DM());
+        }
+    }
+
+    /// Resample `iterate` onto the grid of this transcription, spanning
+    /// the provided initial and final times. Slack variables are kept only on
+    /// mesh interior points.
+    Iterate resampleToGrid(const Iterate& iterate,
+            const casadi::DM& initialTime, const casadi::DM& finalTime) const;
+
+    /// Organize the multipliers from the NLP solver by variable and
+    /// constraint type.
+    NLPMultipliers createNLPMultipliers(const casadi::DM& lamX,
+            const casadi::DM& lamG, const casadi::DM& times) const;
+
+    /// Interpolate multipliers (possibly from a different mesh) onto this
+    /// transcription to create the flattened initial multipliers for the NLP
+    /// solver. Constraint types whose number of equations differs from this
+    /// transcription (e.g., defects from a different transcription scheme)
+    /// are set to zero.
+    void createMultipliersGuess(const NLPMultipliers& multipliers,
+            const casadi::DM& initialTime, const casadi::DM& finalTime,
+            casadi::DM& lamX0, casadi::DM& lamG0) const;
+
     /// Flatten the constraints into a row vector, keeping constraints
     /// grouped together by time. Organizing the sparsity of the Jacobian
     /// this way might have benefits for sparse linear algebra.
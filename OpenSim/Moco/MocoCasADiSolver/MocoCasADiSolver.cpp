@@ -19,6 +19,7 @@
 #include "MocoCasADiSolver.h"
 
 #include <OpenSim/Moco/MocoUtilities.h>
+#include <algorithm>
 
 #ifdef OPENSIM_WITH_CASADI
     #include "CasOCSolver.h"
@@ -26,6 +27,7 @@
     #include <casadi/casadi.hpp>
 
     #include <OpenSim/Common/Stopwatch.h>
+    #include <OpenSim/Moco/MocoProblem.h>
 
     using casadi::Callback;
     using casadi::Dict;
@@ -37,14 +39,34 @@
 
 using namespace OpenSim;
 
+#ifdef OPENSIM_WITH_CASADI
+namespace {
+/// Keep IPOPT from pushing the initial point and the multipliers away from
+/// the bounds, which would undo the warm start.
+void setIPOPTWarmStartOptions(Dict& solverOptions) {
+    solverOptions["warm_start_init_point"] = "yes";
+    solverOptions["warm_start_bound_push"] = 1e-9;
+    solverOptions["warm_start_slack_bound_push"] = 1e-9;
+    solverOptions["warm_start_mult_bound_push"] = 1e-9;
+}
+} // namespace
+#endif
+
 MocoCasADiSolver::MocoCasADiSolver() { constructProperties(); }
 
 void MocoCasADiSolver::constructProperties() {
     constructProperty_parameters_require_initsystem(true);
     constructProperty_optim_sparsity_detection("none");
+    constructProperty_optim_sparsity_cache_directory("");
     constructProperty_optim_write_sparsity("");
     constructProperty_optim_finite_difference_scheme("central");
+    constructProperty_optim_finite_difference_coloring(false);
     constructProperty_parallel();
+    constructProperty_batch_multibody_evaluation(false);
+    constructProperty_parallel_scheduler("casadi");
+    constructProperty_mesh_refinement_tolerance(-1);
+    constructProperty_mesh_refinement_max_iterations(5);
+    constructProperty_warm_start_init_point(false);
     constructProperty_output_interval(0);
 
     constructProperty_minimize_implicit_multibody_accelerations(false);
@@ -95,6 +117,10 @@ void MocoCasADiSolver::setGuess(MocoTrajectory guess) {
     clearGuess();
     m_guessFromAPI = std::move(guess);
 }
+void MocoCasADiSolver::setWarmStart(const MocoSolution& solution) {
+    setGuess(solution);
+    m_warmStart = solution;
+}
 void MocoCasADiSolver::setGuessFile(const std::string& file) {
     clearGuess();
     set_guess_file(file);
@@ -120,6 +146,7 @@ void MocoCasADiSolver::clearGuess() {
     m_guessFromFile = MocoTrajectory();
     set_guess_file("");
     m_guessToUse.reset();
+    m_warmStart = MocoSolution();
 }
 const MocoTrajectory& MocoCasADiSolver::getGuess() const {
     if (!m_guessToUse) {
@@ -160,6 +187,8 @@ std::unique_ptr<MocoCasOCProblem> MocoCasADiSolver::createCasOCProblem() const {
         numThreads = parallel;
     }
 
+    checkPropertyValueIsInSet(
+            getProperty_parallel_scheduler(), {"casadi", "work-stealing"});
     checkPropertyValueIsInSet(
             getProperty_multibody_dynamics_mode(), {"explicit", "implicit"});
     if (problemRep.isPrescribedKinematics()) {
@@ -265,18 +294,40 @@ std::unique_ptr<CasOC::Solver> MocoCasADiSolver::createCasOCSolver(
             solverOptions["constr_viol_tol"] = tol;
             solverOptions["acceptable_constr_viol_tol"] = tol;
         }
+        if (get_warm_start_init_point() &&
+                m_warmStart.hasOptimizationMultipliers()) {
+            setIPOPTWarmStartOptions(solverOptions);
+        }
     }
 
+    checkPropertyValueIsInRangeOrSet(getProperty_mesh_refinement_tolerance(),
+            0.0, SimTK::NTraits<double>::getInfinity(), {-1.0});
+    checkPropertyValueIsInRangeOrSet(
+            getProperty_mesh_refinement_max_iterations(), 0,
+            std::numeric_limits<int>::max(), {});
+
     checkPropertyValueIsInSet(getProperty_optim_sparsity_detection(),
             {"none", "random", "initial-guess"});
     casSolver->setSparsityDetection(get_optim_sparsity_detection());
     casSolver->setSparsityDetectionRandomCount(3);
 
+    casSolver->setSparsityCacheDirectory(
+            get_optim_sparsity_cache_directory());
+    if (!get_optim_sparsity_cache_directory().empty()) {
+        // The sparsity depends on the model, the problem, and the solver
+        // settings (e.g., the transcription scheme and the mesh); CasOC
+        // accounts for the points used for sparsity detection.
+        casSolver->setSparsityCacheKey(getProblem().dump() +
+                                       getProblemRep().getModelBase().dump() +
+                                       dump());
+    }
     casSolver->setWriteSparsity(get_optim_write_sparsity());
 
     checkPropertyValueIsInSet(getProperty_optim_finite_difference_scheme(),
             {"central", "forward", "backward"});
     casSolver->setFiniteDifferenceScheme(get_optim_finite_difference_scheme());
+    casSolver->setFiniteDifferenceColoring(
+            get_optim_finite_difference_coloring());
 
     casSolver->setCallbackInterval(get_output_interval());
 
@@ -326,6 +377,11 @@ std::unique_ptr<CasOC::Solver> MocoCasADiSolver::createCasOCSolver(
     if (casProblem.getJarSize() > 1) {
         casSolver->setParallelism("thread", casProblem.getJarSize());
     }
+    // The work-stealing scheduler distributes the points of a batch, so it
+    // requires batch evaluation.
+    casSolver->setBatchMultibodyEvaluation(get_batch_multibody_evaluation() ||
+                                           get_parallel_scheduler() ==
+                                                   "work-stealing");
     casSolver->setPluginOptions(pluginOptions);
     casSolver->setSolverOptions(solverOptions);
     return casSolver;
@@ -358,14 +414,58 @@ MocoSolution MocoCasADiSolver::solveImpl() const {
     } else {
         casGuess = convertToCasOCIterate(guess);
     }
+    CasOC::NLPMultipliers casMultipliersGuess;
+    if (get_warm_start_init_point()) {
+        if (m_warmStart.hasOptimizationMultipliers()) {
+            casMultipliersGuess = convertToCasOCNLPMultipliers(m_warmStart);
+        } else {
+            log_warn("MocoCasADiSolver: 'warm_start_init_point' is true but "
+                     "no multipliers are available; use setWarmStart() with "
+                     "a solution from MocoCasADiSolver.");
+        }
+    }
 
     // Temporarily disable printing of negative muscle force warnings so the
     // log isn't flooded while computing finite differences.
     Logger::Level origLoggerLevel = Logger::getLevel();
     Logger::setLevel(Logger::Level::Warn);
     CasOC::Solution casSolution;
+    int numIterations = 0;
     try {
-        casSolution = casSolver->solve(casGuess);
+        casSolution = casSolver->solve(casGuess, casMultipliersGuess);
+        numIterations += (int)casSolution.stats.at("iter_count");
+        // Refine the mesh where the estimated error is too large, and solve
+        // again starting from the previous solution.
+        const double refinementTol = get_mesh_refinement_tolerance();
+        for (int iref = 0; refinementTol > 0 &&
+                           iref < get_mesh_refinement_max_iterations() &&
+                           bool(casSolution.stats.at("success"));
+                ++iref) {
+            const auto errors =
+                    casSolver->estimateMeshIntervalErrors(casSolution);
+            const double maxError =
+                    *std::max_element(errors.begin(), errors.end());
+            if (get_verbosity()) {
+                Logger::setLevel(origLoggerLevel);
+                log_info("Mesh refinement iteration {}: {} mesh intervals, "
+                         "maximum estimated error {}.",
+                        iref, errors.size(), maxError);
+                Logger::setLevel(Logger::Level::Warn);
+            }
+            if (maxError <= refinementTol) break;
+            casSolver->setMesh(
+                    casSolver->createRefinedMesh(errors, refinementTol));
+            casGuess = casSolution;
+            if (get_warm_start_init_point() &&
+                    get_optim_solver() == "ipopt") {
+                casMultipliersGuess = casSolution.nlp_multipliers;
+                auto solverOptions = casSolver->getSolverOptions();
+                setIPOPTWarmStartOptions(solverOptions);
+                casSolver->setSolverOptions(solverOptions);
+            }
+            casSolution = casSolver->solve(casGuess, casMultipliersGuess);
+            numIterations += (int)casSolution.stats.at("iter_count");
+        }
     } catch (...) {
         OpenSim::Logger::setLevel(origLoggerLevel);
     }
@@ -373,6 +473,12 @@ MocoSolution MocoCasADiSolver::solveImpl() const {
 
     MocoSolution mocoSolution =
             convertToMocoTrajectory<MocoSolution>(casSolution);
+    if (!casSolution.nlp_multipliers.empty()) {
+        setSolutionOptimizationMultipliers(mocoSolution,
+                convertToMocoTrajectory(casSolution.nlp_multipliers.bounds),
+                convertToMocoConstraintMultipliers(
+                        casSolution.nlp_multipliers));
+    }
 
     // If enforcing model constraints and not minimizing Lagrange multipliers,
     // check the rank of the constraint Jacobian and if rank-deficient, print
@@ -422,7 +528,7 @@ MocoSolution MocoCasADiSolver::solveImpl() const {
     const long long elapsed = stopwatch.getElapsedTimeInNs();
     setSolutionStats(mocoSolution, casSolution.stats.at("success"),
             casSolution.objective, casSolution.stats.at("return_status"),
-            casSolution.stats.at("iter_count"), SimTK::nsToSec(elapsed),
+            numIterations, SimTK::nsToSec(elapsed),
             casSolution.objective_breakdown);
 
     if (get_verbosity()) {
@@ -62,6 +62,16 @@ of "random", we use 3 random trajectories and combine the resulting sparsity
 patterns. The seed used for these 3 random trajectories is always exactly
 the same, ensuring that the sparsity pattern is deterministic.
 
+Sparsity detection can take a long time for large models. If you solve many
+problems with the same model and problem structure (e.g., a batch of trials),
+set optim_sparsity_cache_directory to save the detected sparsity patterns to
+files that are reused by later solves. The files are identified by a hash of
+the model, the problem, the solver settings (including
+optim_sparsity_detection), and the points used for sparsity detection;
+changing any of these causes the sparsity to be detected again. Cache files
+that are corrupted or do not match the problem are ignored, and the sparsity
+is detected again.
+
 To explore the sparsity pattern for your problem, set optim_write_sparsity
 and run the resulting files with the plot_casadi_sparsity.py Python script.
 
@@ -71,6 +81,19 @@ The "central" finite difference is more accurate but can be 2 times
 slower than "forward" (tested on exampleSlidingMass). Sometimes, problems
 may struggle to converge with "forward".
 
+Mesh refinement
+===============
+A uniform mesh must be fine everywhere to be accurate where the dynamics
+change quickly (e.g., around heel strike). Instead, set
+mesh_refinement_tolerance to start from a coarse mesh (num_mesh_intervals or
+mesh) and subdivide only the mesh intervals whose error is too large. We
+estimate the error in a mesh interval by bisecting it and evaluating the
+defect constraints of the two halves at the interpolated solution; this
+evaluates the dynamics at points where the solution was not collocated. Each
+re-solve starts from the previous solution (and its multipliers, if
+warm_start_init_point is true), so refinement is usually much faster than
+solving on a dense uniform mesh.
+
 Parallelization
 ===============
 By default, CasADi evaluate the integral cost integrand and the
@@ -130,6 +153,12 @@ public:
             "Detect the sparsity pattern of derivatives; 'none' "
             "(for safe block sparsity; default), 'random', or "
             "'initial-guess'.");
+    OpenSim_DECLARE_PROPERTY(optim_sparsity_cache_directory, std::string,
+            "Save the sparsity patterns detected with "
+            "optim_sparsity_detection to this directory, and reuse them in "
+            "later solves of the same model and problem (with the same "
+            "initial guess, if optim_sparsity_detection is 'initial-guess'); "
+            "empty (default) to always detect the sparsity.");
     OpenSim_DECLARE_PROPERTY(optim_write_sparsity, std::string,
             "Write files for the sparsity pattern of the gradient, Jacobian, "
             "and Hessian to the working directory using this as a prefix; "
@@ -137,6 +166,12 @@ public:
     OpenSim_DECLARE_PROPERTY(optim_finite_difference_scheme, std::string,
             "The finite difference scheme CasADi will use to calculate problem "
             "derivatives (default: 'central').");
+    OpenSim_DECLARE_PROPERTY(optim_finite_difference_coloring, bool,
+            "Compute the derivatives of each function in the problem by "
+            "perturbing groups of variables that affect disjoint outputs "
+            "together (graph coloring), using the sparsity pattern from "
+            "optim_sparsity_detection. This has no effect if "
+            "optim_sparsity_detection is 'none' (default: false).");
 
     OpenSim_DECLARE_OPTIONAL_PROPERTY(parallel, int,
             "Evaluate integral costs and the differential-algebraic "
@@ -144,6 +179,33 @@ public:
             "0: not parallel; 1: use all cores (default); greater than 1: use"
             "this number of parallel jobs. This overrides the OPENSIM_MOCO_PARALLEL "
             "environment variable.");
+    OpenSim_DECLARE_PROPERTY(batch_multibody_evaluation, bool,
+            "Evaluate the multibody system at a block of grid points per "
+            "function call (one block per parallel job), instead of one grid "
+            "point per call. This reduces overhead for problems with many "
+            "mesh intervals (default: false).");
+    OpenSim_DECLARE_PROPERTY(parallel_scheduler, std::string,
+            "How to distribute grid points across parallel jobs when "
+            "'parallel' is not 0. 'casadi' (default): each job evaluates a "
+            "fixed block of grid points. 'work-stealing': the multibody "
+            "system is evaluated in a single batch whose grid points are "
+            "balanced dynamically across the jobs; idle jobs steal grid "
+            "points from busy ones.");
+    OpenSim_DECLARE_PROPERTY(mesh_refinement_tolerance, double,
+            "If positive, solve the problem repeatedly, refining the mesh "
+            "after each solve, until the estimated error in every mesh "
+            "interval is below this tolerance. Mesh intervals whose error "
+            "exceeds the tolerance are subdivided, and the previous solution "
+            "is the guess for the next solve (default: -1, no refinement).");
+    OpenSim_DECLARE_PROPERTY(mesh_refinement_max_iterations, int,
+            "The maximum number of times to refine the mesh if "
+            "'mesh_refinement_tolerance' is positive (default: 5).");
+    OpenSim_DECLARE_PROPERTY(warm_start_init_point, bool,
+            "Initialize the Lagrange multipliers and bound multipliers of the "
+            "optimization problem from the solution passed to "
+            "setWarmStart(), and use IPOPT's warm start options. This has no "
+            "effect if no warm start was set or if optim_solver is not "
+            "'ipopt' (default: false).");
     OpenSim_DECLARE_PROPERTY(output_interval, int,
             "Write intermediate trajectories to file. 0, the default, "
             "indicates no intermediate trajectories are saved, 1 indicates "
@@ -205,7 +267,16 @@ public:
     /// Set to an empty string to clear the guess file.
     void setGuessFile(const std::string& file);
 
-    /// Clear the stored guess and the `guess_file` if any.
+    /// Use a previous solution as the guess (see setGuess()) and keep its
+    /// optimization multipliers, if any, so that the solver can be
+    /// warm-started from them when `warm_start_init_point` is true. This is
+    /// useful when solving a sequence of similar problems (e.g., during mesh
+    /// refinement or when sweeping a parameter). The solution's mesh may
+    /// differ from `num_mesh_intervals`; the multipliers are interpolated.
+    /// This clears the `guess_file`, if one exists.
+    void setWarmStart(const MocoSolution& solution);
+
+    /// Clear the stored guess, the warm start, and the `guess_file` if any.
     void clearGuess();
 
     /// Access the guess, loading it from the guess_file if necessary.
@@ -235,6 +306,8 @@ private:
     MocoTrajectory m_guessFromAPI;
     mutable SimTK::ResetOnCopy<MocoTrajectory> m_guessFromFile;
     mutable SimTK::ReferencePtr<const MocoTrajectory> m_guessToUse;
+    // Holds the optimization multipliers from setWarmStart().
+    MocoSolution m_warmStart;
 };
 
 } // namespace OpenSim
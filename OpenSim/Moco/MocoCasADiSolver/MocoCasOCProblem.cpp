@@ -38,6 +38,12 @@ MocoCasOCProblem::MocoCasOCProblem(const MocoCasADiSolver& mocoCasADiSolver,
                   mocoCasADiSolver.get_parameters_require_initsystem()),
           m_formattedTimeString(getFormattedDateTime(true)) {
 
+    if (mocoCasADiSolver.get_parallel_scheduler() == "work-stealing" &&
+            m_jar->size() > 1) {
+        m_threadPool = OpenSim::make_unique<WorkStealingThreadPool>(
+                (int)m_jar->size());
+    }
+
     setDynamicsMode(dynamicsMode);
     const auto& model = problemRep.getModelBase();
 
@@ -21,6 +21,7 @@
 #include "CasOCProblem.h"
 #include "MocoCasADiSolver.h"
 
+#include <OpenSim/Common/CommonUtilities.h>
 #include <OpenSim/Moco/Components/AccelerationMotion.h>
 #include <OpenSim/Moco/Components/DiscreteController.h>
 #include <OpenSim/Moco/Components/DiscreteForces.h>
@@ -188,6 +189,41 @@ TOut convertToMocoTrajectory(const CasOC::Iterate& casIt) {
     return mocoTraj;
 }
 
+/// This converts the constraint multipliers of the nonlinear program into the
+/// layout used by MocoSolution, with one row per time and one column per
+/// equation.
+inline std::map<std::string, std::pair<SimTK::Vector, SimTK::Matrix>>
+convertToMocoConstraintMultipliers(const CasOC::NLPMultipliers& casMults) {
+    std::map<std::string, std::pair<SimTK::Vector, SimTK::Matrix>> out;
+    for (const auto& entry : casMults.constraints) {
+        const auto& casTimes = casMults.constraint_times.at(entry.first);
+        SimTK::Vector times;
+        if (!casTimes.is_empty()) times = convertToSimTKVector(casTimes);
+        out[entry.first] = {times, convertToSimTKMatrix(entry.second)};
+    }
+    return out;
+}
+
+/// This converts the optimization multipliers stored in a MocoSolution back
+/// into a CasOC::NLPMultipliers.
+inline CasOC::NLPMultipliers convertToCasOCNLPMultipliers(
+        const MocoSolution& mocoSolution) {
+    CasOC::NLPMultipliers casMults;
+    casMults.bounds = convertToCasOCIterate(mocoSolution.getBoundMultipliers());
+    // convertToCasOCIterate() uses the initial and final times as the values
+    // for these variables; MocoTrajectory cannot hold their multipliers.
+    casMults.bounds.variables[CasOC::Var::initial_time] = 0;
+    casMults.bounds.variables[CasOC::Var::final_time] = 0;
+    for (const auto& type : mocoSolution.getConstraintMultiplierTypes()) {
+        const auto& times = mocoSolution.getConstraintMultiplierTimes(type);
+        casMults.constraints[type] = convertToCasADiDMTranspose(
+                mocoSolution.getConstraintMultipliers(type));
+        casMults.constraint_times[type] =
+                times.size() ? convertToCasADiDM(times) : casadi::DM();
+    }
+    return casMults;
+}
+
 /// This class is the bridge between CasOC::Problem and MocoProblemRep. Inputs
 /// are CasADi types, which are converted to SimTK types to evaluate problem
 /// functions. Then, results are converted back into CasADi types.
@@ -205,97 +241,43 @@ private:
             bool calcKCErrors,
             MultibodySystemExplicitOutput& output) const override {
         auto mocoProblemRep = m_jar->take();
-
-        const auto& modelBase = mocoProblemRep->getModelBase();
-        auto& simtkStateBase = mocoProblemRep->updStateBase();
-
-        const auto& modelDisabledConstraints =
-                mocoProblemRep->getModelDisabledConstraints();
-        auto& simtkStateDisabledConstraints =
-                mocoProblemRep->updStateDisabledConstraints();
-
-        applyInput(SimTK::Stage::Acceleration, input.time, input.states,
-                input.controls, input.multipliers, input.derivatives,
-                input.parameters, mocoProblemRep);
-
-        // Compute the accelerations.
-        modelDisabledConstraints.realizeAcceleration(
-                simtkStateDisabledConstraints);
-
-        // Compute kinematic constraint errors if they exist.
-        if (getNumMultipliers() && calcKCErrors) {
-            calcKinematicConstraintErrors(modelBase, simtkStateBase,
-                    simtkStateDisabledConstraints,
-                    output.kinematic_constraint_errors);
-        }
-
-        // Copy state derivative values to output.
-        const auto& udot = simtkStateDisabledConstraints.getUDot();
-        const auto& zdot = simtkStateDisabledConstraints.getZDot();
-        std::copy_n(udot.getContiguousScalarData(), udot.size(),
-                output.multibody_derivatives.ptr());
-        std::copy_n(zdot.getContiguousScalarData(), zdot.size(),
-                output.auxiliary_derivatives.ptr());
-
-        // Copy auxiliary residuals to output.
-        copyImplicitResidualsToOutput(*mocoProblemRep,
-                simtkStateDisabledConstraints, output.auxiliary_residuals);
-
+        calcMultibodySystemExplicitImpl(
+                input, calcKCErrors, output, mocoProblemRep);
         m_jar->leave(std::move(mocoProblemRep));
     }
     void calcMultibodySystemImplicit(const ContinuousInput& input,
             bool calcKCErrors,
             MultibodySystemImplicitOutput& output) const override {
         auto mocoProblemRep = m_jar->take();
-
-        // Original model and its associated state. These are used to calculate
-        // kinematic constraint forces and errors.
-        const auto& modelBase = mocoProblemRep->getModelBase();
-        auto& simtkStateBase = mocoProblemRep->updStateBase();
-
-        // Model with disabled constriants and its associated state. These are
-        // used to compute the accelerations.
-        const auto& modelDisabledConstraints =
-                mocoProblemRep->getModelDisabledConstraints();
-        auto& simtkStateDisabledConstraints =
-                mocoProblemRep->updStateDisabledConstraints();
-
-        applyInput(SimTK::Stage::Acceleration, input.time, input.states,
-                input.controls, input.multipliers, input.derivatives,
-                input.parameters, mocoProblemRep);
-
-        modelDisabledConstraints.realizeAcceleration(
-                simtkStateDisabledConstraints);
-
-        // Compute kinematic constraint errors if they exist.
-        // TODO: Do not enforce kinematic constraints if prescribedKinematics,
-        // but must make sure the prescribedKinematics already obey the
-        // constraints. This is simple at the q and u level (using assemble()),
-        // but what do we do for the acceleration level?
-        if (getNumMultipliers() && calcKCErrors) {
-            calcKinematicConstraintErrors(modelBase, simtkStateBase,
-                    simtkStateDisabledConstraints,
-                    output.kinematic_constraint_errors);
-        }
-
-        const SimTK::SimbodyMatterSubsystem& matterDisabledConstraints =
-                modelDisabledConstraints.getMatterSubsystem();
-        SimTK::Vector simtkResidual((int)output.multibody_residuals.rows(),
-                output.multibody_residuals.ptr(), true);
-        matterDisabledConstraints.findMotionForces(
-                simtkStateDisabledConstraints, simtkResidual);
-
-        // Copy auxiliary dynamics to output.
-        const auto& zdot = simtkStateDisabledConstraints.getZDot();
-        std::copy_n(zdot.getContiguousScalarData(), zdot.size(),
-                output.auxiliary_derivatives.ptr());
-
-        // Copy auxiliary residuals to output.
-        copyImplicitResidualsToOutput(*mocoProblemRep,
-                simtkStateDisabledConstraints, output.auxiliary_residuals);
-
+        calcMultibodySystemImplicitImpl(
+                input, calcKCErrors, output, mocoProblemRep);
         m_jar->leave(std::move(mocoProblemRep));
     }
+    void calcMultibodySystemExplicitBatch(const ContinuousBatchInput& input,
+            bool calcKCErrors,
+            MultibodySystemExplicitOutput& output) const override {
+        calcMultibodySystemBatch(input, output,
+                [&](const ContinuousInput& pointInput,
+                        MultibodySystemExplicitOutput& pointOutput,
+                        const std::unique_ptr<const MocoProblemRep>& rep) {
+                    calcMultibodySystemExplicitImpl(
+                            pointInput, calcKCErrors, pointOutput, rep);
+                });
+    }
+    void calcMultibodySystemImplicitBatch(const ContinuousBatchInput& input,
+            bool calcKCErrors,
+            MultibodySystemImplicitOutput& output) const override {
+        calcMultibodySystemBatch(input, output,
+                [&](const ContinuousInput& pointInput,
+                        MultibodySystemImplicitOutput& pointOutput,
+                        const std::unique_ptr<const MocoProblemRep>& rep) {
+                    calcMultibodySystemImplicitImpl(
+                            pointInput, calcKCErrors, pointOutput, rep);
+                });
+    }
+    bool isBatchEvaluationParallel() const override {
+        return m_threadPool != nullptr;
+    }
     void calcVelocityCorrection(const double& time,
             const casadi::DM& multibody_states, const casadi::DM& slacks,
             const casadi::DM& parameters,
@@ -503,6 +485,150 @@ private:
     }
 
 private:
+    /// Evaluate each point of a batch with `calcPoint(pointInput,
+    /// pointOutput, mocoProblemRep)`. Without a thread pool, we take a
+    /// MocoProblemRep from the jar once and reuse its models and states for
+    /// all points. With a thread pool, the points are distributed across the
+    /// pool's threads, and each thread takes a MocoProblemRep the first time
+    /// it evaluates a point and keeps it until the batch is done.
+    template <typename TOutput, typename TCalcPoint>
+    void calcMultibodySystemBatch(const ContinuousBatchInput& input,
+            TOutput& output, TCalcPoint calcPoint) const {
+        const int numPoints = (int)input.times.numel();
+        if (!m_threadPool || numPoints < 2) {
+            auto mocoProblemRep = m_jar->take();
+            forEachPointInBatch(input, output,
+                    [&](const ContinuousInput& pointInput,
+                            TOutput& pointOutput) {
+                        calcPoint(pointInput, pointOutput, mocoProblemRep);
+                    });
+            m_jar->leave(std::move(mocoProblemRep));
+            return;
+        }
+
+        const int numWorkers = m_threadPool->getNumThreads();
+        std::vector<std::unique_ptr<const MocoProblemRep>> reps(numWorkers);
+        std::vector<std::unique_ptr<BatchPointEvaluator<TOutput>>> evaluators(
+                numWorkers);
+        auto leaveAll = [&]() {
+            for (auto& rep : reps) {
+                if (rep) m_jar->leave(std::move(rep));
+            }
+        };
+        try {
+            m_threadPool->parallelFor(numPoints, [&](int worker, int ipoint) {
+                auto& rep = reps[worker];
+                if (!rep) {
+                    rep = m_jar->take();
+                    evaluators[worker] = OpenSim::make_unique<
+                            BatchPointEvaluator<TOutput>>(input, output);
+                }
+                evaluators[worker]->eval(ipoint,
+                        [&](const ContinuousInput& pointInput,
+                                TOutput& pointOutput) {
+                            calcPoint(pointInput, pointOutput, rep);
+                        });
+            });
+        } catch (...) {
+            leaveAll();
+            throw;
+        }
+        leaveAll();
+    }
+
+    /// Compute the explicit multibody system for a single point using the
+    /// provided MocoProblemRep, which the caller has taken from the jar.
+    void calcMultibodySystemExplicitImpl(const ContinuousInput& input,
+            bool calcKCErrors, MultibodySystemExplicitOutput& output,
+            const std::unique_ptr<const MocoProblemRep>& mocoProblemRep)
+            const {
+        const auto& modelBase = mocoProblemRep->getModelBase();
+        auto& simtkStateBase = mocoProblemRep->updStateBase();
+
+        const auto& modelDisabledConstraints =
+                mocoProblemRep->getModelDisabledConstraints();
+        auto& simtkStateDisabledConstraints =
+                mocoProblemRep->updStateDisabledConstraints();
+
+        applyInput(SimTK::Stage::Acceleration, input.time, input.states,
+                input.controls, input.multipliers, input.derivatives,
+                input.parameters, mocoProblemRep);
+
+        // Compute the accelerations.
+        modelDisabledConstraints.realizeAcceleration(
+                simtkStateDisabledConstraints);
+
+        // Compute kinematic constraint errors if they exist.
+        if (getNumMultipliers() && calcKCErrors) {
+            calcKinematicConstraintErrors(modelBase, simtkStateBase,
+                    simtkStateDisabledConstraints,
+                    output.kinematic_constraint_errors);
+        }
+
+        // Copy state derivative values to output.
+        const auto& udot = simtkStateDisabledConstraints.getUDot();
+        const auto& zdot = simtkStateDisabledConstraints.getZDot();
+        std::copy_n(udot.getContiguousScalarData(), udot.size(),
+                output.multibody_derivatives.ptr());
+        std::copy_n(zdot.getContiguousScalarData(), zdot.size(),
+                output.auxiliary_derivatives.ptr());
+
+        // Copy auxiliary residuals to output.
+        copyImplicitResidualsToOutput(*mocoProblemRep,
+                simtkStateDisabledConstraints, output.auxiliary_residuals);
+    }
+    /// Compute the implicit multibody system for a single point using the
+    /// provided MocoProblemRep, which the caller has taken from the jar.
+    void calcMultibodySystemImplicitImpl(const ContinuousInput& input,
+            bool calcKCErrors, MultibodySystemImplicitOutput& output,
+            const std::unique_ptr<const MocoProblemRep>& mocoProblemRep)
+            const {
+        // Original model and its associated state. These are used to calculate
+        // kinematic constraint forces and errors.
+        const auto& modelBase = mocoProblemRep->getModelBase();
+        auto& simtkStateBase = mocoProblemRep->updStateBase();
+
+        // Model with disabled constriants and its associated state. These are
+        // used to compute the accelerations.
+        const auto& modelDisabledConstraints =
+                mocoProblemRep->getModelDisabledConstraints();
+        auto& simtkStateDisabledConstraints =
+                mocoProblemRep->updStateDisabledConstraints();
+
+        applyInput(SimTK::Stage::Acceleration, input.time, input.states,
+                input.controls, input.multipliers, input.derivatives,
+                input.parameters, mocoProblemRep);
+
+        modelDisabledConstraints.realizeAcceleration(
+                simtkStateDisabledConstraints);
+
+        // Compute kinematic constraint errors if they exist.
+        // TODO: Do not enforce kinematic constraints if prescribedKinematics,
+        // but must make sure the prescribedKinematics already obey the
+        // constraints. This is simple at the q and u level (using assemble()),
+        // but what do we do for the acceleration level?
+        if (getNumMultipliers() && calcKCErrors) {
+            calcKinematicConstraintErrors(modelBase, simtkStateBase,
+                    simtkStateDisabledConstraints,
+                    output.kinematic_constraint_errors);
+        }
+
+        const SimTK::SimbodyMatterSubsystem& matterDisabledConstraints =
+                modelDisabledConstraints.getMatterSubsystem();
+        SimTK::Vector simtkResidual((int)output.multibody_residuals.rows(),
+                output.multibody_residuals.ptr(), true);
+        matterDisabledConstraints.findMotionForces(
+                simtkStateDisabledConstraints, simtkResidual);
+
+        // Copy auxiliary dynamics to output.
+        const auto& zdot = simtkStateDisabledConstraints.getZDot();
+        std::copy_n(zdot.getContiguousScalarData(), zdot.size(),
+                output.auxiliary_derivatives.ptr());
+
+        // Copy auxiliary residuals to output.
+        copyImplicitResidualsToOutput(*mocoProblemRep,
+                simtkStateDisabledConstraints, output.auxiliary_residuals);
+    }
     /// Apply parameters to properties in the models returned by
     /// `mocoProblemRep.getModelBase()` and
     /// `mocoProblemRep.getModelDisabledConstraints()`.
@@ -752,6 +878,9 @@ private:
     std::unordered_map<int, int> m_yIndexMap;
     std::vector<int> m_modelControlIndices;
     std::unique_ptr<FileDeletionThrower> m_fileDeletionThrower;
+    // Evaluates the points of a batch in parallel if the solver's
+    // parallel_scheduler is "work-stealing"; otherwise, this is null.
+    std::unique_ptr<WorkStealingThreadPool> m_threadPool;
     // Local memory to hold constraint forces.
     static thread_local SimTK::Vector_<SimTK::SpatialVec>
             m_constraintBodyForces;
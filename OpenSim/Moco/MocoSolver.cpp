@@ -101,6 +101,18 @@ void MocoSolver::setSolutionStats(MocoSolution& sol, bool success,
     sol.setObjectiveBreakdown(std::move(objectiveBreakdown));
 }
 
+void MocoSolver::setSolutionOptimizationMultipliers(MocoSolution& sol,
+        MocoTrajectory boundMultipliers,
+        const std::map<std::string, std::pair<SimTK::Vector, SimTK::Matrix>>&
+                constraintMultipliers) {
+    std::map<std::string, MocoSolution::ConstraintMultipliers> constraints;
+    for (const auto& entry : constraintMultipliers) {
+        constraints[entry.first] = {entry.second.first, entry.second.second};
+    }
+    sol.setOptimizationMultipliers(
+            std::move(boundMultipliers), std::move(constraints));
+}
+
 std::unique_ptr<ThreadsafeJar<const MocoProblemRep>>
         MocoSolver::createProblemRepJar(int size) const {
     auto jar = OpenSim::make_unique<ThreadsafeJar<const MocoProblemRep>>();
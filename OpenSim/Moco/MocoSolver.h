@@ -89,10 +89,24 @@ protected:
             std::vector<std::pair<std::string, double>> objectiveBreakdown =
                     {});
 
+    /// Store the multipliers of the optimization problem in the solution (see
+    /// MocoSolution::getBoundMultipliers()). Each entry of
+    /// `constraintMultipliers` maps a constraint type to the normalized times
+    /// and the multipliers (one row per time).
+    static void setSolutionOptimizationMultipliers(MocoSolution&,
+            MocoTrajectory boundMultipliers,
+            const std::map<std::string,
+                    std::pair<SimTK::Vector, SimTK::Matrix>>&
+                    constraintMultipliers);
+
     const MocoProblemRep& getProblemRep() const {
         return m_problemRep;
     }
 
+    /// The problem provided to resetProblem().
+    /// @precondition You must have called resetProblem().
+    const MocoProblem& getProblem() const { return m_problem.getRef(); }
+
     /// Create a library of MocoProblemRep%s for use in parallelized code.
     // TODO SWIG ignore.
     std::unique_ptr<ThreadsafeJar<const MocoProblemRep>>
@@ -20,8 +20,10 @@
 #include "MocoProblem.h"
 #include "MocoUtilities.h"
 
+#include <OpenSim/Common/BSTOFileAdapter.h>
 #include <OpenSim/Common/STOFileAdapter.h>
 #include <OpenSim/Common/GCVSplineSet.h>
+#include <OpenSim/Common/IO.h>
 #include <OpenSim/Simulation/Model/Model.h>
 
 using namespace OpenSim;
@@ -779,7 +781,11 @@ MocoTrajectory::MocoTrajectory(const std::string& filepath) {
 
 void MocoTrajectory::write(const std::string& filepath) const {
     ensureUnsealed();
-    STOFileAdapter::write(convertToTable(), filepath);
+    if (IO::EndsWith(IO::Lowercase(filepath), ".bsto")) {
+        BSTOFileAdapter::write(convertToTable(), filepath);
+    } else {
+        STOFileAdapter::write(convertToTable(), filepath);
+    }
 }
 
 TimeSeriesTable MocoTrajectory::convertToTable() const {
@@ -1381,6 +1387,34 @@ void MocoSolution::printObjectiveBreakdown() const {
     }
 }
 
+std::vector<std::string> MocoSolution::getConstraintMultiplierTypes() const {
+    ensureUnsealed();
+    std::vector<std::string> types;
+    for (const auto& entry : m_constraintMultipliers) {
+        types.push_back(entry.first);
+    }
+    return types;
+}
+
+const MocoSolution::ConstraintMultipliers&
+MocoSolution::getConstraintMultipliersImpl(const std::string& type) const {
+    ensureUnsealed();
+    auto it = m_constraintMultipliers.find(type);
+    OPENSIM_THROW_IF(it == m_constraintMultipliers.end(), Exception,
+            "No multipliers for constraint type '{}'.", type);
+    return it->second;
+}
+
+const SimTK::Vector& MocoSolution::getConstraintMultiplierTimes(
+        const std::string& type) const {
+    return getConstraintMultipliersImpl(type).times;
+}
+
+const SimTK::Matrix& MocoSolution::getConstraintMultipliers(
+        const std::string& type) const {
+    return getConstraintMultipliersImpl(type).values;
+}
+
 void MocoSolution::convertToTableImpl(TimeSeriesTable& table) const {
     std::string success = m_success ? "true" : "false";
     table.updTableMetaData().setValueForKey("success", success);
@@ -815,6 +815,41 @@ public:
     void printObjectiveBreakdown() const;
     /// @}
 
+    /// @name Multipliers of the optimization problem
+    /// Some solvers (e.g., MocoCasADiSolver with IPOPT) provide the
+    /// multipliers (dual variables) of the nonlinear program at the solution.
+    /// MocoCasADiSolver::setWarmStart() uses these to warm-start the solver
+    /// for a similar problem. These multipliers are not written to file.
+    /// @{
+
+    /// Returns true if the solver provided the multipliers of the
+    /// optimization problem.
+    bool hasOptimizationMultipliers() const {
+        return !m_constraintMultipliers.empty();
+    }
+    /// The multipliers for the bounds on the variables, with the same layout
+    /// as this solution (e.g., the states trajectory contains the multipliers
+    /// for the bounds on the states).
+    const MocoTrajectory& getBoundMultipliers() const {
+        ensureUnsealed();
+        return m_boundMultipliers;
+    }
+    /// The types of constraints in the optimization problem (e.g.,
+    /// "defects", "path_<name>", or "endpoint_<name>"), for use with
+    /// getConstraintMultipliers().
+    std::vector<std::string> getConstraintMultiplierTypes() const;
+    /// The times, normalized to [0, 1], at which each row of
+    /// getConstraintMultipliers() applies. The times are empty for
+    /// constraints that do not apply at a specific time (e.g., endpoint
+    /// constraints).
+    const SimTK::Vector& getConstraintMultiplierTimes(
+            const std::string& type) const;
+    /// The multipliers for a type of constraint, with one row per time (see
+    /// getConstraintMultiplierTimes()) and one column per equation.
+    const SimTK::Matrix& getConstraintMultipliers(
+            const std::string& type) const;
+    /// @}
+
     /// @name Access control
     /// @{
 
@@ -856,6 +891,17 @@ private:
         m_numIterations = numIterations;
     };
     void setSolverDuration(double duration) { m_solverDuration = duration; }
+    struct ConstraintMultipliers {
+        SimTK::Vector times;
+        SimTK::Matrix values;
+    };
+    void setOptimizationMultipliers(MocoTrajectory boundMultipliers,
+            std::map<std::string, ConstraintMultipliers> constraints) {
+        m_boundMultipliers = std::move(boundMultipliers);
+        m_constraintMultipliers = std::move(constraints);
+    }
+    const ConstraintMultipliers& getConstraintMultipliersImpl(
+            const std::string& type) const;
     void convertToTableImpl(TimeSeriesTable&) const override;
     bool m_success = true;
     double m_objective = -1;
@@ -863,6 +909,8 @@ private:
     std::string m_status;
     int m_numIterations = -1;
     double m_solverDuration = -1;
+    MocoTrajectory m_boundMultipliers;
+    std::map<std::string, ConstraintMultipliers> m_constraintMultipliers;
     // Allow solvers to set success, status, and construct a solution.
     friend class MocoSolver;
 };
@@ -19,6 +19,7 @@
  * -------------------------------------------------------------------------- */
 
 #include <OpenSim/Actuators/ModelProcessor.h>
+#include <OpenSim/Actuators/MuscleBank.h>
 
 namespace OpenSim {
 
@@ -180,6 +181,22 @@ public:
     }
 };
 
+/** Add a MuscleBank to the model, so that all DeGrooteFregly2016Muscle%s in
+the model are computed together. This does not change the results, but is
+faster for models with many muscles. Apply this after any operators that
+replace or add muscles. */
+class OSIMMOCO_API ModOpAddMuscleBankDGF : public ModelOperator {
+    OpenSim_DECLARE_CONCRETE_OBJECT(ModOpAddMuscleBankDGF, ModelOperator);
+
+public:
+    void operate(Model& model, const std::string&) const override {
+        model.finalizeFromProperties();
+        if (model.countNumComponents<MuscleBank>() == 0) {
+            model.addComponent(new MuscleBank());
+        }
+    }
+};
+
 } // namespace OpenSim
 
 #endif // OPENSIM_MODELOPERATORS_H
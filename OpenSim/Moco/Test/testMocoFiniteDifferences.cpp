@@ -0,0 +1,61 @@
+/* -------------------------------------------------------------------------- *
+ * OpenSim Moco: testMocoFiniteDifferences.cpp                                *
+ * -------------------------------------------------------------------------- *
+ * Copyright (c) 2020 Stanford University and the Authors                     *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0          *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+#define CATCH_CONFIG_MAIN
+#include "Testing.h"
+
+#include <OpenSim/Moco/MocoCasADiSolver/CasOCFunction.h>
+#include <cmath>
+
+using namespace CasOC;
+
+TEST_CASE("Colored finite difference Jacobian", "[casadi]") {
+    // y0 = x0^2
+    // y1 = x0 x1
+    // y2 = sin(x1) + 1e-12 x2^2
+    // x0 and x2 are large, so that steps that are not relative to the
+    // magnitude of the variables give inaccurate derivatives.
+    auto function = [](const std::vector<double>& x, std::vector<double>& y) {
+        y = {x[0] * x[0], x[0] * x[1], std::sin(x[1]) + 1e-12 * x[2] * x[2]};
+    };
+    const std::vector<double> x0{1e6, 0.5, -2e5};
+    std::vector<double> y0;
+    function(x0, y0);
+
+    const casadi::Sparsity sparsity =
+            casadi::Sparsity::triplet(3, 3, {0, 1, 1, 2, 2}, {0, 0, 1, 1, 2});
+    const JacobianColoring coloring(sparsity);
+    // Columns 0 and 2 do not share a row.
+    CHECK(coloring.getNumColors() == 2);
+
+    // The nonzeros in column-major order.
+    const std::vector<double> expected{
+            2 * x0[0], x0[1], x0[0], std::cos(x0[1]), 2e-12 * x0[2]};
+    for (const std::string scheme : {"central", "forward", "backward"}) {
+        CAPTURE(scheme);
+        const std::vector<double> jacobian = calcFiniteDifferenceJacobian(
+                function, coloring, scheme, x0, y0);
+        REQUIRE(jacobian.size() == expected.size());
+        for (int k = 0; k < (int)expected.size(); ++k) {
+            CAPTURE(k);
+            CHECK(jacobian[k] == Approx(expected[k]).epsilon(1e-6));
+        }
+    }
+
+    CHECK_THROWS_AS(calcFiniteDifferenceJacobian(
+                            function, coloring, "central", {1, 2}, y0),
+            OpenSim::Exception);
+}
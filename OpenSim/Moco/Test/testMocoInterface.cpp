@@ -18,7 +18,11 @@
 
 #define CATCH_CONFIG_MAIN
 #include "Testing.h"
+#include <algorithm>
+#include <cstdio>
 #include <fstream>
+#include <set>
+#include <sstream>
 
 #include <OpenSim/Actuators/BodyActuator.h>
 #include <OpenSim/Actuators/CoordinateActuator.h>
@@ -1739,6 +1743,253 @@ TEMPLATE_TEST_CASE("Sliding mass", "", MocoCasADiSolver,
     }
 }
 
+TEST_CASE("Batch multibody evaluation", "[casadi]") {
+    // Evaluating the multibody system in blocks of grid points should not
+    // change the solution. With 3 threads, the blocks require padding.
+    for (const std::string dynamicsMode : {"explicit", "implicit"}) {
+        for (int parallel : {0, 3}) {
+            CAPTURE(dynamicsMode, parallel);
+            MocoStudy study = createSlidingMassMocoStudy<MocoCasADiSolver>();
+            auto& solver = study.updSolver<MocoCasADiSolver>();
+            solver.set_transcription_scheme("hermite-simpson");
+            solver.set_multibody_dynamics_mode(dynamicsMode);
+            solver.set_parallel(parallel);
+            solver.set_batch_multibody_evaluation(false);
+            MocoSolution pointwise = study.solve();
+            solver.set_batch_multibody_evaluation(true);
+            MocoSolution batch = study.solve();
+            REQUIRE(pointwise.success());
+            REQUIRE(batch.success());
+            CHECK(batch.compareContinuousVariablesRMS(pointwise) < 1e-6);
+        }
+    }
+}
+
+TEST_CASE("Finite difference coloring", "[casadi]") {
+    // Coloring changes the finite difference step sizes, so the solutions are
+    // close but not identical.
+    for (const std::string dynamicsMode : {"explicit", "implicit"}) {
+        for (const std::string scheme : {"central", "forward"}) {
+            CAPTURE(dynamicsMode, scheme);
+            MocoStudy study = createSlidingMassMocoStudy<MocoCasADiSolver>();
+            auto& solver = study.updSolver<MocoCasADiSolver>();
+            solver.set_multibody_dynamics_mode(dynamicsMode);
+            solver.set_optim_sparsity_detection("random");
+            solver.set_optim_finite_difference_scheme(scheme);
+            solver.set_optim_finite_difference_coloring(false);
+            MocoSolution uncolored = study.solve();
+            solver.set_optim_finite_difference_coloring(true);
+            MocoSolution colored = study.solve();
+            REQUIRE(uncolored.success());
+            REQUIRE(colored.success());
+            CHECK(colored.compareContinuousVariablesRMS(uncolored) < 1e-3);
+        }
+    }
+}
+
+/// Solve the study and return the names of the sparsity cache files that
+/// CasOC reported with the given action ("Read" or "Wrote").
+std::set<std::string> solveAndGetSparsityCacheFiles(MocoStudy& study,
+        const std::string& action, MocoSolution& solution,
+        int* numIgnored = nullptr) {
+    std::ostringstream output;
+    std::streambuf* coutBuffer = std::cout.rdbuf(output.rdbuf());
+    try {
+        solution = study.solve();
+    } catch (...) {
+        std::cout.rdbuf(coutBuffer);
+        throw;
+    }
+    std::cout.rdbuf(coutBuffer);
+    std::cout << output.str();
+
+    std::set<std::string> files;
+    const std::string prefix = "[CasOC] " + action + " sparsity cache file '";
+    const std::string log = output.str();
+    for (auto begin = log.find(prefix); begin != std::string::npos;
+            begin = log.find(prefix, begin)) {
+        begin += prefix.size();
+        const auto end = log.find('\'', begin);
+        files.insert(log.substr(begin, end - begin));
+    }
+    if (numIgnored) {
+        *numIgnored = 0;
+        const std::string ignored = "[CasOC] Ignoring invalid sparsity cache";
+        for (auto pos = log.find(ignored); pos != std::string::npos;
+                pos = log.find(ignored, pos + 1)) {
+            ++*numIgnored;
+        }
+    }
+    return files;
+}
+
+TEST_CASE("Sparsity cache", "[casadi]") {
+    for (const std::string detection : {"random", "initial-guess"}) {
+        CAPTURE(detection);
+        MocoStudy study = createSlidingMassMocoStudy<MocoCasADiSolver>();
+        auto& solver = study.updSolver<MocoCasADiSolver>();
+        solver.set_optim_sparsity_detection(detection);
+        MocoSolution uncached = study.solve();
+        REQUIRE(uncached.success());
+        solver.set_optim_sparsity_cache_directory(
+                "testMocoInterface_sparsity_cache");
+
+        // Start from an empty cache: remove the files that a previous run of
+        // this test may have left behind.
+        {
+            MocoSolution solution;
+            for (const auto& action : {"Read", "Wrote"}) {
+                for (const auto& file : solveAndGetSparsityCacheFiles(
+                             study, action, solution)) {
+                    std::remove(file.c_str());
+                }
+            }
+        }
+
+        // The first solve writes the cache.
+        MocoSolution writeCache;
+        const auto written =
+                solveAndGetSparsityCacheFiles(study, "Wrote", writeCache);
+        REQUIRE(!written.empty());
+        for (const auto& file : written) {
+            INFO(file);
+            CHECK(IO::FileExists(file));
+        }
+        CHECK(writeCache.isNumericallyEqual(uncached));
+
+        // The second solve reads the cache and does not detect the sparsity.
+        MocoSolution readCache;
+        CHECK(solveAndGetSparsityCacheFiles(study, "Read", readCache) ==
+                written);
+        REQUIRE(readCache.success());
+        CHECK(readCache.isNumericallyEqual(uncached));
+
+        // A corrupted cache file, or one for a function with different
+        // dimensions, is ignored; the sparsity is detected and the file is
+        // rewritten.
+        for (const std::string contents : {"not a sparsity pattern", "1 1 0"}) {
+            CAPTURE(contents);
+            const std::string& invalidFile = *written.begin();
+            {
+                std::ofstream file(invalidFile);
+                file << contents << std::endl;
+            }
+            MocoSolution invalidCache;
+            int numIgnored = 0;
+            const auto rewritten = solveAndGetSparsityCacheFiles(
+                    study, "Wrote", invalidCache, &numIgnored);
+            CHECK(numIgnored >= 1);
+            CHECK(rewritten == std::set<std::string>{invalidFile});
+            REQUIRE(invalidCache.success());
+            CHECK(invalidCache.isNumericallyEqual(uncached));
+        }
+
+        // A different detection setting does not reuse these files.
+        solver.set_optim_sparsity_detection(
+                detection == "random" ? "initial-guess" : "random");
+        MocoSolution otherDetection;
+        for (const auto& file : solveAndGetSparsityCacheFiles(
+                     study, "Read", otherDetection)) {
+            CHECK(written.count(file) == 0);
+        }
+    }
+}
+
+TEST_CASE("Work-stealing parallel scheduler", "[casadi]") {
+    for (const std::string dynamicsMode : {"explicit", "implicit"}) {
+        CAPTURE(dynamicsMode);
+        MocoStudy study = createSlidingMassMocoStudy<MocoCasADiSolver>();
+        auto& solver = study.updSolver<MocoCasADiSolver>();
+        solver.set_transcription_scheme("hermite-simpson");
+        solver.set_multibody_dynamics_mode(dynamicsMode);
+        solver.set_parallel(3);
+        MocoSolution casadiScheduler = study.solve();
+        solver.set_parallel_scheduler("work-stealing");
+        MocoSolution workStealing = study.solve();
+        REQUIRE(casadiScheduler.success());
+        REQUIRE(workStealing.success());
+        CHECK(workStealing.compareContinuousVariablesRMS(casadiScheduler) <
+                1e-6);
+    }
+    {
+        MocoStudy study = createSlidingMassMocoStudy<MocoCasADiSolver>();
+        auto& solver = study.updSolver<MocoCasADiSolver>();
+        solver.set_parallel_scheduler("guided");
+        CHECK_THROWS(study.solve());
+    }
+}
+
+TEST_CASE("Mesh refinement", "[casadi]") {
+    for (const std::string scheme : {"trapezoidal", "hermite-simpson"}) {
+        CAPTURE(scheme);
+        MocoStudy study = createSlidingMassMocoStudy<MocoCasADiSolver>();
+        auto& solver = study.updSolver<MocoCasADiSolver>();
+        solver.set_transcription_scheme(scheme);
+        solver.set_num_mesh_intervals(100);
+        MocoSolution dense = study.solve();
+        REQUIRE(dense.success());
+
+        solver.set_num_mesh_intervals(8);
+        MocoSolution coarse = study.solve();
+        solver.set_mesh_refinement_tolerance(1e-3);
+        solver.set_mesh_refinement_max_iterations(4);
+        MocoSolution refined = study.solve();
+        REQUIRE(refined.success());
+        CHECK(refined.getNumTimes() > coarse.getNumTimes());
+        CHECK(refined.getNumTimes() < dense.getNumTimes());
+        CHECK(refined.getFinalTime() ==
+                Approx(dense.getFinalTime()).epsilon(1e-2));
+
+        // No refinement is performed if the maximum number of iterations is
+        // 0.
+        solver.set_mesh_refinement_max_iterations(0);
+        MocoSolution unrefined = study.solve();
+        CHECK(unrefined.getNumTimes() == coarse.getNumTimes());
+    }
+    MocoStudy study = createSlidingMassMocoStudy<MocoCasADiSolver>();
+    auto& solver = study.updSolver<MocoCasADiSolver>();
+    solver.set_mesh_refinement_tolerance(-2);
+    CHECK_THROWS(study.solve());
+}
+
+TEST_CASE("Warm start with multipliers", "[casadi]") {
+    MocoStudy study = createSlidingMassMocoStudy<MocoCasADiSolver>();
+    auto& solver = study.updSolver<MocoCasADiSolver>();
+    solver.set_transcription_scheme("hermite-simpson");
+    MocoSolution cold = study.solve();
+    REQUIRE(cold.success());
+    REQUIRE(cold.hasOptimizationMultipliers());
+    CHECK(cold.getBoundMultipliers().getNumTimes() == cold.getNumTimes());
+    const auto types = cold.getConstraintMultiplierTypes();
+    CHECK(std::find(types.begin(), types.end(), "defects") != types.end());
+    CHECK(cold.getConstraintMultipliers("defects").nrow() ==
+            solver.get_num_mesh_intervals());
+    CHECK(cold.getConstraintMultiplierTimes("defects").size() ==
+            solver.get_num_mesh_intervals());
+    CHECK_THROWS(cold.getConstraintMultipliers("not_a_constraint"));
+
+    // Warm-starting from the solution converges immediately.
+    solver.set_warm_start_init_point(true);
+    solver.setWarmStart(cold);
+    MocoSolution warm = study.solve();
+    REQUIRE(warm.success());
+    CHECK(warm.getNumIterations() <= cold.getNumIterations());
+    CHECK(warm.compareContinuousVariablesRMS(cold) < 1e-6);
+
+    // The multipliers are interpolated onto a different mesh.
+    solver.set_num_mesh_intervals(2 * solver.get_num_mesh_intervals());
+    solver.setWarmStart(cold);
+    MocoSolution refined = study.solve();
+    REQUIRE(refined.success());
+    CHECK(refined.compareContinuousVariablesRMS(cold) < 1e-2);
+
+    // Setting a different guess discards the warm start.
+    solver.setGuess("bounds");
+    MocoSolution fromBounds = study.solve();
+    REQUIRE(fromBounds.success());
+    CHECK(fromBounds.compareContinuousVariablesRMS(refined) < 1e-6);
+}
+
 TEMPLATE_TEST_CASE("Solving an empty MocoProblem", "",
         MocoCasADiSolver, MocoTropterSolver) {
     MocoStudy study;
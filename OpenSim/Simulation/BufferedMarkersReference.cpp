@@ -0,0 +1,136 @@
+/* -------------------------------------------------------------------------- *
+ *                  OpenSim:  BufferedMarkersReference.cpp                    *
+ * -------------------------------------------------------------------------- *
+ * The OpenSim API is a toolkit for musculoskeletal modeling and simulation.  *
+ * See http://opensim.stanford.edu and the NOTICE file for more information.  *
+ * OpenSim is developed at Stanford University and supported by the US        *
+ * National Institutes of Health (U54 GM072970, R24 HD065690) and by DARPA    *
+ * through the Warrior Web program.                                           *
+ *                                                                            *
+ * Copyright (c) 2005-2021 Stanford University and the Authors                *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+#include "BufferedMarkersReference.h"
+#include <thread>
+
+using namespace std;
+using namespace SimTK;
+
+namespace OpenSim {
+
+BufferedMarkersReference::BufferedMarkersReference() : MarkersReference() {
+    setBufferCapacity(64);
+}
+
+BufferedMarkersReference::BufferedMarkersReference(
+        const TimeSeriesTable_<SimTK::Vec3>& markerData,
+        const Set<MarkerWeight>& markerWeightSet, Units units,
+        int bufferCapacity)
+        : MarkersReference(markerData, markerWeightSet, units) {
+    setBufferCapacity(bufferCapacity);
+}
+
+BufferedMarkersReference::BufferedMarkersReference(
+        const BufferedMarkersReference& other)
+        : MarkersReference(other) {
+    setBufferCapacity(other.getBufferCapacity());
+    _finished = other.getFinished();
+}
+
+BufferedMarkersReference& BufferedMarkersReference::operator=(
+        const BufferedMarkersReference& other) {
+    if (this != &other) {
+        MarkersReference::operator=(other);
+        setBufferCapacity(other.getBufferCapacity());
+        _finished = other.getFinished();
+    }
+    return *this;
+}
+
+void BufferedMarkersReference::setBufferCapacity(int bufferCapacity) {
+    OPENSIM_THROW_IF_FRMOBJ(bufferCapacity < 1, Exception,
+            "Expected bufferCapacity to be at least 1, but got {}.",
+            bufferCapacity);
+    _queue = DataQueue_<SimTK::Vec3>(bufferCapacity,
+            DataQueue_<SimTK::Vec3>::OverflowPolicy::DropNewest, getNumRefs());
+    _lastValues.resize(getNumRefs());
+}
+
+SimTK::Vec2 BufferedMarkersReference::getValidTimeRange() const {
+    SimTK::Vec2 tableRange = Super::getValidTimeRange();
+    return SimTK::Vec2(tableRange[0], SimTK::Infinity);
+}
+
+void BufferedMarkersReference::getValuesAtTime(
+        double time, SimTK::Array_<Vec3>& values) const {
+    const auto& times = getMarkerTable().getIndependentColumn();
+    if (!times.empty() && time >= times.front() && time <= times.back()) {
+        Super::getValuesAtTime(time, values);
+        return;
+    }
+    double nextTime;
+    const_cast<BufferedMarkersReference*>(this)->getNextValuesAndTime(
+            nextTime, values);
+}
+
+void BufferedMarkersReference::getNextValuesAndTime(
+        double& time, SimTK::Array_<Vec3>& values) {
+    while (!_queue.try_pop_front(time, _lastValues, &_lastReceiveTime)) {
+        OPENSIM_THROW_IF_FRMOBJ(_finished && _queue.isEmpty(), Exception,
+                "No more frames are available: the producer has finished "
+                "and all frames have been consumed.");
+        waitForFrame(0.01);
+    }
+    const int n = _lastValues.size();
+    values.resize(n);
+    for (int i = 0; i < n; ++i) { values[i] = _lastValues[i]; }
+}
+
+bool BufferedMarkersReference::hasNext() const {
+    return !_finished || !_queue.isEmpty();
+}
+
+bool BufferedMarkersReference::putValues(
+        double time, const SimTK::RowVector_<SimTK::Vec3>& dataRow) {
+    OPENSIM_THROW_IF_FRMOBJ(dataRow.size() != getNumRefs(), Exception,
+            "Expected a frame with {} marker locations, but got {}.",
+            getNumRefs(), dataRow.size());
+    return _queue.push_back(time, dataRow);
+}
+
+bool BufferedMarkersReference::waitForFrame(double timeout) const {
+    const auto deadline = std::chrono::steady_clock::now() +
+            std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                    std::chrono::duration<double>(timeout));
+    // Poll the queue, since the producer does not signal new frames (to
+    // keep putValues() from waiting for the consumer). Spin briefly before
+    // sleeping so that a frame that arrives right away is picked up with
+    // little latency.
+    int numPolls = 0;
+    while (_queue.isEmpty()) {
+        if (_finished || std::chrono::steady_clock::now() >= deadline) {
+            return !_queue.isEmpty();
+        }
+        if (++numPolls < 100) {
+            std::this_thread::yield();
+        } else {
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+        }
+    }
+    return true;
+}
+
+int BufferedMarkersReference::discardStaleFrames() {
+    return (int)_queue.discard_all_but_latest();
+}
+
+} // end of namespace OpenSim
@@ -0,0 +1,159 @@
+#ifndef OPENSIM_BUFFERED_MARKERS_REFERENCE_H_
+#define OPENSIM_BUFFERED_MARKERS_REFERENCE_H_
+/* -------------------------------------------------------------------------- *
+ *                   OpenSim:  BufferedMarkersReference.h                     *
+ * -------------------------------------------------------------------------- *
+ * The OpenSim API is a toolkit for musculoskeletal modeling and simulation.  *
+ * See http://opensim.stanford.edu and the NOTICE file for more information.  *
+ * OpenSim is developed at Stanford University and supported by the US        *
+ * National Institutes of Health (U54 GM072970, R24 HD065690) and by DARPA    *
+ * through the Warrior Web program.                                           *
+ *                                                                            *
+ * Copyright (c) 2005-2021 Stanford University and the Authors                *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+#include "MarkersReference.h"
+#include <OpenSim/Common/DataQueue.h>
+#include <atomic>
+#include <chrono>
+#include <memory>
+
+namespace OpenSim {
+
+//=============================================================================
+//=============================================================================
+/**
+ * Subclass of MarkersReference that handles live marker data. One producer
+ * thread (e.g., a thread reading from a motion capture system) adds frames
+ * with putValues(), and the InverseKinematicsSolver draws them with
+ * getNextValuesAndTime() when it advances time from its references (see
+ * InverseKinematicsSolver::setAdvanceTimeFromReference()).
+ *
+ * The frames are passed through a bounded DataQueue_, whose preallocated
+ * slots are shared with the consumer through a lock-free ring buffer, so
+ * adding a frame never waits for the consumer or allocates memory: if the
+ * consumer falls behind and the buffer is full, the new frame is rejected
+ * (see getNumFramesRejected()). A consumer that prefers the
+ * newest data over every frame can call discardStaleFrames() before solving.
+ *
+ * The marker data used to construct this reference defines the markers, their
+ * order, and their units, and is used for times within its time range (e.g.,
+ * to assemble the model before streaming starts). Frames added with
+ * putValues() must contain one location per marker, in the order given by
+ * getNames(), in the units of getMarkerTable().
+ */
+class OSIMSIMULATION_API BufferedMarkersReference : public MarkersReference {
+    OpenSim_DECLARE_CONCRETE_OBJECT(
+            BufferedMarkersReference, MarkersReference);
+//=============================================================================
+// METHODS
+//=============================================================================
+public:
+    //--------------------------------------------------------------------------
+    // CONSTRUCTION
+    //--------------------------------------------------------------------------
+    BufferedMarkersReference();
+    /** Use markerData for the markers, weights, and units of this reference,
+    as for MarkersReference, and buffer up to bufferCapacity frames. */
+    BufferedMarkersReference(const TimeSeriesTable_<SimTK::Vec3>& markerData,
+            const Set<MarkerWeight>& markerWeightSet,
+            Units units = Units(Units::Meters), int bufferCapacity = 64);
+    /** The copy has the same data but an empty buffer. */
+    BufferedMarkersReference(const BufferedMarkersReference& other);
+    BufferedMarkersReference& operator=(const BufferedMarkersReference& other);
+
+    virtual ~BufferedMarkersReference() {}
+
+    //--------------------------------------------------------------------------
+    // Reference Interface
+    //--------------------------------------------------------------------------
+    /** get the time range for which this Reference values are valid,
+        which starts with the loaded marker data and has no end. */
+    SimTK::Vec2 getValidTimeRange() const override;
+
+    /** get the values from the base MarkersReference if time is within the
+        loaded marker data, otherwise the next frame that was added with
+        putValues(). */
+    void getValuesAtTime(double time,
+            SimTK::Array_<SimTK::Vec3>& values) const override;
+
+    /** Remove the oldest frame from the buffer and return its values and
+        time, waiting for a frame if the buffer is empty. Throws an Exception
+        if the buffer is empty and the producer has finished. */
+    void getNextValuesAndTime(double& time,
+            SimTK::Array_<SimTK::Vec3>& values) override;
+
+    /** Whether more frames are, or may become, available: true until the
+        producer has finished and the buffer is empty. */
+    bool hasNext() const override;
+
+    //--------------------------------------------------------------------------
+    // Producer interface
+    //--------------------------------------------------------------------------
+    /** Add a frame of marker locations for the given time. This is meant to
+        be called from a single producer thread, and never blocks.
+        @returns false if the buffer is full, in which case the frame is
+        dropped. */
+    bool putValues(double time, const SimTK::RowVector_<SimTK::Vec3>& dataRow);
+
+    /** Indicate that the producer will not add more frames. */
+    void setFinished(bool finished) { _finished = finished; }
+    bool getFinished() const { return _finished; }
+
+    //--------------------------------------------------------------------------
+    // Consumer interface
+    //--------------------------------------------------------------------------
+    /** Wait until the buffer contains a frame or the producer has finished,
+        for at most timeout seconds.
+        @returns true if the buffer contains a frame. */
+    bool waitForFrame(double timeout) const;
+
+    /** Discard all buffered frames except the newest, so that the next call
+        to getNextValuesAndTime() returns the newest frame.
+        @returns the number of frames discarded. */
+    int discardStaleFrames();
+
+    /** The number of frames that are currently buffered. */
+    int getNumBufferedFrames() const { return (int)_queue.size(); }
+    /** The number of frames that putValues() rejected because the buffer was
+        full. */
+    int getNumFramesRejected() const { return (int)_queue.getNumDropped(); }
+    int getBufferCapacity() const { return (int)_queue.getCapacity(); }
+    /** Change the capacity of the buffer. Any buffered frames are discarded.
+        This must not be called while frames are being added or removed. */
+    void setBufferCapacity(int bufferCapacity);
+
+#ifndef SWIG
+    /** The (steady clock) time at which the frame most recently returned by
+        getNextValuesAndTime() was added with putValues(). This can be used to
+        measure the latency of processing the frame. */
+    std::chrono::steady_clock::time_point getReceiveTimeOfLastFrame() const {
+        return _lastReceiveTime;
+    }
+#endif
+
+private:
+    // Frames are copied into preallocated slots of the queue, so no memory
+    // is allocated per frame once the queue exists. New frames are dropped
+    // if the queue is full.
+    DataQueue_<SimTK::Vec3> _queue;
+    // The frame most recently removed from the queue (consumer only).
+    SimTK::RowVector_<SimTK::Vec3> _lastValues;
+    std::chrono::steady_clock::time_point _lastReceiveTime;
+    std::atomic<bool> _finished{false};
+    //=============================================================================
+};  // END of class BufferedMarkersReference
+//=============================================================================
+} // namespace
+
+#endif // OPENSIM_BUFFERED_MARKERS_REFERENCE_H_
@@ -71,4 +71,21 @@ void BufferedOrientationsReference::putValues(
         double time, const SimTK::RowVector_<SimTK::Rotation>& dataRow) {
     _orientationDataQueue.push_back(time, dataRow);
 }
-} // end of namespace OpenSim
\ No newline at end of file
+
+void BufferedOrientationsReference::setQueueCapacity(int capacity) {
+    setQueueCapacity(capacity, OverflowPolicy::Throw);
+}
+
+void BufferedOrientationsReference::setQueueCapacity(
+        int capacity, OverflowPolicy policy) {
+    OPENSIM_THROW_IF_FRMOBJ(capacity < 0, Exception,
+            "Expected the queue capacity to be non-negative, but got {}.",
+            capacity);
+    if (capacity == 0) {
+        _orientationDataQueue = DataQueue_<SimTK::Rotation>();
+    } else {
+        _orientationDataQueue = DataQueue_<SimTK::Rotation>(
+                capacity, policy, getNumRefs());
+    }
+}
+} // end of namespace OpenSim
@@ -89,8 +89,42 @@ public:
     void setFinished(bool finished) { 
         _finished = finished;
     };
+
+    //--------------------------------------------------------------------------
+    // Queue capacity
+    //--------------------------------------------------------------------------
+    /** Bound the number of rows that putValues() can queue before they are
+    drawn for solving. By default (capacity 0), the queue is unbounded: it
+    grows with the number of rows that have not been drawn, and putValues()
+    never waits or drops rows. With a capacity of at least 1, the rows are
+    passed through that many preallocated slots of a lock-free ring buffer
+    (see DataQueue_), and if the queue is full, putValues() follows the
+    overflow policy. The policy is Throw unless given: putValues() throws an
+    Exception. Only use Block if another thread draws the rows, since a thread
+    that puts more rows than the capacity before drawing any would wait
+    forever. Any queued rows are discarded. This must not be called while
+    rows are being put or drawn. */
+    void setQueueCapacity(int capacity);
+    /** The capacity of the queue of rows, or 0 if it is unbounded. */
+    int getQueueCapacity() const {
+        return (int)_orientationDataQueue.getCapacity();
+    }
+#ifndef SWIG
+    using OverflowPolicy = DataQueue_<SimTK::Rotation>::OverflowPolicy;
+    /** Same as above, with the given policy for a full queue. */
+    void setQueueCapacity(int capacity, OverflowPolicy policy);
+    OverflowPolicy getQueueOverflowPolicy() const {
+        return _orientationDataQueue.getOverflowPolicy();
+    }
+#endif
+    /** The number of rows discarded because the queue was full (with the
+    DropOldest or DropNewest policy). */
+    int getNumDroppedValues() const {
+        return (int)_orientationDataQueue.getNumDropped();
+    }
+
 private:
-    // Use a specialized data structure for holding the orientation data
+    // Use a specialized data structure for holding the orientation data.
     mutable DataQueue_<SimTK::Rotation> _orientationDataQueue;
     bool _finished{false};
     //=============================================================================
@@ -165,10 +165,16 @@ void PrescribedController::extendConnectToModel(Model& model)
 void PrescribedController::computeControls(const SimTK::State& s, SimTK::Vector& controls) const
 {
     SimTK::Vector actControls(1, 0.0);
-    SimTK::Vector time(1, s.getTime());
+    SimTK::Vector functionValues;
+    get_ControlFunctions().evaluate(functionValues, 0, s.getTime());
+    OPENSIM_THROW_IF_FRMOBJ(
+            functionValues.size() < getActuatorSet().getSize(), Exception,
+            "Expected a control function for each of the {} actuators, but "
+            "got {} functions.", getActuatorSet().getSize(),
+            functionValues.size());
 
     for(int i=0; i<getActuatorSet().getSize(); i++){
-        actControls[0] = get_ControlFunctions()[i].calcValue(time);
+        actControls[0] = functionValues[i];
         getActuatorSet()[i].addInControls(actControls, controls);
     }  
 }
@@ -479,6 +479,19 @@ void InverseKinematicsSolver::updateGoals(SimTK::State &s)
 
     if (_advanceTimeFromReference) {
         double nextTime = NaN;
+        // Only a BufferedMarkersReference streams marker values; the
+        // observations of any other MarkersReference are left unchanged.
+        auto bufferedMarkersReference =
+                std::dynamic_pointer_cast<BufferedMarkersReference>(
+                        _markersReference);
+        if (bufferedMarkersReference &&
+                bufferedMarkersReference->getNumRefs() > 0) {
+            SimTK::Array_<SimTK::Vec3> markerValues;
+            bufferedMarkersReference->getNextValuesAndTime(
+                    nextTime, markerValues);
+            s.setTime(nextTime);
+            _markerAssemblyCondition->moveAllObservations(markerValues);
+        }
         if (_orientationsReference &&
                 _orientationsReference->getNumRefs() > 0) {
             SimTK::Array_<SimTK::Rotation> orientationValues;
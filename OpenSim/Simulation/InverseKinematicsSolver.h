@@ -26,6 +26,7 @@
 #include "AssemblySolver.h"
 #include "MarkersReference.h"
 #include "BufferedOrientationsReference.h"
+#include "BufferedMarkersReference.h"
 
 namespace SimTK {
 class Markers;
@@ -227,7 +228,11 @@ public:
     corresponding orientation sensor name for an index in the list of
     orientations returned by the solver. */
     std::string getOrientationSensorNameForIndex(int osensorIndex) const;
-    /** indicate whether time is provided by Reference objects or driver program */
+    /** indicate whether time is provided by Reference objects or driver program.
+        If true, track() draws the next time and values from the orientations
+        reference and, if it is a BufferedMarkersReference, from the markers
+        reference. The marker observations of any other MarkersReference are
+        not changed by track() in this mode. */
     void setAdvanceTimeFromReference(bool newValue) {
         _advanceTimeFromReference = newValue;
     };
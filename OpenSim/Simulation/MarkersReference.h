@@ -81,9 +81,9 @@ private:
  * @author Ajay Seth
  */
 class OSIMSIMULATION_API MarkersReference
-        : public Reference_<SimTK::Vec3> {
+        : public StreamableReference_<SimTK::Vec3> {
     OpenSim_DECLARE_CONCRETE_OBJECT(
-            MarkersReference, Reference_<SimTK::Vec3>);
+            MarkersReference, StreamableReference_<SimTK::Vec3>);
     //=============================================================================
 // Properties
 //=============================================================================
@@ -146,6 +146,15 @@ public:
     /** get the value of the MarkersReference  */
     void getValuesAtTime(
             double time, SimTK::Array_<SimTK::Vec3> &values) const override;
+    /** Streaming is not supported by this class; see
+        BufferedMarkersReference. */
+    void getNextValuesAndTime(
+            double& time, SimTK::Array_<SimTK::Vec3>& values) override {
+        throw Exception("getNextValuesAndTime method is not supported for "
+                        "this reference {}.",
+                this->getName());
+    }
+    bool hasNext() const override { return false; }
     // The following two methods are commented out as they are not implemented
     // and we don't want users to think it *is* implemented when viewing
     // doxygen.
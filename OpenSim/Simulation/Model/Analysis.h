@@ -188,6 +188,18 @@ public:
 
     virtual bool proceed(int aStep=0);
 
+    /**
+     * Whether the results of this analysis at each step depend only on the
+     * state at that step, and not on the steps before it. If so, AnalyzeTool
+     * may analyze consecutive chunks of a trajectory in parallel, each with
+     * its own copy of the model and of this analysis, and then append the
+     * results of each copy to the storages of this analysis in
+     * getStorageList(). An analysis that returns true must therefore record
+     * the state in begin(), step(), and end(), and must list all of its
+     * results in getStorageList(). The default is false.
+     */
+    virtual bool isFrameIndependent() const { return false; }
+
     //--------------------------------------------------------------------------
     // GET AND SET
     //--------------------------------------------------------------------------
@@ -31,6 +31,10 @@
 #include <OpenSim/Simulation/Wrap/PathWrap.h>
 #include "Model.h"
 
+#include <algorithm>
+#include <array>
+#include <functional>
+
 //=============================================================================
 // STATICS
 //=============================================================================
@@ -70,6 +74,21 @@ void GeometryPath::extendFinalizeFromProperties()
             upd_PathWrapSet()[i].setName(label.str());
         }
     }
+
+    _surrogateLength.reset();
+    if (!getProperty_polynomial_surrogate().empty()) {
+        const auto& surrogate = get_polynomial_surrogate();
+        const auto& lengthFunction = surrogate.get_length_function();
+        OPENSIM_THROW_IF_FRMOBJ(lengthFunction.getDimension() !=
+                                        surrogate.getNumCoordinates(),
+                Exception,
+                "Expected the length_function of the polynomial_surrogate to "
+                "have {} arguments (one per coordinate), but it has {}.",
+                surrogate.getNumCoordinates(), lengthFunction.getDimension());
+        if (surrogate.get_enabled()) {
+            _surrogateLength.reset(lengthFunction.createSimTKFunction());
+        }
+    }
 }
 
 void GeometryPath::extendConnectToModel(Model& aModel)
@@ -85,6 +104,15 @@ void GeometryPath::extendConnectToModel(Model& aModel)
     // (i.e., the set of currently active points is numbered
     // 1, 2, 3, ...).
     namePathPoints(0);
+
+    _surrogateCoordinates.clear();
+    if (!getProperty_polynomial_surrogate().empty()) {
+        const auto& surrogate = get_polynomial_surrogate();
+        for (int i = 0; i < surrogate.getNumCoordinates(); ++i) {
+            _surrogateCoordinates.emplace_back(&aModel.getComponent<Coordinate>(
+                    surrogate.get_coordinates(i)));
+        }
+    }
 }
 
 //_____________________________________________________________________________
@@ -104,6 +132,13 @@ void GeometryPath::extendConnectToModel(Model& aModel)
     // Cache the set of points currently defining this path.
     this->_currentPathCV = addCacheVariable("current_path", Array<AbstractPathPoint*>{}, SimTK::Stage::Position);
 
+    // Cache the mobilized bodies of the path points, which change only with
+    // the topology, and a flat copy of the current path.
+    this->_pathPointFramesCV = addCacheVariable("path_point_frames",
+            std::vector<PathPointFrame>{}, SimTK::Stage::Topology);
+    this->_flatPathCV = addCacheVariable("flat_path", FlatPath{},
+            SimTK::Stage::Position);
+
     // We consider this cache entry valid any time after it has been created
     // and first marked valid, and we won't ever invalidate it.
     this->_colorCV = addCacheVariable("color", get_Appearance().get_color(), SimTK::Stage::Topology);
@@ -305,18 +340,31 @@ void GeometryPath::addInEquivalentForces(const SimTK::State& s,
     SimTK::Vector_<SimTK::SpatialVec>& bodyForces,
     SimTK::Vector& mobilityForces) const
 {
-    AbstractPathPoint* start = NULL;
-    AbstractPathPoint* end = NULL;
-    const SimTK::MobilizedBody* bo = NULL;
-    const SimTK::MobilizedBody* bf = NULL;
-    const Array<AbstractPathPoint*>& currentPath = getCurrentPath(s);
-    int np = currentPath.getSize();
+    if (_surrogateLength) {
+        // The tension produces a generalized force of tension * moment arm
+        // on each coordinate q that the path spans. The mobility forces act
+        // along the speeds u, so map the forces with N(q)^T (qdot = N u).
+        const SimTK::Vector q = getSurrogateCoordinateValues(s);
+        SimTK::Vector qForces(s.getNQ(), 0.0);
+        for (int i = 0; i < (int)_surrogateCoordinates.size(); ++i) {
+            qForces[getSurrogateQIndex(s, i)] =
+                    tension * calcSurrogateMomentArm(q, i);
+        }
+        SimTK::Vector uForces;
+        getModel().getMatterSubsystem().multiplyByN(s, true, qForces,
+                uForces);
+        mobilityForces += uForces;
+        return;
+    }
+
+    const FlatPath& path = getFlatPath(s);
+    const int np = (int)path.bodies.size();
 
     const SimTK::SimbodyMatterSubsystem& matter = 
                                         getModel().getMatterSubsystem();
 
-    // start point, end point,  direction, and force vectors in ground
-    Vec3 po(0), pf(0), dir(0), force(0);
+    // direction and force vectors in ground
+    Vec3 dir(0), force(0);
     // partial velocity of point in body expressed in ground 
     Vec3 dPodq_G(0), dPfdq_G(0);
 
@@ -324,99 +372,66 @@ void GeometryPath::addInEquivalentForces(const SimTK::State& s,
     double fo, ff;
 
     for (int i = 0; i < np-1; ++i) {
-        start = currentPath[i];
-        end = currentPath[i+1];
-
-        bo = &start->getParentFrame().getMobilizedBody();
-        bf = &end->getParentFrame().getMobilizedBody();
-
-        if (bo != bf) {
-            // Find the positions of start and end in the inertial frame.
-            po = start->getLocationInGround(s);
-            pf = end->getLocationInGround(s);
-
-            // Form a vector from start to end, in the inertial frame.
-            dir = (pf - po);
-
-            // Check that the two points are not coincident.
-            // This can happen due to infeasible wrapping of the path,
-            // when the origin or insertion enters the wrapping surface.
-            // This is a temporary fix, since the wrap algorithm should
-            // return NaN for the points and/or throw an Exception- aseth
-            if (dir.norm() < SimTK::SignificantReal){
-                dir = dir*SimTK::NaN;
-            }
-            else{
-                dir = dir.normalize();
-            }
-
-            force = tension*dir;
-
-            const MovingPathPoint* mppo =
-                dynamic_cast<MovingPathPoint *>(start);
+        if (path.bodies[i] == path.bodies[i+1]) {
+            continue;
+        }
 
-            // do the same for the end point of this segment of the path
-            const MovingPathPoint* mppf =
-                dynamic_cast<MovingPathPoint *>(end);
+        const SimTK::MobilizedBody& bo = matter.getMobilizedBody(path.bodies[i]);
+        const SimTK::MobilizedBody& bf =
+                matter.getMobilizedBody(path.bodies[i+1]);
 
-            // add in the tension point forces to body forces
-            if (mppo) {// moving path point location is a function of the state
-                // transform of the frame of the point to the base mobilized body
-                auto X_BF = mppo->getParentFrame().findTransformInBaseFrame();
-                bo->applyForceToBodyPoint(s, X_BF*mppo->getLocation(s), force,
-                    bodyForces);
-            }
-            else {
-                // transform of the frame of the point to the base mobilized body
-                auto X_BF = start->getParentFrame().findTransformInBaseFrame();
-                bo->applyForceToBodyPoint(s, X_BF*start->getLocation(s), force,
-                    bodyForces);
-            }
+        // Form a vector from start to end, in the inertial frame.
+        dir = (path.locations[i+1] - path.locations[i]);
 
-            if (mppf) {// moving path point location is a function of the state
-                // transform of the frame of the point to the base mobilized body
-                auto X_BF = mppf->getParentFrame().findTransformInBaseFrame();
-                bf->applyForceToBodyPoint(s, X_BF*mppf->getLocation(s), -force,
-                    bodyForces);
-            }
-            else {
-                // transform of the frame of the point to the base mobilized body
-                auto X_BF = end->getParentFrame().findTransformInBaseFrame();
-                bf->applyForceToBodyPoint(s, X_BF*end->getLocation(s), -force,
-                    bodyForces);
-            }
+        // Check that the two points are not coincident.
+        // This can happen due to infeasible wrapping of the path,
+        // when the origin or insertion enters the wrapping surface.
+        // This is a temporary fix, since the wrap algorithm should
+        // return NaN for the points and/or throw an Exception- aseth
+        if (dir.norm() < SimTK::SignificantReal){
+            dir = dir*SimTK::NaN;
+        }
+        else{
+            dir = dir.normalize();
+        }
 
-            // Now account for the work being done by virtue of the moving
-            // path point motion relative to the body it is on
-            if(mppo){
-                // torque (genforce) contribution due to relative movement 
-                // of a via point w.r.t. the body it is connected to.
-                dPodq_G = bo->expressVectorInGroundFrame(s, start->getdPointdQ(s));
-                fo = ~dPodq_G*force;            
-
-                // get the mobilized body the coordinate is couple to.
-                const SimTK::MobilizedBody& mpbod =
-                    matter.getMobilizedBody(mppo->getXCoordinate().getBodyIndex());
-
-                // apply the generalized (mobility) force to the coordinate's body
-                mpbod.applyOneMobilityForce(s, 
-                    mppo->getXCoordinate().getMobilizerQIndex(), 
-                    fo, mobilityForces);
-            }
+        force = tension*dir;
+
+        // add in the tension point forces to body forces; the stations are
+        // already expressed in the frames of the mobilized bodies.
+        bo.applyForceToBodyPoint(s, path.stations[i], force, bodyForces);
+        bf.applyForceToBodyPoint(s, path.stations[i+1], -force, bodyForces);
+
+        // Now account for the work being done by virtue of the moving
+        // path point motion relative to the body it is on
+        if (const MovingPathPoint* mppo = path.movingPoints[i]) {
+            // torque (genforce) contribution due to relative movement 
+            // of a via point w.r.t. the body it is connected to.
+            dPodq_G = bo.expressVectorInGroundFrame(s, mppo->getdPointdQ(s));
+            fo = ~dPodq_G*force;            
+
+            // get the mobilized body the coordinate is couple to.
+            const SimTK::MobilizedBody& mpbod =
+                matter.getMobilizedBody(mppo->getXCoordinate().getBodyIndex());
+
+            // apply the generalized (mobility) force to the coordinate's body
+            mpbod.applyOneMobilityForce(s, 
+                mppo->getXCoordinate().getMobilizerQIndex(), 
+                fo, mobilityForces);
+        }
 
-            if(mppf){
-                dPfdq_G = bf->expressVectorInGroundFrame(s, end->getdPointdQ(s));
-                ff = ~dPfdq_G*(-force);
+        if (const MovingPathPoint* mppf = path.movingPoints[i+1]) {
+            dPfdq_G = bf.expressVectorInGroundFrame(s, mppf->getdPointdQ(s));
+            ff = ~dPfdq_G*(-force);
 
-                // get the mobilized body the coordinate is couple to.
-                const SimTK::MobilizedBody& mpbod =
-                    matter.getMobilizedBody(mppf->getXCoordinate().getBodyIndex());
+            // get the mobilized body the coordinate is couple to.
+            const SimTK::MobilizedBody& mpbod =
+                matter.getMobilizedBody(mppf->getXCoordinate().getBodyIndex());
 
-                mpbod.applyOneMobilityForce(s, 
-                    mppf->getXCoordinate().getMobilizerQIndex(), 
-                    ff, mobilityForces);
-            }
-        }       
+            mpbod.applyOneMobilityForce(s, 
+                mppf->getXCoordinate().getMobilizerQIndex(), 
+                ff, mobilityForces);
+        }
     }
 }
 
@@ -448,6 +463,9 @@ void GeometryPath::updateGeometry(const SimTK::State& s) const
  */
 double GeometryPath::getLength( const SimTK::State& s) const
 {
+    if (_surrogateLength) {
+        return _surrogateLength->calcValue(getSurrogateCoordinateValues(s));
+    }
     computePath(s);  // compute checks if path needs to be recomputed
     return getCacheVariableValue(s, _lengthCV);
 }
@@ -830,11 +848,137 @@ void GeometryPath::computePath(const SimTK::State& s) const
     // Use the current path so far to check for intersection with wrap objects, 
     // which may add additional points to the path.
     applyWrapObjects(s, currentPath);
-    calcLengthAfterPathComputation(s, currentPath);
+
+    // Compute the length from the flat copy of the path, in which the
+    // locations of all points in ground were computed in a single pass.
+    updateFlatPath(s, currentPath);
+    const FlatPath& path = getCacheVariableValue(s, _flatPathCV);
+    double length = 0.0;
+    for (int i = 0; i < (int)path.wrapLengths.size(); ++i) {
+        if (SimTK::isNaN(path.wrapLengths[i])) {
+            length += (path.locations[i+1] - path.locations[i]).norm();
+        } else {
+            length += path.wrapLengths[i];
+        }
+    }
+    setLength(s, length);
 
     markCacheVariableValid(s, _currentPathCV);
 }
 
+//_____________________________________________________________________________
+/*
+ * Find the mobilized body of each path point and the transform from the
+ * point's parent frame to that body.
+ */
+const std::vector<GeometryPath::PathPointFrame>& GeometryPath::
+getPathPointFrames(const SimTK::State& s) const
+{
+    if (isCacheVariableValid(s, _pathPointFramesCV)) {
+        return getCacheVariableValue(s, _pathPointFramesCV);
+    }
+
+    std::vector<PathPointFrame>& frames =
+            updCacheVariableValue(s, _pathPointFramesCV);
+    frames.clear();
+    const auto addFrame = [&frames](const AbstractPathPoint& point) {
+        const PhysicalFrame& frame = point.getParentFrame();
+        frames.push_back({&point, dynamic_cast<const MovingPathPoint*>(&point),
+                frame.getMobilizedBodyIndex(),
+                frame.findTransformInBaseFrame()});
+    };
+    for (int i = 0; i < get_PathPointSet().getSize(); ++i) {
+        addFrame(get_PathPointSet()[i]);
+    }
+    for (int i = 0; i < get_PathWrapSet().getSize(); ++i) {
+        const PathWrap& ws = get_PathWrapSet()[i];
+        if (ws.getWrapObject()) {
+            addFrame(ws.getWrapPoint1());
+            addFrame(ws.getWrapPoint2());
+        }
+    }
+    std::sort(frames.begin(), frames.end(),
+            [](const PathPointFrame& a, const PathPointFrame& b) {
+                return std::less<const AbstractPathPoint*>()(a.point, b.point);
+            });
+
+    markCacheVariableValid(s, _pathPointFramesCV);
+    return frames;
+}
+
+//_____________________________________________________________________________
+/*
+ * Copy the current path into the flat (structure-of-arrays) representation
+ * and compute the locations of all of its points in ground.
+ */
+void GeometryPath::updateFlatPath(const SimTK::State& s,
+        const Array<AbstractPathPoint*>& currentPath) const
+{
+    const std::vector<PathPointFrame>& frames = getPathPointFrames(s);
+    FlatPath& path = updCacheVariableValue(s, _flatPathCV);
+
+    const int np = currentPath.getSize();
+    path.bodies.resize(np);
+    path.stations.resize(np);
+    path.locations.resize(np);
+    path.movingPoints.resize(np);
+    path.wrapLengths.resize(std::max(np - 1, 0));
+
+    for (int i = 0; i < np; ++i) {
+        const AbstractPathPoint* point = currentPath[i];
+        const auto it = std::lower_bound(frames.begin(), frames.end(), point,
+                [](const PathPointFrame& f, const AbstractPathPoint* p) {
+                    return std::less<const AbstractPathPoint*>()(f.point, p);
+                });
+        if (it != frames.end() && it->point == point) {
+            path.bodies[i] = it->body;
+            path.stations[i] = it->X_BF * point->getLocation(s);
+            path.movingPoints[i] = it->movingPoint;
+        } else {
+            // The point was added to the path after the system was created.
+            const PhysicalFrame& frame = point->getParentFrame();
+            path.bodies[i] = frame.getMobilizedBodyIndex();
+            path.stations[i] =
+                    frame.findTransformInBaseFrame() * point->getLocation(s);
+            path.movingPoints[i] =
+                    dynamic_cast<const MovingPathPoint*>(point);
+        }
+    }
+
+    // Transform all stations to ground in one pass.
+    const SimTK::SimbodyMatterSubsystem& matter =
+            getModel().getMatterSubsystem();
+    for (int i = 0; i < np; ++i) {
+        path.locations[i] =
+                matter.getMobilizedBody(path.bodies[i]).getBodyTransform(s) *
+                path.stations[i];
+    }
+
+    for (int i = 0; i < np - 1; ++i) {
+        const AbstractPathPoint* p1 = currentPath[i];
+        const AbstractPathPoint* p2 = currentPath[i+1];
+        path.wrapLengths[i] = SimTK::NaN;
+        // If both points are wrap points on the same wrap object, then this
+        // path segment wraps over the surface of a wrap object.
+        if (   p1->getWrapObject()
+            && p2->getWrapObject()
+            && p1->getWrapObject() == p2->getWrapObject())
+        {
+            const PathWrapPoint* smwp = dynamic_cast<const PathWrapPoint*>(p2);
+            path.wrapLengths[i] = smwp ? smwp->getWrapLength() : 0.0;
+        }
+    }
+
+    markCacheVariableValid(s, _flatPathCV);
+}
+
+const GeometryPath::FlatPath& GeometryPath::getFlatPath(
+        const SimTK::State& s) const
+{
+    computePath(s);   // compute checks if path needs to be recomputed
+    return getCacheVariableValue(s, _flatPathCV);
+}
+
 //_____________________________________________________________________________
 /*
  * Compute lengthening speed of the path.
@@ -845,12 +989,42 @@ void GeometryPath::computeLengtheningSpeed(const SimTK::State& s) const
         return;
     }
 
-    const Array<AbstractPathPoint*>& currentPath = getCurrentPath(s);
+    if (_surrogateLength) {
+        // d(length)/dt = -sum_i (moment arm)_i * qdot_i. The speeds u of some
+        // coordinates (e.g., the rotations of ball and free joints) are not
+        // qdot, so compute qdot = N(q) u.
+        const SimTK::Vector q = getSurrogateCoordinateValues(s);
+        SimTK::Vector qdot;
+        getModel().getMatterSubsystem().multiplyByN(s, false, s.getU(),
+                qdot);
+        double speed = 0.0;
+        for (int i = 0; i < (int)_surrogateCoordinates.size(); ++i) {
+            speed -= calcSurrogateMomentArm(q, i) *
+                     qdot[getSurrogateQIndex(s, i)];
+        }
+        setLengtheningSpeed(s, speed);
+        return;
+    }
+
+    const FlatPath& path = getFlatPath(s);
+    const SimTK::SimbodyMatterSubsystem& matter =
+            getModel().getMatterSubsystem();
+    const auto calcVelocity = [&](int i) -> Vec3 {
+        if (path.movingPoints[i]) {
+            return path.movingPoints[i]->getVelocityInGround(s);
+        }
+        return matter.getMobilizedBody(path.bodies[i])
+                .findStationVelocityInGround(s, path.stations[i]);
+    };
 
     double speed = 0.0;
-    
-    for (int i = 0; i < currentPath.getSize() - 1; i++) {
-        speed += currentPath[i]->calcSpeedBetween(s, *currentPath[i+1]);
+    const int np = (int)path.bodies.size();
+    Vec3 velocity = np > 0 ? calcVelocity(0) : Vec3(0);
+    for (int i = 0; i < np - 1; i++) {
+        const Vec3 nextVelocity = calcVelocity(i+1);
+        speed += Point::calcSpeedBetween(path.locations[i], velocity,
+                path.locations[i+1], nextVelocity);
+        velocity = nextVelocity;
     }
 
     setLengtheningSpeed(s, speed);
@@ -1147,12 +1321,224 @@ calcLengthAfterPathComputation(const SimTK::State& s,
 double GeometryPath::
 computeMomentArm(const SimTK::State& s, const Coordinate& aCoord) const
 {
+    if (_surrogateLength) {
+        for (int i = 0; i < (int)_surrogateCoordinates.size(); ++i) {
+            if (_surrogateCoordinates[i].get() == &aCoord) {
+                return calcSurrogateMomentArm(
+                        getSurrogateCoordinateValues(s), i);
+            }
+        }
+        // The surrogate does not depend on this coordinate directly, but the
+        // coordinate may drive the surrogate's coordinates through
+        // constraints; the MomentArmSolver accounts for this coupling using
+        // the generalized forces of the surrogate (see
+        // addInEquivalentForces()).
+    }
+
     if (!_maSolver)
         const_cast<Self*>(this)->_maSolver.reset(new MomentArmSolver(*_model));
 
     return _maSolver->solve(s, aCoord,  *this);
 }
 
+//=============================================================================
+// POLYNOMIAL SURROGATE
+//=============================================================================
+namespace {
+// The exponents of the terms of a MultivariatePolynomialFunction, in the
+// order of its coefficients.
+std::vector<std::array<int, 4>> createPolynomialExponents(
+        int dimension, int order) {
+    std::vector<std::array<int, 4>> exponents;
+    std::array<int, 4> nq{{0, 0, 0, 0}};
+    for (nq[0] = 0; nq[0] <= (dimension < 1 ? 0 : order); ++nq[0]) {
+        const int max1 = dimension < 2 ? 0 : order - nq[0];
+        for (nq[1] = 0; nq[1] <= max1; ++nq[1]) {
+            const int max2 = dimension < 3 ? 0 : order - nq[0] - nq[1];
+            for (nq[2] = 0; nq[2] <= max2; ++nq[2]) {
+                const int max3 =
+                        dimension < 4 ? 0 : order - nq[0] - nq[1] - nq[2];
+                for (nq[3] = 0; nq[3] <= max3; ++nq[3]) {
+                    exponents.push_back(nq);
+                }
+            }
+        }
+    }
+    return exponents;
+}
+} // namespace
+
+SimTK::Vector GeometryPath::getSurrogateCoordinateValues(
+        const SimTK::State& s) const
+{
+    SimTK::Vector q((int)_surrogateCoordinates.size());
+    for (int i = 0; i < q.size(); ++i) {
+        q[i] = _surrogateCoordinates[i]->getValue(s);
+    }
+    return q;
+}
+
+double GeometryPath::calcSurrogateMomentArm(
+        const SimTK::Vector& q, int i) const
+{
+    return -_surrogateLength->calcDerivative(SimTK::Array_<int>(1, i), q);
+}
+
+int GeometryPath::getSurrogateQIndex(const SimTK::State& s, int i) const
+{
+    const Coordinate& coord = *_surrogateCoordinates[i];
+    return getModel().getMatterSubsystem()
+                   .getMobilizedBody(coord.getBodyIndex())
+                   .getFirstQIndex(s) +
+           coord.getMobilizerQIndex();
+}
+
+const PolynomialPathSurrogate& GeometryPath::fitPolynomialSurrogate(
+        const SimTK::State& s, int order, int numSamples,
+        const std::vector<std::string>& coordinatePaths)
+{
+    OPENSIM_THROW_IF_FRMOBJ(order < 1, Exception,
+            "Expected order >= 1, but got {}.", order);
+    const Model& model = getModel();
+    const SimTK::MultibodySystem& system = model.getMultibodySystem();
+    const bool hasConstraints = model.getMatterSubsystem().getNumConstraints();
+
+    // Compute the exact path while fitting. The current surrogate (if any) is
+    // restored when we return or throw, so that an invalid call does not
+    // disable a surrogate that is in use.
+    struct SurrogateRestorer {
+        std::unique_ptr<SimTK::Function>& surrogateLength;
+        std::unique_ptr<SimTK::Function> original;
+        ~SurrogateRestorer() { surrogateLength.reset(original.release()); }
+    } surrogateRestorer{_surrogateLength,
+            std::unique_ptr<SimTK::Function>(_surrogateLength.release())};
+    SimTK::State state = s;
+    const auto calcExactLength = [&]() {
+        system.realize(state, SimTK::Stage::Position);
+        return getLength(state);
+    };
+    const auto getSampleBounds = [](const Coordinate& coord) {
+        const double limit =
+                coord.getMotionType() == Coordinate::Rotational ? SimTK::Pi
+                                                                : 1.0;
+        return std::make_pair(std::max(coord.getRangeMin(), -limit),
+                std::min(coord.getRangeMax(), limit));
+    };
+
+    // Find the coordinates that the length depends on.
+    std::vector<const Coordinate*> coords;
+    if (coordinatePaths.empty()) {
+        for (const auto& coord : model.getComponentList<Coordinate>()) {
+            if (coord.isConstrained(s)) continue;
+            const auto bounds = getSampleBounds(coord);
+            const int numProbes = 5;
+            const double origValue = coord.getValue(s);
+            for (int iprobe = 0; iprobe < numProbes; ++iprobe) {
+                const double value = bounds.first + (iprobe + 0.5) /
+                        numProbes * (bounds.second - bounds.first);
+                coord.setValue(state, value, false);
+                const double length = calcExactLength();
+                coord.setValue(state, value + 1e-4, false);
+                if (std::abs(calcExactLength() - length) > 1e-9) {
+                    coords.push_back(&coord);
+                    break;
+                }
+            }
+            coord.setValue(state, origValue, false);
+        }
+    } else {
+        for (const auto& path : coordinatePaths) {
+            coords.push_back(&model.getComponent<Coordinate>(path));
+        }
+    }
+    const int dimension = (int)coords.size();
+    OPENSIM_THROW_IF_FRMOBJ(dimension == 0, Exception,
+            "The length of the path does not depend on any coordinates.");
+    OPENSIM_THROW_IF_FRMOBJ(dimension > 4, Exception,
+            "The length of the path depends on {} coordinates, but a "
+            "polynomial surrogate supports at most 4.", dimension);
+
+    const auto exponents = createPolynomialExponents(dimension, order);
+    const int numCoefficients = (int)exponents.size();
+    OPENSIM_THROW_IF_FRMOBJ(numSamples < numCoefficients, Exception,
+            "Expected at least {} samples (the number of coefficients), but "
+            "got {}.", numCoefficients, numSamples);
+
+    std::vector<std::pair<double, double>> bounds;
+    for (const auto* coord : coords) bounds.push_back(getSampleBounds(*coord));
+    SimTK::Random::Uniform random(0, 1);
+    random.setSeed(0);
+    // Set the coordinates to random values within the bounds and return the
+    // exact length; q holds the coordinate values after satisfying the model
+    // constraints.
+    SimTK::Vector q(dimension);
+    const auto sample = [&]() {
+        for (int i = 0; i < dimension; ++i) {
+            coords[i]->setValue(state,
+                    bounds[i].first + random.getValue() *
+                            (bounds[i].second - bounds[i].first),
+                    false);
+        }
+        if (hasConstraints) {
+            system.realize(state, SimTK::Stage::Position);
+            system.projectQ(state, 1e-10);
+        }
+        for (int i = 0; i < dimension; ++i) q[i] = coords[i]->getValue(state);
+        return calcExactLength();
+    };
+
+    // Fit the coefficients by least squares.
+    SimTK::Matrix basis(numSamples, numCoefficients);
+    SimTK::Vector lengths(numSamples);
+    for (int isample = 0; isample < numSamples; ++isample) {
+        lengths[isample] = sample();
+        for (int icoef = 0; icoef < numCoefficients; ++icoef) {
+            double term = 1.0;
+            for (int i = 0; i < dimension; ++i) {
+                term *= std::pow(q[i], exponents[icoef][i]);
+            }
+            basis(isample, icoef) = term;
+        }
+    }
+    SimTK::Vector coefficients;
+    SimTK::FactorQTZ(basis).solve(lengths, coefficients);
+
+    PolynomialPathSurrogate surrogate;
+    surrogate.set_length_function(
+            MultivariatePolynomialFunction(coefficients, dimension, order));
+    for (int i = 0; i < dimension; ++i) {
+        surrogate.append_coordinates(coords[i]->getAbsolutePathString());
+        surrogate.append_coordinate_lower_bounds(bounds[i].first);
+        surrogate.append_coordinate_upper_bounds(bounds[i].second);
+    }
+
+    // Compare to the exact path at new samples.
+    std::unique_ptr<SimTK::Function> fit(
+            surrogate.get_length_function().createSimTKFunction());
+    double sumSquaredLengthError = 0;
+    double maxLengthError = 0;
+    double maxMomentArmError = 0;
+    for (int isample = 0; isample < numSamples; ++isample) {
+        const double exactLength = sample();
+        const double lengthError = std::abs(fit->calcValue(q) - exactLength);
+        sumSquaredLengthError += lengthError * lengthError;
+        maxLengthError = std::max(maxLengthError, lengthError);
+        for (int i = 0; i < dimension; ++i) {
+            const double momentArm =
+                    -fit->calcDerivative(SimTK::Array_<int>(1, i), q);
+            maxMomentArmError = std::max(maxMomentArmError,
+                    std::abs(momentArm - computeMomentArm(state, *coords[i])));
+        }
+    }
+    surrogate.set_length_rms_error(
+            std::sqrt(sumSquaredLengthError / numSamples));
+    surrogate.set_length_max_error(maxLengthError);
+    surrogate.set_moment_arm_max_error(maxMomentArmError);
+
+    set_polynomial_surrogate(surrogate);
+    return get_polynomial_surrogate();
+}
+
 //_____________________________________________________________________________
 // Override default implementation by object to intercept and fix the XML node
 // underneath the model to match current version.
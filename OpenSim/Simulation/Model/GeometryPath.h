@@ -28,6 +28,7 @@
 #include <OpenSim/Simulation/osimSimulationDLL.h>
 #include "OpenSim/Simulation/Model/ModelComponent.h"
 #include "PathPointSet.h"
+#include "PolynomialPathSurrogate.h"
 #include <OpenSim/Simulation/Wrap/PathWrapSet.h>
 #include <OpenSim/Simulation/MomentArmSolver.h>
 
@@ -42,6 +43,7 @@
 namespace OpenSim {
 
 class Coordinate;
+class MovingPathPoint;
 class PointForceDirection;
 class ScaleSet;
 class WrapResult;
@@ -72,6 +74,13 @@ public:
     OpenSim_DECLARE_UNNAMED_PROPERTY(Appearance,
         "Default appearance attributes for this GeometryPath");
 
+    OpenSim_DECLARE_OPTIONAL_PROPERTY(polynomial_surrogate,
+        PolynomialPathSurrogate,
+        "A polynomial approximation of the length of the path, created with "
+        "fitPolynomialSurrogate(). If enabled, it is used instead of the path "
+        "points and wrap objects to compute the length, lengthening speed, "
+        "and moment arms.");
+
 private:
     OpenSim_DECLARE_UNNAMED_PROPERTY(PathPointSet,
         "The set of points defining the path");
@@ -91,6 +100,50 @@ private:
     mutable CacheVariable<double> _speedCV;
     mutable CacheVariable<Array<AbstractPathPoint*>> _currentPathCV;
     mutable CacheVariable<SimTK::Vec3> _colorCV;
+
+    // The mobilized body of each path point (including the wrap points) and
+    // the transform from the point's parent frame to that body, sorted by the
+    // address of the point. These depend only on the topology of the model.
+    struct PathPointFrame {
+        const AbstractPathPoint* point;
+        // Null unless the point is a MovingPathPoint.
+        const MovingPathPoint* movingPoint;
+        SimTK::MobilizedBodyIndex body;
+        SimTK::Transform X_BF;
+        friend std::ostream& operator<<(std::ostream& o,
+                const PathPointFrame&) {
+            o << "GeometryPath::PathPointFrame should not be serialized!"
+              << std::endl;
+            return o;
+        }
+    };
+    // A structure-of-arrays copy of the current path, in which each point is
+    // a station on a mobilized body. The length, lengthening speed, and
+    // equivalent forces are computed from these contiguous arrays instead of
+    // through the (virtual) interface of each path point. The arrays keep
+    // their capacity, so updating them does not allocate memory.
+    struct FlatPath {
+        // One entry per point in the current path.
+        std::vector<SimTK::MobilizedBodyIndex> bodies;
+        std::vector<SimTK::Vec3> stations;  // expressed in the body frame.
+        std::vector<SimTK::Vec3> locations; // expressed in ground.
+        // Null unless the point is a MovingPathPoint.
+        std::vector<const MovingPathPoint*> movingPoints;
+        // One entry per segment: the length of the segment if it wraps over
+        // the surface of a wrap object, or NaN if it is a straight line.
+        std::vector<double> wrapLengths;
+        friend std::ostream& operator<<(std::ostream& o, const FlatPath&) {
+            o << "GeometryPath::FlatPath should not be serialized!"
+              << std::endl;
+            return o;
+        }
+    };
+    mutable CacheVariable<std::vector<PathPointFrame>> _pathPointFramesCV;
+    mutable CacheVariable<FlatPath> _flatPathCV;
+
+    // Created from the polynomial_surrogate property if it is enabled.
+    SimTK::ResetOnCopy<std::unique_ptr<SimTK::Function>> _surrogateLength;
+    std::vector<SimTK::ReferencePtr<const Coordinate>> _surrogateCoordinates;
     
 //=============================================================================
 // METHODS
@@ -187,6 +240,38 @@ public:
     //--------------------------------------------------------------------------
     virtual double computeMomentArm(const SimTK::State& s, const Coordinate& aCoord) const;
 
+    //--------------------------------------------------------------------------
+    // POLYNOMIAL SURROGATE
+    //--------------------------------------------------------------------------
+    /** Fit a polynomial surrogate for the length of this path (see
+    PolynomialPathSurrogate) and store it in the polynomial_surrogate
+    property, replacing any existing surrogate. We sample the coordinates
+    uniformly within their ranges (limited to [-pi, pi] for rotational
+    coordinates and [-1, 1] for other coordinates), compute the exact length
+    of the path at each sample, and fit the polynomial coefficients by least
+    squares. The errors of the fit are computed for a second, independent set
+    of samples and stored in the surrogate (see
+    PolynomialPathSurrogate::printErrorReport()).
+    Call Model::initSystem() afterwards to use the surrogate.
+    @param s A state of the model; coordinates that the path does not depend
+        on keep their values from this state.
+    @param order The order of the polynomial.
+    @param numSamples The number of samples used for the fit and for the
+        error report. This must be at least the number of coefficients of
+        the polynomial.
+    @param coordinates Paths to the coordinates (at most 4) that the length
+        depends on. If empty, we use the unconstrained coordinates that
+        change the length of the path. */
+    const PolynomialPathSurrogate& fitPolynomialSurrogate(
+            const SimTK::State& s, int order = 5, int numSamples = 1000,
+            const std::vector<std::string>& coordinates = {});
+    /** Whether the length, lengthening speed, and moment arms are computed
+    from an enabled polynomial_surrogate. */
+    bool isPolynomialSurrogateEnabled() const {
+        return !getProperty_polynomial_surrogate().empty() &&
+               get_polynomial_surrogate().get_enabled();
+    }
+
     //--------------------------------------------------------------------------
     // SCALING
     //--------------------------------------------------------------------------
@@ -233,6 +318,14 @@ private:
                                 const Array<AbstractPathPoint*>& path) const; 
     double calcLengthAfterPathComputation
        (const SimTK::State& s, const Array<AbstractPathPoint*>& currentPath) const;
+    const std::vector<PathPointFrame>& getPathPointFrames(
+            const SimTK::State& s) const;
+    void updateFlatPath(const SimTK::State& s,
+            const Array<AbstractPathPoint*>& currentPath) const;
+    const FlatPath& getFlatPath(const SimTK::State& s) const;
+    SimTK::Vector getSurrogateCoordinateValues(const SimTK::State& s) const;
+    double calcSurrogateMomentArm(const SimTK::Vector& q, int i) const;
+    int getSurrogateQIndex(const SimTK::State& s, int i) const;
 
     void constructProperties();
     void namePathPoints(int aStartingIndex);
@@ -111,9 +111,17 @@ double Point::calcDistanceBetween(const SimTK::State& s,
 
 double Point::calcSpeedBetween(const SimTK::State& s, const Point& o) const
 {
-    const auto r = getLocationInGround(s) - o.getLocationInGround(s);
+    return calcSpeedBetween(getLocationInGround(s), getVelocityInGround(s),
+            o.getLocationInGround(s), o.getVelocityInGround(s));
+}
+
+double Point::calcSpeedBetween(const SimTK::Vec3& location,
+        const SimTK::Vec3& velocity, const SimTK::Vec3& otherLocation,
+        const SimTK::Vec3& otherVelocity)
+{
+    const auto r = location - otherLocation;
     const double d = r.norm();
-    const auto v = getVelocityInGround(s) - o.getVelocityInGround(s);
+    const auto v = velocity - otherVelocity;
     if (d < SimTK::Eps) // avoid divide by zero
         return v.norm();
     else // speed is the projection of relative velocity, v, onto the 
@@ -115,6 +115,18 @@ public:
     @return speed     The speed (distance time derivative) which is a scalar. */
     double calcSpeedBetween(const SimTK::State& state, const Point& other) const;
 
+    /** Calculate the relative speed between two points with the given
+    locations and velocities in Ground (see the overload above). This is
+    useful if the locations and velocities of the points are already known.
+    @param location       The location of the first point.
+    @param velocity       The velocity of the first point.
+    @param otherLocation  The location of the other point.
+    @param otherVelocity  The velocity of the other point.
+    @return speed     The speed (distance time derivative) which is a scalar. */
+    static double calcSpeedBetween(const SimTK::Vec3& location,
+            const SimTK::Vec3& velocity, const SimTK::Vec3& otherLocation,
+            const SimTK::Vec3& otherVelocity);
+
 protected:
     /** @name Point Extension methods.
     Concrete Point types must override these calculations.
@@ -0,0 +1,39 @@
+/* -------------------------------------------------------------------------- *
+ *                  OpenSim:  PolynomialPathSurrogate.cpp                     *
+ * -------------------------------------------------------------------------- *
+ * The OpenSim API is a toolkit for musculoskeletal modeling and simulation.  *
+ * See http://opensim.stanford.edu and the NOTICE file for more information.  *
+ * OpenSim is developed at Stanford University and supported by the US        *
+ * National Institutes of Health (U54 GM072970, R24 HD065690) and by DARPA    *
+ * through the Warrior Web program.                                           *
+ *                                                                            *
+ * Copyright (c) 2005-2021 Stanford University and the Authors                *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+#include "PolynomialPathSurrogate.h"
+
+#include <OpenSim/Common/Logger.h>
+
+using namespace OpenSim;
+
+void PolynomialPathSurrogate::printErrorReport() const {
+    log_info("Polynomial path surrogate '{}' (order {}, {} coordinates):",
+            getName(), get_length_function().getOrder(), getNumCoordinates());
+    for (int i = 0; i < getNumCoordinates(); ++i) {
+        log_info("    {} in [{}, {}]", get_coordinates(i),
+                get_coordinate_lower_bounds(i), get_coordinate_upper_bounds(i));
+    }
+    log_info("    length RMS error: {} m", get_length_rms_error());
+    log_info("    length max error: {} m", get_length_max_error());
+    log_info("    moment arm max error: {}", get_moment_arm_max_error());
+}
@@ -0,0 +1,98 @@
+#ifndef OPENSIM_POLYNOMIAL_PATH_SURROGATE_H_
+#define OPENSIM_POLYNOMIAL_PATH_SURROGATE_H_
+/* -------------------------------------------------------------------------- *
+ *                   OpenSim:  PolynomialPathSurrogate.h                      *
+ * -------------------------------------------------------------------------- *
+ * The OpenSim API is a toolkit for musculoskeletal modeling and simulation.  *
+ * See http://opensim.stanford.edu and the NOTICE file for more information.  *
+ * OpenSim is developed at Stanford University and supported by the US        *
+ * National Institutes of Health (U54 GM072970, R24 HD065690) and by DARPA    *
+ * through the Warrior Web program.                                           *
+ *                                                                            *
+ * Copyright (c) 2005-2021 Stanford University and the Authors                *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+#include <OpenSim/Common/MultivariatePolynomialFunction.h>
+#include <OpenSim/Simulation/osimSimulationDLL.h>
+
+namespace OpenSim {
+
+/** A polynomial approximation of the length of a GeometryPath as a function of
+the coordinates that the path spans. A GeometryPath with an enabled surrogate
+computes its length, lengthening speed, moment arms, and the generalized
+forces due to its tension from the polynomial (and its analytic derivatives)
+instead of from its path points and wrap objects, which avoids the cost of
+computing the wrapping geometry. The path points and wrap objects are still
+used for visualization and for GeometryPath::getCurrentPath().
+
+Create a surrogate with GeometryPath::fitPolynomialSurrogate(), which also
+fills in the errors of the fit relative to the exact path. The surrogate is
+saved with the model, so you can enable or disable it (with the `enabled`
+property) without fitting again.
+
+The polynomial is accurate only within the ranges of the coordinates that
+were sampled for the fit (see `coordinate_lower_bounds` and
+`coordinate_upper_bounds`). A MultivariatePolynomialFunction has at most 4
+arguments, so paths that span more than 4 coordinates are not supported. */
+class OSIMSIMULATION_API PolynomialPathSurrogate : public Object {
+    OpenSim_DECLARE_CONCRETE_OBJECT(PolynomialPathSurrogate, Object);
+
+public:
+    OpenSim_DECLARE_PROPERTY(enabled, bool,
+            "Compute the length, lengthening speed, and moment arms of the "
+            "path from length_function instead of from the path points and "
+            "wrap objects (default: true).");
+    OpenSim_DECLARE_LIST_PROPERTY(coordinates, std::string,
+            "Paths to the coordinates that the length of the path depends "
+            "on, in the order of the arguments of length_function.");
+    OpenSim_DECLARE_PROPERTY(length_function, MultivariatePolynomialFunction,
+            "The length of the path as a function of the coordinates.");
+    OpenSim_DECLARE_LIST_PROPERTY(coordinate_lower_bounds, double,
+            "The smallest value of each coordinate used in the fit.");
+    OpenSim_DECLARE_LIST_PROPERTY(coordinate_upper_bounds, double,
+            "The largest value of each coordinate used in the fit.");
+    OpenSim_DECLARE_PROPERTY(length_rms_error, double,
+            "Root-mean-square error of the length, relative to the exact "
+            "path, for configurations that were not used in the fit.");
+    OpenSim_DECLARE_PROPERTY(length_max_error, double,
+            "Maximum absolute error of the length, relative to the exact "
+            "path, for configurations that were not used in the fit.");
+    OpenSim_DECLARE_PROPERTY(moment_arm_max_error, double,
+            "Maximum absolute error of the moment arms (for any of the "
+            "coordinates), relative to the exact path, for configurations "
+            "that were not used in the fit.");
+
+    PolynomialPathSurrogate() { constructProperties(); }
+
+    /// The number of coordinates that the length depends on.
+    int getNumCoordinates() const { return getProperty_coordinates().size(); }
+
+    /// Print the errors of the fit.
+    void printErrorReport() const;
+
+private:
+    void constructProperties() {
+        constructProperty_enabled(true);
+        constructProperty_coordinates();
+        constructProperty_length_function(MultivariatePolynomialFunction());
+        constructProperty_coordinate_lower_bounds();
+        constructProperty_coordinate_upper_bounds();
+        constructProperty_length_rms_error(SimTK::NaN);
+        constructProperty_length_max_error(SimTK::NaN);
+        constructProperty_moment_arm_max_error(SimTK::NaN);
+    }
+};
+
+} // namespace OpenSim
+
+#endif // OPENSIM_POLYNOMIAL_PATH_SURROGATE_H_
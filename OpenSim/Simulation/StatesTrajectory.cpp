@@ -30,31 +30,331 @@
 
 using namespace OpenSim;
 
+// Hide these functions from other translation units.
+namespace {
+    template <typename T>
+    bool isSameValue(const SimTK::AbstractValue& a,
+            const SimTK::AbstractValue& b, bool& handled) {
+        if (!SimTK::Value<T>::isA(a) || !SimTK::Value<T>::isA(b)) return false;
+        handled = true;
+        return SimTK::Value<T>::downcast(a).get() ==
+               SimTK::Value<T>::downcast(b).get();
+    }
+
+    bool isSameReal(SimTK::Real a, SimTK::Real b) {
+        return a == b || (SimTK::isNaN(a) && SimTK::isNaN(b));
+    }
+
+    /// Whether two discrete variables are known to have the same value. NaN
+    /// is considered equal to NaN, so that a NaN variable is not seen as
+    /// changing in every state.
+    bool isSameDiscreteValue(
+            const SimTK::AbstractValue& a, const SimTK::AbstractValue& b) {
+        // Only the most common types can be compared. Other types (e.g.,
+        // Simbody's instance variables, which hold whether each constraint
+        // is enabled) are assumed to have changed, since their string
+        // representation may be only the name of the type.
+        if (SimTK::Value<SimTK::Real>::isA(a) &&
+                SimTK::Value<SimTK::Real>::isA(b)) {
+            return isSameReal(SimTK::Value<SimTK::Real>::downcast(a).get(),
+                    SimTK::Value<SimTK::Real>::downcast(b).get());
+        }
+        if (SimTK::Value<SimTK::Vector>::isA(a) &&
+                SimTK::Value<SimTK::Vector>::isA(b)) {
+            const auto& va = SimTK::Value<SimTK::Vector>::downcast(a).get();
+            const auto& vb = SimTK::Value<SimTK::Vector>::downcast(b).get();
+            if (va.size() != vb.size()) return false;
+            for (int i = 0; i < va.size(); ++i) {
+                if (!isSameReal(va[i], vb[i])) return false;
+            }
+            return true;
+        }
+        bool handled = false;
+        bool same = isSameValue<bool>(a, b, handled);
+        if (!handled) same = isSameValue<int>(a, b, handled);
+        if (handled) return same;
+        return false;
+    }
+
+    /// Whether the states have the same layout of continuous and discrete
+    /// variables and belong to the same realization of the same System, so
+    /// that one can be restored from the other by setting its variables.
+    bool haveSameLayout(const SimTK::State& a, const SimTK::State& b) {
+        if (a.getSystemTopologyStageVersion() !=
+                b.getSystemTopologyStageVersion()) {
+            return false;
+        }
+        if (a.getNY() != b.getNY()) return false;
+        if (a.getNumSubsystems() != b.getNumSubsystems()) return false;
+        for (SimTK::SubsystemIndex isub(0); isub < a.getNumSubsystems();
+                ++isub) {
+            if (a.getNDiscreteVars(isub) != b.getNDiscreteVars(isub)) {
+                return false;
+            }
+        }
+        return true;
+    }
+}
+
+StatesTrajectory::StatesTrajectory(const StatesTrajectory& other) {
+    *this = other;
+}
+
+StatesTrajectory::StatesTrajectory(StatesTrajectory&& other) {
+    *this = std::move(other);
+}
+
+StatesTrajectory& StatesTrajectory::operator=(const StatesTrajectory& other) {
+    if (this == &other) return *this;
+    std::lock(m_mutex, other.m_mutex);
+    std::lock_guard<std::mutex> lock(m_mutex, std::adopt_lock);
+    std::lock_guard<std::mutex> otherLock(other.m_mutex, std::adopt_lock);
+    m_times = other.m_times;
+    m_y = other.m_y;
+    m_numY = other.m_numY;
+    m_stateTemplate = other.m_stateTemplate;
+    m_stateDiscrete = other.m_stateDiscrete;
+    m_templates = other.m_templates;
+    m_templateDiscrete = other.m_templateDiscrete;
+    // The values in the snapshots are never modified, so they are shared.
+    m_discreteSnapshots = other.m_discreteSnapshots;
+    m_states = other.m_states;
+    m_isMaterialized.clear();
+    for (const auto& isMaterialized : other.m_isMaterialized) {
+        m_isMaterialized.emplace_back(isMaterialized.load());
+    }
+    return *this;
+}
+
+StatesTrajectory& StatesTrajectory::operator=(StatesTrajectory&& other) {
+    if (this == &other) return *this;
+    std::lock(m_mutex, other.m_mutex);
+    std::lock_guard<std::mutex> lock(m_mutex, std::adopt_lock);
+    std::lock_guard<std::mutex> otherLock(other.m_mutex, std::adopt_lock);
+    m_times = std::move(other.m_times);
+    m_y = std::move(other.m_y);
+    m_numY = other.m_numY;
+    m_stateTemplate = std::move(other.m_stateTemplate);
+    m_stateDiscrete = std::move(other.m_stateDiscrete);
+    m_templates = std::move(other.m_templates);
+    m_templateDiscrete = std::move(other.m_templateDiscrete);
+    m_discreteSnapshots = std::move(other.m_discreteSnapshots);
+    m_states = std::move(other.m_states);
+    m_isMaterialized = std::move(other.m_isMaterialized);
+    other.m_times.clear();
+    other.m_y.clear();
+    other.m_stateTemplate.clear();
+    other.m_stateDiscrete.clear();
+    other.m_templates.clear();
+    other.m_templateDiscrete.clear();
+    other.m_discreteSnapshots.clear();
+    other.m_states.clear();
+    other.m_isMaterialized.clear();
+    return *this;
+}
+
 size_t StatesTrajectory::getSize() const {
-    return m_states.size();
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_times.size();
 }
 
 void StatesTrajectory::clear() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_times.clear();
+    m_y.clear();
+    m_numY = 0;
+    m_stateTemplate.clear();
+    m_stateDiscrete.clear();
+    m_templates.clear();
+    m_templateDiscrete.clear();
+    m_discreteSnapshots.clear();
     m_states.clear();
+    m_isMaterialized.clear();
+}
+
+void StatesTrajectory::reserve(size_t numStates) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_times.reserve(numStates);
+    m_y.reserve(numStates * m_numY);
+    m_stateTemplate.reserve(numStates);
+    m_stateDiscrete.reserve(numStates);
 }
 
 void StatesTrajectory::append(const SimTK::State& state) {
-    if (!m_states.empty()) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    int templateIndex = -1;
+    if (!m_times.empty()) {
 
-        SimTK_APIARGCHECK2_ALWAYS(m_states.back().getTime() <= state.getTime(),
+        SimTK_APIARGCHECK2_ALWAYS(m_times.back() <= state.getTime(),
                 "StatesTrajectory", "append",
                 "New state's time (%f) must be equal to or greater than the "
                 "time for the last state in the trajectory (%f).",
-                state.getTime(), m_states.back().getTime()
+                state.getTime(), m_times.back()
                 );
 
         // We assume the trajectory (before appending) is already consistent,
         // so we only need to check consistency with a single state in the
         // trajectory.
-        OPENSIM_THROW_IF(!m_states.back().isConsistent(state),
+        templateIndex = m_stateTemplate.back();
+        OPENSIM_THROW_IF(!m_templates[templateIndex].isConsistent(state),
           InconsistentState, state.getTime());
     }
-    m_states.push_back(state);
+
+    int discreteIndex = -1;
+    if (templateIndex < 0 ||
+            !haveSameLayout(m_templates[templateIndex], state)) {
+        // Keep a complete copy of the first state with this layout.
+        DiscreteSnapshot snapshot;
+        for (SimTK::SubsystemIndex isub(0); isub < state.getNumSubsystems();
+                ++isub) {
+            for (SimTK::DiscreteVariableIndex idv(0);
+                    idv < state.getNDiscreteVars(isub); ++idv) {
+                snapshot.emplace_back(
+                        state.getDiscreteVariable(isub, idv).clone());
+            }
+        }
+        m_discreteSnapshots.push_back(std::move(snapshot));
+        discreteIndex = (int)m_discreteSnapshots.size() - 1;
+        m_templates.push_back(state);
+        m_templateDiscrete.push_back(discreteIndex);
+        templateIndex = (int)m_templates.size() - 1;
+        m_numY = state.getNY();
+    } else {
+        // Store the discrete variables that changed since the previous
+        // state, sharing the others.
+        discreteIndex = m_stateDiscrete.back();
+        const DiscreteSnapshot& previous = m_discreteSnapshots[discreteIndex];
+        std::unique_ptr<DiscreteSnapshot> changed;
+        int iflat = 0;
+        for (SimTK::SubsystemIndex isub(0); isub < state.getNumSubsystems();
+                ++isub) {
+            for (SimTK::DiscreteVariableIndex idv(0);
+                    idv < state.getNDiscreteVars(isub); ++idv, ++iflat) {
+                const auto& value = state.getDiscreteVariable(isub, idv);
+                if (isSameDiscreteValue(*previous[iflat], value)) continue;
+                if (!changed) changed.reset(new DiscreteSnapshot(previous));
+                (*changed)[iflat].reset(value.clone());
+            }
+        }
+        if (changed) {
+            m_discreteSnapshots.push_back(std::move(*changed));
+            discreteIndex = (int)m_discreteSnapshots.size() - 1;
+        }
+    }
+
+    m_times.push_back(state.getTime());
+    const SimTK::Vector& y = state.getY();
+    for (int i = 0; i < m_numY; ++i) m_y.push_back(y[i]);
+    m_stateTemplate.push_back(templateIndex);
+    m_stateDiscrete.push_back(discreteIndex);
+    // Make room for the state to be reconstructed. Like appending to a
+    // std::vector, this may invalidate references to reconstructed states.
+    m_states.emplace_back();
+    m_isMaterialized.emplace_back(false);
+}
+
+void StatesTrajectory::restoreState(
+        size_t index, SimTK::State& state, int previous) const {
+    const int templateIndex = m_stateTemplate[index];
+    int currentDiscrete;
+    if (previous < 0 || m_stateTemplate[previous] != templateIndex) {
+        state = m_templates[templateIndex];
+        currentDiscrete = m_templateDiscrete[templateIndex];
+    } else {
+        currentDiscrete = m_stateDiscrete[previous];
+    }
+
+    const int discreteIndex = m_stateDiscrete[index];
+    if (discreteIndex != currentDiscrete) {
+        const auto& current = m_discreteSnapshots[currentDiscrete];
+        const auto& values = m_discreteSnapshots[discreteIndex];
+        int iflat = 0;
+        for (SimTK::SubsystemIndex isub(0); isub < state.getNumSubsystems();
+                ++isub) {
+            for (SimTK::DiscreteVariableIndex idv(0);
+                    idv < state.getNDiscreteVars(isub); ++idv, ++iflat) {
+                // Values that did not change are shared between snapshots.
+                if (values[iflat] != current[iflat]) {
+                    state.updDiscreteVariable(isub, idv) = *values[iflat];
+                }
+            }
+        }
+    }
+
+    state.setTime(m_times[index]);
+    SimTK::Vector& y = state.updY();
+    const double* yData = &m_y[index * m_numY];
+    for (int i = 0; i < m_numY; ++i) y[i] = yData[i];
+}
+
+void StatesTrajectory::materialize(size_t index) const {
+    if (m_isMaterialized[index].load(std::memory_order_acquire)) return;
+    std::lock_guard<std::mutex> lock(m_mutex);
+    // Another thread may have reconstructed the state while we waited.
+    if (m_isMaterialized[index].load(std::memory_order_relaxed)) return;
+    restoreState(index, m_states[index], -1);
+    m_isMaterialized[index].store(true, std::memory_order_release);
+}
+
+const SimTK::State* StatesTrajectory::getMaterialized(size_t index) const {
+    if (m_isMaterialized[index].load(std::memory_order_acquire)) {
+        return &m_states[index];
+    }
+    return nullptr;
+}
+
+const SimTK::State& StatesTrajectory::operator[](size_t index) const {
+    // Like std::vector, this does not check the index.
+    materialize(index);
+    return m_states[index];
+}
+
+const SimTK::State& StatesTrajectory::get(size_t index) const {
+    if (index >= getSize()) {
+        OPENSIM_THROW(IndexOutOfRange, index, 0,
+                      static_cast<unsigned>(getSize() - 1));
+    }
+    return operator[](index);
+}
+
+struct StatesTrajectory::const_iterator::WorkingState {
+    SimTK::State state;
+    // The index of the state that `state` holds, or -1.
+    int index = -1;
+};
+
+StatesTrajectory::const_iterator::const_iterator(
+        const StatesTrajectory* trajectory, size_t index) :
+        m_trajectory(trajectory), m_index(index),
+        m_workingState(std::make_shared<WorkingState>()) {}
+
+const SimTK::State& StatesTrajectory::const_iterator::operator*() const {
+    if (const SimTK::State* state = m_trajectory->getMaterialized(m_index)) {
+        return *state;
+    }
+    // Only the variables that differ from those of the state that the
+    // working state holds are set.
+    WorkingState& working = *m_workingState;
+    if (working.index != static_cast<int>(m_index)) {
+        m_trajectory->restoreState(m_index, working.state, working.index);
+        working.index = static_cast<int>(m_index);
+    }
+    return working.state;
+}
+
+StatesTrajectory::const_iterator StatesTrajectory::begin() const {
+    return const_iterator(this, 0);
+}
+
+StatesTrajectory::const_iterator StatesTrajectory::end() const {
+    return const_iterator(this, getSize());
+}
+
+double StatesTrajectory::getTime(size_t index) const {
+    if (const SimTK::State* state = getMaterialized(index)) {
+        return state->getTime();
+    }
+    return m_times[index];
 }
 
 bool StatesTrajectory::hasIntegrity() const {
@@ -67,7 +367,7 @@ bool StatesTrajectory::isNondecreasingInTime() const {
 
     for (unsigned itime = 1; itime < getSize(); ++itime) {
 
-        if (get(itime).getTime() < get(itime - 1).getTime()) {
+        if (getTime(itime) < getTime(itime - 1)) {
             return false;
         }
 
@@ -79,11 +379,13 @@ bool StatesTrajectory::isConsistent() const {
     // An empty or size-1 trajectory is necessarily consistent.
     if (getSize() <= 1) return true;
 
-    const auto& state0 = operator[](0);
+    // All states are restored from one of the templates, so it is sufficient
+    // to check the templates.
+    const auto& state0 = m_templates[0];
 
-    for (unsigned itime = 1; itime < getSize(); ++itime) {
+    for (unsigned itemplate = 1; itemplate < m_templates.size(); ++itemplate) {
 
-        if (!state0.isConsistent(operator[](itime))) {
+        if (!state0.isConsistent(m_templates[itemplate])) {
             return false;
         }
 
@@ -99,7 +401,7 @@ bool StatesTrajectory::isCompatibleWith(const Model& model) const {
 
     // Since we now know all the states are consistent with each other, we only
     // need to check if the first one is compatible with the model.
-    const auto& state0 = get(0);
+    const auto& state0 = m_templates[0];
 
     // We only check the number of speeds because OpenSim does not count
     // quaternion slots, while the SimTK State contains quaternion slots even if
@@ -139,9 +441,10 @@ TimeSeriesTable StatesTrajectory::exportToTable(const Model& model,
     table.setColumnLabels(stateVars);
     size_t numDepColumns = stateVars.size();
 
-    // Fill up the table with the data.
-    for (size_t itime = 0; itime < getSize(); ++itime) {
-        const auto& state = get(itime);
+    // Fill up the table with the data. The iterator restores states that
+    // have not been reconstructed into a single working state, which only
+    // requires setting the variables that differ from the previous state.
+    for (const auto& state : *this) {
         TimeSeriesTable::RowVector row(static_cast<int>(numDepColumns));
 
         // Get each state variable's value.
@@ -248,7 +551,8 @@ StatesTrajectory StatesTrajectory::createFromStatesTable(
     // ===================
 
     // Reserve the memory we'll need to fit all the states.
-    states.m_states.reserve(table.getNumRows());
+    states.m_numY = state.getNY();
+    states.reserve(table.getNumRows());
 
     // Working memory for state. Initialize so that missing columns end up as
     // NaN.
@@ -23,6 +23,11 @@
  * limitations under the License.                                             *
  * -------------------------------------------------------------------------- */
 
+#include <atomic>
+#include <deque>
+#include <iterator>
+#include <memory>
+#include <mutex>
 #include <vector>
 
 #include <OpenSim/Common/Exception.h>
@@ -33,6 +38,7 @@
 
 namespace SimTK {
 class State;
+class AbstractValue;
 }
 
 namespace OpenSim {
@@ -136,11 +142,36 @@ class Model;
  *               << std::endl;
  * }
  * @endcode
+ *
+ * ### Storage
+ * To keep long trajectories small, the trajectory does not keep a copy of
+ * each appended SimTK::State. Instead, it stores the time and the continuous
+ * state variables (Y) of each state in one contiguous array, the discrete
+ * variables only when they change, and one complete copy of a state as a
+ * template for all states with the same layout. A SimTK::State is
+ * reconstructed from this data the first time it is accessed by index (e.g.,
+ * with get()), and is kept until the trajectory is cleared. As with a
+ * std::vector, references to states and iterators remain valid until the
+ * next call to append() or clear(). Iterating (e.g., in a range for loop)
+ * and exportToTable() do not keep the states: each state that was not
+ * accessed by index is restored into a single working state.
+ *
+ * A reconstructed state has the same time, continuous and discrete state
+ * variables as the appended state, but its cache is realized to at most
+ * SimTK::Stage::Instance, so you may need to realize it before using it (see
+ * above). Since a reconstructed state is kept, modifying it (e.g., from
+ * Python) modifies the trajectory.
  */
 class OSIMSIMULATION_API StatesTrajectory {
 public:
     /** Create an empty trajectory of states. */
     StatesTrajectory() {}
+    StatesTrajectory(const StatesTrajectory& other);
+    StatesTrajectory& operator=(const StatesTrajectory& other);
+    #ifndef SWIG
+    StatesTrajectory(StatesTrajectory&& other);
+    StatesTrajectory& operator=(StatesTrajectory&& other);
+    #endif
 
     /** The number of SimTK::State%s in the trajectory. */
     size_t getSize() const;
@@ -158,35 +189,59 @@ public:
      * @endcode
      * This function does not check if the index is larger than the size of
      * the trajectory; see get() if you want this check. */
-    const SimTK::State& operator[](size_t index) const {
-        return m_states[index];
-    }
+    const SimTK::State& operator[](size_t index) const;
     /** Get a const reference to the state at a given index in the trajectory.
 
      * @throws IndexOutOfRange If the index is greater than the size of the
      *                         trajectory.
      */
-    const SimTK::State& get(size_t index) const {
-        try {
-            return m_states.at(index);
-        } catch (const std::out_of_range&) {
-            OPENSIM_THROW(IndexOutOfRange, index, 0, 
-                          static_cast<unsigned>(m_states.size() - 1));
-        }
-    }
+    const SimTK::State& get(size_t index) const;
     /** Get a const reference to the first state in the trajectory. */
-    const SimTK::State& front() const { 
-        return m_states.front();
-    }
+    const SimTK::State& front() const { return operator[](0); }
     /** Get a const reference to the last state in the trajectory. */
-    const SimTK::State& back() const { 
-        return m_states.back();
-    }
+    const SimTK::State& back() const { return operator[](getSize() - 1); }
     /// @}
     
     /** Iterator type that does not allow modifying the trajectory.
-     * Most users do not need to understand what this is. */
-    typedef std::vector<SimTK::State>::const_iterator const_iterator;
+     * Most users do not need to understand what this is.
+     *
+     * Dereferencing the iterator gives the state that was kept after it was
+     * accessed by index, if any. Otherwise, the state is restored into a
+     * working state that the iterator and its copies share, so the reference
+     * is only valid until the iterator (or a copy) is dereferenced at another
+     * index. Copy the state if you need to keep it. */
+    class OSIMSIMULATION_API const_iterator {
+    public:
+        typedef std::input_iterator_tag iterator_category;
+        typedef SimTK::State value_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef const SimTK::State* pointer;
+        typedef const SimTK::State& reference;
+
+        const_iterator() = default;
+        reference operator*() const;
+        pointer operator->() const { return &operator*(); }
+        const_iterator& operator++() { ++m_index; return *this; }
+        const_iterator operator++(int) {
+            const_iterator previous = *this;
+            ++m_index;
+            return previous;
+        }
+        bool operator==(const const_iterator& other) const {
+            return m_index == other.m_index;
+        }
+        bool operator!=(const const_iterator& other) const {
+            return m_index != other.m_index;
+        }
+
+    private:
+        friend class StatesTrajectory;
+        struct WorkingState;
+        const_iterator(const StatesTrajectory* trajectory, size_t index);
+        const StatesTrajectory* m_trajectory = nullptr;
+        size_t m_index = 0;
+        std::shared_ptr<WorkingState> m_workingState;
+    };
 
     /** A helper type to allow using range for loops over a subset of the
      * trajectory. */
@@ -196,11 +251,12 @@ public:
     /// @{
 
     /** Iterator pointing to first SimTK::State; does not allow modifying the
-     * states. Allows using this class in a range for loop. */
-    const_iterator begin() const { return m_states.cbegin(); }
+     * states. Allows using this class in a range for loop. The states are
+     * restored one at a time and are not kept (see "Storage" above). */
+    const_iterator begin() const;
     /** Iterator pointing past the end of the trajectory. Allows using this
      * class in a range for loop. */
-    const_iterator end() const { return m_states.cend(); }
+    const_iterator end() const;
     /// @}
 
     /// @name Modify the contents of the trajectory
@@ -211,8 +267,8 @@ public:
      * This function ensures that the time in the new SimTK::State is greater
      * than or equal to the time in the last SimTK::State in the trajectory.
      *
-     * The state that ends up in the trajectory is a deep copy of the one
-     * passed in.
+     * The trajectory stores a copy of the time, continuous state variables,
+     * and discrete variables of the state passed in (see "Storage" above).
      */
     void append(const SimTK::State& state);
     /// @}
@@ -288,8 +344,45 @@ public:
             const std::vector<std::string>& stateVars = {}) const;
 
 private:
-
-    std::vector<SimTK::State> m_states;
+    /// The discrete variables of a state, for all subsystems in order.
+    /// Entries are shared between snapshots if they did not change.
+    typedef std::vector<std::shared_ptr<const SimTK::AbstractValue>>
+            DiscreteSnapshot;
+
+    void reserve(size_t numStates);
+    /// The time of a state, from the reconstructed state if it exists.
+    double getTime(size_t index) const;
+    /// Set `state` to the state at `index`. If `state` already holds the
+    /// state at `previous` (-1 if not), only the differences are set.
+    void restoreState(size_t index, SimTK::State& state, int previous) const;
+    /// Reconstruct the state at `index` if it was not reconstructed yet.
+    void materialize(size_t index) const;
+    /// Get the state at `index` if it was reconstructed, and nullptr
+    /// otherwise.
+    const SimTK::State* getMaterialized(size_t index) const;
+
+    // Compact storage (see "Storage" above).
+    std::vector<double> m_times;
+    // The continuous state variables (Y) of all states, one state after the
+    // other.
+    std::vector<double> m_y;
+    int m_numY = 0;
+    // Index into m_templates and m_discreteSnapshots for each state.
+    std::vector<int> m_stateTemplate;
+    std::vector<int> m_stateDiscrete;
+    // One complete state for each layout of state variables, and the index
+    // of its discrete variables in m_discreteSnapshots.
+    std::vector<SimTK::State> m_templates;
+    std::vector<int> m_templateDiscrete;
+    std::vector<DiscreteSnapshot> m_discreteSnapshots;
+
+    // States reconstructed on access. Elements that have not been
+    // reconstructed yet are empty states. A state is only written while
+    // m_mutex is locked and before its flag is set, so readers only lock
+    // m_mutex for states that have not been reconstructed.
+    mutable std::vector<SimTK::State> m_states;
+    mutable std::deque<std::atomic<bool>> m_isMaterialized;
+    mutable std::mutex m_mutex;
 
 public:
 
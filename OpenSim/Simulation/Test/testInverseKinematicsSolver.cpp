@@ -88,6 +88,10 @@ void testTrackWithUpdateMarkerWeights();
 // includes intervals with NaNs (no observation)
 void testNumberOfMarkersMismatch();
 void testNumberOfOrientationsMismatch();
+// Verify that a single thread can put more rows into a
+// BufferedOrientationsReference than a bounded queue would hold, and that a
+// bounded queue reports overflow instead of waiting forever.
+void testBufferedOrientationsReferenceQueue();
 
 int main()
 {
@@ -131,6 +135,12 @@ int main()
         failures.push_back("testNumberOfOrientationsMismatch");
     }
 
+    try { testBufferedOrientationsReferenceQueue(); }
+    catch (const std::exception& e) {
+        cout << e.what() << endl;
+        failures.push_back("testBufferedOrientationsReferenceQueue");
+    }
+
     if (!failures.empty()) {
         cout << "Done, with failure(s): " << failures << endl;
         return 1;
@@ -281,6 +291,44 @@ void testOrientationsReference() {
 }
 
 
+void testBufferedOrientationsReferenceQueue() {
+    const SimTK::RowVector_<SimTK::Rotation> row{2, SimTK::Rotation()};
+    double time;
+    SimTK::Array_<SimTK::Rotation> values;
+
+    // By default, the queue is unbounded.
+    BufferedOrientationsReference unbounded;
+    SimTK_ASSERT_ALWAYS(unbounded.getQueueCapacity() == 0,
+            "Expected an unbounded queue by default.");
+    const int numRows = 5000;
+    for (int i = 0; i < numRows; ++i) unbounded.putValues(0.01 * i, row);
+    for (int i = 0; i < numRows; ++i) {
+        unbounded.getNextValuesAndTime(time, values);
+        SimTK_ASSERT_ALWAYS(time == 0.01 * i && values.size() == 2,
+                "Rows were not drawn in the order they were put.");
+    }
+
+    // A bounded queue throws when it is full, and drops rows with the
+    // DropOldest policy.
+    BufferedOrientationsReference bounded;
+    bounded.setQueueCapacity(4);
+    for (int i = 0; i < 4; ++i) bounded.putValues(0.01 * i, row);
+    bool threw = false;
+    try { bounded.putValues(0.04, row); }
+    catch (const OpenSim::Exception&) { threw = true; }
+    SimTK_ASSERT_ALWAYS(threw, "Expected putValues() to throw if full.");
+    bounded.getNextValuesAndTime(time, values);
+    SimTK_ASSERT_ALWAYS(time == 0, "Expected the first row to be kept.");
+
+    bounded.setQueueCapacity(4,
+            BufferedOrientationsReference::OverflowPolicy::DropOldest);
+    for (int i = 0; i < 10; ++i) bounded.putValues(0.01 * i, row);
+    SimTK_ASSERT_ALWAYS(bounded.getNumDroppedValues() == 6,
+            "Expected 6 rows to be dropped.");
+    bounded.getNextValuesAndTime(time, values);
+    SimTK_ASSERT_ALWAYS(time == 0.01 * 6, "Expected the oldest rows dropped.");
+}
+
 void testAccuracy()
 {
     cout << "\ntestInverseKinematicsSolver::testAccuracy()" << endl;
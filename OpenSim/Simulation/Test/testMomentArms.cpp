@@ -55,6 +55,9 @@ void testMomentArmDefinitionForModel(const string &filename,
                                      double mass = -1.0, string errorMessage = "");
 
 void testMomentArmsAcrossCompoundJoint();
+void testPolynomialPathSurrogate();
+void testPolynomialPathSurrogateAcrossBallJoint();
+void testPathLengthAndSpeedFromPathPoints();
 
 int main()
 {
@@ -67,6 +70,16 @@ int main()
         testMomentArmsAcrossCompoundJoint();
         cout << "Joint composed of more than one mobilized body: PASSED\n" << endl;
 
+        testPolynomialPathSurrogate();
+        cout << "Polynomial path surrogate: PASSED\n" << endl;
+
+        testPolynomialPathSurrogateAcrossBallJoint();
+        cout << "Polynomial path surrogate across a BallJoint: PASSED\n"
+             << endl;
+
+        testPathLengthAndSpeedFromPathPoints();
+        cout << "Path length and speed from path points: PASSED\n" << endl;
+
         testMomentArmDefinitionForModel("BothLegs22.osim", "r_knee_angle", "VASINT", 
             SimTK::Vec2(-2*SimTK::Pi/3, SimTK::Pi/18), 0.0, 
             "VASINT of BothLegs with no mass: FAILED");
@@ -442,3 +455,256 @@ void testMomentArmDefinitionForModel(const string &filename, const string &coord
     // dL/dTheta definition or is at least dynamically consistent, in which dL/dTheta is not
     ASSERT(passesDefinition || passesDynamicConsistency, __FILE__, __LINE__, errorMessage);
 }
+
+void testPolynomialPathSurrogate()
+{
+    Model model("gait2354_simbody.osim");
+    SimTK::State& s = model.initSystem();
+
+    // vas_int_r spans the knee (with moving path points) and med_gas_r spans
+    // the knee and the ankle.
+    for (const std::string name : {"vas_int_r", "med_gas_r"}) {
+        auto& path = model.updMuscles().get(name).updGeometryPath();
+        const auto& surrogate = path.fitPolynomialSurrogate(s, 5, 300);
+        surrogate.printErrorReport();
+        ASSERT(surrogate.getNumCoordinates() == (name == "vas_int_r" ? 1 : 2),
+                __FILE__, __LINE__, "Unexpected number of coordinates.");
+        ASSERT(surrogate.get_length_max_error() < 1e-3, __FILE__, __LINE__,
+                "Length error of the surrogate is too large.");
+        ASSERT(surrogate.get_moment_arm_max_error() < 5e-3, __FILE__,
+                __LINE__, "Moment arm error of the surrogate is too large.");
+    }
+    ASSERT_THROW(OpenSim::Exception,
+            model.updMuscles().get("bifemlh_r").updGeometryPath()
+                    .fitPolynomialSurrogate(s, 5, 300,
+                            {"/jointset/hip_r/hip_flexion_r",
+                                    "/jointset/hip_r/hip_adduction_r",
+                                    "/jointset/hip_r/hip_rotation_r",
+                                    "/jointset/knee_r/knee_angle_r",
+                                    "/jointset/ankle_r/ankle_angle_r"}));
+
+    // The surrogate is saved with the model, and the length, lengthening
+    // speed, and moment arms match the exact path.
+    model.print("testMomentArms_polynomial_surrogate.osim");
+    Model exactModel("gait2354_simbody.osim");
+    SimTK::State& sExact = exactModel.initSystem();
+    Model surrogateModel("testMomentArms_polynomial_surrogate.osim");
+    SimTK::State& sSurrogate = surrogateModel.initSystem();
+    const auto& gasPath =
+            surrogateModel.getMuscles().get("med_gas_r").getGeometryPath();
+    const auto& gasPathExact =
+            exactModel.getMuscles().get("med_gas_r").getGeometryPath();
+    ASSERT(gasPath.isPolynomialSurrogateEnabled(), __FILE__, __LINE__,
+            "Expected the surrogate to be enabled.");
+    ASSERT(!gasPathExact.isPolynomialSurrogateEnabled(), __FILE__, __LINE__,
+            "Expected no surrogate.");
+    const auto setState = [](const Model& m, SimTK::State& state,
+                                  const SimTK::Vec2& q) {
+        const auto& knee = m.getCoordinateSet().get("knee_angle_r");
+        const auto& ankle = m.getCoordinateSet().get("ankle_angle_r");
+        knee.setValue(state, q[0], false);
+        ankle.setValue(state, q[1], false);
+        knee.setSpeedValue(state, 1.0);
+        ankle.setSpeedValue(state, -2.0);
+        m.realizeVelocity(state);
+    };
+    for (const auto& q : {SimTK::Vec2(-1.5, -0.3), SimTK::Vec2(-0.2, 0.2)}) {
+        setState(exactModel, sExact, q);
+        setState(surrogateModel, sSurrogate, q);
+        ASSERT_EQUAL(gasPathExact.getLength(sExact),
+                gasPath.getLength(sSurrogate), 1e-3);
+        ASSERT_EQUAL(gasPathExact.getLengtheningSpeed(sExact),
+                gasPath.getLengtheningSpeed(sSurrogate), 1e-2);
+        for (const std::string coord : {"knee_angle_r", "ankle_angle_r"}) {
+            ASSERT_EQUAL(gasPathExact.computeMomentArm(sExact,
+                                 exactModel.getCoordinateSet().get(coord)),
+                    gasPath.computeMomentArm(sSurrogate,
+                            surrogateModel.getCoordinateSet().get(coord)),
+                    5e-3);
+        }
+        // The generalized forces from the tension are consistent with the
+        // moment arms.
+        const auto& knee = surrogateModel.getCoordinateSet().get("knee_angle_r");
+        SimTK::Vector_<SimTK::SpatialVec> bodyForces(
+                surrogateModel.getMatterSubsystem().getNumBodies(),
+                SimTK::SpatialVec(SimTK::Vec3(0), SimTK::Vec3(0)));
+        SimTK::Vector mobilityForces(sSurrogate.getNU(), 0.0);
+        gasPath.addInEquivalentForces(sSurrogate, 2.0, bodyForces,
+                mobilityForces);
+        const auto& mobod = surrogateModel.getMatterSubsystem()
+                .getMobilizedBody(knee.getBodyIndex());
+        ASSERT_EQUAL(2.0 * gasPath.computeMomentArm(sSurrogate, knee),
+                mobod.getOneFromUPartition(sSurrogate,
+                        SimTK::MobilizerUIndex(knee.getMobilizerQIndex()),
+                        mobilityForces),
+                1e-10);
+    }
+
+    // The moment arm about a coordinate that the surrogate does not use
+    // matches the exact path.
+    const auto& hip = surrogateModel.getCoordinateSet().get("hip_flexion_r");
+    ASSERT_EQUAL(gasPathExact.computeMomentArm(sExact,
+                         exactModel.getCoordinateSet().get("hip_flexion_r")),
+            gasPath.computeMomentArm(sSurrogate, hip), 1e-10);
+
+    // An invalid fit throws and keeps the surrogate that is in use.
+    const double surrogateLength = gasPath.getLength(sSurrogate);
+    ASSERT(std::abs(surrogateLength - gasPathExact.getLength(sExact)) > 0,
+            __FILE__, __LINE__,
+            "Expected the surrogate length to differ from the exact length.");
+    auto& gasPathToRefit =
+            surrogateModel.updMuscles().get("med_gas_r").updGeometryPath();
+    ASSERT_THROW(OpenSim::Exception,
+            gasPathToRefit.fitPolynomialSurrogate(sSurrogate, 5, 2));
+    ASSERT_THROW(OpenSim::Exception,
+            gasPathToRefit.fitPolynomialSurrogate(sSurrogate, 5, 300,
+                    {"/jointset/knee_r/not_a_coordinate"}));
+    sSurrogate.invalidateAllCacheAtOrAbove(SimTK::Stage::Position);
+    surrogateModel.realizeVelocity(sSurrogate);
+    ASSERT_EQUAL(surrogateLength, gasPath.getLength(sSurrogate), 1e-12);
+
+    // Disabling the surrogate restores the exact path.
+    surrogateModel.updMuscles().get("med_gas_r").updGeometryPath()
+            .upd_polynomial_surrogate().set_enabled(false);
+    SimTK::State& sDisabled = surrogateModel.initSystem();
+    ASSERT_EQUAL(gasPathExact.getLength(exactModel.initSystem()),
+            surrogateModel.getMuscles().get("med_gas_r").getGeometryPath()
+                    .getLength(sDisabled), 1e-10);
+}
+
+// The moment arms of a surrogate are derivatives with respect to q, but the
+// speeds u of a BallJoint are not qdot. The lengthening speed and the
+// mobility forces of the surrogate must account for this.
+void testPolynomialPathSurrogateAcrossBallJoint()
+{
+    Model model;
+    auto* body = new Body("body", 1.0, SimTK::Vec3(0), SimTK::Inertia(1.0));
+    model.addBody(body);
+    auto* ball = new BallJoint("ball", model.getGround(), SimTK::Vec3(0),
+            SimTK::Vec3(0), *body, SimTK::Vec3(0), SimTK::Vec3(0));
+    for (int i = 0; i < 3; ++i) {
+        ball->upd_coordinates(i).setRangeMin(-1.0);
+        ball->upd_coordinates(i).setRangeMax(1.0);
+    }
+    model.addJoint(ball);
+    auto* actu = new PathActuator();
+    actu->setName("actu");
+    actu->addNewPathPoint("origin", model.updGround(),
+            SimTK::Vec3(0.1, 0.5, 0));
+    actu->addNewPathPoint("insertion", *body, SimTK::Vec3(0.3, -0.2, 0.1));
+    model.addForce(actu);
+    SimTK::State* s = &model.initSystem();
+
+    std::vector<std::string> coordinatePaths;
+    for (int i = 0; i < 3; ++i) {
+        coordinatePaths.push_back(
+                ball->get_coordinates(i).getAbsolutePathString());
+    }
+    actu->updGeometryPath().fitPolynomialSurrogate(*s, 4, 300,
+            coordinatePaths);
+    s = &model.initSystem();
+    const GeometryPath& path = actu->getGeometryPath();
+    ASSERT(path.isPolynomialSurrogateEnabled(), __FILE__, __LINE__,
+            "Expected the surrogate to be enabled.");
+
+    const SimTK::Vec3 q(0.5, -0.6, 0.4);
+    const SimTK::Vec3 u(1.0, -2.0, 0.5);
+    for (int i = 0; i < 3; ++i) {
+        ball->get_coordinates(i).setValue(*s, q[i], false);
+        ball->get_coordinates(i).setSpeedValue(*s, u[i]);
+    }
+    model.realizeVelocity(*s);
+    const SimTK::Vector qdot = s->getQDot();
+    ASSERT((qdot - s->getU()).normInf() > 0.1, __FILE__, __LINE__,
+            "Expected qdot to differ from u.");
+
+    // The lengthening speed is the derivative of the surrogate length along
+    // qdot.
+    const double h = 1e-6;
+    const auto calcLength = [&](double step) {
+        SimTK::State state = *s;
+        state.updQ() += step * qdot;
+        model.realizePosition(state);
+        return path.getLength(state);
+    };
+    const double speed = path.getLengtheningSpeed(*s);
+    ASSERT_EQUAL((calcLength(h) - calcLength(-h)) / (2 * h), speed, 1e-6,
+            __FILE__, __LINE__, "Lengthening speed of the surrogate differs.");
+
+    // The power of the mobility forces is -tension * lengthening speed.
+    const double tension = 2.0;
+    SimTK::Vector_<SimTK::SpatialVec> bodyForces(
+            model.getMatterSubsystem().getNumBodies(),
+            SimTK::SpatialVec(SimTK::Vec3(0), SimTK::Vec3(0)));
+    SimTK::Vector mobilityForces(s->getNU(), 0.0);
+    path.addInEquivalentForces(*s, tension, bodyForces, mobilityForces);
+    ASSERT_EQUAL(-tension * speed, ~mobilityForces * s->getU(), 1e-10,
+            __FILE__, __LINE__, "Power of the mobility forces differs.");
+}
+
+// GeometryPath computes its length and lengthening speed from a flat copy of
+// the current path; compare to the same quantities computed from the path
+// points themselves.
+void testPathLengthAndSpeedFromPathPoints()
+{
+    // arm26 has wrapping surfaces; gait2354 has moving path points.
+    for (const std::string file : {"arm26.osim", "gait2354_simbody.osim"}) {
+        Model model(file);
+        SimTK::State& s = model.initSystem();
+        SimTK::Random::Uniform random(-0.5, 0.5);
+        random.setSeed(0);
+        for (int trial = 0; trial < 5; ++trial) {
+            for (const auto& coord : model.getComponentList<Coordinate>()) {
+                if (coord.isConstrained(s)) continue;
+                const double lower = std::max(coord.getRangeMin(), -SimTK::Pi);
+                const double upper = std::min(coord.getRangeMax(), SimTK::Pi);
+                coord.setValue(s,
+                        lower + (random.getValue() + 0.5) * (upper - lower),
+                        false);
+                coord.setSpeedValue(s, 2 * random.getValue());
+            }
+            model.assemble(s);
+            model.realizeVelocity(s);
+
+            for (const auto& muscle : model.getComponentList<Muscle>()) {
+                const GeometryPath& path = muscle.getGeometryPath();
+                const Array<AbstractPathPoint*>& points =
+                        path.getCurrentPath(s);
+                double length = 0;
+                double speed = 0;
+                for (int i = 0; i < points.getSize() - 1; ++i) {
+                    const AbstractPathPoint& p1 = *points[i];
+                    const AbstractPathPoint& p2 = *points[i + 1];
+                    const SimTK::Vec3 r1 = p1.getParentFrame()
+                            .getTransformInGround(s) * p1.getLocation(s);
+                    const SimTK::Vec3 r2 = p2.getParentFrame()
+                            .getTransformInGround(s) * p2.getLocation(s);
+                    const auto* wrapPoint =
+                            dynamic_cast<const PathWrapPoint*>(&p2);
+                    if (p1.getWrapObject() && wrapPoint &&
+                            p1.getWrapObject() == p2.getWrapObject()) {
+                        length += wrapPoint->getWrapLength();
+                    } else {
+                        length += (r2 - r1).norm();
+                    }
+                    const auto velocity = [&s](const AbstractPathPoint& p) {
+                        if (dynamic_cast<const MovingPathPoint*>(&p)) {
+                            return p.getVelocityInGround(s);
+                        }
+                        return p.getParentFrame().findStationVelocityInGround(
+                                s, p.getLocation(s));
+                    };
+                    const SimTK::Vec3 v = velocity(p1) - velocity(p2);
+                    const double d = (r1 - r2).norm();
+                    speed += d < SimTK::Eps ? v.norm() : dot(v, (r1 - r2) / d);
+                }
+                ASSERT_EQUAL(length, path.getLength(s), 1e-10, __FILE__,
+                        __LINE__, "Length of " + muscle.getName() + " differs.");
+                ASSERT_EQUAL(speed, path.getLengtheningSpeed(s), 1e-10,
+                        __FILE__, __LINE__,
+                        "Lengthening speed of " + muscle.getName() +
+                                " differs.");
+            }
+        }
+    }
+}
@@ -770,6 +770,104 @@ void testExport() {
             OpenSim::Exception);
 }
 
+void testDiscreteVariablesAreRestored() {
+    // States are stored compactly and reconstructed on access; make sure
+    // discrete variables (here, a locked coordinate) that change within the
+    // trajectory are restored correctly, including when the trajectory is
+    // exported or copied before any state is accessed.
+    Model model("gait2354_simbody.osim");
+    auto& state = model.initSystem();
+    const auto& knee = model.getCoordinateSet().get("knee_angle_r");
+
+    StatesTrajectory states;
+    const int numStates = 10;
+    // Locking a coordinate enables a constraint, which changes the number of
+    // constraint equations once the state is realized.
+    std::vector<int> numQErr;
+    for (int i = 0; i < numStates; ++i) {
+        state.setTime(0.1 * i);
+        knee.setLocked(state, false);
+        knee.setValue(state, -0.1 * i, false);
+        knee.setLocked(state, i >= 3 && i < 6);
+        states.append(state);
+        model.getMultibodySystem().realize(state, SimTK::Stage::Instance);
+        numQErr.push_back(state.getNQErr());
+    }
+    SimTK_TEST(numQErr[3] > numQErr[0]);
+
+    const auto table = states.exportToTable(model);
+    const StatesTrajectory statesCopy(states);
+    for (int i = 0; i < numStates; ++i) {
+        SimTK_TEST_EQ(states[i].getTime(), 0.1 * i);
+        SimTK_TEST(knee.getLocked(states[i]) == (i >= 3 && i < 6));
+        SimTK_TEST_EQ(knee.getValue(states[i]), -0.1 * i);
+        SimTK_TEST(knee.getLocked(statesCopy[i]) == (i >= 3 && i < 6));
+        SimTK_TEST_EQ(knee.getValue(statesCopy[i]), -0.1 * i);
+    }
+    tableAndTrajectoryMatch(model, table, states);
+
+    // The constraints that are enabled in a state are stored in Simbody
+    // discrete variables that OpenSim cannot compare; they must be restored
+    // as well.
+    for (int i = 0; i < numStates; ++i) {
+        SimTK::State restored = states[i];
+        model.getMultibodySystem().realize(restored, SimTK::Stage::Position);
+        SimTK_TEST(restored.getNQErr() == numQErr[i]);
+        SimTK_TEST(knee.getLocked(restored) == (i >= 3 && i < 6));
+    }
+
+    // Accessing a state returns the same object each time.
+    SimTK_TEST(&states[4] == &states.get(4));
+    SimTK_TEST(&states.back() == &states[numStates - 1]);
+}
+
+void testIteratingRestoresStates() {
+    // Iterating restores each state into a working state shared by the
+    // iterator and its copies, going forward or back to any state, and gives
+    // the kept state for states that were accessed by index.
+    Model model("gait2354_simbody.osim");
+    auto& state = model.initSystem();
+    const auto& knee = model.getCoordinateSet().get("knee_angle_r");
+
+    StatesTrajectory states;
+    const int numStates = 10;
+    for (int i = 0; i < numStates; ++i) {
+        state.setTime(0.1 * i);
+        knee.setLocked(state, false);
+        knee.setValue(state, -0.1 * i, false);
+        knee.setLocked(state, i >= 3 && i < 6);
+        states.append(state);
+    }
+
+    int i = 0;
+    for (const auto& restored : states) {
+        SimTK_TEST_EQ(restored.getTime(), 0.1 * i);
+        SimTK_TEST(knee.getLocked(restored) == (i >= 3 && i < 6));
+        SimTK_TEST_EQ(knee.getValue(restored), -0.1 * i);
+        ++i;
+    }
+    SimTK_TEST(i == numStates);
+
+    const auto first = states.begin();
+    auto it = first;
+    for (int k = 0; k < 7; ++k) ++it;
+    SimTK_TEST_EQ(it->getTime(), 0.7);
+    SimTK_TEST(knee.getLocked(*first) == false);
+    SimTK_TEST_EQ(knee.getValue(*first), 0.0);
+    // The copies share the working state, so `it` restores its state again.
+    SimTK_TEST(&*it == &*first);
+    SimTK_TEST_EQ(knee.getValue(*it), -0.7);
+
+    const SimTK::State& kept = states[4];
+    it = states.begin();
+    for (int k = 0; k < 4; ++k) ++it;
+    SimTK_TEST(&*it == &kept);
+    SimTK_TEST(knee.getLocked(*it));
+    SimTK_TEST(it++ != states.end());
+    SimTK_TEST(&*it != &kept);
+    SimTK_TEST_EQ(it->getTime(), 0.5);
+}
+
 int main() {
     SimTK_START_TEST("testStatesTrajectory");
         // actuators library is not loaded automatically (unless using clang).
@@ -802,6 +900,8 @@ int main() {
 
         // Export to data table.
         SimTK_SUBTEST(testExport);
+        SimTK_SUBTEST(testDiscreteVariablesAreRestored);
+        SimTK_SUBTEST(testIteratingRestoresStates);
 
     SimTK_END_TEST();
 }
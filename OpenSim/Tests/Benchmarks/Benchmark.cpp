@@ -0,0 +1,398 @@
+/* -------------------------------------------------------------------------- *
+ *                        OpenSim:  Benchmark.cpp                             *
+ * -------------------------------------------------------------------------- *
+ * The OpenSim API is a toolkit for musculoskeletal modeling and simulation.  *
+ * See http://opensim.stanford.edu and the NOTICE file for more information.  *
+ * OpenSim is developed at Stanford University and supported by the US        *
+ * National Institutes of Health (U54 GM072970, R24 HD065690) and by DARPA    *
+ * through the Warrior Web program.                                           *
+ *                                                                            *
+ * Copyright (c) 2005-2021 Stanford University and the Authors                *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+#include "Benchmark.h"
+
+#include <OpenSim/Auxiliary/getRSS.h>
+#include <OpenSim/Common/Logger.h>
+
+#include <atomic>
+#include <cstdlib>
+#include <ctime>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <new>
+#include <sstream>
+#include <thread>
+
+using namespace OpenSim;
+
+// Allocation counting.
+// --------------------
+// Replacing the global allocation functions lets us count every heap
+// allocation made while a benchmark is timed. On Linux and macOS, this also
+// captures allocations made inside the OpenSim and Simbody shared libraries;
+// on Windows, only allocations made from the benchmark executable itself are
+// counted.
+static std::atomic<int64_t> g_numAllocations{0};
+static std::atomic<int64_t> g_numBytesAllocated{0};
+
+static void* countedAllocate(std::size_t size) {
+    g_numAllocations.fetch_add(1, std::memory_order_relaxed);
+    g_numBytesAllocated.fetch_add((int64_t)size, std::memory_order_relaxed);
+    if (size == 0) size = 1;
+    if (void* ptr = std::malloc(size)) return ptr;
+    throw std::bad_alloc();
+}
+
+void* operator new(std::size_t size) { return countedAllocate(size); }
+void* operator new[](std::size_t size) { return countedAllocate(size); }
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    try {
+        return countedAllocate(size);
+    } catch (...) {
+        return nullptr;
+    }
+}
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+    try {
+        return countedAllocate(size);
+    } catch (...) {
+        return nullptr;
+    }
+}
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+void operator delete[](void* ptr) noexcept { std::free(ptr); }
+void operator delete(void* ptr, std::size_t) noexcept { std::free(ptr); }
+void operator delete[](void* ptr, std::size_t) noexcept { std::free(ptr); }
+
+// BenchmarkState.
+// ---------------
+BenchmarkState::BenchmarkState(double minTime, int64_t maxIterations)
+        : m_minTime(minTime), m_maxIterations(maxIterations) {}
+
+void BenchmarkState::startTimer() {
+    m_allocationsAtStart = g_numAllocations.load(std::memory_order_relaxed);
+    m_bytesAtStart = g_numBytesAllocated.load(std::memory_order_relaxed);
+    m_running = true;
+    m_start = Clock::now();
+}
+
+void BenchmarkState::stopTimer() {
+    const auto end = Clock::now();
+    m_elapsedNs += (double)std::chrono::duration_cast<std::chrono::nanoseconds>(
+            end - m_start).count();
+    m_numAllocations +=
+            g_numAllocations.load(std::memory_order_relaxed) -
+            m_allocationsAtStart;
+    m_numBytesAllocated +=
+            g_numBytesAllocated.load(std::memory_order_relaxed) -
+            m_bytesAtStart;
+    m_running = false;
+}
+
+bool BenchmarkState::keepRunning() {
+    if (!m_started) {
+        m_started = true;
+        m_numIterations = 0;
+        m_rssAtStart = getCurrentRSS();
+        startTimer();
+        return true;
+    }
+    // Only check the clock if the timer is running; if the benchmark paused
+    // the timer at the end of an iteration, it is paused until we resume it.
+    const bool wasRunning = m_running;
+    if (wasRunning) stopTimer();
+    ++m_numIterations;
+    if (m_numIterations >= m_maxIterations ||
+            m_elapsedNs >= 1e9 * m_minTime) {
+        m_rssDelta = (int64_t)getCurrentRSS() - (int64_t)m_rssAtStart;
+        return false;
+    }
+    startTimer();
+    return true;
+}
+
+void BenchmarkState::pauseTiming() {
+    if (m_running) stopTimer();
+}
+
+void BenchmarkState::resumeTiming() {
+    if (!m_running) startTimer();
+}
+
+// Registry.
+// ---------
+namespace {
+struct RegisteredBenchmark {
+    std::string name;
+    BenchmarkFunction function;
+};
+std::vector<RegisteredBenchmark>& getRegistry() {
+    static std::vector<RegisteredBenchmark> registry;
+    return registry;
+}
+
+struct BenchmarkResult {
+    std::string name;
+    std::string label;
+    int64_t iterations = 0;
+    double nsPerOp = 0;
+    double allocationsPerOp = 0;
+    double bytesPerOp = 0;
+    int64_t rssDelta = 0;
+    std::string skipReason;
+};
+
+struct Options {
+    std::vector<std::string> filters;
+    double minTime = 0.5;
+    int64_t maxIterations = 1000000000;
+    std::string jsonFile;
+    std::string compareFile;
+    double threshold = 0.10;
+};
+
+void printUsage(const char* executable) {
+    std::cout <<
+        "Usage: " << executable << " [options]\n"
+        "  --filter=<substring>   Only run benchmarks whose name contains\n"
+        "                         <substring>. May be given multiple times.\n"
+        "  --min-time=<seconds>   Minimum timed duration per benchmark\n"
+        "                         (default: 0.5).\n"
+        "  --max-iterations=<n>   Maximum iterations per benchmark.\n"
+        "  --json=<file>          Write results to <file> as JSON.\n"
+        "  --compare=<file>       Compare ns/op against a JSON baseline\n"
+        "                         written by --json; exit with a nonzero\n"
+        "                         status if any benchmark regressed.\n"
+        "  --threshold=<ratio>    Relative slowdown that counts as a\n"
+        "                         regression (default: 0.10).\n"
+        "  --list                 List the benchmarks and exit.\n";
+}
+
+std::string escapeJSON(const std::string& in) {
+    std::string out;
+    for (const char c : in) {
+        if (c == '"' || c == '\\') out += '\\';
+        out += c;
+    }
+    return out;
+}
+
+void writeJSON(const std::string& filename, const std::string& executable,
+        const std::vector<BenchmarkResult>& results) {
+    std::ofstream out(filename);
+    if (!out) {
+        throw std::runtime_error("Could not open '" + filename + "'.");
+    }
+    const std::time_t now = std::time(nullptr);
+    char date[32];
+    std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S",
+            std::localtime(&now));
+    out << "{\n";
+    out << "  \"context\": {\"executable\": \"" << escapeJSON(executable)
+        << "\", \"date\": \"" << date << "\", \"num_cpus\": "
+        << std::thread::hardware_concurrency() << "},\n";
+    out << "  \"benchmarks\": [\n";
+    // Each benchmark is written on its own line so that the files are easy
+    // to diff and easy to parse in compareToBaseline().
+    out << std::setprecision(10);
+    for (size_t i = 0; i < results.size(); ++i) {
+        const auto& r = results[i];
+        out << "    {\"name\": \"" << escapeJSON(r.name) << "\"";
+        if (!r.skipReason.empty()) {
+            out << ", \"skipped\": \"" << escapeJSON(r.skipReason) << "\"}";
+        } else {
+            out << ", \"label\": \"" << escapeJSON(r.label) << "\""
+                << ", \"iterations\": " << r.iterations
+                << ", \"ns_per_op\": " << r.nsPerOp
+                << ", \"allocs_per_op\": " << r.allocationsPerOp
+                << ", \"bytes_per_op\": " << r.bytesPerOp
+                << ", \"rss_delta_bytes\": " << r.rssDelta << "}";
+        }
+        out << (i + 1 < results.size() ? ",\n" : "\n");
+    }
+    out << "  ]\n";
+    out << "}\n";
+}
+
+/// Extract the value of a key from a single-line JSON object written by
+/// writeJSON().
+bool findValue(const std::string& line, const std::string& key,
+        std::string& value) {
+    const std::string pattern = "\"" + key + "\": ";
+    auto pos = line.find(pattern);
+    if (pos == std::string::npos) return false;
+    pos += pattern.size();
+    if (line[pos] == '"') {
+        const auto end = line.find('"', pos + 1);
+        value = line.substr(pos + 1, end - pos - 1);
+    } else {
+        const auto end = line.find_first_of(",}", pos);
+        value = line.substr(pos, end - pos);
+    }
+    return true;
+}
+
+int compareToBaseline(const std::string& filename,
+        const std::vector<BenchmarkResult>& results, double threshold) {
+    std::ifstream in(filename);
+    if (!in) {
+        throw std::runtime_error("Could not open '" + filename + "'.");
+    }
+    std::map<std::string, double> baseline;
+    std::string line;
+    while (std::getline(in, line)) {
+        std::string name, nsPerOp;
+        if (findValue(line, "name", name) &&
+                findValue(line, "ns_per_op", nsPerOp)) {
+            baseline[name] = std::stod(nsPerOp);
+        }
+    }
+
+    int numRegressions = 0;
+    std::cout << "\nComparison against " << filename << " (threshold "
+              << 100 * threshold << "%):\n";
+    for (const auto& r : results) {
+        if (!r.skipReason.empty()) continue;
+        const auto it = baseline.find(r.name);
+        if (it == baseline.end()) {
+            std::cout << "  " << std::left << std::setw(50) << r.name
+                      << " (not in baseline)\n";
+            continue;
+        }
+        const double change = (r.nsPerOp - it->second) / it->second;
+        const bool regressed = change > threshold;
+        if (regressed) ++numRegressions;
+        std::cout << "  " << std::left << std::setw(50) << r.name
+                  << std::right << std::showpos << std::fixed
+                  << std::setprecision(1) << std::setw(8) << 100 * change
+                  << "%" << std::noshowpos
+                  << (regressed ? "  REGRESSION" : "") << "\n";
+    }
+    return numRegressions;
+}
+
+} // anonymous namespace
+
+BenchmarkRegistration::BenchmarkRegistration(
+        const std::string& name, BenchmarkFunction function) {
+    getRegistry().push_back({name, std::move(function)});
+}
+
+int main(int argc, char* argv[]) {
+    Options options;
+    bool listOnly = false;
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        const auto eq = arg.find('=');
+        const std::string key = arg.substr(0, eq);
+        const std::string value =
+                eq == std::string::npos ? "" : arg.substr(eq + 1);
+        if (key == "--filter") options.filters.push_back(value);
+        else if (key == "--min-time") options.minTime = std::stod(value);
+        else if (key == "--max-iterations")
+            options.maxIterations = std::stoll(value);
+        else if (key == "--json") options.jsonFile = value;
+        else if (key == "--compare") options.compareFile = value;
+        else if (key == "--threshold") options.threshold = std::stod(value);
+        else if (key == "--list") listOnly = true;
+        else {
+            printUsage(argv[0]);
+            return key == "--help" ? 0 : 1;
+        }
+    }
+
+    // Log messages (e.g., from loading models) would distort the timings.
+    Logger::setLevel(Logger::Level::Warn);
+
+    std::vector<BenchmarkResult> results;
+    std::cout << std::left << std::setw(50) << "Benchmark" << std::right
+              << std::setw(14) << "ns/op" << std::setw(12) << "allocs/op"
+              << std::setw(14) << "bytes/op" << std::setw(12) << "iterations"
+              << std::setw(14) << "RSS delta" << std::endl;
+    std::cout << std::string(116, '-') << std::endl;
+    int numFailures = 0;
+    for (const auto& benchmark : getRegistry()) {
+        bool selected = options.filters.empty();
+        for (const auto& filter : options.filters) {
+            if (benchmark.name.find(filter) != std::string::npos) {
+                selected = true;
+            }
+        }
+        if (!selected) continue;
+        if (listOnly) {
+            std::cout << benchmark.name << std::endl;
+            continue;
+        }
+
+        BenchmarkState state(options.minTime, options.maxIterations);
+        BenchmarkResult result;
+        result.name = benchmark.name;
+        try {
+            benchmark.function(state);
+        } catch (const std::exception& e) {
+            std::cout << std::left << std::setw(50) << benchmark.name
+                      << " FAILED: " << e.what() << std::endl;
+            ++numFailures;
+            continue;
+        }
+        result.label = state.getLabel();
+        if (state.isSkipped() || state.getNumIterations() <= 0) {
+            result.skipReason = state.isSkipped() ? state.getSkipReason()
+                                                  : "no iterations";
+            std::cout << std::left << std::setw(50) << benchmark.name
+                      << " skipped: " << result.skipReason << std::endl;
+            results.push_back(result);
+            continue;
+        }
+        const double numOps = (double)state.getNumIterations() *
+                              (double)state.getItemsPerIteration();
+        result.iterations = state.getNumIterations();
+        result.nsPerOp = state.getElapsedNs() / numOps;
+        result.allocationsPerOp = (double)state.getNumAllocations() / numOps;
+        result.bytesPerOp = (double)state.getNumBytesAllocated() / numOps;
+        result.rssDelta = state.getRSSDelta();
+        results.push_back(result);
+
+        std::cout << std::left << std::setw(50) << result.name << std::right
+                  << std::fixed << std::setprecision(1) << std::setw(14)
+                  << result.nsPerOp << std::setw(12)
+                  << result.allocationsPerOp << std::setw(14)
+                  << result.bytesPerOp << std::setw(12) << result.iterations
+                  << std::setw(14) << result.rssDelta;
+        if (!result.label.empty()) std::cout << "  " << result.label;
+        std::cout << std::endl;
+    }
+    if (listOnly) return 0;
+
+    try {
+        if (!options.jsonFile.empty()) {
+            writeJSON(options.jsonFile, argv[0], results);
+        }
+        if (!options.compareFile.empty()) {
+            const int numRegressions = compareToBaseline(
+                    options.compareFile, results, options.threshold);
+            if (numRegressions) {
+                std::cout << numRegressions << " benchmark(s) regressed."
+                          << std::endl;
+                return 1;
+            }
+        }
+    } catch (const std::exception& e) {
+        std::cout << e.what() << std::endl;
+        return 1;
+    }
+    return numFailures ? 1 : 0;
+}
@@ -0,0 +1,145 @@
+#ifndef OPENSIM_BENCHMARK_H_
+#define OPENSIM_BENCHMARK_H_
+/* -------------------------------------------------------------------------- *
+ *                         OpenSim:  Benchmark.h                              *
+ * -------------------------------------------------------------------------- *
+ * The OpenSim API is a toolkit for musculoskeletal modeling and simulation.  *
+ * See http://opensim.stanford.edu and the NOTICE file for more information.  *
+ * OpenSim is developed at Stanford University and supported by the US        *
+ * National Institutes of Health (U54 GM072970, R24 HD065690) and by DARPA    *
+ * through the Warrior Web program.                                           *
+ *                                                                            *
+ * Copyright (c) 2005-2021 Stanford University and the Authors                *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+// A minimal micro-benchmark harness in the style of Google Benchmark. Each
+// bench*.cpp file registers benchmarks with OPENSIM_BENCHMARK() and is linked
+// with Benchmark.cpp, which provides main(). Setup code placed before the
+// timing loop is not timed:
+//
+//     OPENSIM_BENCHMARK(realizeAcceleration) {
+//         Model model("model.osim");
+//         SimTK::State& state = model.initSystem();
+//         while (bench.keepRunning()) {
+//             state.updQ() = state.getQ(); // Invalidate the cache.
+//             model.realizeAcceleration(state);
+//         }
+//     }
+//
+// For each benchmark, we report the wall time per iteration (ns/op), the
+// number of heap allocations and bytes allocated per iteration (counted by
+// replacing the global operator new in Benchmark.cpp), and the change in
+// resident set size (see OpenSim/Auxiliary/getRSS.h) over the timed region.
+// Results can be written to JSON and compared against a previous run; run any
+// bench* executable with --help for the available options.
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace OpenSim {
+
+/// The state of a single benchmark run, passed to the benchmark function as
+/// `bench`. The function performs its setup, then loops on keepRunning().
+class BenchmarkState {
+public:
+    explicit BenchmarkState(double minTime, int64_t maxIterations);
+
+    /// Returns true while more iterations should be run. The first call
+    /// starts the timer, so setup performed before the loop is not included.
+    /// The loop runs until the accumulated timed duration exceeds the minimum
+    /// time or the maximum number of iterations is reached.
+    bool keepRunning();
+
+    /// Exclude work inside the loop from timing and allocation counting
+    /// (e.g., resetting inputs between iterations).
+    void pauseTiming();
+    void resumeTiming();
+
+    /// Divide the reported per-iteration costs by this number. Use this when
+    /// each iteration evaluates several items (e.g., all muscles in a model)
+    /// and you want the cost per item.
+    void setItemsPerIteration(int64_t items) { m_itemsPerIteration = items; }
+
+    /// A short description appended to the benchmark name in the report.
+    void setLabel(const std::string& label) { m_label = label; }
+
+    /// Mark the benchmark as skipped (e.g., a data file or optional
+    /// dependency is unavailable). Call this before keepRunning().
+    void skip(const std::string& reason) { m_skipReason = reason; }
+
+    int64_t getNumIterations() const { return m_numIterations; }
+    int64_t getItemsPerIteration() const { return m_itemsPerIteration; }
+    double getElapsedNs() const { return m_elapsedNs; }
+    int64_t getNumAllocations() const { return m_numAllocations; }
+    int64_t getNumBytesAllocated() const { return m_numBytesAllocated; }
+    int64_t getRSSDelta() const { return m_rssDelta; }
+    const std::string& getLabel() const { return m_label; }
+    const std::string& getSkipReason() const { return m_skipReason; }
+    bool isSkipped() const { return !m_skipReason.empty(); }
+
+private:
+    void startTimer();
+    void stopTimer();
+
+    using Clock = std::chrono::steady_clock;
+
+    double m_minTime;
+    int64_t m_maxIterations;
+    bool m_started = false;
+    bool m_running = false;
+    int64_t m_numIterations = -1;
+    int64_t m_itemsPerIteration = 1;
+    Clock::time_point m_start;
+    double m_elapsedNs = 0;
+    int64_t m_allocationsAtStart = 0;
+    int64_t m_bytesAtStart = 0;
+    int64_t m_numAllocations = 0;
+    int64_t m_numBytesAllocated = 0;
+    size_t m_rssAtStart = 0;
+    int64_t m_rssDelta = 0;
+    std::string m_label;
+    std::string m_skipReason;
+};
+
+using BenchmarkFunction = std::function<void(BenchmarkState&)>;
+
+/// Add a benchmark to the global registry. Prefer the OPENSIM_BENCHMARK()
+/// macro, which calls this during static initialization.
+struct BenchmarkRegistration {
+    BenchmarkRegistration(const std::string& name, BenchmarkFunction function);
+};
+
+/// Prevent the compiler from optimizing away a computed value.
+inline void doNotOptimize(double value) {
+    static volatile double sink;
+    sink = value;
+    (void)sink;
+}
+template <typename T>
+inline void doNotOptimize(const T& value) {
+    static const void* volatile sink;
+    sink = &value;
+}
+
+} // namespace OpenSim
+
+#define OPENSIM_BENCHMARK(name)                                               \
+    static void OpenSimBenchmark_##name(OpenSim::BenchmarkState& bench);      \
+    static OpenSim::BenchmarkRegistration OpenSimBenchmarkRegistration_##name(\
+            #name, OpenSimBenchmark_##name);                                  \
+    static void OpenSimBenchmark_##name(OpenSim::BenchmarkState& bench)
+
+#endif // OPENSIM_BENCHMARK_H_
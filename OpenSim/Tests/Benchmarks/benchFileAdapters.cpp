@@ -0,0 +1,83 @@
+/* -------------------------------------------------------------------------- *
+ *                      OpenSim:  benchFileAdapters.cpp                       *
+ * -------------------------------------------------------------------------- *
+ * The OpenSim API is a toolkit for musculoskeletal modeling and simulation.  *
+ * See http://opensim.stanford.edu and the NOTICE file for more information.  *
+ * OpenSim is developed at Stanford University and supported by the US        *
+ * National Institutes of Health (U54 GM072970, R24 HD065690) and by DARPA    *
+ * through the Warrior Web program.                                           *
+ *                                                                            *
+ * Copyright (c) 2005-2021 Stanford University and the Authors                *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+// Benchmarks for reading the data files that the Tools and Moco load.
+
+#include "Benchmark.h"
+
+#include <OpenSim/Common/STOFileAdapter.h>
+#include <OpenSim/Common/Storage.h>
+#include <OpenSim/Common/TRCFileAdapter.h>
+#include <OpenSim/Common/TimeSeriesTable.h>
+
+#if defined(WITH_EZC3D) || defined(WITH_BTK)
+#include <OpenSim/Common/C3DFileAdapter.h>
+#endif
+
+using namespace OpenSim;
+
+namespace {
+const std::string statesFile = "std_subject01_walk1_states.sto";
+const std::string coordinatesFile = "coordinates.sto";
+const std::string markersFile = "marker_trajectories.trc";
+const std::string c3dFile = "walking5.c3d";
+} // anonymous namespace
+
+OPENSIM_BENCHMARK(STOFileAdapter_read_states) {
+    while (bench.keepRunning()) {
+        TimeSeriesTable table(statesFile);
+        doNotOptimize(table.getNumRows());
+    }
+}
+
+OPENSIM_BENCHMARK(STOFileAdapter_read_coordinates) {
+    while (bench.keepRunning()) {
+        TimeSeriesTable table(coordinatesFile);
+        doNotOptimize(table.getNumRows());
+    }
+}
+
+OPENSIM_BENCHMARK(Storage_read_states) {
+    while (bench.keepRunning()) {
+        Storage storage(statesFile);
+        doNotOptimize(storage.getSize());
+    }
+}
+
+OPENSIM_BENCHMARK(TRCFileAdapter_read) {
+    while (bench.keepRunning()) {
+        TimeSeriesTableVec3 table(markersFile);
+        doNotOptimize(table.getNumRows());
+    }
+}
+
+OPENSIM_BENCHMARK(C3DFileAdapter_read) {
+#if defined(WITH_EZC3D) || defined(WITH_BTK)
+    C3DFileAdapter c3dFileAdapter;
+    while (bench.keepRunning()) {
+        auto tables = c3dFileAdapter.read(c3dFile);
+        doNotOptimize(tables.size());
+    }
+#else
+    bench.skip("OpenSim was built without C3D support");
+#endif
+}
@@ -0,0 +1,172 @@
+/* -------------------------------------------------------------------------- *
+ *                          OpenSim:  benchMoco.cpp                           *
+ * -------------------------------------------------------------------------- *
+ * The OpenSim API is a toolkit for musculoskeletal modeling and simulation.  *
+ * See http://opensim.stanford.edu and the NOTICE file for more information.  *
+ * OpenSim is developed at Stanford University and supported by the US        *
+ * National Institutes of Health (U54 GM072970, R24 HD065690) and by DARPA    *
+ * through the Warrior Web program.                                           *
+ *                                                                            *
+ * Copyright (c) 2005-2021 Stanford University and the Authors                *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+// Benchmarks for the functions that MocoCasADiSolver evaluates at every grid
+// point (and for every finite difference perturbation) of a direct
+// collocation problem.
+
+#include "Benchmark.h"
+
+#include <OpenSim/Moco/MocoCasADiSolver/MocoCasOCProblem.h>
+#include <OpenSim/Moco/osimMoco.h>
+
+using namespace OpenSim;
+
+namespace {
+
+// Expose the CasOC problem, which MocoCasADiSolver otherwise only creates
+// inside solve().
+class BenchmarkCasADiSolver : public MocoCasADiSolver {
+    OpenSim_DECLARE_CONCRETE_OBJECT(BenchmarkCasADiSolver, MocoCasADiSolver);
+public:
+    using MocoCasADiSolver::createCasOCProblem;
+};
+
+// An 80-muscle Rajagopal-class model, as used in MocoInverse and MocoTrack.
+MocoProblem createWalkArmlessProblem() {
+    ModelProcessor modelProcessor =
+            ModelProcessor("subject_walk_armless.osim") |
+            ModOpReplaceMusclesWithDeGrooteFregly2016() |
+            ModOpIgnorePassiveFiberForcesDGF() |
+            ModOpTendonComplianceDynamicsModeDGF("implicit") |
+            ModOpAddReserves(250);
+    MocoProblem problem;
+    problem.setModelProcessor(modelProcessor);
+    problem.setTimeBounds(0, 1);
+    problem.addGoal<MocoControlGoal>();
+    return problem;
+}
+
+// Evaluate the multibody system at `numPoints` copies of a point at the
+// midpoint of the variable bounds. If `batch` is false, we invoke the
+// single-point function once per point (as casadi::Function::map() does);
+// otherwise, we evaluate all points with one call to the batch function.
+void benchMultibodySystem(BenchmarkState& bench, const std::string& mode,
+        int numPoints = 1, bool batch = false) {
+    MocoProblem problem = createWalkArmlessProblem();
+    BenchmarkCasADiSolver solver;
+    solver.set_multibody_dynamics_mode(mode);
+    solver.set_parallel(0);
+    solver.resetProblem(problem);
+    const auto casProblem = solver.createCasOCProblem();
+
+    const CasOC::Iterate guess =
+            convertToCasOCIterate(solver.createGuess("bounds"));
+    using casadi::DM;
+    using casadi::Slice;
+    using CasOC::Var;
+    const DM times = DM::repmat(DM(0.5), 1, numPoints);
+    const DM states = DM::repmat(
+            guess.variables.at(Var::states)(Slice(), 0), 1, numPoints);
+    const DM controls = DM::repmat(
+            guess.variables.at(Var::controls)(Slice(), 0), 1, numPoints);
+    const DM multipliers =
+            DM::zeros(casProblem->getNumMultipliers(), numPoints);
+    const DM derivatives =
+            DM::zeros(casProblem->getNumDerivatives(), numPoints);
+    const DM parameters = DM::zeros(casProblem->getNumParameters(), numPoints);
+
+    const bool implicit = mode == "implicit";
+    DM multibodyOutput = DM::zeros(implicit
+                    ? casProblem->getNumMultibodyDynamicsEquations()
+                    : casProblem->getNumSpeeds(), numPoints);
+    DM auxiliaryDerivatives =
+            DM::zeros(casProblem->getNumAuxiliaryStates(), numPoints);
+    DM auxiliaryResiduals = DM::zeros(
+            casProblem->getNumAuxiliaryResidualEquations(), numPoints);
+    DM kinematicConstraintErrors = DM::zeros(
+            casProblem->getNumKinematicConstraintEquations(), numPoints);
+    CasOC::Problem::MultibodySystemImplicitOutput implicitOutput{
+            multibodyOutput, auxiliaryDerivatives, auxiliaryResiduals,
+            kinematicConstraintErrors};
+    CasOC::Problem::MultibodySystemExplicitOutput explicitOutput{
+            multibodyOutput, auxiliaryDerivatives, auxiliaryResiduals,
+            kinematicConstraintErrors};
+
+    // Single-point inputs and outputs, for evaluating the points one at a
+    // time.
+    double time = 0.5;
+    const DM pointStates = states(Slice(), 0);
+    const DM pointControls = controls(Slice(), 0);
+    const DM pointMultipliers = multipliers(Slice(), 0);
+    const DM pointDerivatives = derivatives(Slice(), 0);
+    const DM pointParameters = parameters(Slice(), 0);
+    const CasOC::Problem::ContinuousInput pointInput{time, pointStates,
+            pointControls, pointMultipliers, pointDerivatives,
+            pointParameters};
+    DM pointMultibodyOutput = multibodyOutput(Slice(), 0);
+    DM pointAuxiliaryDerivatives = auxiliaryDerivatives(Slice(), 0);
+    DM pointAuxiliaryResiduals = auxiliaryResiduals(Slice(), 0);
+    DM pointKinematicConstraintErrors = kinematicConstraintErrors(Slice(), 0);
+    CasOC::Problem::MultibodySystemImplicitOutput pointImplicitOutput{
+            pointMultibodyOutput, pointAuxiliaryDerivatives,
+            pointAuxiliaryResiduals, pointKinematicConstraintErrors};
+    CasOC::Problem::MultibodySystemExplicitOutput pointExplicitOutput{
+            pointMultibodyOutput, pointAuxiliaryDerivatives,
+            pointAuxiliaryResiduals, pointKinematicConstraintErrors};
+
+    const CasOC::Problem::ContinuousBatchInput batchInput{
+            times, states, controls, multipliers, derivatives, parameters};
+    const CasOC::Problem& base = *casProblem;
+    bench.setItemsPerIteration(numPoints);
+    while (bench.keepRunning()) {
+        if (batch) {
+            if (implicit) {
+                base.calcMultibodySystemImplicitBatch(
+                        batchInput, true, implicitOutput);
+            } else {
+                base.calcMultibodySystemExplicitBatch(
+                        batchInput, true, explicitOutput);
+            }
+            doNotOptimize(multibodyOutput.ptr()[0]);
+        } else {
+            for (int ipoint = 0; ipoint < numPoints; ++ipoint) {
+                if (implicit) {
+                    base.calcMultibodySystemImplicit(
+                            pointInput, true, pointImplicitOutput);
+                } else {
+                    base.calcMultibodySystemExplicit(
+                            pointInput, true, pointExplicitOutput);
+                }
+                doNotOptimize(pointMultibodyOutput.ptr()[0]);
+            }
+        }
+    }
+}
+
+} // anonymous namespace
+
+OPENSIM_BENCHMARK(MocoCasOCProblem_calcMultibodySystemImplicit_walkArmless) {
+    benchMultibodySystem(bench, "implicit");
+}
+
+OPENSIM_BENCHMARK(MocoCasOCProblem_calcMultibodySystemExplicit_walkArmless) {
+    benchMultibodySystem(bench, "explicit");
+}
+
+OPENSIM_BENCHMARK(MocoCasOCProblem_multibodyImplicit_pointwise50_walkArmless) {
+    benchMultibodySystem(bench, "implicit", 50, false);
+}
+
+OPENSIM_BENCHMARK(MocoCasOCProblem_multibodyImplicit_batch50_walkArmless) {
+    benchMultibodySystem(bench, "implicit", 50, true);
+}
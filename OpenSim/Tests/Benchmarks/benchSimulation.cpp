@@ -0,0 +1,211 @@
+/* -------------------------------------------------------------------------- *
+ *                       OpenSim:  benchSimulation.cpp                        *
+ * -------------------------------------------------------------------------- *
+ * The OpenSim API is a toolkit for musculoskeletal modeling and simulation.  *
+ * See http://opensim.stanford.edu and the NOTICE file for more information.  *
+ * OpenSim is developed at Stanford University and supported by the US        *
+ * National Institutes of Health (U54 GM072970, R24 HD065690) and by DARPA    *
+ * through the Warrior Web program.                                           *
+ *                                                                            *
+ * Copyright (c) 2005-2021 Stanford University and the Authors                *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+// Benchmarks for the functions that forward simulations and optimal control
+// problems evaluate at every integrator step or collocation point.
+
+#include "Benchmark.h"
+
+#include <OpenSim/Actuators/Millard2012EquilibriumMuscle.h>
+#include <OpenSim/Actuators/Millard2012FiberEquilibriumSolver.h>
+#include <OpenSim/Simulation/Model/Model.h>
+#include <OpenSim/Simulation/Model/Muscle.h>
+
+using namespace OpenSim;
+
+namespace {
+
+// A gait2354-class model: 23 DOF, 54 muscles (Thelen2003Muscle).
+const std::string gait2354 = "gait2354_simbody.osim";
+// A Rajagopal-class full-body model: 80 muscles (Millard2012EquilibriumMuscle)
+// with wrapping surfaces.
+const std::string walkArmless = "subject_walk_armless.osim";
+
+// Perturb the generalized coordinates slightly so that every cache entry at or
+// above Stage::Position must be recomputed, and so that successive iterations
+// do not evaluate the exact same pose.
+void perturbPose(SimTK::State& state, const SimTK::Vector& q0, int iteration) {
+    const double delta = 1e-4 * ((iteration % 10) - 5);
+    for (int i = 0; i < q0.size(); ++i) { state.updQ()[i] = q0[i] + delta; }
+}
+
+void benchRealizeAcceleration(BenchmarkState& bench, const std::string& file) {
+    Model model(file);
+    SimTK::State& state = model.initSystem();
+    model.equilibrateMuscles(state);
+    const SimTK::Vector q0 = state.getQ();
+    int iteration = 0;
+    while (bench.keepRunning()) {
+        perturbPose(state, q0, iteration++);
+        model.realizeAcceleration(state);
+        doNotOptimize(state.getUDot()[0]);
+    }
+}
+
+void benchPathLength(BenchmarkState& bench, const std::string& file) {
+    Model model(file);
+    SimTK::State& state = model.initSystem();
+    const SimTK::Vector q0 = state.getQ();
+    const auto& muscles = model.getMuscles();
+    bench.setItemsPerIteration(muscles.getSize());
+    bench.setLabel("per path");
+    int iteration = 0;
+    while (bench.keepRunning()) {
+        perturbPose(state, q0, iteration++);
+        model.realizePosition(state);
+        // GeometryPath::getLength() invokes computePath() (including
+        // wrapping) because the perturbation invalidated the path cache.
+        double total = 0;
+        for (int i = 0; i < muscles.getSize(); ++i) {
+            total += muscles[i].getGeometryPath().getLength(state);
+        }
+        doNotOptimize(total);
+    }
+}
+
+void benchPathLengtheningSpeed(BenchmarkState& bench, const std::string& file) {
+    Model model(file);
+    SimTK::State& state = model.initSystem();
+    const SimTK::Vector q0 = state.getQ();
+    state.updU() = 0.1;
+    const auto& muscles = model.getMuscles();
+    bench.setItemsPerIteration(muscles.getSize());
+    bench.setLabel("per path");
+    int iteration = 0;
+    while (bench.keepRunning()) {
+        perturbPose(state, q0, iteration++);
+        model.realizeVelocity(state);
+        double total = 0;
+        for (int i = 0; i < muscles.getSize(); ++i) {
+            total += muscles[i].getGeometryPath().getLengtheningSpeed(state);
+        }
+        doNotOptimize(total);
+    }
+}
+
+void benchPathEquivalentForces(BenchmarkState& bench, const std::string& file) {
+    Model model(file);
+    SimTK::State& state = model.initSystem();
+    const SimTK::Vector q0 = state.getQ();
+    const auto& muscles = model.getMuscles();
+    const auto& matter = model.getMatterSubsystem();
+    SimTK::Vector_<SimTK::SpatialVec> bodyForces(matter.getNumBodies());
+    SimTK::Vector mobilityForces(state.getNU());
+    bench.setItemsPerIteration(muscles.getSize());
+    bench.setLabel("per path");
+    int iteration = 0;
+    while (bench.keepRunning()) {
+        perturbPose(state, q0, iteration++);
+        model.realizePosition(state);
+        bodyForces.setToZero();
+        mobilityForces.setToZero();
+        for (int i = 0; i < muscles.getSize(); ++i) {
+            muscles[i].getGeometryPath().addInEquivalentForces(
+                    state, 1.0, bodyForces, mobilityForces);
+        }
+        doNotOptimize(mobilityForces[0]);
+    }
+}
+
+} // anonymous namespace
+
+OPENSIM_BENCHMARK(Model_realizeAcceleration_gait2354) {
+    benchRealizeAcceleration(bench, gait2354);
+}
+
+OPENSIM_BENCHMARK(Model_realizeAcceleration_walkArmless80musc) {
+    benchRealizeAcceleration(bench, walkArmless);
+}
+
+OPENSIM_BENCHMARK(GeometryPath_getLength_gait2354) {
+    benchPathLength(bench, gait2354);
+}
+
+OPENSIM_BENCHMARK(GeometryPath_getLength_walkArmless80musc) {
+    benchPathLength(bench, walkArmless);
+}
+
+OPENSIM_BENCHMARK(GeometryPath_getLengtheningSpeed_walkArmless80musc) {
+    benchPathLengtheningSpeed(bench, walkArmless);
+}
+
+OPENSIM_BENCHMARK(GeometryPath_addInEquivalentForces_walkArmless80musc) {
+    benchPathEquivalentForces(bench, walkArmless);
+}
+
+OPENSIM_BENCHMARK(Millard2012EquilibriumMuscle_computeFiberEquilibrium) {
+    Model model(walkArmless);
+    SimTK::State& state = model.initSystem();
+    std::vector<const Millard2012EquilibriumMuscle*> muscles;
+    for (const auto& muscle :
+            model.getComponentList<Millard2012EquilibriumMuscle>()) {
+        if (!muscle.get_ignore_tendon_compliance()) {
+            muscles.push_back(&muscle);
+        }
+    }
+    if (muscles.empty()) {
+        bench.skip("no muscles with compliant tendons");
+        return;
+    }
+    bench.setItemsPerIteration((int64_t)muscles.size());
+    bench.setLabel("per muscle");
+    const SimTK::Vector q0 = state.getQ();
+    int iteration = 0;
+    while (bench.keepRunning()) {
+        perturbPose(state, q0, iteration++);
+        for (const auto* muscle : muscles) {
+            muscle->computeFiberEquilibrium(state, true);
+        }
+        doNotOptimize(state.getZ()[0]);
+    }
+}
+
+OPENSIM_BENCHMARK(Model_equilibrateMuscles_walkArmless80musc) {
+    Model model(walkArmless);
+    SimTK::State& state = model.initSystem();
+    const SimTK::Vector q0 = state.getQ();
+    int iteration = 0;
+    while (bench.keepRunning()) {
+        perturbPose(state, q0, iteration++);
+        model.equilibrateMuscles(state);
+        doNotOptimize(state.getZ()[0]);
+    }
+}
+
+OPENSIM_BENCHMARK(Millard2012FiberEquilibriumSolver_walkArmless80musc) {
+    Model model(walkArmless);
+    SimTK::State& state = model.initSystem();
+    Millard2012FiberEquilibriumSolver solver(model);
+    if (solver.getNumMuscles() == 0) {
+        bench.skip("no muscles with compliant tendons");
+        return;
+    }
+    bench.setItemsPerIteration((int64_t)solver.getNumMuscles());
+    bench.setLabel("per muscle");
+    const SimTK::Vector q0 = state.getQ();
+    int iteration = 0;
+    while (bench.keepRunning()) {
+        perturbPose(state, q0, iteration++);
+        solver.solve(state);
+        doNotOptimize(state.getZ()[0]);
+    }
+}
@@ -0,0 +1,85 @@
+/* -------------------------------------------------------------------------- *
+ *                          OpenSim:  benchTools.cpp                          *
+ * -------------------------------------------------------------------------- *
+ * The OpenSim API is a toolkit for musculoskeletal modeling and simulation.  *
+ * See http://opensim.stanford.edu and the NOTICE file for more information.  *
+ * OpenSim is developed at Stanford University and supported by the US        *
+ * National Institutes of Health (U54 GM072970, R24 HD065690) and by DARPA    *
+ * through the Warrior Web program.                                           *
+ *                                                                            *
+ * Copyright (c) 2005-2021 Stanford University and the Authors                *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+// Benchmarks for the per-frame work done by InverseKinematicsTool and
+// InverseDynamicsTool.
+
+#include "Benchmark.h"
+
+#include <OpenSim/Common/TRCFileAdapter.h>
+#include <OpenSim/Simulation/InverseDynamicsSolver.h>
+#include <OpenSim/Simulation/InverseKinematicsSolver.h>
+#include <OpenSim/Simulation/MarkersReference.h>
+#include <OpenSim/Simulation/Model/Model.h>
+
+using namespace OpenSim;
+
+namespace {
+const std::string walkArmless = "subject_walk_armless.osim";
+const std::string walkArmlessMarkers = "marker_trajectories.trc";
+} // anonymous namespace
+
+OPENSIM_BENCHMARK(InverseKinematicsSolver_track_walkArmless) {
+    Model model(walkArmless);
+    SimTK::State& state = model.initSystem();
+
+    const TimeSeriesTableVec3 markerData(walkArmlessMarkers);
+    const auto& times = markerData.getIndependentColumn();
+    auto markersReference = std::make_shared<MarkersReference>(
+            markerData, Set<MarkerWeight>());
+    SimTK::Array_<CoordinateReference> coordinateReferences;
+    InverseKinematicsSolver ikSolver(
+            model, markersReference, coordinateReferences);
+    ikSolver.setAccuracy(1e-5);
+    state.updTime() = times.front();
+    ikSolver.assemble(state);
+
+    bench.setLabel(std::to_string(ikSolver.getNumMarkersInUse()) + " markers");
+    size_t frame = 1;
+    while (bench.keepRunning()) {
+        // Track successive frames, as InverseKinematicsTool does. When we
+        // reach the end of the trial, restart from the first frame (this
+        // first track() takes longer, but is rare).
+        state.updTime() = times[frame];
+        ikSolver.track(state);
+        doNotOptimize(state.getQ()[0]);
+        frame = (frame + 1) % times.size();
+    }
+}
+
+OPENSIM_BENCHMARK(InverseDynamicsSolver_solve_walkArmless) {
+    Model model(walkArmless);
+    SimTK::State& state = model.initSystem();
+    InverseDynamicsSolver idSolver(model);
+    const SimTK::Vector q0 = state.getQ();
+    SimTK::Vector udot(state.getNU(), 0.5);
+    state.updU() = 0.1;
+    int iteration = 0;
+    while (bench.keepRunning()) {
+        const double delta = 1e-4 * ((iteration++ % 10) - 5);
+        for (int i = 0; i < q0.size(); ++i) {
+            state.updQ()[i] = q0[i] + delta;
+        }
+        const SimTK::Vector tau = idSolver.solve(state, udot);
+        doNotOptimize(tau[0]);
+    }
+}
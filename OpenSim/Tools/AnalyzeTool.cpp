@@ -34,10 +34,148 @@
 #include <OpenSim/Analyses/ProbeReporter.h>
 #include <OpenSim/Simulation/Model/PrescribedForce.h>
 #include <OpenSim/Actuators/Thelen2003Muscle.h>
+#include <OpenSim/Actuators/Millard2012FiberEquilibriumSolver.h>
+
+#include <exception>
+#include <memory>
+#include <thread>
 
 using namespace OpenSim;
 using namespace std;
 
+namespace {
+// Same as Model::equilibrateMuscles(), except that the
+// Millard2012EquilibriumMuscles are solved together by the given solver,
+// which warm-starts them from the solution of the previous frame.
+void equilibrateMuscles(Model& model,
+        Millard2012FiberEquilibriumSolver& millardSolver, SimTK::State& s) {
+    model.getMultibodySystem().realize(s, SimTK::Stage::Velocity);
+
+    string errorMsg;
+    for (const auto& muscle : model.getComponentList<Muscle>()) {
+        if (!muscle.appliesForce(s) || millardSolver.hasMuscle(muscle)) {
+            continue;
+        }
+        try {
+            muscle.computeEquilibrium(s);
+        } catch (const std::exception& e) {
+            if (errorMsg.empty()) errorMsg = e.what();
+        }
+    }
+    try {
+        millardSolver.solve(s);
+    } catch (const std::exception& e) {
+        if (errorMsg.empty()) errorMsg = e.what();
+    }
+
+    if (!errorMsg.empty()) {
+        throw Exception("Model::equilibrateMuscles() " + errorMsg, __FILE__,
+                __LINE__);
+    }
+}
+
+// Set the state to each frame from iFrom to iTo of the states storage and
+// step the analyses of the model, which analyze the frames from iFirst to
+// iLast: begin() at iFirst, end() at iLast, and step() at the frames in
+// between.
+void analyzeFrames(SimTK::State& s, Model& model, int iFirst, int iLast,
+        int iFrom, int iTo, const Storage& statesStore,
+        bool solveForEquilibrium)
+{
+    AnalysisSet& analysisSet = model.updAnalysisSet();
+
+    // PERFORM THE ANALYSES
+    double /*tPrev=0.0,*/t=0.0/*,dt=0.0*/;
+    int ny = s.getNY();
+    Array<double> dydt(0.0,ny);
+    Array<double> yFromStorage(0.0,ny);
+
+    const Array<string>& labels =  statesStore.getColumnLabels();
+    int numOpenSimStates = labels.getSize()-1;
+
+    SimTK::Vector stateData;
+    stateData.resize(numOpenSimStates);
+
+    // There is no guarantee that the order in which a model had written out
+    // its states will be the same order in which the states will be created,
+    // allocated and listed in any future recreation of the model and its
+    // system. Therefore, it is imperative that we ensure that the state
+    // values being read in are reordered according to the model's order.
+    // The model's order is given by its getStateVariableNames() so we can 
+    // compare to the column labels of the storage and construct a dataToModel
+    // mapping.
+    const Array<std::string>& stateNames = statesStore.getColumnLabels();
+    Array<std::string> modelStateNames = model.getStateVariableNames();
+
+    int nsData = stateNames.size() - 1;  //-1 since time is a column
+    Array<int> dataToModel(-1, nsData);
+    for (int k = 0; k < nsData; ++k) {
+        for (int j = 0; j < modelStateNames.size(); ++j) {
+            if (stateNames[k+1] == modelStateNames[j]) { //+1 skip "time"
+                dataToModel[k] = j;
+            }
+        }
+    }
+
+    // It is possible that there are internal states or that future modeling
+    // choices add state variables that are not known to the modeler/user.
+    // In which case we rely on the model to supply reasonable defaults and
+    // assume all the important/necessary state values for running an analysis
+    // are provided by the Storage. Here we initialize the state values to their
+    // model defaults.
+    SimTK::Vector stateValues = model.getStateVariableValues(s);
+
+    std::unique_ptr<Millard2012FiberEquilibriumSolver> millardSolver;
+    if (solveForEquilibrium) {
+        millardSolver.reset(new Millard2012FiberEquilibriumSolver(model));
+    }
+
+    for(int i=iFrom;i<=iTo;i++) {
+        // tPrev = t;
+        statesStore.getTime(i,s.updTime()); // time
+        t = s.getTime();
+        model.setAllControllersEnabled(true);
+
+        statesStore.getData(i,numOpenSimStates,&stateData[0]); // states
+        // Get data into local Vector and assign to State using common utility
+        // to handle internal (non-OpenSim) states that may exist
+
+        for (int k=0; k < nsData; ++k) {
+            stateValues[dataToModel[k]] = stateData[k];
+        }
+        model.setStateVariableValues(s, stateValues);
+       
+        // Adjust configuration to match constraints and other goals
+        model.assemble(s);
+
+        // equilibrateMuscles before realization as it may affect forces
+        if(solveForEquilibrium){
+            try{// might not be able to equilibrate if model is in
+                // a non-physical pose. For example, a pose where the 
+                // muscle length is shorter than the tendon slack-length.
+                // the muscle will throw an Exception in this case.
+                equilibrateMuscles(model, *millardSolver, s);
+            }
+            catch (const std::exception& e) {
+                log_warn("AnalyzeTool::run() unable to equilibrate muscles at "
+                    "time = {}. Reason: {}.", t, e.what());
+            }
+        }
+        // Make sure model is at least ready to provide kinematics
+        model.getMultibodySystem().realize(s, SimTK::Stage::Velocity);
+
+        if(i==iFirst) {
+            analysisSet.begin(s);
+        } else if(i==iLast) {
+            analysisSet.end(s);
+        // Step
+        } else {
+            analysisSet.step(s,i);
+        }
+    }
+}
+} // anonymous namespace
+
 
 //=============================================================================
 // CONSTRUCTOR(S) AND DESTRUCTOR
@@ -59,6 +197,7 @@ AnalyzeTool::AnalyzeTool() :
     _coordinatesFileName(_coordinatesFileNameProp.getValueStr()),
     _speedsFileName(_speedsFileNameProp.getValueStr()),
     _lowpassCutoffFrequency(_lowpassCutoffFrequencyProp.getValueDbl()),
+    _numThreads(_numThreadsProp.getValueInt()),
     _printResultFiles(true),
     _loadModelAndInput(false)
 {
@@ -79,6 +218,7 @@ AnalyzeTool::AnalyzeTool(const string &aFileName, bool aLoadModelAndInput) :
     _coordinatesFileName(_coordinatesFileNameProp.getValueStr()),
     _speedsFileName(_speedsFileNameProp.getValueStr()),
     _lowpassCutoffFrequency(_lowpassCutoffFrequencyProp.getValueDbl()),
+    _numThreads(_numThreadsProp.getValueInt()),
     _printResultFiles(true),
     _loadModelAndInput(aLoadModelAndInput)
 {
@@ -111,6 +251,7 @@ AnalyzeTool::AnalyzeTool(Model& aModel) :
     _coordinatesFileName(_coordinatesFileNameProp.getValueStr()),
     _speedsFileName(_speedsFileNameProp.getValueStr()),
     _lowpassCutoffFrequency(_lowpassCutoffFrequencyProp.getValueDbl()),
+    _numThreads(_numThreadsProp.getValueInt()),
     _printResultFiles(true),
     _loadModelAndInput(false)
 {
@@ -171,6 +312,7 @@ AnalyzeTool(const AnalyzeTool &aTool) :
     _coordinatesFileName(_coordinatesFileNameProp.getValueStr()),
     _speedsFileName(_speedsFileNameProp.getValueStr()),
     _lowpassCutoffFrequency(_lowpassCutoffFrequencyProp.getValueDbl()),
+    _numThreads(_numThreadsProp.getValueInt()),
     _loadModelAndInput(false)
 {
     setNull();
@@ -191,6 +333,7 @@ setNull()
     _coordinatesFileName = "";
     _speedsFileName = "";
     _lowpassCutoffFrequency = -1.0;
+    _numThreads = 1;
 
     _statesStore = NULL;
 
@@ -236,6 +379,15 @@ void AnalyzeTool::setupProperties()
     _lowpassCutoffFrequencyProp.setName("lowpass_cutoff_frequency_for_coordinates");
     _propertySet.append( &_lowpassCutoffFrequencyProp );
 
+    comment = "The number of threads used to analyze the frames (default: 1). With more than 1 thread, "
+                 "if all analyses are frame independent (e.g., StaticOptimization, MuscleAnalysis, BodyKinematics, "
+                 "PointKinematics, and JointReaction) and have a step_interval of 1, the frames are split into "
+                 "consecutive chunks that are analyzed in parallel, each with its own copy of the model. "
+                 "Otherwise, the frames are analyzed on 1 thread.";
+    _numThreadsProp.setComment(comment);
+    _numThreadsProp.setName("num_threads");
+    _propertySet.append( &_numThreadsProp );
+
 }
 
 
@@ -259,6 +411,7 @@ operator=(const AnalyzeTool &aTool)
     _coordinatesFileName = aTool._coordinatesFileName;
     _speedsFileName = aTool._speedsFileName;
     _lowpassCutoffFrequency= aTool._lowpassCutoffFrequency;
+    _numThreads = aTool._numThreads;
     _statesStore = aTool._statesStore;
     _printResultFiles = aTool._printResultFiles;
     return(*this);
@@ -590,7 +743,7 @@ bool AnalyzeTool::run(bool plotting)
     //}
 
     log_info("Executing the analyses from {} to {}...", ti, tf);
-    run(s, *_model, iInitial, iFinal, *_statesStore, _solveForEquilibriumForAuxiliaryStates);
+    run(s, *_model, iInitial, iFinal, *_statesStore, _solveForEquilibriumForAuxiliaryStates, _numThreads);
     _model->getMultibodySystem().realize(s, SimTK::Stage::Position );
     } catch (const Exception& x) {
         x.print(cout);
@@ -613,7 +766,7 @@ bool AnalyzeTool::run(bool plotting)
 //=============================================================================
 // HELPER
 //=============================================================================
-void AnalyzeTool::run(SimTK::State& s, Model &aModel, int iInitial, int iFinal, const Storage &aStatesStore, bool aSolveForEquilibrium)
+void AnalyzeTool::run(SimTK::State& s, Model &aModel, int iInitial, int iFinal, const Storage &aStatesStore, bool aSolveForEquilibrium, int aNumThreads)
 {
     AnalysisSet& analysisSet = aModel.updAnalysisSet();
 
@@ -621,89 +774,116 @@ void AnalyzeTool::run(SimTK::State& s, Model &aModel, int iInitial, int iFinal,
         analysisSet.get(i).setStatesStore(aStatesStore);
     }
 
-
-    // PERFORM THE ANALYSES
-    double /*tPrev=0.0,*/t=0.0/*,dt=0.0*/;
-    int ny = s.getNY();
-    Array<double> dydt(0.0,ny);
-    Array<double> yFromStorage(0.0,ny);
-
-    const Array<string>& labels =  aStatesStore.getColumnLabels();
-    int numOpenSimStates = labels.getSize()-1;
-
-    SimTK::Vector stateData;
-    stateData.resize(numOpenSimStates);
-
-    // There is no guarantee that the order in which a model had written out
-    // its states will be the same order in which the states will be created,
-    // allocated and listed in any future recreation of the model and its
-    // system. Therefore, it is imperative that we ensure that the state
-    // values being read in are reordered according to the model's order.
-    // The model's order is given by its getStateVariableNames() so we can 
-    // compare to the column labels of the storage and construct a dataToModel
-    // mapping.
-    const Array<std::string>& stateNames = aStatesStore.getColumnLabels();
-    Array<std::string> modelStateNames = aModel.getStateVariableNames();
-
-    int nsData = stateNames.size() - 1;  //-1 since time is a column
-    Array<int> dataToModel(-1, nsData);
-    for (int k = 0; k < nsData; ++k) {
-        for (int j = 0; j < modelStateNames.size(); ++j) {
-            if (stateNames[k+1] == modelStateNames[j]) { //+1 skip "time"
-                dataToModel[k] = j;
-            }
+    OPENSIM_THROW_IF(aNumThreads < 1, Exception,
+            "Expected the number of threads to be at least 1, but got {}.",
+            aNumThreads);
+    const int numFrames = iFinal - iInitial + 1;
+    int numChunks = std::min(aNumThreads, numFrames);
+    for(int i=0;i<analysisSet.getSize() && numChunks>1;i++) {
+        const Analysis& analysis = analysisSet.get(i);
+        if(analysis.getOn() && (!analysis.isFrameIndependent() ||
+                analysis.getStepInterval() != 1)) {
+            log_info("AnalyzeTool: analysis '{}' must see the frames in "
+                     "order, so the frames are analyzed on 1 thread.",
+                    analysis.getName());
+            numChunks = 1;
         }
     }
+    if(numChunks <= 1) {
+        analyzeFrames(s, aModel, iInitial, iFinal, iInitial, iFinal,
+                aStatesStore, aSolveForEquilibrium);
+        return;
+    }
 
-    // It is possible that there are internal states or that future modeling
-    // choices add state variables that are not known to the modeler/user.
-    // In which case we rely on the model to supply reasonable defaults and
-    // assume all the important/necessary state values for running an analysis
-    // are provided by the Storage. Here we initialize the state values to their
-    // model defaults.
-    SimTK::Vector stateValues = aModel.getStateVariableValues(s);
-
-    for(int i=iInitial;i<=iFinal;i++) {
-        // tPrev = t;
-        aStatesStore.getTime(i,s.updTime()); // time
-        t = s.getTime();
-        aModel.setAllControllersEnabled(true);
-
-        aStatesStore.getData(i,numOpenSimStates,&stateData[0]); // states
-        // Get data into local Vector and assign to State using common utility
-        // to handle internal (non-OpenSim) states that may exist
+    // Split the frames into consecutive chunks. The first chunk is analyzed
+    // with aModel and its analyses; each other chunk with a copy of the
+    // model, which has its own copies of the analyses, and of the states
+    // (the analyses are stepped with each frame exactly as in the serial
+    // loop).
+    log_info("AnalyzeTool: analyzing {} frames in {} chunks in parallel.",
+            numFrames, numChunks);
+    std::vector<int> chunkFirst(numChunks), chunkLast(numChunks);
+    for(int c=0;c<numChunks;c++) {
+        chunkFirst[c] = iInitial + c * numFrames / numChunks;
+        chunkLast[c] = iInitial + (c + 1) * numFrames / numChunks - 1;
+    }
 
-        for (int k=0; k < nsData; ++k) {
-            stateValues[dataToModel[k]] = stateData[k];
+    // Building the systems of the models, and beginning the analyses (which
+    // may build their own copies of the model), is not thread-safe: for
+    // example, connecting ExternalLoads can change the working directory of
+    // the process. So we do this, and analyze the first frame of each chunk,
+    // on this thread; only the remaining frames are analyzed in parallel.
+    std::vector<std::unique_ptr<Model>> chunkModels;
+    std::vector<SimTK::State*> chunkStates;
+    std::vector<std::unique_ptr<Storage>> chunkStatesStores;
+    for(int c=1;c<numChunks;c++) {
+        // The copy of the model owns copies of the analyses of aModel.
+        chunkModels.emplace_back(aModel.clone());
+        chunkStatesStores.emplace_back(new Storage(aStatesStore));
+        AnalysisSet& chunkAnalysisSet = chunkModels.back()->updAnalysisSet();
+        for(int i=0;i<chunkAnalysisSet.getSize();i++) {
+            chunkAnalysisSet.get(i).setStatesStore(*chunkStatesStores.back());
         }
-        aModel.setStateVariableValues(s, stateValues);
-       
-        // Adjust configuration to match constraints and other goals
-        aModel.assemble(s);
+        chunkStates.push_back(&chunkModels.back()->initSystem());
+    }
+    analyzeFrames(s, aModel, chunkFirst[0], chunkLast[0], chunkFirst[0],
+            chunkFirst[0], aStatesStore, aSolveForEquilibrium);
+    for(int c=1;c<numChunks;c++) {
+        analyzeFrames(*chunkStates[c-1], *chunkModels[c-1], chunkFirst[c],
+                chunkLast[c], chunkFirst[c], chunkFirst[c],
+                *chunkStatesStores[c-1], aSolveForEquilibrium);
+    }
 
-        // equilibrateMuscles before realization as it may affect forces
-        if(aSolveForEquilibrium){
-            try{// might not be able to equilibrate if model is in
-                // a non-physical pose. For example, a pose where the 
-                // muscle length is shorter than the tendon slack-length.
-                // the muscle will throw an Exception in this case.
-                aModel.equilibrateMuscles(s);
-            }
-            catch (const std::exception& e) {
-                log_warn("AnalyzeTool::run() unable to equilibrate muscles at "
-                    "time = {}. Reason: {}.", t, e.what());
+    std::vector<std::exception_ptr> chunkErrors(numChunks);
+    auto analyzeChunk = [&](int c) {
+        try {
+            if(c == 0) {
+                analyzeFrames(s, aModel, chunkFirst[c], chunkLast[c],
+                        chunkFirst[c] + 1, chunkLast[c], aStatesStore,
+                        aSolveForEquilibrium);
+            } else {
+                analyzeFrames(*chunkStates[c-1], *chunkModels[c-1],
+                        chunkFirst[c], chunkLast[c], chunkFirst[c] + 1,
+                        chunkLast[c], *chunkStatesStores[c-1],
+                        aSolveForEquilibrium);
             }
+        } catch (...) {
+            chunkErrors[c] = std::current_exception();
         }
-        // Make sure model is at least ready to provide kinematics
-        aModel.getMultibodySystem().realize(s, SimTK::Stage::Velocity);
-
-        if(i==iInitial) {
-            analysisSet.begin(s);
-        } else if(i==iFinal) {
-            analysisSet.end(s);
-        // Step
-        } else {
-            analysisSet.step(s,i);
+    };
+    std::vector<std::thread> threads;
+    for(int c=1;c<numChunks;c++) threads.emplace_back(analyzeChunk, c);
+    analyzeChunk(0);
+    for(auto& thread : threads) thread.join();
+    for(const auto& error : chunkErrors)
+        if(error) std::rethrow_exception(error);
+
+    // As in the serial loop, leave s at the last frame, which the last chunk
+    // analyzed.
+    const SimTK::State& lastChunkState = *chunkStates.back();
+    s.setTime(lastChunkState.getTime());
+    aModel.setStateVariableValues(s,
+            chunkModels.back()->getStateVariableValues(lastChunkState));
+
+    // Append the results of each chunk, in time order, to the storages of
+    // the analyses of aModel.
+    for(int c=1;c<numChunks;c++) {
+        AnalysisSet& chunkAnalysisSet = chunkModels[c-1]->updAnalysisSet();
+        for(int i=0;i<analysisSet.getSize();i++) {
+            ArrayPtrs<Storage>& stores = analysisSet.get(i).getStorageList();
+            ArrayPtrs<Storage>& chunkStores =
+                    chunkAnalysisSet.get(i).getStorageList();
+            OPENSIM_THROW_IF(stores.getSize() != chunkStores.getSize(),
+                    Exception,
+                    "Expected analysis '{}' to have {} storages in each "
+                    "chunk, but got {}.",
+                    analysisSet.get(i).getName(), stores.getSize(),
+                    chunkStores.getSize());
+            for(int k=0;k<stores.getSize();k++) {
+                const Storage& chunkStore = *chunkStores[k];
+                for(int j=0;j<chunkStore.getSize();j++)
+                    stores[k]->append(*chunkStore.getStateVector(j));
+            }
         }
     }
 }
@@ -68,6 +68,9 @@ private:
     /** Low-pass cut-off frequency for filtering the coordinates (does not apply to states). */
     PropertyDbl _lowpassCutoffFrequencyProp;
     double &_lowpassCutoffFrequency;
+    /** Number of threads used to analyze the frames. */
+    PropertyInt _numThreadsProp;
+    int &_numThreads;
 
     /** Storage for the model states. */
     Storage *_statesStore;
@@ -119,6 +122,8 @@ public:
     void setSpeedsFileName(const std::string &aFileName) { _speedsFileName = aFileName; }
     double getLowpassCutoffFrequency() const { return _lowpassCutoffFrequency; }
     void setLowpassCutoffFrequency(double aLowpassCutoffFrequency) { _lowpassCutoffFrequency = aLowpassCutoffFrequency; }
+    int getNumThreads() const { return _numThreads; }
+    void setNumThreads(int aNumThreads) { _numThreads = aNumThreads; }
     bool getLoadModelAndInput() const { return _loadModelAndInput; }
     void setLoadModelAndInput(bool b) { _loadModelAndInput = b; }
 
@@ -140,7 +145,16 @@ public:
     // HELPER
     //--------------------------------------------------------------------------
 #ifndef SWIG
-    static void run(SimTK::State& s, Model &aModel, int iInitial, int iFinal, const Storage &aStatesStore, bool aSolveForEquilibrium);
+    /** Analyze the frames iInitial to iFinal of aStatesStore with the
+    analyses of aModel. With aNumThreads greater than 1, if every analysis
+    that is on is frame independent (see Analysis::isFrameIndependent()) and
+    has a step interval of 1, the frames are split into consecutive chunks
+    that are analyzed in parallel: the first chunk with aModel and its
+    analyses, and each other chunk with a copy of the model and of the
+    analyses, whose results are then appended to those of the analyses of
+    aModel. Otherwise, the frames are analyzed in order on this thread. In
+    both cases, s is left at frame iFinal. */
+    static void run(SimTK::State& s, Model &aModel, int iInitial, int iFinal, const Storage &aStatesStore, bool aSolveForEquilibrium, int aNumThreads = 1);
 #endif
 //=============================================================================
 };  // END of class AnalyzeTool
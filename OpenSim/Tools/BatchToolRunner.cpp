@@ -0,0 +1,413 @@
+/* -------------------------------------------------------------------------- *
+ *                       OpenSim:  BatchToolRunner.cpp                        *
+ * -------------------------------------------------------------------------- *
+ * The OpenSim API is a toolkit for musculoskeletal modeling and simulation.  *
+ * See http://opensim.stanford.edu and the NOTICE file for more information.  *
+ * OpenSim is developed at Stanford University and supported by the US        *
+ * National Institutes of Health (U54 GM072970, R24 HD065690) and by DARPA    *
+ * through the Warrior Web program.                                           *
+ *                                                                            *
+ * Copyright (c) 2005-2021 Stanford University and the Authors                *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+#include "BatchToolRunner.h"
+
+#include "AnalyzeTool.h"
+#include "InverseDynamicsTool.h"
+#include "InverseKinematicsTool.h"
+
+#include <OpenSim/Common/IO.h>
+#include <OpenSim/Common/LogSink.h>
+#include <OpenSim/Common/Logger.h>
+#include <OpenSim/Simulation/Model/ExternalLoads.h>
+#include <OpenSim/Simulation/Model/Model.h>
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <thread>
+
+using namespace OpenSim;
+
+namespace {
+
+bool isUnassigned(const std::string& path) {
+    return path.empty() || path == "Unassigned";
+}
+
+bool isAbsolutePath(const std::string& path) {
+    return (!path.empty() && (path[0] == '/' || path[0] == '\\')) ||
+           (path.size() > 1 && path[1] == ':');
+}
+
+/// Interpret a relative path as relative to `dir` (which is either empty or
+/// ends with a directory separator, as returned by IO::getParentDirectory()).
+std::string resolvePath(const std::string& dir, const std::string& path) {
+    if (isUnassigned(path) || isAbsolutePath(path)) return path;
+    return dir + path;
+}
+
+/// Writes the messages logged by each worker thread to the log file of the
+/// trial that the thread is running. spdlog invokes sinks on the thread that
+/// logs the message, so the thread identifies the trial.
+class TrialLogSink : public LogSink {
+public:
+    void beginTrial(const std::string& fileName) {
+        std::unique_ptr<std::ofstream> stream(new std::ofstream(fileName));
+        std::lock_guard<std::mutex> lock(m_streamsMutex);
+        m_streams[std::this_thread::get_id()] = std::move(stream);
+    }
+    void endTrial() {
+        std::lock_guard<std::mutex> lock(m_streamsMutex);
+        m_streams.erase(std::this_thread::get_id());
+    }
+protected:
+    void sinkImpl(const std::string& msg) override {
+        std::lock_guard<std::mutex> lock(m_streamsMutex);
+        const auto it = m_streams.find(std::this_thread::get_id());
+        if (it != m_streams.end()) *it->second << msg << "\n";
+    }
+    void flushImpl() override {
+        std::lock_guard<std::mutex> lock(m_streamsMutex);
+        for (auto& stream : m_streams) stream.second->flush();
+    }
+private:
+    std::mutex m_streamsMutex;
+    std::map<std::thread::id, std::unique_ptr<std::ofstream>> m_streams;
+};
+
+/// A fixed-capacity queue of trial indices shared by the thread that adds
+/// trials and the worker threads that run them.
+class TrialQueue {
+public:
+    explicit TrialQueue(size_t capacity) : m_capacity(capacity) {}
+    void push(size_t index) {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_notFull.wait(lock, [this] { return m_queue.size() < m_capacity; });
+        m_queue.push_back(index);
+        lock.unlock();
+        m_notEmpty.notify_one();
+    }
+    /// Returns false if the queue is closed and empty.
+    bool pop(size_t& index) {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_notEmpty.wait(lock, [this] { return m_closed || !m_queue.empty(); });
+        if (m_queue.empty()) return false;
+        index = m_queue.front();
+        m_queue.pop_front();
+        lock.unlock();
+        m_notFull.notify_one();
+        return true;
+    }
+    void close() {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_closed = true;
+        }
+        m_notEmpty.notify_all();
+    }
+private:
+    const size_t m_capacity;
+    std::deque<size_t> m_queue;
+    bool m_closed = false;
+    std::mutex m_mutex;
+    std::condition_variable m_notFull;
+    std::condition_variable m_notEmpty;
+};
+
+} // anonymous namespace
+
+BatchToolRunner::BatchToolRunner(const std::string& setupFile) :
+        m_setupFile(setupFile),
+        m_setupDir(IO::getParentDirectory(setupFile)),
+        m_numThreads(std::max(1, (int)std::thread::hardware_concurrency())) {
+
+    m_tool.reset(Object::makeObjectFromFile(setupFile));
+    OPENSIM_THROW_IF(m_tool == nullptr, Exception,
+            "A problem occurred when trying to load file '{}'.", setupFile);
+
+    // Paths in the setup file are relative to the setup file. The tools
+    // handle this by changing the current directory while they run, which
+    // cannot be done from multiple threads, so we resolve the paths here.
+    std::string modelFile;
+    if (auto* ik = dynamic_cast<InverseKinematicsTool*>(m_tool.get())) {
+        m_toolType = ToolType::InverseKinematics;
+        modelFile = ik->get_model_file();
+        ik->setCoordinateFileName(
+                resolvePath(m_setupDir, ik->getCoordinateFileName()));
+        m_resultsDir = resolvePath(m_setupDir, ik->getResultsDir());
+    } else if (auto* id = dynamic_cast<InverseDynamicsTool*>(m_tool.get())) {
+        m_toolType = ToolType::InverseDynamics;
+        modelFile = id->getModelFileName();
+        id->setExternalLoadsFileName(
+                resolvePath(m_setupDir, id->getExternalLoadsFileName()));
+        m_resultsDir = resolvePath(m_setupDir, id->getResultsDir());
+    } else if (auto* analyze = dynamic_cast<AnalyzeTool*>(m_tool.get())) {
+        m_toolType = ToolType::Analyze;
+        modelFile = analyze->getModelFilename();
+        analyze->setExternalLoadsFileName(
+                resolvePath(m_setupDir, analyze->getExternalLoadsFileName()));
+        analyze->setStatesFileName(
+                resolvePath(m_setupDir, analyze->getStatesFileName()));
+        m_resultsDir = resolvePath(m_setupDir, analyze->getResultsDir());
+    } else {
+        OPENSIM_THROW(Exception,
+                "The setup file '{}' does not define an InverseKinematicsTool, "
+                "InverseDynamicsTool, or AnalyzeTool.", setupFile);
+    }
+    OPENSIM_THROW_IF(isUnassigned(modelFile), Exception,
+            "No model file was specified in the setup file '{}'.", setupFile);
+
+    log_info("BatchToolRunner: loading model {}.", modelFile);
+    m_model.reset(new Model(resolvePath(m_setupDir, modelFile)));
+    m_model->finalizeFromProperties();
+    if (m_toolType == ToolType::Analyze) {
+        // Apply the force set files and replace_force_set once for all
+        // trials.
+        static_cast<AnalyzeTool&>(*m_tool).updateModelForces(
+                *m_model, setupFile);
+    }
+}
+
+BatchToolRunner::~BatchToolRunner() = default;
+
+const std::string& BatchToolRunner::getToolClassName() const {
+    return m_tool->getConcreteClassName();
+}
+
+void BatchToolRunner::addTrial(const std::string& name,
+        const std::string& inputFile, const std::string& externalLoadsFile) {
+    OPENSIM_THROW_IF(name.empty(), Exception, "Expected a trial name.");
+    OPENSIM_THROW_IF(inputFile.empty(), Exception,
+            "Expected an input file for trial '{}'.", name);
+    for (const auto& trial : m_trials) {
+        OPENSIM_THROW_IF(trial.name == name, Exception,
+                "A trial named '{}' already exists.", name);
+    }
+    Trial trial;
+    trial.name = name;
+    trial.inputFile = inputFile;
+    trial.externalLoadsFile = externalLoadsFile;
+    m_trials.push_back(trial);
+}
+
+void BatchToolRunner::addTrialsFromFile(const std::string& trialsFile) {
+    std::ifstream stream(trialsFile);
+    OPENSIM_THROW_IF(!stream.good(), FileDoesNotExist, trialsFile);
+    const std::string dir = IO::getParentDirectory(trialsFile);
+    std::string line;
+    int lineNumber = 0;
+    while (std::getline(stream, line)) {
+        ++lineNumber;
+        IO::TrimWhitespace(line);
+        if (line.empty() || line[0] == '#') continue;
+        std::istringstream tokens(line);
+        std::string name, inputFile, externalLoadsFile, extra;
+        tokens >> name >> inputFile >> externalLoadsFile >> extra;
+        OPENSIM_THROW_IF(inputFile.empty() || !extra.empty(), Exception,
+                "Expected '<name> <input-file> [<external-loads-file>]' on "
+                "line {} of '{}', but got '{}'.", lineNumber, trialsFile, line);
+        addTrial(name, resolvePath(dir, inputFile),
+                resolvePath(dir, externalLoadsFile));
+    }
+}
+
+void BatchToolRunner::setNumThreads(int numThreads) {
+    OPENSIM_THROW_IF(numThreads < 1, Exception,
+            "Expected the number of threads to be positive, but got {}.",
+            numThreads);
+    m_numThreads = numThreads;
+}
+
+void BatchToolRunner::setResultsDir(const std::string& resultsDir) {
+    m_resultsDir = resultsDir;
+}
+
+std::string BatchToolRunner::resolveExternalLoads(
+        const std::string& externalLoadsFile,
+        const std::string& trialName) const {
+    if (isUnassigned(externalLoadsFile)) return externalLoadsFile;
+    // ExternalLoads looks for a relative data file in the directory of the
+    // ExternalLoads file by changing the current directory, which is not
+    // safe while other trials are running. Instead, we write a copy of the
+    // ExternalLoads with an absolute path to its data file.
+    ExternalLoads loads(externalLoadsFile, true);
+    const std::string dataFile = loads.getDataFileName();
+    if (dataFile.empty() || IO::FileExists(dataFile)) return externalLoadsFile;
+    const std::string resolved = resolvePath(
+            IO::getParentDirectory(externalLoadsFile), dataFile);
+    OPENSIM_THROW_IF(!IO::FileExists(resolved), Exception,
+            "Could not find the data file '{}' of the external loads file "
+            "'{}'.", dataFile, externalLoadsFile);
+    loads.setDataFileName(resolved);
+    const std::string copyFile =
+            m_resultsDir + "/" + trialName + "_external_loads.xml";
+    loads.print(copyFile);
+    return copyFile;
+}
+
+void BatchToolRunner::runTrial(const Trial& trial, Object& toolCopy,
+        Model& model) const {
+    log_info("BatchToolRunner: running trial '{}'.", trial.name);
+    bool success = false;
+    switch (m_toolType) {
+    case ToolType::InverseKinematics: {
+        auto* tool = static_cast<InverseKinematicsTool*>(&toolCopy);
+        tool->setName(trial.name);
+        tool->setMarkerDataFileName(trial.inputFile);
+        tool->setOutputMotionFileName(
+                m_resultsDir + "/" + trial.name + "_ik.mot");
+        tool->setResultsDir(m_resultsDir);
+        tool->setModel(model);
+        success = tool->run();
+        break;
+    }
+    case ToolType::InverseDynamics: {
+        auto* tool = static_cast<InverseDynamicsTool*>(&toolCopy);
+        tool->setName(trial.name);
+        tool->setCoordinatesFileName(trial.inputFile);
+        tool->setExternalLoadsFileName(trial.externalLoadsFile);
+        tool->setOutputGenForceFileName(trial.name + "_id.sto");
+        tool->setOutputBodyForcesFileName(
+                trial.name + "_body_forces_at_joints.sto");
+        tool->setResultsDir(m_resultsDir);
+        tool->setModel(model);
+        success = tool->run();
+        break;
+    }
+    case ToolType::Analyze: {
+        auto* tool = static_cast<AnalyzeTool*>(&toolCopy);
+        tool->setName(trial.name);
+        if (!isUnassigned(tool->getStatesFileName())) {
+            tool->setStatesFileName(trial.inputFile);
+        } else {
+            tool->setCoordinatesFileName(trial.inputFile);
+            tool->setSpeedsFileName("");
+        }
+        tool->setExternalLoadsFileName(trial.externalLoadsFile);
+        tool->setResultsDir(m_resultsDir);
+        tool->setModel(model);
+        tool->setLoadModelAndInput(true);
+        success = tool->run();
+        tool->removeAnalysisSetFromModel();
+        tool->removeControllerSetFromModel();
+        break;
+    }
+    }
+    OPENSIM_THROW_IF(!success, Exception,
+            "{} did not complete.", m_tool->getConcreteClassName());
+}
+
+std::vector<BatchToolRunner::TrialResult> BatchToolRunner::run() const {
+    std::vector<TrialResult> results(m_trials.size());
+    if (m_trials.empty()) return results;
+    IO::makeDir(m_resultsDir);
+
+    // Prepare the trials before starting any threads. A trial that cannot
+    // be prepared is reported as failed and is not run.
+    std::string defaultExternalLoadsFile;
+    if (m_toolType == ToolType::InverseDynamics) {
+        defaultExternalLoadsFile = static_cast<const InverseDynamicsTool&>(
+                *m_tool).getExternalLoadsFileName();
+    } else if (m_toolType == ToolType::Analyze) {
+        defaultExternalLoadsFile = static_cast<const AnalyzeTool&>(
+                *m_tool).getExternalLoadsFileName();
+    }
+    std::vector<Trial> trials = m_trials;
+    std::vector<size_t> runnable;
+    for (size_t i = 0; i < trials.size(); ++i) {
+        auto& trial = trials[i];
+        results[i].name = trial.name;
+        if (m_toolType == ToolType::InverseKinematics) {
+            runnable.push_back(i);
+            continue;
+        }
+        if (trial.externalLoadsFile.empty()) {
+            trial.externalLoadsFile = defaultExternalLoadsFile;
+        }
+        try {
+            trial.externalLoadsFile =
+                    resolveExternalLoads(trial.externalLoadsFile, trial.name);
+            runnable.push_back(i);
+        } catch (const std::exception& e) {
+            results[i].message = e.what();
+            log_error("BatchToolRunner: trial '{}' failed: {}", trial.name,
+                    e.what());
+        }
+    }
+
+    auto logSink = std::make_shared<TrialLogSink>();
+    if (m_writeTrialLogs) Logger::addSink(logSink);
+
+    const int numThreads = (int)std::min<size_t>(
+            (size_t)m_numThreads, std::max<size_t>(runnable.size(), 1));
+    log_info("BatchToolRunner: running {} trials of {} with {} threads.",
+            runnable.size(), m_tool->getConcreteClassName(), numThreads);
+
+    TrialQueue queue(2 * (size_t)numThreads);
+    // Serializes copying the shared setup and model.
+    std::mutex cloneMutex;
+    auto worker = [&]() {
+        // The worker reuses its copy of the model for its trials (the tools
+        // remove what they add to the model), unless a trial fails and may
+        // have left the model in an unknown state.
+        std::unique_ptr<Model> model;
+        size_t index;
+        while (queue.pop(index)) {
+            const Trial& trial = trials[index];
+            TrialResult& result = results[index];
+            if (m_writeTrialLogs) {
+                result.logFile = m_resultsDir + "/" + trial.name + ".log";
+                logSink->beginTrial(result.logFile);
+            }
+            const auto start = std::chrono::steady_clock::now();
+            try {
+                std::unique_ptr<Object> tool;
+                {
+                    std::lock_guard<std::mutex> lock(cloneMutex);
+                    tool.reset(m_tool->clone());
+                    if (!model) model.reset(m_model->clone());
+                }
+                runTrial(trial, *tool, *model);
+                result.success = true;
+            } catch (const std::exception& e) {
+                result.message = e.what();
+                model.reset();
+                log_error("BatchToolRunner: trial '{}' failed: {}",
+                        trial.name, e.what());
+            }
+            result.elapsedTime = std::chrono::duration<double>(
+                    std::chrono::steady_clock::now() - start).count();
+            if (m_writeTrialLogs) logSink->endTrial();
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (int i = 0; i < numThreads; ++i) threads.emplace_back(worker);
+    for (const auto& index : runnable) queue.push(index);
+    queue.close();
+    for (auto& thread : threads) thread.join();
+
+    if (m_writeTrialLogs) Logger::removeSink(logSink);
+
+    const auto numSucceeded = std::count_if(results.begin(), results.end(),
+            [](const TrialResult& result) { return result.success; });
+    log_info("BatchToolRunner: {} of {} trials succeeded.", numSucceeded,
+            results.size());
+    return results;
+}
@@ -0,0 +1,155 @@
+#ifndef OPENSIM_BATCH_TOOL_RUNNER_H_
+#define OPENSIM_BATCH_TOOL_RUNNER_H_
+/* -------------------------------------------------------------------------- *
+ *                        OpenSim:  BatchToolRunner.h                         *
+ * -------------------------------------------------------------------------- *
+ * The OpenSim API is a toolkit for musculoskeletal modeling and simulation.  *
+ * See http://opensim.stanford.edu and the NOTICE file for more information.  *
+ * OpenSim is developed at Stanford University and supported by the US        *
+ * National Institutes of Health (U54 GM072970, R24 HD065690) and by DARPA    *
+ * through the Warrior Web program.                                           *
+ *                                                                            *
+ * Copyright (c) 2005-2021 Stanford University and the Authors                *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+#include "osimToolsDLL.h"
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace OpenSim {
+
+class Object;
+class Model;
+
+/** Run an InverseKinematicsTool, InverseDynamicsTool, or AnalyzeTool on many
+trials that share the same setup file, in parallel. The setup file and the
+model are loaded only once; each worker thread runs its trials on its own copy
+of the model, so the cost of reading the model file is paid once per batch
+rather than once per trial.
+
+Each trial replaces the primary input of the setup file:
+ - InverseKinematicsTool: the marker file.
+ - InverseDynamicsTool: the coordinates file.
+ - AnalyzeTool: the states file if the setup file specifies one, otherwise
+   the coordinates file (the speeds file is not used).
+
+A trial can also replace the external loads file (InverseDynamicsTool and
+AnalyzeTool). All other settings, including the time range, come from the
+setup file. Results are written to the results directory, with file names
+prefixed by the name of the trial (e.g., `<trial>_ik.mot`, `<trial>_id.sto`,
+or `<trial>_<analysis>_*.sto`). Unless disabled, the messages logged while
+running a trial are also written to `<trial>.log` in the results directory.
+
+A trial that fails does not stop the batch: the error is reported in the
+TrialResult of that trial and the worker continues with the next trial using
+a fresh copy of the model.
+
+@code
+BatchToolRunner runner("subject01_Setup_InverseKinematics.xml");
+runner.addTrial("walk1", "walk1.trc");
+runner.addTrial("walk2", "walk2.trc");
+runner.setNumThreads(4);
+for (const auto& result : runner.run()) {
+    if (!result.success) log_error("{}: {}", result.name, result.message);
+}
+@endcode
+
+File paths given for trials are used as given (relative to the current
+directory), while relative paths within the setup file are relative to the
+directory containing the setup file, as for the tools themselves. The
+current directory must not be changed while the batch is running. */
+class OSIMTOOLS_API BatchToolRunner {
+public:
+    /// A trial to run: the tool's primary input file (see above) and,
+    /// optionally, an external loads (.xml) file.
+    struct Trial {
+        std::string name;
+        std::string inputFile;
+        std::string externalLoadsFile;
+    };
+
+    /// The outcome of running one trial.
+    struct TrialResult {
+        std::string name;
+        bool success = false;
+        /// The error message if the trial failed.
+        std::string message;
+        /// Empty if trial logs are disabled.
+        std::string logFile;
+        /// Wall-clock time spent on this trial, in seconds.
+        double elapsedTime = 0;
+    };
+
+    /// Load the setup file and the model it specifies. The setup file must
+    /// define an InverseKinematicsTool, InverseDynamicsTool, or AnalyzeTool.
+    explicit BatchToolRunner(const std::string& setupFile);
+    ~BatchToolRunner();
+
+    BatchToolRunner(const BatchToolRunner&) = delete;
+    BatchToolRunner& operator=(const BatchToolRunner&) = delete;
+
+    /// The concrete class name of the tool in the setup file.
+    const std::string& getToolClassName() const;
+
+    void addTrial(const std::string& name, const std::string& inputFile,
+            const std::string& externalLoadsFile = "");
+    /// Add trials listed in a text file. Each line contains the name of the
+    /// trial, its input file, and optionally its external loads file,
+    /// separated by whitespace. Blank lines and lines starting with '#' are
+    /// ignored. Relative file paths are relative to the directory containing
+    /// the trials file.
+    void addTrialsFromFile(const std::string& trialsFile);
+    const std::vector<Trial>& getTrials() const { return m_trials; }
+
+    /// The number of trials run at the same time (default: the number of
+    /// hardware threads). The number of threads is never larger than the
+    /// number of trials.
+    void setNumThreads(int numThreads);
+    int getNumThreads() const { return m_numThreads; }
+
+    /// The directory to which results are written (default: the results
+    /// directory of the setup file).
+    void setResultsDir(const std::string& resultsDir);
+    const std::string& getResultsDir() const { return m_resultsDir; }
+
+    /// Write the messages logged while running each trial to
+    /// `<trial>.log` in the results directory (default: true).
+    void setWriteTrialLogs(bool tf) { m_writeTrialLogs = tf; }
+    bool getWriteTrialLogs() const { return m_writeTrialLogs; }
+
+    /// Run all trials and return their results, in the order in which the
+    /// trials were added. This function returns after all trials finish.
+    std::vector<TrialResult> run() const;
+
+private:
+    enum class ToolType { InverseKinematics, InverseDynamics, Analyze };
+
+    void runTrial(const Trial& trial, Object& toolCopy, Model& model) const;
+    std::string resolveExternalLoads(const std::string& externalLoadsFile,
+            const std::string& trialName) const;
+
+    std::string m_setupFile;
+    std::string m_setupDir;
+    ToolType m_toolType;
+    std::unique_ptr<Object> m_tool;
+    std::unique_ptr<Model> m_model;
+    std::vector<Trial> m_trials;
+    int m_numThreads;
+    std::string m_resultsDir;
+    bool m_writeTrialLogs = true;
+};
+
+} // namespace OpenSim
+
+#endif // OPENSIM_BATCH_TOOL_RUNNER_H_
@@ -36,6 +36,10 @@
 #include <OpenSim/Simulation/Model/Model.h>
 #include <OpenSim/Simulation/SimulationUtilities.h>
 
+#include <exception>
+#include <memory>
+#include <thread>
+
 using namespace OpenSim;
 using namespace std;
 using namespace SimTK;
@@ -63,7 +67,8 @@ InverseDynamicsTool::InverseDynamicsTool() : DynamicsTool(),
     _lowpassCutoffFrequency(_lowpassCutoffFrequencyProp.getValueDbl()),
     _outputGenForceFileName(_outputGenForceFileNameProp.getValueStr()),
     _jointsForReportingBodyForces(_jointsForReportingBodyForcesProp.getValueStrArray()),
-    _outputBodyForcesAtJointsFileName(_outputBodyForcesAtJointsFileNameProp.getValueStr())
+    _outputBodyForcesAtJointsFileName(_outputBodyForcesAtJointsFileNameProp.getValueStr()),
+    _numThreads(_numThreadsProp.getValueInt())
 {
     setNull();
 }
@@ -82,7 +87,8 @@ InverseDynamicsTool::InverseDynamicsTool(const string &aFileName, bool aLoadMode
     _lowpassCutoffFrequency(_lowpassCutoffFrequencyProp.getValueDbl()),
     _outputGenForceFileName(_outputGenForceFileNameProp.getValueStr()),
     _jointsForReportingBodyForces(_jointsForReportingBodyForcesProp.getValueStrArray()),
-    _outputBodyForcesAtJointsFileName(_outputBodyForcesAtJointsFileNameProp.getValueStr())
+    _outputBodyForcesAtJointsFileName(_outputBodyForcesAtJointsFileNameProp.getValueStr()),
+    _numThreads(_numThreadsProp.getValueInt())
 {
     setNull();
     updateFromXMLDocument();
@@ -104,7 +110,8 @@ InverseDynamicsTool::InverseDynamicsTool(const InverseDynamicsTool &aTool) :
     _lowpassCutoffFrequency(_lowpassCutoffFrequencyProp.getValueDbl()),
     _outputGenForceFileName(_outputGenForceFileNameProp.getValueStr()),
     _jointsForReportingBodyForces(_jointsForReportingBodyForcesProp.getValueStrArray()),
-    _outputBodyForcesAtJointsFileName(_outputBodyForcesAtJointsFileNameProp.getValueStr())
+    _outputBodyForcesAtJointsFileName(_outputBodyForcesAtJointsFileNameProp.getValueStr()),
+    _numThreads(_numThreadsProp.getValueInt())
 {
     setNull();
     *this = aTool;
@@ -151,6 +158,13 @@ void InverseDynamicsTool::setupProperties()
     _outputBodyForcesAtJointsFileNameProp.setName("output_body_forces_file");
     _outputBodyForcesAtJointsFileNameProp.setValue("body_forces_at_joints.sto");
     _propertySet.append(&_outputBodyForcesAtJointsFileNameProp);
+
+    _numThreadsProp.setComment("The number of threads used to solve the time "
+        "frames (default: 1). With more than 1 thread, the frames are split "
+        "into consecutive chunks that are solved in parallel.");
+    _numThreadsProp.setName("num_threads");
+    _numThreadsProp.setValue(1);
+    _propertySet.append(&_numThreadsProp);
 }
 
 //_____________________________________________________________________________
@@ -182,6 +196,7 @@ operator=(const InverseDynamicsTool &aTool)
     _lowpassCutoffFrequency = aTool._lowpassCutoffFrequency;
     _outputGenForceFileName = aTool._outputGenForceFileName;
     _outputBodyForcesAtJointsFileName = aTool._outputBodyForcesAtJointsFileName;
+    _numThreads = aTool._numThreads;
     _coordinateValues = NULL;
 
     return(*this);
@@ -399,8 +414,9 @@ bool InverseDynamicsTool::run()
         int start_index = _coordinateValues->findIndex(start_time);
         int final_index = _coordinateValues->findIndex(final_time);
 
-        // create the solver given the input data
-        InverseDynamicsSolver ivdSolver(*_model);
+        OPENSIM_THROW_IF_FRMOBJ(_numThreads < 1, Exception,
+                "Expected num_threads to be at least 1, but got {}.",
+                _numThreads);
 
         Stopwatch watch;
 
@@ -411,21 +427,147 @@ bool InverseDynamicsTool::run()
             times[i]=_coordinateValues->getStateVector(start_index+i)->getTime();
         }
 
+        // Evaluate each coordinate function and its first and second
+        // derivatives at all times up front: column d of coordDerivs[j] holds
+        // the d-th derivative of the j-th function.
+        std::vector<Matrix> coordDerivs(nq);
+        const Vector timesVector(nt, times.cdata());
+        Vector values(nt);
+        for (int j = 0; j < nq; ++j) {
+            coordDerivs[j].resize(nt, 3);
+            for (int d = 0; d < 3; ++d) {
+                coordFunctions[j].calcValues(timesVector, values, d);
+                coordDerivs[j].updCol(d) = values;
+            }
+        }
+
+        // Set the time, q, u and udot of a state to those of frame i.
+        // Account for cases where qdot != u with coordinatesToSpeedsIndexMap.
+        auto setStateToFrame = [&](SimTK::State& state, int i) {
+            state.updTime() = times[i];
+            Vector& q = state.updQ();
+            Vector& u = state.updU();
+            Vector& udot = state.updUDot();
+            for (int j = 0; j < nq; ++j) {
+                q[j] = coordDerivs[j](i, 0);
+            }
+            for (int j = 0; j < nu; ++j) {
+                const Matrix& derivs = coordDerivs[coordinatesToSpeedsIndexMap[j]];
+                u[j] = derivs(i, 1);
+                udot[j] = derivs(i, 2);
+            }
+        };
+
+        JointSet jointsForEquivalentBodyForces;
+        getJointsByName(*_model, _jointsForReportingBodyForces, jointsForEquivalentBodyForces);
+        int nj = jointsForEquivalentBodyForces.getSize();
+
         // Preallocate results
         Array_<Vector> genForceTraj(nt, Vector(nCoords, 0.0));
+        Matrix bodyForcesTraj(nt, 6*nj, 0.0);
+
+        // Solve for the generalized forces of frames [begin, end) with the
+        // given model and state, and calculate the equivalent body forces at
+        // the given joints of that model.
+        auto solveFrames = [&](const Model& model, SimTK::State& state,
+                const std::vector<const Joint*>& joints, int begin, int end,
+                AnalysisSet* analysisSet) {
+            InverseDynamicsSolver ivdSolver(model);
+            for (int i = begin; i < end; ++i) {
+                setStateToFrame(state, i);
+                genForceTraj[i] = ivdSolver.solve(state, state.updUDot());
+                if (analysisSet) analysisSet->step(state, i);
+
+                for (int j = 0; j < (int)joints.size(); ++j) {
+                    const SpatialVec equivalentBodyForceAtJoint =
+                            joints[j]->calcEquivalentSpatialForce(
+                                    state, genForceTraj[i]);
+                    for (int k = 0; k < 3; ++k) {
+                        // body force components
+                        bodyForcesTraj(i, 6*j+k) = equivalentBodyForceAtJoint[1][k];
+                        // body torque components
+                        bodyForcesTraj(i, 6*j+k+3) = equivalentBodyForceAtJoint[0][k];
+                    }
+                }
+            }
+        };
+
+        std::vector<const Joint*> joints;
+        for (int j = 0; j < nj; ++j) {
+            joints.push_back(&jointsForEquivalentBodyForces[j]);
+        }
 
         // solve for the trajectory of generalized forces that correspond to the 
         // coordinate trajectories provided
-        ivdSolver.solve(s, coordFunctions, coordinatesToSpeedsIndexMap, times,
-                genForceTraj);
+        const int numChunks = std::min(_numThreads, nt);
+        if (numChunks <= 1) {
+            solveFrames(*_model, s, joints, 0, nt, &_model->updAnalysisSet());
+        } else {
+            // Split the frames into consecutive chunks and solve each chunk
+            // on its own copy of the model (and therefore its own state).
+            // Frames are independent given q, u and udot, so the results are
+            // the same as when solving the frames serially.
+            log_info("InverseDynamicsTool: solving {} time frames in {} "
+                     "chunks in parallel.", nt, numChunks);
+            std::vector<bool> appliesForce;
+            const ForceSet& forces = _model->getForceSet();
+            for (int k = 0; k < forces.getSize(); ++k) {
+                appliesForce.push_back(forces[k].appliesForce(s));
+            }
+            std::vector<std::unique_ptr<Model>> chunkModels;
+            for (int c = 0; c < numChunks; ++c) {
+                chunkModels.emplace_back(_model->clone());
+                // The analyses are stepped with the model of this tool.
+                chunkModels.back()->updAnalysisSet().clearAndDestroy();
+            }
+            std::vector<std::exception_ptr> chunkErrors(numChunks);
+            auto solveChunk = [&](int c) {
+                try {
+                    Model& chunkModel = *chunkModels[c];
+                    SimTK::State& cs = chunkModel.initSystem();
+                    ForceSet& chunkForces = chunkModel.updForceSet();
+                    for (int k = 0; k < chunkForces.getSize(); ++k) {
+                        if (!appliesForce[k]) {
+                            chunkForces[k].setAppliesForce(cs, false);
+                        }
+                    }
+                    std::vector<const Joint*> chunkJoints;
+                    for (const Joint* joint : joints) {
+                        chunkJoints.push_back(
+                                &chunkModel.getJointSet().get(joint->getName()));
+                    }
+                    solveFrames(chunkModel, cs, chunkJoints,
+                            c * nt / numChunks, (c + 1) * nt / numChunks,
+                            nullptr);
+                } catch (...) {
+                    chunkErrors[c] = std::current_exception();
+                }
+            };
+            std::vector<std::thread> threads;
+            for (int c = 1; c < numChunks; ++c) {
+                threads.emplace_back(solveChunk, c);
+            }
+            solveChunk(0);
+            for (auto& thread : threads) thread.join();
+            for (const auto& error : chunkErrors) {
+                if (error) std::rethrow_exception(error);
+            }
+
+            // Step the analyses of the model in the order of the frames.
+            AnalysisSet& analysisSet = _model->updAnalysisSet();
+            if (analysisSet.getSize() > 0) {
+                for (int i = 0; i < nt; ++i) {
+                    setStateToFrame(s, i);
+                    _model->getMultibodySystem().realize(s,
+                            SimTK::Stage::Dynamics);
+                    analysisSet.step(s, i);
+                }
+            }
+        }
         success = true;
 
         log_info("InverseDynamicsTool: {} time frames in {}.", nt, 
             watch.getElapsedTimeFormatted());
-    
-        JointSet jointsForEquivalentBodyForces;
-        getJointsByName(*_model, _jointsForReportingBodyForces, jointsForEquivalentBodyForces);
-        int nj = jointsForEquivalentBodyForces.getSize();
 
         // Generalized forces from ID Solver are in MultibodyTree order and not
         // necessarily in the order of the Coordinates in the Model.
@@ -450,45 +592,18 @@ bool InverseDynamicsTool::run()
 
         Storage genForceResults(nt);
         Storage bodyForcesResults(nt);
-        SpatialVec equivalentBodyForceAtJoint;
 
         for(int i=0; i<nt; i++){
             StateVector
                 genForceVec(times[i], genForceTraj[i]);
             genForceResults.append(genForceVec);
 
-            // if there are joints requested for equivalent body forces then calculate them
+            // if there are joints requested for equivalent body forces then
+            // append the ones calculated for this frame
             if(nj>0){
-                Vector forces(6*nj, 0.0);
                 StateVector bodyForcesVec(times[i],
-                                          SimTK::Vector_<double>(6*nj,
-                                                                 &forces[0]));
-
-                s.updTime() = times[i];
-                Vector &q = s.updQ();
-                Vector &u = s.updU();
-
-                // Account for cases where qdot != u with coordinatesToSpeedsIndexMap
-                for( int j = 0; j < nq; ++j) {
-                    q[j] = coordFunctions.evaluate(j, 0, times[i]);
-                }
-                for (int j = 0; j < nu; ++j) {
-                    u[j] = coordFunctions.evaluate(
-                            coordinatesToSpeedsIndexMap[j], 1, times[i]);
-                }
-
-            
-                for(int j=0; j<nj; ++j){
-                    equivalentBodyForceAtJoint = jointsForEquivalentBodyForces[j].calcEquivalentSpatialForce(s, genForceTraj[i]);
-                    for(int k=0; k<3; ++k){
-                        // body force components
-                        bodyForcesVec.setDataValue(6*j+k, equivalentBodyForceAtJoint[1][k]); 
-                        // body torque components
-                        bodyForcesVec.setDataValue(6*j+k+3, equivalentBodyForceAtJoint[0][k]);
-                    }
-                }
+                        SimTK::Vector(~bodyForcesTraj[i]));
                 bodyForcesResults.append(bodyForcesVec);
-
             }
         }
 
@@ -23,6 +23,7 @@
  * limitations under the License.                                             *
  * -------------------------------------------------------------------------- */
 
+#include <OpenSim/Common/PropertyInt.h>
 #include <OpenSim/Common/Storage.h>
 #include "DynamicsTool.h"
 
@@ -88,6 +89,10 @@ protected:
     PropertyStr _outputBodyForcesAtJointsFileNameProp;
     std::string &_outputBodyForcesAtJointsFileName;
 
+    /** number of threads used to solve the time frames */
+    PropertyInt _numThreadsProp;
+    int &_numThreads;
+
 //=============================================================================
 // METHODS
 //=============================================================================
@@ -135,6 +140,26 @@ public:
     void setOutputGenForceFileName(const std::string& desiredOutputFileName) {
         _outputGenForceFileName = desiredOutputFileName;
     }
+    /**
+     * get/set the joints (or the keyword All) at which the equivalent body
+     * forces are reported
+     */
+    const Array<std::string>& getJointsToReportBodyForces() const {
+        return _jointsForReportingBodyForces;
+    }
+    void setJointsToReportBodyForces(const Array<std::string>& aJointNames) {
+        _jointsForReportingBodyForces = aJointNames;
+    }
+    /**
+     * get/set the name of the file to which the body forces at the joints
+     * specified in joints_to_report_body_forces are written
+     */
+    std::string getOutputBodyForcesFileName() const {
+        return _outputBodyForcesAtJointsFileName;
+    }
+    void setOutputBodyForcesFileName(const std::string& aFileName) {
+        _outputBodyForcesAtJointsFileName = aFileName;
+    }
     /**
      * get/set the name of the file containing coordinates
      */
@@ -156,6 +181,13 @@ public:
     void setLowpassCutoffFrequency(double aFrequency) {
         _lowpassCutoffFrequency = aFrequency;
     }
+    /**
+     * get/set the number of threads used to solve the time frames (default:
+     * 1). With more than 1 thread, the frames are split into consecutive
+     * chunks that are solved in parallel, each on its own copy of the model.
+     */
+    int getNumThreads() const { return _numThreads; }
+    void setNumThreads(int aNumThreads) { _numThreads = aNumThreads; }
     //--------------------------------------------------------------------------
     // INTERFACE
     //--------------------------------------------------------------------------
@@ -40,10 +40,23 @@
 #include <OpenSim/Simulation/InverseKinematicsSolver.h>
 #include <OpenSim/Simulation/Model/Model.h>
 
+#include <atomic>
+#include <exception>
+#include <thread>
+
 using namespace OpenSim;
 using namespace std;
 using namespace SimTK;
 
+namespace {
+    /// The solution of one frame when frames are solved in parallel.
+    struct IKFrameSolution {
+        SimTK::Vector q;
+        SimTK::Array_<double> squaredMarkerErrors;
+        SimTK::Array_<Vec3> markerLocations;
+    };
+}
+
 //=============================================================================
 // CONSTRUCTOR(S) AND DESTRUCTOR
 //=============================================================================
@@ -86,6 +99,7 @@ void InverseKinematicsTool::constructProperties()
     constructProperty_marker_file("");
     constructProperty_coordinate_file("");
     constructProperty_report_marker_locations(false);
+    constructProperty_num_threads(1);
 }
 
 //=============================================================================
@@ -190,23 +204,21 @@ bool InverseKinematicsTool::run()
 
         Stopwatch watch;
 
-        for (int i = start_ix; i <= final_ix; ++i) {
-            s.updTime() = times[i];
-            ikSolver.track(s);
-            // show progress line every 1000 frames so users see progress
-            if (std::remainder(i - start_ix, 1000) == 0 && i != start_ix)
-                log_info("Solved {} frame(s)...", i - start_ix);
+        // Record the results for frame i, given the marker errors and
+        // locations computed for the solution in state.
+        auto recordFrame = [&](int i, const SimTK::State& state,
+                const SimTK::Array_<double>& frameSquaredMarkerErrors,
+                const SimTK::Array_<Vec3>& frameMarkerLocations) {
             if(get_report_errors()){
                 Array<double> markerErrors(0.0, 3);
                 double totalSquaredMarkerError = 0.0;
                 double maxSquaredMarkerError = 0.0;
                 int worst = -1;
 
-                ikSolver.computeCurrentSquaredMarkerErrors(squaredMarkerErrors);
                 for(int j=0; j<nm; ++j){
-                    totalSquaredMarkerError += squaredMarkerErrors[j];
-                    if(squaredMarkerErrors[j] > maxSquaredMarkerError){
-                        maxSquaredMarkerError = squaredMarkerErrors[j];
+                    totalSquaredMarkerError += frameSquaredMarkerErrors[j];
+                    if(frameSquaredMarkerErrors[j] > maxSquaredMarkerError){
+                        maxSquaredMarkerError = frameSquaredMarkerErrors[j];
                         worst = j;
                     }
                 }
@@ -215,29 +227,116 @@ bool InverseKinematicsTool::run()
                 markerErrors.set(0, totalSquaredMarkerError); 
                 markerErrors.set(1, rms);
                 markerErrors.set(2, sqrt(maxSquaredMarkerError));
-                modelMarkerErrors->append(s.getTime(), 3, &markerErrors[0]);
+                modelMarkerErrors->append(state.getTime(), 3, &markerErrors[0]);
 
                 log_info("Frame {} (t = {}):\t total squared error = {}, "
                          "marker error: RMS = {}, max = {} ({})", 
-                    i, s.getTime(), totalSquaredMarkerError, rms,
+                    i, state.getTime(), totalSquaredMarkerError, rms,
                     sqrt(maxSquaredMarkerError), 
                     ikSolver.getMarkerNameForIndex(worst));
             }
 
             if(get_report_marker_locations()){
-                ikSolver.computeCurrentMarkerLocations(markerLocations);
                 Array<double> locations(0.0, 3*nm);
                 for(int j=0; j<nm; ++j){
                     for(int k=0; k<3; ++k)
-                        locations.set(3*j+k, markerLocations[j][k]);
+                        locations.set(3*j+k, frameMarkerLocations[j][k]);
                 }
 
-                modelMarkerLocations->append(s.getTime(), 3*nm, &locations[0]);
+                modelMarkerLocations->append(state.getTime(), 3*nm, &locations[0]);
 
             }
 
-            kinematicsReporter->step(s, i);
-            analysisSet.step(s, i);
+            kinematicsReporter->step(state, i);
+            analysisSet.step(state, i);
+        };
+
+        OPENSIM_THROW_IF_FRMOBJ(get_num_threads() < 1, Exception,
+                "Expected num_threads to be at least 1, but got {}.",
+                get_num_threads());
+        const int numChunks = std::min(get_num_threads(), Nframes);
+        if (numChunks <= 1) {
+            for (int i = start_ix; i <= final_ix; ++i) {
+                s.updTime() = times[i];
+                ikSolver.track(s);
+                // show progress line every 1000 frames so users see progress
+                if (std::remainder(i - start_ix, 1000) == 0 && i != start_ix)
+                    log_info("Solved {} frame(s)...", i - start_ix);
+                if (get_report_errors())
+                    ikSolver.computeCurrentSquaredMarkerErrors(
+                            squaredMarkerErrors);
+                if (get_report_marker_locations())
+                    ikSolver.computeCurrentMarkerLocations(markerLocations);
+                recordFrame(i, s, squaredMarkerErrors, markerLocations);
+            }
+        } else {
+            // Split the frames into consecutive chunks, solve each chunk on
+            // its own copy of the model, then record the frames in order.
+            // Each chunk starts with a full assembly (as the first frame of
+            // the serial solve does) and tracks the remaining frames of the
+            // chunk, so the solution at the start of each chunk other than
+            // the first can differ from the serial solution by up to the
+            // accuracy of the solver.
+            log_info("Solving {} frames in {} chunks in parallel.", Nframes,
+                    numChunks);
+            std::vector<IKFrameSolution> solutions(Nframes);
+            std::vector<std::unique_ptr<Model>> chunkModels;
+            for (int c = 0; c < numChunks; ++c) {
+                chunkModels.emplace_back(_model->clone());
+                // The analyses are stepped with the model of this tool.
+                chunkModels.back()->updAnalysisSet().clearAndDestroy();
+            }
+            std::atomic<int> numSolved(0);
+            std::vector<std::exception_ptr> chunkErrors(numChunks);
+            auto solveChunk = [&](int c) {
+                try {
+                    const int begin = start_ix + c * Nframes / numChunks;
+                    const int end = start_ix + (c + 1) * Nframes / numChunks;
+                    Model& chunkModel = *chunkModels[c];
+                    SimTK::State& cs = chunkModel.initSystem();
+                    InverseKinematicsSolver chunkSolver(chunkModel,
+                            make_shared<MarkersReference>(markersReference),
+                            coordinateReferences, get_constraint_weight());
+                    chunkSolver.setAccuracy(get_accuracy());
+                    cs.updTime() = times[begin];
+                    chunkSolver.assemble(cs);
+                    for (int i = begin; i < end; ++i) {
+                        cs.updTime() = times[i];
+                        chunkSolver.track(cs);
+                        IKFrameSolution& solution = solutions[i - start_ix];
+                        solution.q = cs.getQ();
+                        solution.squaredMarkerErrors.resize(nm, 0.0);
+                        solution.markerLocations.resize(nm, Vec3(0));
+                        if (get_report_errors())
+                            chunkSolver.computeCurrentSquaredMarkerErrors(
+                                    solution.squaredMarkerErrors);
+                        if (get_report_marker_locations())
+                            chunkSolver.computeCurrentMarkerLocations(
+                                    solution.markerLocations);
+                        const int solved = ++numSolved;
+                        if (solved % 1000 == 0)
+                            log_info("Solved {} frame(s)...", solved);
+                    }
+                } catch (...) {
+                    chunkErrors[c] = std::current_exception();
+                }
+            };
+            std::vector<std::thread> threads;
+            for (int c = 1; c < numChunks; ++c)
+                threads.emplace_back(solveChunk, c);
+            solveChunk(0);
+            for (auto& thread : threads) thread.join();
+            for (const auto& error : chunkErrors)
+                if (error) std::rethrow_exception(error);
+
+            for (int i = start_ix; i <= final_ix; ++i) {
+                const IKFrameSolution& solution = solutions[i - start_ix];
+                s.updTime() = times[i];
+                s.updQ() = solution.q;
+                _model->getMultibodySystem().realize(s, SimTK::Stage::Position);
+                recordFrame(i, s, solution.squaredMarkerErrors,
+                        solution.markerLocations);
+            }
         }
 
         // Do the maneuver to change then restore working directory 
@@ -71,6 +71,11 @@ public:
             "Flag indicating whether or not to report model marker locations. "
             "Note, model marker locations are expressed in Ground.");
 
+    OpenSim_DECLARE_PROPERTY(num_threads, int,
+            "The number of threads used to solve the frames (default: 1). With "
+            "more than 1 thread, the frames are split into consecutive chunks "
+            "that are solved in parallel, each starting with a full assembly.");
+
 //=============================================================================
 // METHODS
 //=============================================================================
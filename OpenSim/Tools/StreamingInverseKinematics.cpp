@@ -0,0 +1,304 @@
+/* -------------------------------------------------------------------------- *
+ *                  OpenSim:  StreamingInverseKinematics.cpp                  *
+ * -------------------------------------------------------------------------- *
+ * The OpenSim API is a toolkit for musculoskeletal modeling and simulation.  *
+ * See http://opensim.stanford.edu and the NOTICE file for more information.  *
+ * OpenSim is developed at Stanford University and supported by the US        *
+ * National Institutes of Health (U54 GM072970, R24 HD065690) and by DARPA    *
+ * through the Warrior Web program.                                           *
+ *                                                                            *
+ * Copyright (c) 2005-2021 Stanford University and the Authors                *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+#include "StreamingInverseKinematics.h"
+
+#include <OpenSim/Common/Units.h>
+#include <OpenSim/Simulation/InverseKinematicsSolver.h>
+#include <OpenSim/Simulation/Model/Model.h>
+
+#include <algorithm>
+
+using namespace OpenSim;
+
+namespace {
+
+double secondsSince(std::chrono::steady_clock::time_point start,
+        std::chrono::steady_clock::time_point end) {
+    return std::chrono::duration<double>(end - start).count();
+}
+
+/// The units of marker data, which are meters if not specified.
+Units getTableUnits(const TimeSeriesTable_<SimTK::Vec3>& table) {
+    if (table.hasTableMetaDataKey("Units")) {
+        return Units(table.getTableMetaData<std::string>("Units"));
+    }
+    return Units(Units::Meters);
+}
+
+} // anonymous namespace
+
+//=============================================================================
+// StreamingInverseKinematics
+//=============================================================================
+StreamingInverseKinematics::StreamingInverseKinematics(const Model& model,
+        std::shared_ptr<BufferedMarkersReference> markersReference,
+        const SimTK::Array_<CoordinateReference>& coordinateReferences,
+        double constraintWeight)
+        : m_model(model.clone()), m_markersReference(markersReference),
+          m_coordinateReferences(coordinateReferences),
+          m_constraintWeight(constraintWeight) {
+    OPENSIM_THROW_IF(!m_markersReference, Exception,
+            "Expected a BufferedMarkersReference, but got nullptr.");
+    m_state = m_model->initSystem();
+}
+
+StreamingInverseKinematics::~StreamingInverseKinematics() {
+    m_stopRequested = true;
+    if (m_thread.joinable()) m_thread.join();
+}
+
+void StreamingInverseKinematics::setAccuracy(double accuracy) {
+    OPENSIM_THROW_IF(m_running, Exception,
+            "Cannot change the accuracy while the solver thread is running.");
+    m_accuracy = accuracy;
+}
+
+void StreamingInverseKinematics::setFrameCallback(FrameCallback callback) {
+    OPENSIM_THROW_IF(m_running, Exception,
+            "Cannot change the frame callback while the solver thread is "
+            "running.");
+    m_callback = std::move(callback);
+}
+
+void StreamingInverseKinematics::start() {
+    OPENSIM_THROW_IF(m_thread.joinable(), Exception,
+            "The solver thread was already started.");
+
+    m_solver.reset(new InverseKinematicsSolver(*m_model, m_markersReference,
+            m_coordinateReferences, m_constraintWeight));
+    m_solver->setAccuracy(m_accuracy);
+
+    // Assemble to the marker data of the reference, before any frames are
+    // drawn from the buffer.
+    m_state.updTime() = m_markersReference->getValidTimeRange()[0];
+    m_solver->assemble(m_state);
+    m_solver->setAdvanceTimeFromReference(true);
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_statistics = Statistics();
+        m_totalLatency = 0;
+        m_totalSolveTime = 0;
+        m_latestTime = SimTK::NaN;
+    }
+    m_exception = nullptr;
+    m_stopRequested = false;
+    m_running = true;
+    m_startTime = std::chrono::steady_clock::now();
+    m_thread = std::thread(&StreamingInverseKinematics::solveFrames, this);
+}
+
+void StreamingInverseKinematics::stop() {
+    m_stopRequested = true;
+    if (m_thread.joinable()) m_thread.join();
+}
+
+void StreamingInverseKinematics::waitUntilFinished() {
+    if (m_thread.joinable()) m_thread.join();
+    if (m_exception) {
+        std::exception_ptr exception = m_exception;
+        m_exception = nullptr;
+        std::rethrow_exception(exception);
+    }
+}
+
+bool StreamingInverseKinematics::getLatestSolution(
+        double& time, SimTK::Vector& q) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_statistics.numFramesSolved == 0) return false;
+    time = m_latestTime;
+    q = m_latestQ;
+    return true;
+}
+
+StreamingInverseKinematics::Statistics
+StreamingInverseKinematics::getStatistics() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Statistics statistics = m_statistics;
+    statistics.numFramesRejected = m_markersReference->getNumFramesRejected();
+    if (statistics.numFramesSolved > 0) {
+        statistics.meanLatency =
+                m_totalLatency / statistics.numFramesSolved;
+        statistics.meanSolveTime =
+                m_totalSolveTime / statistics.numFramesSolved;
+        const double elapsed = secondsSince(m_startTime,
+                m_running ? std::chrono::steady_clock::now() : m_stopTime);
+        if (elapsed > 0) {
+            statistics.throughput = statistics.numFramesSolved / elapsed;
+        }
+    }
+    return statistics;
+}
+
+void StreamingInverseKinematics::solveFrames() {
+    try {
+        while (!m_stopRequested) {
+            if (!m_markersReference->waitForFrame(0.01)) {
+                if (!m_markersReference->hasNext()) break;
+                continue;
+            }
+            int numSkipped = 0;
+            if (m_dropStaleFrames) {
+                numSkipped = m_markersReference->discardStaleFrames();
+            }
+
+            // track() draws the next frame from the reference and sets the
+            // time of the state to the time of the frame.
+            const auto solveStart = std::chrono::steady_clock::now();
+            m_solver->track(m_state);
+            const auto solveEnd = std::chrono::steady_clock::now();
+            const double solveTime = secondsSince(solveStart, solveEnd);
+            const double latency = secondsSince(
+                    m_markersReference->getReceiveTimeOfLastFrame(), solveEnd);
+
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                ++m_statistics.numFramesSolved;
+                m_statistics.numFramesSkipped += numSkipped;
+                m_statistics.lastLatency = latency;
+                m_statistics.maxLatency =
+                        std::max(m_statistics.maxLatency, latency);
+                m_statistics.maxSolveTime =
+                        std::max(m_statistics.maxSolveTime, solveTime);
+                m_totalLatency += latency;
+                m_totalSolveTime += solveTime;
+                m_latestTime = m_state.getTime();
+                m_latestQ = m_state.getQ();
+            }
+
+            if (m_callback) m_callback(m_state, *m_solver);
+        }
+    } catch (...) {
+        m_exception = std::current_exception();
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopTime = std::chrono::steady_clock::now();
+        m_running = false;
+    }
+}
+
+//=============================================================================
+// MarkersReplayProducer
+//=============================================================================
+MarkersReplayProducer::MarkersReplayProducer(
+        std::shared_ptr<BufferedMarkersReference> markersReference,
+        const TimeSeriesTable_<SimTK::Vec3>& markerData, double frameRate)
+        : m_markersReference(markersReference), m_frameRate(frameRate) {
+    OPENSIM_THROW_IF(!m_markersReference, Exception,
+            "Expected a BufferedMarkersReference, but got nullptr.");
+    OPENSIM_THROW_IF(frameRate < 0, Exception,
+            "Expected frameRate to be non-negative, but got {}.", frameRate);
+
+    const double scaleFactor = getTableUnits(markerData).convertTo(
+            getTableUnits(m_markersReference->getMarkerTable()));
+    OPENSIM_THROW_IF(SimTK::isNaN(scaleFactor), Exception,
+            "Cannot convert the units of the marker data to the units of the "
+            "reference.");
+
+    const auto& names = m_markersReference->getNames();
+    const int nr = (int)markerData.getNumRows();
+    const int nm = (int)names.size();
+    m_times = markerData.getIndependentColumn();
+    m_frames.resize(nr, nm);
+    m_frames.setToNaN();
+    for (int j = 0; j < nm; ++j) {
+        if (!markerData.hasColumn(names[j])) continue;
+        const auto column = markerData.getDependentColumn(names[j]);
+        for (int i = 0; i < nr; ++i) {
+            m_frames(i, j) = scaleFactor * column[i];
+        }
+    }
+}
+
+MarkersReplayProducer::~MarkersReplayProducer() {
+    stop();
+}
+
+void MarkersReplayProducer::start() {
+    OPENSIM_THROW_IF(m_thread.joinable(), Exception,
+            "The producer thread was already started.");
+    m_exception = nullptr;
+    m_stopRequested = false;
+    m_thread = std::thread(&MarkersReplayProducer::replay, this);
+}
+
+void MarkersReplayProducer::stop() {
+    m_stopRequested = true;
+    if (m_thread.joinable()) m_thread.join();
+}
+
+void MarkersReplayProducer::join() {
+    if (m_thread.joinable()) m_thread.join();
+    if (m_exception) {
+        std::exception_ptr exception = m_exception;
+        m_exception = nullptr;
+        std::rethrow_exception(exception);
+    }
+}
+
+void MarkersReplayProducer::replay() {
+    try {
+        const auto start = std::chrono::steady_clock::now();
+        SimTK::RowVector_<SimTK::Vec3> frame(m_frames.ncol());
+        for (int i = 0; i < (int)m_times.size() && !m_stopRequested; ++i) {
+            frame = m_frames[i];
+            if (m_frameRate > 0) {
+                std::this_thread::sleep_until(start +
+                        std::chrono::duration_cast<
+                                std::chrono::steady_clock::duration>(
+                                std::chrono::duration<double>(
+                                        i / m_frameRate)));
+                if (m_markersReference->putValues(m_times[i], frame)) {
+                    ++m_numFramesPushed;
+                } else {
+                    ++m_numFramesRejected;
+                }
+            } else {
+                // Wait for room in the buffer rather than dropping the
+                // frame. Only this thread adds frames, so the frame is
+                // accepted once there is room. As in
+                // BufferedMarkersReference::waitForFrame(), spin briefly and
+                // then sleep, so that waiting for a slow consumer does not
+                // occupy a core.
+                int numPolls = 0;
+                while (m_markersReference->getNumBufferedFrames() >=
+                        m_markersReference->getBufferCapacity()) {
+                    if (m_stopRequested) break;
+                    if (++numPolls < 100) {
+                        std::this_thread::yield();
+                    } else {
+                        std::this_thread::sleep_for(
+                                std::chrono::microseconds(100));
+                    }
+                }
+                if (m_stopRequested) break;
+                m_markersReference->putValues(m_times[i], frame);
+                ++m_numFramesPushed;
+            }
+        }
+    } catch (...) {
+        m_exception = std::current_exception();
+    }
+    m_markersReference->setFinished(true);
+}
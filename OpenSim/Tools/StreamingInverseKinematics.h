@@ -0,0 +1,238 @@
+#ifndef OPENSIM_STREAMING_INVERSE_KINEMATICS_H_
+#define OPENSIM_STREAMING_INVERSE_KINEMATICS_H_
+/* -------------------------------------------------------------------------- *
+ *                   OpenSim:  StreamingInverseKinematics.h                   *
+ * -------------------------------------------------------------------------- *
+ * The OpenSim API is a toolkit for musculoskeletal modeling and simulation.  *
+ * See http://opensim.stanford.edu and the NOTICE file for more information.  *
+ * OpenSim is developed at Stanford University and supported by the US        *
+ * National Institutes of Health (U54 GM072970, R24 HD065690) and by DARPA    *
+ * through the Warrior Web program.                                           *
+ *                                                                            *
+ * Copyright (c) 2005-2021 Stanford University and the Authors                *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+#include "osimToolsDLL.h"
+#include <OpenSim/Simulation/BufferedMarkersReference.h>
+#include <OpenSim/Simulation/CoordinateReference.h>
+#include <atomic>
+#include <chrono>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace OpenSim {
+
+class Model;
+class InverseKinematicsSolver;
+
+/** Solve inverse kinematics on a live stream of marker data. Frames are added
+to a BufferedMarkersReference by a producer thread (e.g., a thread reading
+from a motion capture system, or a MarkersReplayProducer), and a solver thread
+owned by this class tracks them with an InverseKinematicsSolver as they
+arrive.
+
+By default, the solver always works on the newest frame: frames that arrived
+while the previous frame was being solved are discarded (see
+setDropStaleFrames()), so the latency stays bounded when frames arrive faster
+than they can be solved. Each solved frame is passed to the frame callback (if
+any), and the newest solution is available from getLatestSolution(). The
+latency (from putValues() to the end of the solve), solve time, and
+throughput are tracked in the Statistics.
+
+@code
+auto markersRef = std::make_shared<BufferedMarkersReference>(
+        firstFrames, Set<MarkerWeight>());
+StreamingInverseKinematics streamingIK(model, markersRef);
+streamingIK.setFrameCallback([](const SimTK::State& s,
+        InverseKinematicsSolver&) { sendToVisualizer(s); });
+streamingIK.start();
+// ... producer thread calls markersRef->putValues() and, at the end,
+// markersRef->setFinished(true) ...
+streamingIK.waitUntilFinished();
+log_info("Mean latency: {} s.", streamingIK.getStatistics().meanLatency);
+@endcode
+
+The solver thread uses its own copy of the model. The marker data used to
+construct the BufferedMarkersReference must contain at least one frame, which
+is used to assemble the model before streaming starts. */
+class OSIMTOOLS_API StreamingInverseKinematics {
+public:
+    /// Performance of the solver thread. Times are in seconds.
+    struct Statistics {
+        /// Number of frames solved.
+        int numFramesSolved = 0;
+        /// Number of frames discarded because a newer frame was available.
+        int numFramesSkipped = 0;
+        /// Number of frames the reference rejected because its buffer was
+        /// full.
+        int numFramesRejected = 0;
+        /// Time from adding a frame (putValues()) to the end of its solve.
+        double meanLatency = 0;
+        double maxLatency = 0;
+        double lastLatency = 0;
+        /// Time spent in InverseKinematicsSolver::track() for a frame.
+        double meanSolveTime = 0;
+        double maxSolveTime = 0;
+        /// Frames solved per second of wall-clock time since start().
+        double throughput = 0;
+    };
+
+    /// Called by the solver thread after each frame is solved, with the
+    /// solved state.
+    using FrameCallback = std::function<void(
+            const SimTK::State&, InverseKinematicsSolver&)>;
+
+    StreamingInverseKinematics(const Model& model,
+            std::shared_ptr<BufferedMarkersReference> markersReference,
+            const SimTK::Array_<CoordinateReference>& coordinateReferences =
+                    SimTK::Array_<CoordinateReference>(),
+            double constraintWeight = SimTK::Infinity);
+    /// Stops the solver thread if it is running.
+    ~StreamingInverseKinematics();
+
+    StreamingInverseKinematics(const StreamingInverseKinematics&) = delete;
+    StreamingInverseKinematics& operator=(
+            const StreamingInverseKinematics&) = delete;
+
+    /// The accuracy of the InverseKinematicsSolver (default: 1e-4).
+    void setAccuracy(double accuracy);
+    double getAccuracy() const { return m_accuracy; }
+
+    /// Discard all but the newest buffered frame before each solve
+    /// (default: true). If false, every frame is solved in order, and the
+    /// latency grows if frames arrive faster than they can be solved.
+    void setDropStaleFrames(bool tf) { m_dropStaleFrames = tf; }
+    bool getDropStaleFrames() const { return m_dropStaleFrames; }
+
+    /// The callback runs on the solver thread, so a slow callback delays the
+    /// next solve.
+    void setFrameCallback(FrameCallback callback);
+
+    /// Assemble the model to the first frame of the marker data (on the
+    /// calling thread) and start the solver thread. The solver thread stops
+    /// when the producer has finished and all frames are consumed, or when
+    /// stop() is called.
+    void start();
+    /// Stop the solver thread after the frame it is solving, and wait for it.
+    void stop();
+    /// Wait for the solver thread to stop. If the solver thread failed, its
+    /// exception is rethrown here.
+    void waitUntilFinished();
+    bool isRunning() const { return m_running; }
+
+    /// The time and generalized coordinates of the newest solved frame.
+    /// @returns false if no frame has been solved yet.
+    bool getLatestSolution(double& time, SimTK::Vector& q) const;
+
+    Statistics getStatistics() const;
+
+    const Model& getModel() const { return *m_model; }
+    const BufferedMarkersReference& getMarkersReference() const {
+        return *m_markersReference;
+    }
+
+private:
+    void solveFrames();
+
+    std::unique_ptr<Model> m_model;
+    std::shared_ptr<BufferedMarkersReference> m_markersReference;
+    SimTK::Array_<CoordinateReference> m_coordinateReferences;
+    double m_constraintWeight;
+    double m_accuracy = 1e-4;
+    bool m_dropStaleFrames = true;
+    FrameCallback m_callback;
+
+    // Used only by the solver thread once it is started.
+    std::unique_ptr<InverseKinematicsSolver> m_solver;
+    SimTK::State m_state;
+
+    std::thread m_thread;
+    std::atomic<bool> m_running{false};
+    std::atomic<bool> m_stopRequested{false};
+    std::exception_ptr m_exception;
+    std::chrono::steady_clock::time_point m_startTime;
+    std::chrono::steady_clock::time_point m_stopTime;
+
+    // Guards the statistics and the latest solution, which are written by
+    // the solver thread and read by other threads.
+    mutable std::mutex m_mutex;
+    Statistics m_statistics;
+    double m_totalLatency = 0;
+    double m_totalSolveTime = 0;
+    double m_latestTime = SimTK::NaN;
+    SimTK::Vector m_latestQ;
+};
+
+/** Replay marker data from a table into a BufferedMarkersReference on a
+separate thread, at a fixed frame rate, to mimic a live motion capture feed
+(e.g., for testing or benchmarking StreamingInverseKinematics).
+
+Frame i of the table is added at i / frameRate seconds after start(), with
+its time from the table. Columns are matched to the markers of the reference
+by name (markers missing from the table are NaN), and the locations are
+converted to the units of the reference. If the buffer of the reference is
+full, the frame is dropped, as for a live feed. With a frameRate of 0, frames
+are added as fast as possible and the producer waits for room in the buffer
+instead of dropping frames; while it waits, it sleeps between checks rather
+than occupying a core. If nothing draws frames from the reference, call stop()
+to end such a wait. After the last frame (or stop()), the reference is marked
+as finished. */
+class OSIMTOOLS_API MarkersReplayProducer {
+public:
+    MarkersReplayProducer(
+            std::shared_ptr<BufferedMarkersReference> markersReference,
+            const TimeSeriesTable_<SimTK::Vec3>& markerData,
+            double frameRate = 200);
+    /// Stops the producer thread (see stop()).
+    ~MarkersReplayProducer();
+
+    MarkersReplayProducer(const MarkersReplayProducer&) = delete;
+    MarkersReplayProducer& operator=(const MarkersReplayProducer&) = delete;
+
+    /// Start adding frames on a separate thread.
+    void start();
+    /// Wait until all frames have been added. If the producer thread failed,
+    /// its exception is rethrown here.
+    void join();
+    /// Stop adding frames and wait for the producer thread to finish. The
+    /// destructor calls this.
+    void stop();
+
+    int getNumFrames() const { return (int)m_times.size(); }
+    /// The number of frames the reference accepted so far.
+    int getNumFramesPushed() const { return m_numFramesPushed; }
+    /// The number of frames dropped because the buffer was full.
+    int getNumFramesRejected() const { return m_numFramesRejected; }
+
+private:
+    void replay();
+
+    std::shared_ptr<BufferedMarkersReference> m_markersReference;
+    std::vector<double> m_times;
+    // One row per frame, one column per marker of the reference.
+    SimTK::Matrix_<SimTK::Vec3> m_frames;
+    double m_frameRate;
+
+    std::thread m_thread;
+    std::exception_ptr m_exception;
+    std::atomic<bool> m_stopRequested{false};
+    std::atomic<int> m_numFramesPushed{0};
+    std::atomic<int> m_numFramesRejected{0};
+};
+
+} // namespace OpenSim
+
+#endif // OPENSIM_STREAMING_INVERSE_KINEMATICS_H_
@@ -31,6 +31,8 @@
 
 #include "InverseKinematicsTool.h"
 #include "InverseDynamicsTool.h"
+#include "BatchToolRunner.h"
+#include "StreamingInverseKinematics.h"
 #include "GenericModelMaker.h"
 #include "TrackingTask.h"
 #include "MuscleStateTrackingTask.h"